@@ -0,0 +1,417 @@
+/*
+ AES-GCM authenticated encryption (NIST SP 800-38D).
+
+ The text is encrypted in counter mode and the ciphertext is hashed by
+ GHASH block by block as it is produced, so each byte is read and written
+ once. The portable GHASH multiplies with integer multiplications on
+ masked operands and has no table lookups, so its timing does not depend
+ on the hash key or the data. With AES-NI and PCLMULQDQ the whole blocks
+ go to aes_ni_gcm_crypt(), which encrypts and hashes AES_NI_BLOCKS blocks
+ at a time using the powers of the hash key kept in the context.
+*/
+
+#include <string.h>
+
+#include "aesopt.h"
+#include "aes_gcm.h"
+#include "memzero.h"
+
+#if defined( USE_INTEL_AES_IF_PRESENT )
+#  include "aes_ni.h"
+#  define gcm_has_clmul()   has_aes_ni_clmul()
+#else
+#  define gcm_has_clmul()   0
+#endif
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#define gcm_valid_tag_len(n)    ((n) >= AES_GCM_MIN_TAG_LEN && (n) <= AES_BLOCK_SIZE)
+
+/* the text of one message is limited to 2^32 - 2 blocks */
+#define GCM_MAX_TXT     ((((uint64_t)1 << 32) - 2) * AES_BLOCK_SIZE)
+
+static uint64_t gcm_load64(const unsigned char *p)
+{
+    return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40)
+         | ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16)
+         | ((uint64_t)p[6] <<  8) |  (uint64_t)p[7];
+}
+
+static void gcm_store64(unsigned char *p, uint64_t v)
+{   int i;
+
+    for(i = 7; i >= 0; --i, v >>= 8)
+        p[i] = (unsigned char)v;
+}
+
+/* the low 64 bits of the carry-less product of x and y. The operands */
+/* are split into four sets of bits 4 apart, the holes between them   */
+/* absorb the carries of the integer multiplications                  */
+
+static uint64_t gcm_bmul64(uint64_t x, uint64_t y)
+{   const uint64_t m0 = 0x1111111111111111, m1 = 0x2222222222222222,
+                   m2 = 0x4444444444444444, m3 = 0x8888888888888888;
+    uint64_t x0 = x & m0, x1 = x & m1, x2 = x & m2, x3 = x & m3;
+    uint64_t y0 = y & m0, y1 = y & m1, y2 = y & m2, y3 = y & m3;
+    uint64_t z0, z1, z2, z3;
+
+    z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+    z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+    z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+    z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+    return (z0 & m0) | (z1 & m1) | (z2 & m2) | (z3 & m3);
+}
+
+static uint64_t gcm_rev64(uint64_t x)
+{
+    x = ((x & 0x5555555555555555) << 1) | ((x >> 1) & 0x5555555555555555);
+    x = ((x & 0x3333333333333333) << 2) | ((x >> 2) & 0x3333333333333333);
+    x = ((x & 0x0f0f0f0f0f0f0f0f) << 4) | ((x >> 4) & 0x0f0f0f0f0f0f0f0f);
+    x = ((x & 0x00ff00ff00ff00ff) << 8) | ((x >> 8) & 0x00ff00ff00ff00ff);
+    x = ((x & 0x0000ffff0000ffff) << 16) | ((x >> 16) & 0x0000ffff0000ffff);
+    return (x << 32) | (x >> 32);
+}
+
+/* the 127-bit carry-less product of x and y, the high half comes */
+/* from the low half of the product of the reversed operands      */
+
+static void gcm_clmul64(uint64_t x, uint64_t y, uint64_t *hi, uint64_t *lo)
+{
+    *lo = gcm_bmul64(x, y);
+    *hi = gcm_rev64(gcm_bmul64(gcm_rev64(x), gcm_rev64(y))) >> 1;
+}
+
+/* y = y * h in GF(2^128). The first byte of a GCM block holds the lowest */
+/* coefficients, so loaded big-endian the bits are in reverse order and  */
+/* the product of two elements is one bit short of the reversed product  */
+
+static void gcm_gf_mul(unsigned char y[AES_BLOCK_SIZE], const unsigned char h[AES_BLOCK_SIZE])
+{   uint64_t a1 = gcm_load64(y), a0 = gcm_load64(y + 8);
+    uint64_t b1 = gcm_load64(h), b0 = gcm_load64(h + 8);
+    uint64_t z0h, z0l, z2h, z2l, mh, ml, t0, t1, t2, t3, d0, d1;
+
+    /* Karatsuba */
+    gcm_clmul64(a0, b0, &z0h, &z0l);
+    gcm_clmul64(a1, b1, &z2h, &z2l);
+    gcm_clmul64(a0 ^ a1, b0 ^ b1, &mh, &ml);
+    mh ^= z0h ^ z2h;
+    ml ^= z0l ^ z2l;
+    t0 = z0l;
+    t1 = z0h ^ ml;
+    t2 = z2l ^ mh;
+    t3 = z2h;
+
+    t3 = (t3 << 1) | (t2 >> 63);
+    t2 = (t2 << 1) | (t1 >> 63);
+    t1 = (t1 << 1) | (t0 >> 63);
+    t0 <<= 1;
+
+    /* reduce modulo x^128 + x^7 + x^2 + x + 1, folding first the bits */
+    /* that the shifts would carry out of t1:t0                        */
+    d1 = t1 ^ (t0 << 63) ^ (t0 << 62) ^ (t0 << 57);
+    d0 = t0;
+    t3 ^= d1 ^ (d1 >> 1) ^ (d1 >> 2) ^ (d1 >> 7);
+    t2 ^= d0 ^ ((d0 >> 1) | (d1 << 63)) ^ ((d0 >> 2) | (d1 << 62)) ^ ((d0 >> 7) | (d1 << 57));
+
+    gcm_store64(y, t3);
+    gcm_store64(y + 8, t2);
+}
+
+static void gcm_xor_block(unsigned char *d, const unsigned char *s)
+{   int i;
+
+    for(i = 0; i < AES_BLOCK_SIZE; ++i)
+        d[i] ^= s[i];
+}
+
+static void gcm_ghash_blocks(const unsigned char *data, size_t nb, aes_gcm_ctx ctx[1])
+{
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(gcm_has_clmul())
+    {
+        aes_ni_ghash(ctx->ghash, data, nb, (const unsigned char (*)[AES_BLOCK_SIZE])ctx->hpow);
+        return;
+    }
+#endif
+    for(; nb > 0; --nb, data += AES_BLOCK_SIZE)
+    {
+        gcm_xor_block(ctx->ghash, data);
+        gcm_gf_mul(ctx->ghash, ctx->hpow[0]);
+    }
+}
+
+/* hashes the partial block in buf padded with zeros */
+static void gcm_ghash_partial(size_t len, aes_gcm_ctx ctx[1])
+{
+    memset(ctx->buf + len, 0, AES_BLOCK_SIZE - len);
+    gcm_ghash_blocks(ctx->buf, 1, ctx);
+}
+
+/* GCM increments the last 32 bits of the counter block only */
+static void gcm_inc32(unsigned char *ctr)
+{
+    if(!++ctr[15] && !++ctr[14] && !++ctr[13])
+        ++ctr[12];
+}
+
+AES_RETURN aes_gcm_init_key(const unsigned char *key, int key_len, aes_gcm_ctx ctx[1])
+{   AES_RETURN ret;
+    int i;
+
+    switch(key_len)
+    {
+#if defined( AES_128 ) || defined( AES_VAR )
+    case 16: ret = aes_encrypt_key128(key, ctx->aes); break;
+#endif
+#if defined( AES_192 ) || defined( AES_VAR )
+    case 24: ret = aes_encrypt_key192(key, ctx->aes); break;
+#endif
+#if defined( AES_256 ) || defined( AES_VAR )
+    case 32: ret = aes_encrypt_key256(key, ctx->aes); break;
+#endif
+    default: return EXIT_FAILURE;
+    }
+    if(ret != EXIT_SUCCESS)
+        return ret;
+
+    memset(ctx->hpow[0], 0, AES_BLOCK_SIZE);
+    if(aes_encrypt(ctx->hpow[0], ctx->hpow[0], ctx->aes) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    for(i = 1; i < AES_GCM_HPOWERS; ++i)
+    {
+        memcpy(ctx->hpow[i], ctx->hpow[i - 1], AES_BLOCK_SIZE);
+        gcm_gf_mul(ctx->hpow[i], ctx->hpow[0]);
+    }
+    ctx->hdr_cnt = ctx->txt_cnt = 0;
+    return EXIT_SUCCESS;
+}
+
+AES_RETURN aes_gcm_init_message(const unsigned char *iv, size_t iv_len, aes_gcm_ctx ctx[1])
+{
+    if(iv_len == 0)
+        return EXIT_FAILURE;
+
+    memset(ctx->ghash, 0, AES_BLOCK_SIZE);
+    if(iv_len == 12)
+    {
+        memcpy(ctx->ctr, iv, 12);
+        ctx->ctr[12] = ctx->ctr[13] = ctx->ctr[14] = 0;
+        ctx->ctr[15] = 1;
+    }
+    else
+    {   /* J0 = GHASH(IV || 0^s || 0^64 || [len(IV)]_64) */
+        size_t nb = iv_len / AES_BLOCK_SIZE, rem = iv_len % AES_BLOCK_SIZE;
+
+        gcm_ghash_blocks(iv, nb, ctx);
+        if(rem)
+        {
+            memcpy(ctx->buf, iv + nb * AES_BLOCK_SIZE, rem);
+            gcm_ghash_partial(rem, ctx);
+        }
+        memset(ctx->buf, 0, 8);
+        gcm_store64(ctx->buf + 8, (uint64_t)iv_len << 3);
+        gcm_ghash_blocks(ctx->buf, 1, ctx);
+        memcpy(ctx->ctr, ctx->ghash, AES_BLOCK_SIZE);
+        memset(ctx->ghash, 0, AES_BLOCK_SIZE);
+    }
+
+    if(aes_encrypt(ctx->ctr, ctx->tagmask, ctx->aes) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    gcm_inc32(ctx->ctr);
+    ctx->hdr_cnt = ctx->txt_cnt = 0;
+    return EXIT_SUCCESS;
+}
+
+AES_RETURN aes_gcm_auth_header(const unsigned char *hdr, size_t hdr_len, aes_gcm_ctx ctx[1])
+{   size_t pos = (size_t)(ctx->hdr_cnt % AES_BLOCK_SIZE), nb;
+
+    if(ctx->txt_cnt)
+        return EXIT_FAILURE;
+    ctx->hdr_cnt += hdr_len;
+
+    if(pos)
+    {   /* complete a partial block */
+        while(pos < AES_BLOCK_SIZE && hdr_len)
+        {
+            ctx->buf[pos++] = *hdr++;
+            --hdr_len;
+        }
+        if(pos < AES_BLOCK_SIZE)
+            return EXIT_SUCCESS;
+        gcm_ghash_blocks(ctx->buf, 1, ctx);
+    }
+
+    nb = hdr_len / AES_BLOCK_SIZE;
+    gcm_ghash_blocks(hdr, nb, ctx);
+    hdr += nb * AES_BLOCK_SIZE;
+    memcpy(ctx->buf, hdr, hdr_len % AES_BLOCK_SIZE);
+    return EXIT_SUCCESS;
+}
+
+/* whole blocks from the counter, hashing the ciphertext of each block */
+/* before the next one is produced                                     */
+static AES_RETURN gcm_crypt_blocks(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t nb, int encrypt, aes_gcm_ctx ctx[1])
+{   unsigned char c[AES_BLOCK_SIZE];
+    int i;
+
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(gcm_has_clmul())
+        return aes_ni_gcm_crypt(ibuf, obuf, nb, ctx->ctr, ctx->ghash,
+                    (const unsigned char (*)[AES_BLOCK_SIZE])ctx->hpow, encrypt, ctx->aes);
+#endif
+    for(; nb > 0; --nb, ibuf += AES_BLOCK_SIZE, obuf += AES_BLOCK_SIZE)
+    {
+        if(aes_encrypt(ctx->ctr, ctx->ks, ctx->aes) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+        gcm_inc32(ctx->ctr);
+        for(i = 0; i < AES_BLOCK_SIZE; ++i)
+        {
+            c[i] = (encrypt ? ibuf[i] ^ ctx->ks[i] : ibuf[i]);
+            obuf[i] = ibuf[i] ^ ctx->ks[i];
+        }
+        gcm_xor_block(ctx->ghash, c);
+        gcm_gf_mul(ctx->ghash, ctx->hpow[0]);
+    }
+    return EXIT_SUCCESS;
+}
+
+static AES_RETURN gcm_crypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t len, int encrypt, aes_gcm_ctx ctx[1])
+{   size_t pos = (size_t)(ctx->txt_cnt % AES_BLOCK_SIZE), nb;
+    unsigned char t;
+
+    if(len == 0)
+        return EXIT_SUCCESS;
+    if(len > GCM_MAX_TXT - ctx->txt_cnt)
+        return EXIT_FAILURE;
+
+    /* the text starts, pad the associated data to a block */
+    if(ctx->txt_cnt == 0 && ctx->hdr_cnt % AES_BLOCK_SIZE)
+        gcm_ghash_partial((size_t)(ctx->hdr_cnt % AES_BLOCK_SIZE), ctx);
+    ctx->txt_cnt += len;
+
+    if(pos)
+    {   /* complete a partial block */
+        while(pos < AES_BLOCK_SIZE && len)
+        {
+            t = *ibuf++;
+            *obuf++ = t ^ ctx->ks[pos];
+            ctx->buf[pos] = (encrypt ? t ^ ctx->ks[pos] : t);
+            ++pos;
+            --len;
+        }
+        if(pos < AES_BLOCK_SIZE)
+            return EXIT_SUCCESS;
+        gcm_ghash_blocks(ctx->buf, 1, ctx);
+    }
+
+    nb = len / AES_BLOCK_SIZE;
+    if(nb && gcm_crypt_blocks(ibuf, obuf, nb, encrypt, ctx) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    ibuf += nb * AES_BLOCK_SIZE;
+    obuf += nb * AES_BLOCK_SIZE;
+    len -= nb * AES_BLOCK_SIZE;
+
+    if(len)
+    {   /* start a partial block */
+        if(aes_encrypt(ctx->ctr, ctx->ks, ctx->aes) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+        gcm_inc32(ctx->ctr);
+        for(pos = 0; pos < len; ++pos)
+        {
+            t = ibuf[pos];
+            obuf[pos] = t ^ ctx->ks[pos];
+            ctx->buf[pos] = (encrypt ? t ^ ctx->ks[pos] : t);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+AES_RETURN aes_gcm_encrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t len, aes_gcm_ctx ctx[1])
+{
+    return gcm_crypt(ibuf, obuf, len, 1, ctx);
+}
+
+AES_RETURN aes_gcm_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t len, aes_gcm_ctx ctx[1])
+{
+    return gcm_crypt(ibuf, obuf, len, 0, ctx);
+}
+
+AES_RETURN aes_gcm_compute_tag(unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1])
+{
+    if(!gcm_valid_tag_len(tag_len))
+        return EXIT_FAILURE;
+
+    if(ctx->txt_cnt % AES_BLOCK_SIZE)
+        gcm_ghash_partial((size_t)(ctx->txt_cnt % AES_BLOCK_SIZE), ctx);
+    else if(ctx->txt_cnt == 0 && ctx->hdr_cnt % AES_BLOCK_SIZE)
+        gcm_ghash_partial((size_t)(ctx->hdr_cnt % AES_BLOCK_SIZE), ctx);
+
+    /* [len(A)]_64 || [len(C)]_64 */
+    gcm_store64(ctx->buf, ctx->hdr_cnt << 3);
+    gcm_store64(ctx->buf + 8, ctx->txt_cnt << 3);
+    gcm_ghash_blocks(ctx->buf, 1, ctx);
+
+    gcm_xor_block(ctx->ghash, ctx->tagmask);
+    memcpy(tag, ctx->ghash, tag_len);
+    return EXIT_SUCCESS;
+}
+
+AES_RETURN aes_gcm_encrypt_message(const unsigned char *iv, size_t iv_len,
+                    const unsigned char *hdr, size_t hdr_len,
+                    const unsigned char *ibuf, unsigned char *obuf, size_t len,
+                    unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1])
+{
+    if(!gcm_valid_tag_len(tag_len))
+        return EXIT_FAILURE;
+    if(aes_gcm_init_message(iv, iv_len, ctx) != EXIT_SUCCESS
+        || aes_gcm_auth_header(hdr, hdr_len, ctx) != EXIT_SUCCESS
+        || aes_gcm_encrypt(ibuf, obuf, len, ctx) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    return aes_gcm_compute_tag(tag, tag_len, ctx);
+}
+
+AES_RETURN aes_gcm_decrypt_message(const unsigned char *iv, size_t iv_len,
+                    const unsigned char *hdr, size_t hdr_len,
+                    const unsigned char *ibuf, unsigned char *obuf, size_t len,
+                    const unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1])
+{   unsigned char t[AES_BLOCK_SIZE], diff = 0;
+    size_t i;
+
+    /* a short tag would let a forgery through, do not decrypt at all */
+    if(!gcm_valid_tag_len(tag_len))
+        return EXIT_FAILURE;
+    if(aes_gcm_init_message(iv, iv_len, ctx) != EXIT_SUCCESS
+        || aes_gcm_auth_header(hdr, hdr_len, ctx) != EXIT_SUCCESS
+        || aes_gcm_decrypt(ibuf, obuf, len, ctx) != EXIT_SUCCESS
+        || aes_gcm_compute_tag(t, tag_len, ctx) != EXIT_SUCCESS)
+    {
+        memzero(obuf, len);
+        return EXIT_FAILURE;
+    }
+
+    for(i = 0; i < tag_len; ++i)
+        diff |= t[i] ^ tag[i];
+    memzero(t, sizeof(t));
+    if(diff)
+    {
+        memzero(obuf, len);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+void aes_gcm_end(aes_gcm_ctx ctx[1])
+{
+    memzero(ctx, sizeof(aes_gcm_ctx));
+}
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+ AES-GCM authenticated encryption (NIST SP 800-38D) on top of the AES key
+ schedule and block functions in this directory.
+
+ A message is processed by calling aes_gcm_init_message() with the IV,
+ aes_gcm_auth_header() any number of times for the associated data, then
+ aes_gcm_encrypt() or aes_gcm_decrypt() any number of times for the text
+ and finally aes_gcm_compute_tag(). All calls may be given any number of
+ bytes, but all the associated data has to come before the text. Every
+ call encrypts (or decrypts) and authenticates its bytes in one pass.
+
+ The functions return EXIT_SUCCESS or EXIT_FAILURE as the AES functions
+ do. aes_gcm_decrypt_message() returns EXIT_FAILURE when the tag does not
+ match, and then clears the output rather than release unauthenticated
+ plaintext.
+*/
+
+#ifndef AES_GCM_H
+#define AES_GCM_H
+
+#include <stddef.h>
+#include "aes.h"
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/* the number of powers of the hash key kept for aggregated GHASH */
+#define AES_GCM_HPOWERS 8
+
+typedef struct
+{   aes_encrypt_ctx aes[1];
+    unsigned char hpow[AES_GCM_HPOWERS][AES_BLOCK_SIZE]; /* H, H^2, ... */
+    unsigned char ghash[AES_BLOCK_SIZE];    /* the GHASH accumulator    */
+    unsigned char ctr[AES_BLOCK_SIZE];      /* the next counter block   */
+    unsigned char tagmask[AES_BLOCK_SIZE];  /* E(K, J0)                 */
+    unsigned char ks[AES_BLOCK_SIZE];       /* key stream of a partial block */
+    unsigned char buf[AES_BLOCK_SIZE];      /* a partial block to hash  */
+    uint64_t hdr_cnt;                       /* associated data bytes    */
+    uint64_t txt_cnt;                       /* text bytes               */
+} aes_gcm_ctx;
+
+/* key_len is 16, 24 or 32 bytes, the sizes this build supports */
+AES_RETURN aes_gcm_init_key(const unsigned char *key, int key_len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_init_message(const unsigned char *iv, size_t iv_len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_auth_header(const unsigned char *hdr, size_t hdr_len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_encrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t len, aes_gcm_ctx ctx[1]);
+
+/* tags shorter than 12 bytes can be forged too easily (SP 800-38D    */
+/* allows 8 and 4 byte tags only with limits on the use of the key), */
+/* tag_len must be between AES_GCM_MIN_TAG_LEN and AES_BLOCK_SIZE     */
+#define AES_GCM_MIN_TAG_LEN 12
+
+AES_RETURN aes_gcm_compute_tag(unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_encrypt_message(const unsigned char *iv, size_t iv_len,
+                    const unsigned char *hdr, size_t hdr_len,
+                    const unsigned char *ibuf, unsigned char *obuf, size_t len,
+                    unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1]);
+
+AES_RETURN aes_gcm_decrypt_message(const unsigned char *iv, size_t iv_len,
+                    const unsigned char *hdr, size_t hdr_len,
+                    const unsigned char *ibuf, unsigned char *obuf, size_t len,
+                    const unsigned char *tag, size_t tag_len, aes_gcm_ctx ctx[1]);
+
+/* clears the key and the state */
+void aes_gcm_end(aes_gcm_ctx ctx[1]);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -19,7 +19,9 @@ Issue Date: 20/12/2007
 
  These subroutines implement multiple block AES modes for ECB, CBC, CFB,
  OFB and CTR encryption,  The code provides support for the VIA Advanced
- Cryptography Engine (ACE).
+ Cryptography Engine (ACE).  With AES-NI the modes that can encrypt or
+ decrypt several blocks independently (ECB, CBC and CFB decryption and
+ CTR) pass whole runs of blocks to aes_ni.c.
 
  NOTE: In the following subroutines, the AES contexts (ctx) must be
  16 byte aligned if VIA ACE is being used
@@ -31,6 +33,10 @@ Issue Date: 20/12/2007
 
 #include "aesopt.h"
 
+#if defined( USE_INTEL_AES_IF_PRESENT )
+#  include "aes_ni.h"
+#endif
+
 #if defined( AES_MODES )
 #if defined(__cplusplus)
 extern "C"
@@ -184,6 +190,11 @@ AES_RETURN aes_ecb_encrypt(const unsigned char *ibuf, unsigned char *obuf,
 
 #endif
 
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(has_aes_ni())
+        return aes_ni_ecb_encrypt(ibuf, obuf, nb, ctx);
+#endif
+
 #if !defined( ASSUME_VIA_ACE_PRESENT )
     while(nb--)
     {
@@ -246,6 +257,11 @@ AES_RETURN aes_ecb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
 
 #endif
 
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(has_aes_ni())
+        return aes_ni_ecb_decrypt(ibuf, obuf, nb, ctx);
+#endif
+
 #if !defined( ASSUME_VIA_ACE_PRESENT )
     while(nb--)
     {
@@ -415,6 +431,11 @@ AES_RETURN aes_cbc_decrypt(const unsigned char *ibuf, unsigned char *obuf,
     }
 #endif
 
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(has_aes_ni())
+        return aes_ni_cbc_decrypt(ibuf, obuf, nb, iv, ctx);
+#endif
+
 #if !defined( ASSUME_VIA_ACE_PRESENT )
 # ifdef FAST_BUFFER_OPERATIONS
     if(!ALIGN_OFFSET( obuf, 4 ) && !ALIGN_OFFSET( iv, 4 ))
@@ -599,6 +620,17 @@ AES_RETURN aes_cfb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
 
     if((nb = (len - cnt) >> AES_BLOCK_SIZE_P2) != 0)    /* process whole blocks */
     {
+#if defined( USE_INTEL_AES_IF_PRESENT )
+        if(has_aes_ni())
+        {
+            if(aes_ni_cfb_decrypt(ibuf, obuf, nb, iv, ctx) != EXIT_SUCCESS)
+                return EXIT_FAILURE;
+            ibuf += nb * AES_BLOCK_SIZE;
+            obuf += nb * AES_BLOCK_SIZE;
+            cnt  += nb * AES_BLOCK_SIZE;
+        }
+        else
+#endif
 #if defined( USE_VIA_ACE_IF_PRESENT )
 
         if(ctx->inf.b[1] == 0xff)
@@ -876,6 +908,18 @@ AES_RETURN aes_ctr_crypt(const unsigned char *ibuf, unsigned char *obuf,
             ctr_inc(cbuf), b_pos = 0;
     }
 
+#if defined( USE_INTEL_AES_IF_PRESENT )
+    if(has_aes_ni() && ctr_inc == aes_ctr_cbuf_inc && len >= AES_BLOCK_SIZE)
+    {   int nb = len >> AES_BLOCK_SIZE_P2;
+
+        if(aes_ni_ctr_crypt(ibuf, obuf, nb, cbuf, ctx) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+        ibuf += nb * AES_BLOCK_SIZE;
+        obuf += nb * AES_BLOCK_SIZE;
+        len -= nb * AES_BLOCK_SIZE;
+    }
+#endif
+
     while(len)
     {
         blen = (len > BFR_LENGTH ? BFR_LENGTH : len), len -= blen;
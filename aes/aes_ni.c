@@ -0,0 +1,569 @@
+/*
+---------------------------------------------------------------------------
+Copyright (c) 1998-2013, Brian Gladman, Worcester, UK. All rights reserved.
+
+The redistribution and use of this software (with or without changes)
+is allowed without the payment of fees or royalties provided that:
+
+  source code distributions include the above copyright notice, this
+  list of conditions and the following disclaimer;
+
+  binary distributions include the above copyright notice, this list
+  of conditions and the following disclaimer in their documentation.
+
+This software is provided 'as is' with no explicit or implied warranties
+in respect of its operation, including, but not limited to, correctness
+and fitness for purpose.
+---------------------------------------------------------------------------
+
+ AES-NI implementation of the external API, falling back to the C code
+ when the CPU lacks AES-NI. The key schedules are laid out exactly as the
+ C code lays them out (AES_REV_DKS is not set in an AES-NI build), so a
+ context can be used by either implementation. The instructions are
+ enabled per function, the file does not need to be compiled with -maes.
+*/
+
+#include <string.h>
+
+#include "aes_ni.h"
+
+#if defined( USE_INTEL_AES_IF_PRESENT )
+
+#include <immintrin.h>
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#define AES_NI_TARGET   __attribute__((target("aes,sse2")))
+
+#define ni_rounds(cx)   ((cx)->inf.b[0] >> 4)
+#define ni_valid(n)     ((n) == 10 || (n) == 12 || (n) == 14)
+
+int has_aes_ni(void)
+{   static int has = -1;
+
+    if(has < 0)
+    {
+        __builtin_cpu_init();
+        has = __builtin_cpu_supports("aes") ? 1 : 0;
+    }
+    return has;
+}
+
+/* SubWord() of a key schedule word by AESKEYGENASSIST, which has no */
+/* table lookups and so no timing that depends on the key            */
+
+AES_NI_TARGET static uint32_t ni_sub_word(uint32_t w)
+{
+    return (uint32_t)_mm_cvtsi128_si32(_mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, (int)w, 0), 0));
+}
+
+/* the FIPS-197 key expansion for nk = 4, 6 or 8 key words */
+
+AES_NI_TARGET static void ni_expand_key(const unsigned char *key, int nk, uint32_t ks[])
+{   static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+    int i;
+
+    memcpy(ks, key, 4 * nk);
+    for(i = nk; i < 4 * (nk + 7); ++i)
+    {   uint32_t t = ks[i - 1];
+
+        if(i % nk == 0)
+        {
+            t = ni_sub_word(t);
+            t = ((t >> 8) | (t << 24)) ^ rcon[i / nk - 1];
+        }
+        else if(nk == 8 && i % nk == 4)
+            t = ni_sub_word(t);
+        ks[i] = ks[i - nk] ^ t;
+    }
+}
+
+static void ni_encrypt_key(const unsigned char *key, int nk, aes_encrypt_ctx cx[1])
+{
+    ni_expand_key(key, nk, cx->ks);
+    cx->inf.l = 0;
+    cx->inf.b[0] = (uint8_t)((nk + 6) * AES_BLOCK_SIZE);
+}
+
+/* the equivalent inverse cipher takes InvMixColumns() of the inner */
+/* round keys                                                       */
+
+AES_NI_TARGET static void ni_decrypt_key(const unsigned char *key, int nk, aes_decrypt_ctx cx[1])
+{   int i;
+
+    ni_expand_key(key, nk, cx->ks);
+    for(i = 1; i < nk + 6; ++i)
+    {   __m128i *k = (__m128i *)(cx->ks + 4 * i);
+        _mm_storeu_si128(k, _mm_aesimc_si128(_mm_loadu_si128(k)));
+    }
+    cx->inf.l = 0;
+    cx->inf.b[0] = (uint8_t)((nk + 6) * AES_BLOCK_SIZE);
+}
+
+/* rk[0] is applied first, so the decryption keys are loaded in reverse */
+
+AES_NI_TARGET static inline void ni_load_keys(__m128i rk[15], const uint32_t ks[], int rounds, int reverse)
+{   int r;
+
+    for(r = 0; r <= rounds; ++r)
+        rk[r] = _mm_loadu_si128((const __m128i *)(ks + 4 * (reverse ? rounds - r : r)));
+}
+
+/* the rounds of n independent blocks are interleaved so that n AESENC */
+/* or AESDEC instructions are in flight at once; called with a constant */
+/* n these loops are unrolled and the blocks stay in registers          */
+
+AES_NI_TARGET static inline void ni_encrypt_n(__m128i b[], int n, const __m128i rk[], int rounds)
+{   int i, r;
+
+    for(i = 0; i < n; ++i)
+        b[i] = _mm_xor_si128(b[i], rk[0]);
+    for(r = 1; r < rounds; ++r)
+        for(i = 0; i < n; ++i)
+            b[i] = _mm_aesenc_si128(b[i], rk[r]);
+    for(i = 0; i < n; ++i)
+        b[i] = _mm_aesenclast_si128(b[i], rk[rounds]);
+}
+
+AES_NI_TARGET static inline void ni_decrypt_n(__m128i b[], int n, const __m128i rk[], int rounds)
+{   int i, r;
+
+    for(i = 0; i < n; ++i)
+        b[i] = _mm_xor_si128(b[i], rk[0]);
+    for(r = 1; r < rounds; ++r)
+        for(i = 0; i < n; ++i)
+            b[i] = _mm_aesdec_si128(b[i], rk[r]);
+    for(i = 0; i < n; ++i)
+        b[i] = _mm_aesdeclast_si128(b[i], rk[rounds]);
+}
+
+#define ni_load(p)      _mm_loadu_si128((const __m128i *)(p))
+#define ni_store(p, v)  _mm_storeu_si128((__m128i *)(p), (v))
+
+#if defined( AES_ENCRYPT )
+
+#if defined( AES_128 ) || defined( AES_VAR )
+AES_RETURN aes_ni(encrypt_key128)(const unsigned char *key, aes_encrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(encrypt_key128)(key, cx);
+    ni_encrypt_key(key, 4, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+#if defined( AES_192 ) || defined( AES_VAR )
+AES_RETURN aes_ni(encrypt_key192)(const unsigned char *key, aes_encrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(encrypt_key192)(key, cx);
+    ni_encrypt_key(key, 6, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+#if defined( AES_256 ) || defined( AES_VAR )
+AES_RETURN aes_ni(encrypt_key256)(const unsigned char *key, aes_encrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(encrypt_key256)(key, cx);
+    ni_encrypt_key(key, 8, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+AES_NI_TARGET AES_RETURN aes_ni(encrypt)(const unsigned char *in, unsigned char *out, const aes_encrypt_ctx cx[1])
+{   __m128i rk[15], b[1];
+    int rounds = ni_rounds(cx);
+
+    if(!has_aes_ni())
+        return aes_xi(encrypt)(in, out, cx);
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 0);
+    b[0] = ni_load(in);
+    ni_encrypt_n(b, 1, rk, rounds);
+    ni_store(out, b[0]);
+    return EXIT_SUCCESS;
+}
+
+AES_NI_TARGET AES_RETURN aes_ni_ecb_encrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, const aes_encrypt_ctx cx[1])
+{   __m128i rk[15], b[AES_NI_BLOCKS];
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 0);
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : nb);
+        for(i = 0; i < n; ++i)
+            b[i] = ni_load(ibuf + i * AES_BLOCK_SIZE);
+        if(n == AES_NI_BLOCKS)
+            ni_encrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_encrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+            ni_store(obuf + i * AES_BLOCK_SIZE, b[i]);
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* CFB decryption encrypts the previous ciphertext blocks, which are */
+/* all known in advance                                              */
+
+AES_NI_TARGET AES_RETURN aes_ni_cfb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *iv, const aes_encrypt_ctx cx[1])
+{   __m128i rk[15], b[AES_NI_BLOCKS], c[AES_NI_BLOCKS], v;
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 0);
+    v = ni_load(iv);
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : nb);
+        for(i = 0; i < n; ++i)
+        {
+            c[i] = ni_load(ibuf + i * AES_BLOCK_SIZE);
+            b[i] = (i ? c[i - 1] : v);
+        }
+        if(n == AES_NI_BLOCKS)
+            ni_encrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_encrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+            ni_store(obuf + i * AES_BLOCK_SIZE, _mm_xor_si128(b[i], c[i]));
+        v = c[n - 1];
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    ni_store(iv, v);
+    return EXIT_SUCCESS;
+}
+
+/* CTR mode with the big-endian 128-bit counter of aes_ctr_cbuf_inc(), */
+/* the counter blocks are built in registers                           */
+
+AES_NI_TARGET AES_RETURN aes_ni_ctr_crypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *cbuf, const aes_encrypt_ctx cx[1])
+{   __m128i rk[15], b[AES_NI_BLOCKS];
+    uint64_t hi, lo;
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 0);
+    memcpy(&hi, cbuf, 8);
+    memcpy(&lo, cbuf + 8, 8);
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : nb);
+        for(i = 0; i < n; ++i)
+        {
+            b[i] = _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+            hi += (++lo == 0);
+        }
+        if(n == AES_NI_BLOCKS)
+            ni_encrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_encrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+            ni_store(obuf + i * AES_BLOCK_SIZE, _mm_xor_si128(b[i], ni_load(ibuf + i * AES_BLOCK_SIZE)));
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    hi = __builtin_bswap64(hi);
+    lo = __builtin_bswap64(lo);
+    memcpy(cbuf, &hi, 8);
+    memcpy(cbuf + 8, &lo, 8);
+    return EXIT_SUCCESS;
+}
+
+/* GHASH by carry-less multiplication. The GCM blocks are byte reversed */
+/* so that the first byte is the most significant of the 128-bit lane; */
+/* the bits of the field elements are then in reverse order, and the   */
+/* product of two of them is one bit short of the reversed product     */
+
+#define AES_NI_CLMUL_TARGET __attribute__((target("aes,pclmul,ssse3")))
+
+int has_aes_ni_clmul(void)
+{   static int has = -1;
+
+    if(has < 0)
+    {
+        __builtin_cpu_init();
+        has = __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul")
+                && __builtin_cpu_supports("ssse3") ? 1 : 0;
+    }
+    return has;
+}
+
+AES_NI_CLMUL_TARGET static inline __m128i ni_bswap(__m128i x)
+{
+    return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/* lo, mid and hi accumulate unreduced products, so that a run of */
+/* blocks times the powers of H needs only one reduction           */
+
+AES_NI_CLMUL_TARGET static inline void ni_clmul_acc(__m128i a, __m128i b, __m128i *lo, __m128i *mid, __m128i *hi)
+{
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *mid = _mm_xor_si128(*mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x01),
+                                             _mm_clmulepi64_si128(a, b, 0x10)));
+}
+
+/* a 128-bit right shift by 0 < n < 64 */
+#define ni_shr128(x, n) _mm_or_si128(_mm_srli_epi64(x, n), _mm_slli_epi64(_mm_srli_si128(x, 8), 64 - (n)))
+
+/* reduction modulo x^128 + x^7 + x^2 + x + 1 in the reversed bit order */
+
+AES_NI_CLMUL_TARGET static inline __m128i ni_ghash_reduce(__m128i lo, __m128i mid, __m128i hi)
+{   __m128i c, d;
+
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    /* the one bit shift of the 256-bit product */
+    c = _mm_srli_epi64(lo, 63);
+    d = _mm_srli_epi64(hi, 63);
+    lo = _mm_or_si128(_mm_slli_epi64(lo, 1), _mm_slli_si128(c, 8));
+    hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi64(hi, 1), _mm_slli_si128(d, 8)), _mm_srli_si128(c, 8));
+
+    /* fold the bits that the shifts below would carry out of lo, then */
+    /* fold lo into hi                                                  */
+    c = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi64(lo, 63), _mm_slli_epi64(lo, 62)), _mm_slli_epi64(lo, 57));
+    d = _mm_xor_si128(lo, _mm_slli_si128(c, 8));
+    hi = _mm_xor_si128(hi, d);
+    hi = _mm_xor_si128(hi, ni_shr128(d, 1));
+    hi = _mm_xor_si128(hi, ni_shr128(d, 2));
+    return _mm_xor_si128(hi, ni_shr128(d, 7));
+}
+
+/* y = (y + x[0]) * H^n + x[1] * H^(n-1) + ... + x[n-1] * H */
+
+AES_NI_CLMUL_TARGET static inline __m128i ni_ghash_n(__m128i y, const __m128i x[], int n, const __m128i h[])
+{   __m128i lo = _mm_setzero_si128(), mid = lo, hi = lo;
+    int i;
+
+    ni_clmul_acc(_mm_xor_si128(y, x[0]), h[n - 1], &lo, &mid, &hi);
+    for(i = 1; i < n; ++i)
+        ni_clmul_acc(x[i], h[n - 1 - i], &lo, &mid, &hi);
+    return ni_ghash_reduce(lo, mid, hi);
+}
+
+AES_NI_CLMUL_TARGET static inline void ni_load_hpow(__m128i h[AES_NI_BLOCKS], const unsigned char hpow[][AES_BLOCK_SIZE])
+{   int i;
+
+    for(i = 0; i < AES_NI_BLOCKS; ++i)
+        h[i] = ni_bswap(ni_load(hpow[i]));
+}
+
+AES_NI_CLMUL_TARGET void aes_ni_ghash(unsigned char *ghash, const unsigned char *data, size_t nb,
+                    const unsigned char hpow[][AES_BLOCK_SIZE])
+{   __m128i h[AES_NI_BLOCKS], x[AES_NI_BLOCKS], y;
+    int i, n;
+
+    ni_load_hpow(h, hpow);
+    y = ni_bswap(ni_load(ghash));
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : (int)nb);
+        for(i = 0; i < n; ++i)
+            x[i] = ni_bswap(ni_load(data + i * AES_BLOCK_SIZE));
+        if(n == AES_NI_BLOCKS)
+            y = ni_ghash_n(y, x, AES_NI_BLOCKS, h);
+        else
+            y = ni_ghash_n(y, x, n, h);
+        data += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    ni_store(ghash, ni_bswap(y));
+}
+
+/* GCM encryption or decryption of whole blocks. Each group of blocks */
+/* is encrypted and hashed while it is in registers; GCM increments   */
+/* only the last 32 bits of the counter, which in the byte reversed   */
+/* counter block is the lowest 32-bit lane                            */
+
+AES_NI_CLMUL_TARGET AES_RETURN aes_ni_gcm_crypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t nb, unsigned char *ctr, unsigned char *ghash,
+                    const unsigned char hpow[][AES_BLOCK_SIZE], int encrypt,
+                    const aes_encrypt_ctx cx[1])
+{   __m128i rk[15], h[AES_NI_BLOCKS], b[AES_NI_BLOCKS], x[AES_NI_BLOCKS], c, y;
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 0);
+    ni_load_hpow(h, hpow);
+    c = ni_bswap(ni_load(ctr));
+    y = ni_bswap(ni_load(ghash));
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : (int)nb);
+        for(i = 0; i < n; ++i)
+            b[i] = ni_bswap(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, i)));
+        c = _mm_add_epi32(c, _mm_set_epi32(0, 0, 0, n));
+        if(n == AES_NI_BLOCKS)
+            ni_encrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_encrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+        {   __m128i t = ni_load(ibuf + i * AES_BLOCK_SIZE);
+
+            b[i] = _mm_xor_si128(b[i], t);
+            x[i] = ni_bswap(encrypt ? b[i] : t);
+            ni_store(obuf + i * AES_BLOCK_SIZE, b[i]);
+        }
+        if(n == AES_NI_BLOCKS)
+            y = ni_ghash_n(y, x, AES_NI_BLOCKS, h);
+        else
+            y = ni_ghash_n(y, x, n, h);
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    ni_store(ctr, ni_bswap(c));
+    ni_store(ghash, ni_bswap(y));
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+#if defined( AES_DECRYPT )
+
+#if defined( AES_128 ) || defined( AES_VAR )
+AES_RETURN aes_ni(decrypt_key128)(const unsigned char *key, aes_decrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(decrypt_key128)(key, cx);
+    ni_decrypt_key(key, 4, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+#if defined( AES_192 ) || defined( AES_VAR )
+AES_RETURN aes_ni(decrypt_key192)(const unsigned char *key, aes_decrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(decrypt_key192)(key, cx);
+    ni_decrypt_key(key, 6, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+#if defined( AES_256 ) || defined( AES_VAR )
+AES_RETURN aes_ni(decrypt_key256)(const unsigned char *key, aes_decrypt_ctx cx[1])
+{
+    if(!has_aes_ni())
+        return aes_xi(decrypt_key256)(key, cx);
+    ni_decrypt_key(key, 8, cx);
+    return EXIT_SUCCESS;
+}
+#endif
+
+AES_NI_TARGET AES_RETURN aes_ni(decrypt)(const unsigned char *in, unsigned char *out, const aes_decrypt_ctx cx[1])
+{   __m128i rk[15], b[1];
+    int rounds = ni_rounds(cx);
+
+    if(!has_aes_ni())
+        return aes_xi(decrypt)(in, out, cx);
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 1);
+    b[0] = ni_load(in);
+    ni_decrypt_n(b, 1, rk, rounds);
+    ni_store(out, b[0]);
+    return EXIT_SUCCESS;
+}
+
+AES_NI_TARGET AES_RETURN aes_ni_ecb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, const aes_decrypt_ctx cx[1])
+{   __m128i rk[15], b[AES_NI_BLOCKS];
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 1);
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : nb);
+        for(i = 0; i < n; ++i)
+            b[i] = ni_load(ibuf + i * AES_BLOCK_SIZE);
+        if(n == AES_NI_BLOCKS)
+            ni_decrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_decrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+            ni_store(obuf + i * AES_BLOCK_SIZE, b[i]);
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* the ciphertext blocks are read before any output is written, so */
+/* ibuf and obuf may be the same buffer                            */
+
+AES_NI_TARGET AES_RETURN aes_ni_cbc_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *iv, const aes_decrypt_ctx cx[1])
+{   __m128i rk[15], b[AES_NI_BLOCKS], c[AES_NI_BLOCKS], v;
+    int i, n, rounds = ni_rounds(cx);
+
+    if(!ni_valid(rounds))
+        return EXIT_FAILURE;
+
+    ni_load_keys(rk, cx->ks, rounds, 1);
+    v = ni_load(iv);
+    while(nb > 0)
+    {
+        n = (nb > AES_NI_BLOCKS ? AES_NI_BLOCKS : nb);
+        for(i = 0; i < n; ++i)
+            b[i] = c[i] = ni_load(ibuf + i * AES_BLOCK_SIZE);
+        if(n == AES_NI_BLOCKS)
+            ni_decrypt_n(b, AES_NI_BLOCKS, rk, rounds);
+        else
+            ni_decrypt_n(b, n, rk, rounds);
+        for(i = 0; i < n; ++i)
+        {
+            ni_store(obuf + i * AES_BLOCK_SIZE, _mm_xor_si128(b[i], v));
+            v = c[i];
+        }
+        ibuf += n * AES_BLOCK_SIZE;
+        obuf += n * AES_BLOCK_SIZE;
+        nb -= n;
+    }
+    ni_store(iv, v);
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
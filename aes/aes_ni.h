@@ -0,0 +1,102 @@
+/*
+---------------------------------------------------------------------------
+Copyright (c) 1998-2013, Brian Gladman, Worcester, UK. All rights reserved.
+
+The redistribution and use of this software (with or without changes)
+is allowed without the payment of fees or royalties provided that:
+
+  source code distributions include the above copyright notice, this
+  list of conditions and the following disclaimer;
+
+  binary distributions include the above copyright notice, this list
+  of conditions and the following disclaimer in their documentation.
+
+This software is provided 'as is' with no explicit or implied warranties
+in respect of its operation, including, but not limited to, correctness
+and fitness for purpose.
+---------------------------------------------------------------------------
+
+ AES-NI support. The C code in aeskey.c and aescrypt.c is compiled under
+ internal names and aes_ni.c provides the external API, using the AES-NI
+ instructions when the CPU has them and the C code otherwise. The mode
+ functions in aes_modes.c call the multiple block functions below, which
+ keep AES_NI_BLOCKS blocks in flight to hide the latency of AESENC/AESDEC.
+*/
+
+#ifndef AES_NI_H
+#define AES_NI_H
+
+#include "aesopt.h"
+
+/* map names in C code to make them internal ('name' -> 'aes_name_i') */
+#define aes_xi(x) aes_ ## x ## _i
+
+/* map names here to provide the external API ('name' -> 'aes_name') */
+#define aes_ni(x) aes_ ## x
+
+#define AES_NI_BLOCKS 8
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+int has_aes_ni(void);
+
+/* AES-NI and PCLMULQDQ, for the GCM functions below */
+int has_aes_ni_clmul(void);
+
+#if defined( AES_ENCRYPT )
+#if defined( AES_128 ) || defined( AES_VAR )
+AES_RETURN aes_xi(encrypt_key128)(const unsigned char *key, aes_encrypt_ctx cx[1]);
+#endif
+#if defined( AES_192 ) || defined( AES_VAR )
+AES_RETURN aes_xi(encrypt_key192)(const unsigned char *key, aes_encrypt_ctx cx[1]);
+#endif
+#if defined( AES_256 ) || defined( AES_VAR )
+AES_RETURN aes_xi(encrypt_key256)(const unsigned char *key, aes_encrypt_ctx cx[1]);
+#endif
+AES_RETURN aes_xi(encrypt)(const unsigned char *in, unsigned char *out, const aes_encrypt_ctx cx[1]);
+#endif
+
+#if defined( AES_DECRYPT )
+#if defined( AES_128 ) || defined( AES_VAR )
+AES_RETURN aes_xi(decrypt_key128)(const unsigned char *key, aes_decrypt_ctx cx[1]);
+#endif
+#if defined( AES_192 ) || defined( AES_VAR )
+AES_RETURN aes_xi(decrypt_key192)(const unsigned char *key, aes_decrypt_ctx cx[1]);
+#endif
+#if defined( AES_256 ) || defined( AES_VAR )
+AES_RETURN aes_xi(decrypt_key256)(const unsigned char *key, aes_decrypt_ctx cx[1]);
+#endif
+AES_RETURN aes_xi(decrypt)(const unsigned char *in, unsigned char *out, const aes_decrypt_ctx cx[1]);
+#endif
+
+/* nb whole blocks, only to be called when has_aes_ni() is true, the   */
+/* CBC and CFB calls update the iv and the CTR call the counter block  */
+AES_RETURN aes_ni_ecb_encrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, const aes_encrypt_ctx cx[1]);
+AES_RETURN aes_ni_ecb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, const aes_decrypt_ctx cx[1]);
+AES_RETURN aes_ni_cbc_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *iv, const aes_decrypt_ctx cx[1]);
+AES_RETURN aes_ni_cfb_decrypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *iv, const aes_encrypt_ctx cx[1]);
+AES_RETURN aes_ni_ctr_crypt(const unsigned char *ibuf, unsigned char *obuf,
+                    int nb, unsigned char *cbuf, const aes_encrypt_ctx cx[1]);
+
+/* GHASH and GCM for aes_gcm.c, only to be called when has_aes_ni_clmul() */
+/* is true. hpow holds H, H^2, ... H^AES_NI_BLOCKS as GCM blocks, ghash    */
+/* is the accumulator and ctr the next counter block, both are updated     */
+void aes_ni_ghash(unsigned char *ghash, const unsigned char *data, size_t nb,
+                    const unsigned char hpow[][AES_BLOCK_SIZE]);
+AES_RETURN aes_ni_gcm_crypt(const unsigned char *ibuf, unsigned char *obuf,
+                    size_t nb, unsigned char *ctr, unsigned char *ghash,
+                    const unsigned char hpow[][AES_BLOCK_SIZE], int encrypt,
+                    const aes_encrypt_ctx cx[1]);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
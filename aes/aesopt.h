@@ -182,6 +182,12 @@ Issue Date: 20/12/2007
 #  endif
 #endif
 
+/* aes_ni.c enables the AESNI instructions per function and checks the
+   CPU at runtime, so with GCC or clang on x86-64 it needs no -maes */
+#if !defined( INTEL_AES_POSSIBLE ) && defined( __GNUC__ ) && defined( __x86_64__ )
+#  define INTEL_AES_POSSIBLE
+#endif
+
 /*  Define this option if support for the Intel AESNI is required
     If USE_INTEL_AES_IF_PRESENT is defined then AESNI will be used
     if it is detected (both present and enabled).
@@ -196,7 +202,12 @@ Issue Date: 20/12/2007
 	code files must match that here if they are used). 
 */
 
-#if 0 && defined( INTEL_AES_POSSIBLE ) && !defined( USE_INTEL_AES_IF_PRESENT )
+/*  aes_ni.c is written for GCC and clang, define AES_NO_AESNI to build
+    the C code alone
+*/
+
+#if defined( INTEL_AES_POSSIBLE ) && defined( __GNUC__ ) && !defined( AES_NO_AESNI ) \
+    && !defined( USE_INTEL_AES_IF_PRESENT )
 #  define USE_INTEL_AES_IF_PRESENT
 #endif
 
@@ -23,7 +23,6 @@
 
 #include <string.h>
 #include <stdbool.h>
-#include <sys/types.h>
 #include "base58.h"
 #include "sha2.h"
 #include "ripemd160.h"
@@ -41,16 +40,22 @@ const int8_t b58digits_map[] = {
 	47,48,49,50,51,52,53,54,55,56,57,-1,-1,-1,-1,-1,
 };
 
+// the conversions work on 32-bit words on the binary side and on limbs of
+// five digits on the base58 side, 58^5 < 2^32
+#define B58_LIMB 656356768u
+#define B58_LIMB_DIGITS 5
+
 bool b58tobin(void *bin, size_t *binszp, const char *b58)
 {
+	static const uint32_t pow58[B58_LIMB_DIGITS + 1] = {1, 58, 3364, 195112, 11316496, B58_LIMB};
 	size_t binsz = *binszp;
 	const unsigned char *b58u = (const unsigned char*)b58;
 	unsigned char *binu = bin;
 	size_t outisz = (binsz + 3) / 4;
 	uint32_t outi[outisz];
 	uint64_t t;
-	uint32_t c;
-	size_t i, j;
+	uint32_t c, mul;
+	size_t i, j, k;
 	uint8_t bytesleft = binsz % 4;
 	uint32_t zeromask = bytesleft ? (0xffffffff << (bytesleft * 8)) : 0;
 	unsigned zerocount = 0;
@@ -64,19 +69,24 @@ bool b58tobin(void *bin, size_t *binszp, const char *b58)
 	for (i = 0; i < b58sz && b58u[i] == '1'; ++i)
 		++zerocount;
 
-	for ( ; i < b58sz; ++i)
+	while (i < b58sz)
 	{
-		if (b58u[i] & 0x80)
-			// High-bit set on invalid digit
-			return false;
-		if (b58digits_map[b58u[i]] == -1)
-			// Invalid base58 digit
-			return false;
-		c = (unsigned)b58digits_map[b58u[i]];
+		// up to five digits are multiplied in at once
+		for (c = 0, k = 0; k < B58_LIMB_DIGITS && i < b58sz; ++k, ++i)
+		{
+			if (b58u[i] & 0x80)
+				// High-bit set on invalid digit
+				return false;
+			if (b58digits_map[b58u[i]] == -1)
+				// Invalid base58 digit
+				return false;
+			c = c * 58 + (unsigned)b58digits_map[b58u[i]];
+		}
+		mul = pow58[k];
 		for (j = outisz; j--; )
 		{
-			t = ((uint64_t)outi[j]) * 58 + c;
-			c = (t & 0x3f00000000) >> 32;
+			t = ((uint64_t)outi[j]) * mul + c;
+			c = t >> 32;
 			outi[j] = t & 0xffffffff;
 		}
 		if (c)
@@ -152,41 +162,61 @@ int b58check(const void *bin, size_t binsz, HasherType hasher_type, const char *
 bool b58enc(char *b58, size_t *b58sz, const void *data, size_t binsz)
 {
 	const uint8_t *bin = data;
-	int carry;
-	ssize_t i, j, high, zcount = 0;
-	size_t size;
+	size_t i, j, k, n, high = 0, zcount = 0, ndigits;
+	uint64_t t;
+	uint32_t limb;
 
-	while (zcount < (ssize_t)binsz && !bin[zcount])
+	while (zcount < binsz && !bin[zcount])
 		++zcount;
 
-	size = (binsz - zcount) * 138 / 100 + 1;
-	uint8_t buf[size];
-	memset(buf, 0, size);
+	// limbs of the result, least significant first
+	size_t size = ((binsz - zcount) * 138 / 100 + 1) / B58_LIMB_DIGITS + 1;
+	uint32_t buf[size];
 
-	for (i = zcount, high = size - 1; i < (ssize_t)binsz; ++i, high = j)
+	// the first word takes the bytes that do not fill a whole word
+	for (i = zcount, n = (binsz - zcount) % 4; i < binsz; n = 4)
 	{
-		for (carry = bin[i], j = size - 1; (j > high) || carry; --j)
+		if (n == 0)
+			n = 4;
+		for (t = 0, k = 0; k < n; ++k)
+			t = (t << 8) | bin[i++];
+		for (j = 0; j < high; ++j)
 		{
-			carry += 256 * buf[j];
-			buf[j] = carry % 58;
-			carry /= 58;
+			t += (uint64_t)buf[j] << (8 * n);
+			buf[j] = t % B58_LIMB;
+			t /= B58_LIMB;
 		}
+		for (; t; t /= B58_LIMB)
+			buf[high++] = t % B58_LIMB;
 	}
 
-	for (j = 0; j < (ssize_t)size && !buf[j]; ++j);
+	ndigits = 0;
+	if (high)
+	{
+		for (limb = buf[high - 1]; limb; limb /= 58)
+			++ndigits;
+		ndigits += (high - 1) * B58_LIMB_DIGITS;
+	}
 
-	if (*b58sz <= zcount + size - j)
+	if (*b58sz <= zcount + ndigits)
 	{
-		*b58sz = zcount + size - j + 1;
+		*b58sz = zcount + ndigits + 1;
+		memzero(buf, sizeof(buf));
 		return false;
 	}
 
 	if (zcount)
 		memset(b58, '1', zcount);
-	for (i = zcount; j < (ssize_t)size; ++i, ++j)
-		b58[i] = b58digits_ordered[buf[j]];
+	i = zcount + ndigits;
 	b58[i] = '\0';
 	*b58sz = i + 1;
+	for (j = 0; j < high; ++j)
+	{
+		limb = buf[j];
+		for (k = 0; k < B58_LIMB_DIGITS && i > zcount; ++k, limb /= 58)
+			b58[--i] = b58digits_ordered[limb % 58];
+	}
+	memzero(buf, sizeof(buf));
 
 	return true;
 }
@@ -206,6 +236,54 @@ int base58_encode_check(const uint8_t *data, int datalen, HasherType hasher_type
 	return success ? res : 0;
 }
 
+size_t base58_encode_check_batch(const uint8_t *data, int datalen, size_t count, HasherType hasher_type, char *str, int strsize)
+{
+	if (datalen > 128 || strsize <= 0) {
+		return 0;
+	}
+	uint8_t buf[8][datalen + 32];
+	uint8_t digest[8][SHA256_DIGEST_LENGTH];
+	const uint8_t *lanes[8];
+	size_t first, i, n, done = 0;
+
+	for (first = 0; first < count; first += n) {
+		n = count - first < 8 ? count - first : 8;
+		for (i = 0; i < n; i++) {
+			memcpy(buf[i], data + (first + i) * datalen, datalen);
+		}
+		if (hasher_type == HASHER_SHA2D) {
+			// both rounds of the checksum hash all payloads of the group at once
+			for (i = 0; i < 8; i++) {
+				lanes[i] = buf[i < n ? i : 0];
+			}
+			sha256_Raw_x8(lanes, datalen, digest);
+			for (i = 0; i < 8; i++) {
+				lanes[i] = digest[i];
+			}
+			sha256_Raw_x8(lanes, SHA256_DIGEST_LENGTH, digest);
+			for (i = 0; i < n; i++) {
+				memcpy(buf[i] + datalen, digest[i], 4);
+			}
+		} else {
+			for (i = 0; i < n; i++) {
+				hasher_Raw(hasher_type, buf[i], datalen, buf[i] + datalen);
+			}
+		}
+		for (i = 0; i < n; i++) {
+			char *out = str + (first + i) * strsize;
+			size_t res = strsize;
+			if (b58enc(out, &res, buf[i], datalen + 4)) {
+				done++;
+			} else {
+				out[0] = 0;
+			}
+		}
+	}
+	memzero(buf, sizeof(buf));
+	memzero(digest, sizeof(digest));
+	return done;
+}
+
 int base58_decode_check(const char *str, HasherType hasher_type, uint8_t *data, int datalen)
 {
 	if (datalen > 128) {
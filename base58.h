@@ -35,6 +35,12 @@ extern const int8_t b58digits_map[];
 int base58_encode_check(const uint8_t *data, int len, HasherType hasher_type, char *str, int strsize);
 int base58_decode_check(const char *str, HasherType hasher_type, uint8_t *data, int datalen);
 
+// base58_encode_check for count payloads of datalen bytes stored one after
+// another in data, string i is written to str + i * strsize. returns the
+// number of payloads encoded, the string of a payload that does not fit
+// into strsize is left empty.
+size_t base58_encode_check_batch(const uint8_t *data, int datalen, size_t count, HasherType hasher_type, char *str, int strsize);
+
 // Private
 bool b58tobin(void *bin, size_t *binszp, const char *b58);
 int b58check(const void *bin, size_t binsz, HasherType hasher_type, const char *base58str);
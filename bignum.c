@@ -481,6 +481,139 @@ void bn_multiply_reduce(bignum256 *x, uint32_t res[18], const bignum256 *prime)
 	}
 }
 
+#if USE_BN_INT128
+
+typedef unsigned __int128 uint128_t;
+
+// auxiliary function for the 64 bit multiplication.
+// convert a normalized bignum into five 64 bit limbs (little endian).
+static inline void bn_to_limbs64(const bignum256 *a, uint64_t out[5])
+{
+	const uint32_t *v = a->val;
+	out[0] = v[0] | ((uint64_t)v[1] << 30) | ((uint64_t)v[2] << 60);
+	out[1] = (v[2] >> 4) | ((uint64_t)v[3] << 26) | ((uint64_t)v[4] << 56);
+	out[2] = (v[4] >> 8) | ((uint64_t)v[5] << 22) | ((uint64_t)v[6] << 52);
+	out[3] = (v[6] >> 12) | ((uint64_t)v[7] << 18) | ((uint64_t)v[8] << 48);
+	out[4] = v[8] >> 16;
+}
+
+// auxiliary function for the 64 bit multiplication.
+// convert five 64 bit limbs holding a number < 2^270 into a normalized bignum.
+static inline void bn_from_limbs64(const uint64_t in[5], bignum256 *a)
+{
+	a->val[0] = in[0] & 0x3FFFFFFF;
+	a->val[1] = (in[0] >> 30) & 0x3FFFFFFF;
+	a->val[2] = ((in[0] >> 60) | (in[1] << 4)) & 0x3FFFFFFF;
+	a->val[3] = (in[1] >> 26) & 0x3FFFFFFF;
+	a->val[4] = ((in[1] >> 56) | (in[2] << 8)) & 0x3FFFFFFF;
+	a->val[5] = (in[2] >> 22) & 0x3FFFFFFF;
+	a->val[6] = ((in[2] >> 52) | (in[3] << 12)) & 0x3FFFFFFF;
+	a->val[7] = (in[3] >> 18) & 0x3FFFFFFF;
+	a->val[8] = (in[3] >> 48) | (in[4] << 16);
+}
+
+// auxiliary function for the 64 bit multiplication.
+// reduces res modulo prime, same algorithm as bn_multiply_reduce_step.
+// let k = i-8.
+// assumes    res < 2^(30k + 31) * prime
+// guarantees res < 2^(30k) * 2 * prime
+static inline void bn_multiply_reduce_step64(uint64_t res[10], const uint64_t prime[5], uint32_t i)
+{
+	const uint32_t k = i - 8;
+	const uint32_t pos = 30 * k + 256;
+	const uint32_t limb = pos / 64, shift = pos % 64;
+	const uint32_t plimb = (30 * k) / 64, pshift = (30 * k) % 64;
+	uint64_t coef, p[5], borrow = 0;
+	uint128_t temp;
+	uint32_t j;
+
+	// coef = res / 2^(30k + 256)  rounded down, 0 <= coef < 2^31
+	coef = res[limb] >> shift;
+	if (shift != 0) {
+		coef |= res[limb + 1] << (64 - shift);
+	}
+	assert(coef < 0x80000000u);
+
+	// p = prime * 2^pshift, so that coef * prime * 2^(30k) = coef * p * 2^(64 plimb)
+	p[0] = prime[0] << pshift;
+	for (j = 1; j < 5; j++) {
+		p[j] = pshift ? (prime[j] << pshift) | (prime[j - 1] >> (64 - pshift)) : prime[j];
+	}
+
+	// subtract (coef * 2^(30k) * prime) from res
+	for (j = 0; j < 5; j++) {
+		temp = (uint128_t)coef * p[j] + borrow;
+		borrow = (uint64_t)(temp >> 64) + (res[plimb + j] < (uint64_t)temp);
+		res[plimb + j] -= (uint64_t)temp;
+	}
+	for (j += plimb; j < 9; j++) {
+		uint64_t t = res[j];
+		res[j] = t - borrow;
+		borrow = t < borrow;
+	}
+	// see bn_multiply_reduce_step for why the result is non-negative
+	// and bounded by 2^(30k) * 2 * prime.
+}
+
+// auxiliary function for the 64 bit multiplication.
+// compute k * x as a 528 bit number in base 2^64.
+// assumes that k and x are normalized.
+static inline void bn_multiply_long64(const bignum256 *k, const bignum256 *x, uint64_t res[10])
+{
+	uint64_t a[5], b[5];
+	uint128_t temp;
+	int i, j;
+
+	bn_to_limbs64(k, a);
+	bn_to_limbs64(x, b);
+	memset(res, 0, 10 * sizeof(uint64_t));
+
+	// schoolbook multiplication, every step fits in 128 bits since
+	// (2^64-1)^2 + 2 * (2^64-1) < 2^128
+	for (i = 0; i < 5; i++) {
+		uint64_t carry = 0;
+		for (j = 0; j < 5; j++) {
+			temp = (uint128_t)a[i] * b[j] + res[i + j] + carry;
+			res[i + j] = (uint64_t)temp;
+			carry = (uint64_t)(temp >> 64);
+		}
+		res[i + 5] = carry;
+	}
+	assert(res[9] == 0);
+	memzero(a, sizeof(a));
+	memzero(b, sizeof(b));
+}
+
+// Compute x := k * x  (mod prime)
+// same contract as the 30 bit version below.
+// Only the long product and the limbs are 64 bits wide.  For a prime
+// between 2^256-2^224 and 2^256 a quotient taken from the top bits is good
+// to about 30 bits, so the reduction keeps the nine steps of
+// bn_multiply_reduce, each costing 5 instead of 9 multiplications.  Wider
+// steps need constants for each prime (Barrett or Montgomery), which this
+// interface has no place for; the field multiplications of secp256k1 and
+// nist256p1 avoid the generic reduction with bn_multiply_secp256k1 and
+// bn_multiply_nist256p1.  bn_fast_mod and the binary bn_inverse do no long
+// multiplication and stay on 30 bit limbs.
+void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime)
+{
+	uint64_t p[5], res[10];
+	int i;
+
+	bn_to_limbs64(prime, p);
+	bn_multiply_long64(k, x, res);
+
+	for (i = 16; i >= 8; i--) {
+		bn_multiply_reduce_step64(res, p, i);
+	}
+	assert(res[5] == 0 && res[6] == 0 && res[7] == 0 && res[8] == 0);
+
+	bn_from_limbs64(res, x);
+	memzero(res, sizeof(res));
+}
+
+#else
+
 // Compute x := k * x  (mod prime)
 // both inputs must be smaller than 180 * prime.
 // result is partly reduced (0 <= x < 2 * prime)
@@ -493,6 +626,167 @@ void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime)
 	memzero(res, sizeof(res));
 }
 
+#endif
+
+// auxiliary function for the special prime reductions.
+// compute k * x as a 528 bit number in base 2^32.
+// assumes that k and x are normalized.
+static void bn_multiply_long32(const bignum256 *k, const bignum256 *x, uint32_t res[17])
+{
+	int i;
+#if USE_BN_INT128
+	uint64_t temp[10];
+	bn_multiply_long64(k, x, temp);
+	for (i = 0; i < 17; i++) {
+		res[i] = temp[i / 2] >> (32 * (i % 2));
+	}
+#else
+	uint32_t temp[18] = {0};
+	uint64_t acc = 0;
+	int j = 0, bits = 0;
+	bn_multiply_long(k, x, temp);
+	// regroup the 30 bit limbs into 32 bit words
+	for (i = 0; i < 18; i++) {
+		acc |= (uint64_t)temp[i] << bits;
+		bits += 30;
+		if (bits >= 32) {
+			res[j++] = acc;
+			acc >>= 32;
+			bits -= 32;
+		}
+	}
+	assert(j == 16);
+	res[16] = acc;
+#endif
+	memzero(temp, sizeof(temp));
+}
+
+// auxiliary function for the special prime reductions.
+// convert a 256 bit number in base 2^32 into a normalized bignum.
+static void bn_read_words32(const uint32_t in[8], bignum256 *out_number)
+{
+	int i;
+	uint32_t temp = 0;
+	for (i = 0; i < 8; i++) {
+		// same as bn_read_le, but on 32 bit words
+		temp |= in[i] << (2*i);
+		out_number->val[i] = temp & 0x3FFFFFFF;
+		temp = in[i] >> (30 - 2*i);
+	}
+	out_number->val[8] = temp;
+}
+
+// Compute x := k * x  (mod prime)  for prime = 2^256 - 2^32 - 977 (secp256k1).
+// Same contract as bn_multiply; prime is only checked in debug builds.
+// Instead of the generic reduction, the high words are folded into the
+// low words using 2^256 = 2^32 + 977 (mod prime).
+// result is smaller than 2^256, hence partly reduced.
+void bn_multiply_secp256k1(const bignum256 *k, bignum256 *x, const bignum256 *prime)
+{
+	uint32_t w[17];
+	uint64_t t[17], carry = 0;
+	int i, round;
+
+	assert(prime->val[0] == 0x3ffffc2f && prime->val[1] == 0x3ffffffb && prime->val[8] == 0xffff);
+	(void)prime;
+
+	bn_multiply_long32(k, x, w);
+	for (i = 0; i < 17; i++) {
+		t[i] = w[i];
+	}
+	// w < 2^528, fold words 16..8 into words 9..0.
+	// t[9], t[8] take at most one extra word, so t[i] < 2^33 and
+	// every t[i] for i < 8 stays below 2^44.
+	for (i = 16; i >= 8; i--) {
+		t[i - 7] += t[i];
+		t[i - 8] += t[i] * 977;
+	}
+	for (i = 0; i < 8; i++) {
+		carry += t[i];
+		w[i] = carry;
+		carry >>= 32;
+	}
+	// now w + carry * 2^256 < 2^269, fold the carry again.
+	// after the first round w + carry * 2^256 < 2^256 + 2^82,
+	// after the second round it is smaller than 2^256.
+	for (round = 0; round < 2; round++) {
+		uint64_t c = carry;
+		carry = (uint64_t)w[0] + c * 977;
+		w[0] = carry;
+		carry = (carry >> 32) + w[1] + c;
+		w[1] = carry;
+		carry >>= 32;
+		for (i = 2; i < 8; i++) {
+			carry += w[i];
+			w[i] = carry;
+			carry >>= 32;
+		}
+	}
+	assert(carry == 0);
+
+	bn_read_words32(w, x);
+	memzero(w, sizeof(w));
+	memzero(t, sizeof(t));
+}
+
+// Compute x := k * x  (mod prime)  for
+// prime = 2^256 - 2^224 + 2^192 + 2^96 - 1 (nist256p1).
+// Same contract as bn_multiply; prime is only checked in debug builds.
+// This is the Solinas reduction: the high words are folded into the
+// low words using 2^256 = 2^224 - 2^192 - 2^96 + 1 (mod prime).
+// result is smaller than 2^256, hence partly reduced.
+void bn_multiply_nist256p1(const bignum256 *k, bignum256 *x, const bignum256 *prime)
+{
+	uint32_t w[17];
+	int64_t t[17], carry = 0;
+	int i, round;
+
+	assert(prime->val[0] == 0x3fffffff && prime->val[3] == 0x3f && prime->val[8] == 0xffff);
+	(void)prime;
+
+	bn_multiply_long32(k, x, w);
+	for (i = 0; i < 17; i++) {
+		t[i] = w[i];
+	}
+	// w < 2^528, fold words 16..8 into words 15..0.
+	// every word gets at most four folded words added or subtracted,
+	// so |t[i]| stays below 2^42 and |w + carry * 2^256| < 2^267.
+	for (i = 16; i >= 8; i--) {
+		t[i - 1] += t[i];
+		t[i - 2] -= t[i];
+		t[i - 5] -= t[i];
+		t[i - 8] += t[i];
+	}
+	// w + carry * 2^256 is the (possibly negative) result, |carry| < 2^11.
+	// The two further rounds fold the carry: the folded value is below
+	// 2^235 in magnitude, so after the first one |carry| <= 1, and after
+	// the second one the carry vanishes and 0 <= w < 2^256.
+	for (round = 0; round < 3; round++) {
+		if (round > 0) {
+			t[0] = (int64_t)w[0] + carry;
+			t[1] = w[1];
+			t[2] = w[2];
+			t[3] = (int64_t)w[3] - carry;
+			t[4] = w[4];
+			t[5] = w[5];
+			t[6] = (int64_t)w[6] - carry;
+			t[7] = (int64_t)w[7] + carry;
+		}
+		carry = 0;
+		for (i = 0; i < 8; i++) {
+			carry += t[i];
+			w[i] = (uint32_t)carry;
+			// exact division, carry - w[i] is a multiple of 2^32
+			carry = (carry - w[i]) / 0x100000000LL;
+		}
+	}
+	assert(carry == 0);
+
+	bn_read_words32(w, x);
+	memzero(w, sizeof(w));
+	memzero(t, sizeof(t));
+}
+
 // partly reduce x modulo prime
 // input x does not have to be normalized.
 // x can be any number that fits.
@@ -867,6 +1161,41 @@ void bn_inverse(bignum256 *x, const bignum256 *prime)
 }
 #endif
 
+// invert count numbers at once using a single bn_inverse
+// (Montgomery's trick): x[i] := x[i]^-1 (mod prime) for 0 <= i < count.
+// tmp must have room for count numbers and is clobbered.
+// none of the inputs may be 0 mod prime.
+// the results are smaller than prime
+void bn_inverse_batch(bignum256 *x, bignum256 *tmp, size_t count, const bignum256 *prime)
+{
+	size_t i;
+	bignum256 inv, t;
+
+	if (count == 0) {
+		return;
+	}
+	// tmp[i] = x[0] * ... * x[i]
+	tmp[0] = x[0];
+	for (i = 1; i < count; i++) {
+		tmp[i] = x[i];
+		bn_multiply(&tmp[i - 1], &tmp[i], prime);
+	}
+	inv = tmp[count - 1];
+	bn_inverse(&inv, prime);
+	for (i = count - 1; i > 0; i--) {
+		// invariant: inv = (x[0] * ... * x[i])^-1
+		t = tmp[i - 1];
+		bn_multiply(&inv, &t, prime);       // t = x[i]^-1
+		bn_multiply(&x[i], &inv, prime);    // inv = (x[0] * ... * x[i-1])^-1
+		bn_mod(&t, prime);
+		x[i] = t;
+	}
+	bn_mod(&inv, prime);
+	x[0] = inv;
+	memzero(&inv, sizeof(inv));
+	memzero(&t, sizeof(t));
+}
+
 void bn_normalize(bignum256 *a) {
 	bn_addi(a, 0);
 }
@@ -125,12 +125,18 @@ void bn_mod(bignum256 *x, const bignum256 *prime);
 
 void bn_multiply(const bignum256 *k, bignum256 *x, const bignum256 *prime);
 
+void bn_multiply_secp256k1(const bignum256 *k, bignum256 *x, const bignum256 *prime);
+
+void bn_multiply_nist256p1(const bignum256 *k, bignum256 *x, const bignum256 *prime);
+
 void bn_fast_mod(bignum256 *x, const bignum256 *prime);
 
 void bn_sqrt(bignum256 *x, const bignum256 *prime);
 
 void bn_inverse(bignum256 *x, const bignum256 *prime);
 
+void bn_inverse_batch(bignum256 *x, bignum256 *tmp, size_t count, const bignum256 *prime);
+
 void bn_normalize(bignum256 *a);
 
 void bn_add(bignum256 *a, const bignum256 *b);
@@ -22,6 +22,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <assert.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -151,7 +152,7 @@ int hdnode_from_xprv(uint32_t depth, uint32_t child_num, const uint8_t *chain_co
 
 int hdnode_from_seed(const uint8_t *seed, int seed_len, const char* curve, HDNode *out)
 {
-	static CONFIDENTIAL uint8_t I[32 + 32];
+	STATIC_CONFIDENTIAL uint8_t I[32 + 32];
 	memset(out, 0, sizeof(HDNode));
 	out->depth = 0;
 	out->child_num = 0;
@@ -159,7 +160,7 @@ int hdnode_from_seed(const uint8_t *seed, int seed_len, const char* curve, HDNod
 	if (out->curve == 0) {
 		return 0;
 	}
-	static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+	STATIC_CONFIDENTIAL HMAC_SHA512_CTX ctx;
 	hmac_sha512_Init(&ctx, (const uint8_t*) out->curve->bip32_name, strlen(out->curve->bip32_name));
 	hmac_sha512_Update(&ctx, seed, seed_len);
 	hmac_sha512_Final(&ctx, I);
@@ -199,9 +200,9 @@ uint32_t hdnode_fingerprint(HDNode *node)
 
 int hdnode_private_ckd(HDNode *inout, uint32_t i)
 {
-	static CONFIDENTIAL uint8_t data[1 + 32 + 4];
-	static CONFIDENTIAL uint8_t I[32 + 32];
-	static CONFIDENTIAL bignum256 a, b;
+	STATIC_CONFIDENTIAL uint8_t data[1 + 32 + 4];
+	STATIC_CONFIDENTIAL uint8_t I[32 + 32];
+	STATIC_CONFIDENTIAL bignum256 a, b;
 
 	if (i & 0x80000000) { // private derivation
 		data[0] = 0;
@@ -217,7 +218,7 @@ int hdnode_private_ckd(HDNode *inout, uint32_t i)
 
 	bn_read_be(inout->private_key, &a);
 
-	static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+	STATIC_CONFIDENTIAL HMAC_SHA512_CTX ctx;
 	hmac_sha512_Init(&ctx, inout->chain_code, 32);
 	hmac_sha512_Update(&ctx, data, sizeof(data));
 	hmac_sha512_Final(&ctx, I);
@@ -293,10 +294,10 @@ int hdnode_private_ckd_cardano(HDNode *inout, uint32_t index)
 		keysize = 64;
 	}
 
-	static CONFIDENTIAL uint8_t data[1 + 64 + 4];
-	static CONFIDENTIAL uint8_t z[32 + 32];
-	static CONFIDENTIAL uint8_t priv_key[64];
-	static CONFIDENTIAL uint8_t res_key[64];
+	STATIC_CONFIDENTIAL uint8_t data[1 + 64 + 4];
+	STATIC_CONFIDENTIAL uint8_t z[32 + 32];
+	STATIC_CONFIDENTIAL uint8_t priv_key[64];
+	STATIC_CONFIDENTIAL uint8_t res_key[64];
 
 	write_le(data + keysize + 1, index);
 
@@ -313,12 +314,12 @@ int hdnode_private_ckd_cardano(HDNode *inout, uint32_t index)
 		memcpy(data + 1, inout->public_key + 1, 32);
 	}
 
-	static CONFIDENTIAL HMAC_SHA512_CTX ctx;
+	STATIC_CONFIDENTIAL HMAC_SHA512_CTX ctx;
 	hmac_sha512_Init(&ctx, inout->chain_code, 32);
 	hmac_sha512_Update(&ctx, data, 1 + keysize + 4);
 	hmac_sha512_Final(&ctx, z);
 
-	static CONFIDENTIAL uint8_t zl8[32];
+	STATIC_CONFIDENTIAL uint8_t zl8[32];
 	memset(zl8, 0, 32);
 
 	/* get 8 * Zl */
@@ -355,7 +356,7 @@ int hdnode_private_ckd_cardano(HDNode *inout, uint32_t index)
 }
 
 int hdnode_from_seed_cardano(const uint8_t *pass, int pass_len, const uint8_t *seed, int seed_len, HDNode *out) {
-	static CONFIDENTIAL uint8_t secret[96];
+	STATIC_CONFIDENTIAL uint8_t secret[96];
 	pbkdf2_hmac_sha512(pass, pass_len, seed, seed_len, 4096, secret, 96);
 	
 	secret[0] &= 248;
@@ -440,6 +441,151 @@ int hdnode_public_ckd(HDNode *inout, uint32_t i)
 	return 1;
 }
 
+// compute I = HMAC-SHA512(parent chain code, parent public key || i)
+// from the prepared inner and outer states, i.e. with two compressions
+// instead of four.
+static void hdnode_public_ckd_range_hmac(const HDNodePublicRange *range, uint32_t i, uint8_t I[64])
+{
+	uint64_t block[16], digest[8];
+	const uint8_t *pub = range->parent_public_key;
+	int j;
+
+	// 33 byte public key, 4 byte index, padding and length of
+	// i_key_pad || message in bits
+	for (j = 0; j < 4; j++) {
+		block[j] = ((uint64_t)read_be(pub + 8 * j) << 32) | read_be(pub + 8 * j + 4);
+	}
+	block[4] = ((uint64_t)pub[32] << 56) | ((uint64_t)i << 24) | (0x80ULL << 16);
+	memset(block + 5, 0, 10 * sizeof(uint64_t));
+	block[15] = (SHA512_BLOCK_LENGTH + 33 + 4) * 8;
+	sha512_Transform(range->idig, block, digest);
+
+	// inner digest, padding and length of o_key_pad || digest in bits
+	memcpy(block, digest, sizeof(digest));
+	block[8] = 0x8000000000000000ULL;
+	memset(block + 9, 0, 6 * sizeof(uint64_t));
+	block[15] = (SHA512_BLOCK_LENGTH + SHA512_DIGEST_LENGTH) * 8;
+	sha512_Transform(range->odig, block, digest);
+
+	for (j = 0; j < 8; j++) {
+		write_be(I + 8 * j, digest[j] >> 32);
+		write_be(I + 8 * j + 4, digest[j]);
+	}
+	memzero(block, sizeof(block));
+	memzero(digest, sizeof(digest));
+}
+
+// derive the next window of children into range->child and range->chain_code
+static void hdnode_public_ckd_range_fill(HDNodePublicRange *range)
+{
+	const ecdsa_curve *curve = range->curve;
+	bignum256 c[ECDSA_MULTIPLY_BATCH_SIZE];
+	uint8_t I[32 + 32];
+	uint32_t j, n;
+
+	n = range->end - range->next;
+	if (n > ECDSA_MULTIPLY_BATCH_SIZE) {
+		n = ECDSA_MULTIPLY_BATCH_SIZE;
+	}
+	range->pos = 0;
+	range->count = 0;
+	if (n == 0) {
+		return;
+	}
+	for (j = 0; j < n; j++) {
+		hdnode_public_ckd_range_hmac(range, range->next + j, I);
+		bn_read_be(I, &c[j]);
+		if (!bn_is_less(&c[j], &curve->order)) {
+			// invalid key, handled by hdnode_public_ckd_cp below
+			bn_zero(&c[j]);
+		}
+		memcpy(range->chain_code[j], I + 32, 32);
+	}
+	scalar_multiply_add_batch(curve, c, &range->parent, range->child, n);
+	for (j = 0; j < n; j++) {
+		if (point_is_infinity(&range->child[j]) || bn_is_zero(&c[j])) {
+			// one of the cases that need the next HMAC round
+			hdnode_public_ckd_cp(curve, &range->parent, range->parent_chain_code, range->next + j, &range->child[j], range->chain_code[j]);
+		}
+	}
+	range->count = n;
+
+	memzero(I, sizeof(I));
+	memzero(c, sizeof(c));
+}
+
+// prepare the public derivation of the children from, from + 1, ..., to - 1
+// of parent.  The HMAC key schedule is computed once here and the child
+// points are derived and normalized ECDSA_MULTIPLY_BATCH_SIZE at a time.
+// returns 0 on invalid parent or if the range contains a hardened index.
+int hdnode_public_ckd_range_begin(HDNodePublicRange *range, const HDNode *parent, uint32_t from, uint32_t to)
+{
+	range->curve = parent->curve->params;
+	if (range->curve == NULL || from > to || to > 0x80000000) {
+		return 0;
+	}
+	if (!ecdsa_read_pubkey(range->curve, parent->public_key, &range->parent)) {
+		return 0;
+	}
+	memcpy(range->parent_public_key, parent->public_key, 33);
+	memcpy(range->parent_chain_code, parent->chain_code, 32);
+	hmac_sha512_prepare(parent->chain_code, 32, range->odig, range->idig);
+	range->next = from;
+	range->end = to;
+	range->pos = 0;
+	range->count = 0;
+	return 1;
+}
+
+// get the next child of the range: its index, compressed public key
+// and (if chain_code is not NULL) its chain code.
+// returns 0 when the range is exhausted.
+int hdnode_public_ckd_range_next(HDNodePublicRange *range, uint32_t *i, uint8_t *public_key, uint8_t *chain_code)
+{
+	if (range->pos == range->count) {
+		if (range->next == range->end) {
+			return 0;
+		}
+		hdnode_public_ckd_range_fill(range);
+	}
+	const curve_point *child = &range->child[range->pos];
+	if (i) {
+		*i = range->next;
+	}
+	public_key[0] = 0x02 | (child->y.val[0] & 0x01);
+	bn_write_be(&child->x, public_key + 1);
+	if (chain_code) {
+		memcpy(chain_code, range->chain_code[range->pos], 32);
+	}
+	range->pos++;
+	range->next++;
+	return 1;
+}
+
+// wipe the state of a range
+void hdnode_public_ckd_range_end(HDNodePublicRange *range)
+{
+	memzero(range, sizeof(*range));
+}
+
+// compute the public keys of the children i, i + 1, ..., i + count - 1 of
+// parent and store them compressed in public_keys (33 bytes each).
+// Gives the same keys as calling hdnode_public_ckd on copies of parent.
+// returns 0 on invalid parent or if the range contains a hardened index.
+int hdnode_public_ckd_batch(const HDNode *parent, uint32_t i, uint32_t count, uint8_t *public_keys)
+{
+	HDNodePublicRange range;
+
+	if (count > 0x80000000 - i || !hdnode_public_ckd_range_begin(&range, parent, i, i + count)) {
+		return 0;
+	}
+	while (hdnode_public_ckd_range_next(&range, NULL, public_keys, NULL)) {
+		public_keys += 33;
+	}
+	hdnode_public_ckd_range_end(&range);
+	return 1;
+}
+
 void hdnode_public_ckd_address_optimized(const curve_point *pub, const uint8_t *chain_code, uint32_t i, uint32_t version, HasherType hasher_pubkey, HasherType hasher_base58, char *addr, int addrsize, int addrformat)
 {
 	uint8_t child_pubkey[33];
@@ -460,19 +606,154 @@ void hdnode_public_ckd_address_optimized(const curve_point *pub, const uint8_t *
 }
 
 #if USE_BIP32_CACHE
-static bool private_ckd_cache_root_set = false;
-static CONFIDENTIAL HDNode private_ckd_cache_root;
-static int private_ckd_cache_index = 0;
+#define BIP32_CACHE_NONE UINT32_MAX
 
-static CONFIDENTIAL struct {
-	bool set;
-	size_t depth;
-	uint32_t i[BIP32_CACHE_MAXDEPTH];
-	HDNode node;
-} private_ckd_cache[BIP32_CACHE_SIZE];
+static CONFIDENTIAL BIP32CacheEntry private_ckd_cache_entries[BIP32_CACHE_SIZE];
+static BIP32Cache private_ckd_cache;
 
-int hdnode_private_ckd_cached(HDNode *inout, const uint32_t *i, size_t i_count, uint32_t *fingerprint)
+static void bip32_cache_lock(BIP32Cache *cache)
+{
+	if (cache->lock) {
+		cache->lock(cache->lock_arg);
+	}
+}
+
+static void bip32_cache_unlock(BIP32Cache *cache)
+{
+	if (cache->unlock) {
+		cache->unlock(cache->lock_arg);
+	}
+}
+
+// roots are identified by a digest of everything their children depend on,
+// so the cache does not keep another copy of the root private key
+static void bip32_cache_root_id(const HDNode *node, uint8_t root[32])
+{
+	SHA256_CTX ctx;
+	sha256_Init(&ctx);
+	sha256_Update(&ctx, (const uint8_t *)&node->curve, sizeof(node->curve));
+	sha256_Update(&ctx, (const uint8_t *)&node->depth, sizeof(node->depth));
+	sha256_Update(&ctx, node->chain_code, sizeof(node->chain_code));
+	sha256_Update(&ctx, node->private_key, sizeof(node->private_key));
+	sha256_Update(&ctx, node->private_key_extension, sizeof(node->private_key_extension));
+	sha256_Final(&ctx, root);
+}
+
+static uint32_t bip32_cache_bucket(const BIP32Cache *cache, const uint8_t root[32], const uint32_t *i, size_t depth)
+{
+	uint32_t h;
+	memcpy(&h, root, sizeof(h));
+	for (size_t k = 0; k < depth; k++) {
+		h = (h ^ i[k]) * 0x01000193;
+	}
+	return h % cache->size;
+}
+
+static uint32_t bip32_cache_find(const BIP32Cache *cache, uint32_t bucket, const uint8_t root[32], const uint32_t *i, size_t depth)
+{
+	uint32_t k;
+	for (k = cache->entries[bucket].bucket; k != BIP32_CACHE_NONE; k = cache->entries[k].hash_next) {
+		const BIP32CacheEntry *e = &cache->entries[k];
+		if (e->depth == depth &&
+			memcmp(e->root, root, sizeof(e->root)) == 0 &&
+			memcmp(e->i, i, depth * sizeof(uint32_t)) == 0) {
+			break;
+		}
+	}
+	return k;
+}
+
+// move entry k to the front of the LRU list
+static void bip32_cache_touch(BIP32Cache *cache, uint32_t k)
+{
+	BIP32CacheEntry *e = &cache->entries[k];
+	if (cache->lru_head == k) {
+		return;
+	}
+	cache->entries[e->lru_prev].lru_next = e->lru_next;
+	if (e->lru_next != BIP32_CACHE_NONE) {
+		cache->entries[e->lru_next].lru_prev = e->lru_prev;
+	} else {
+		cache->lru_tail = e->lru_prev;
+	}
+	e->lru_prev = BIP32_CACHE_NONE;
+	e->lru_next = cache->lru_head;
+	cache->entries[cache->lru_head].lru_prev = k;
+	cache->lru_head = k;
+}
+
+// store node under (root, i), replacing the least recently used entry
+static void bip32_cache_insert(BIP32Cache *cache, const uint8_t root[32], const uint32_t *i, size_t depth, const HDNode *node)
+{
+	uint32_t bucket = bip32_cache_bucket(cache, root, i, depth);
+	uint32_t k = bip32_cache_find(cache, bucket, root, i, depth);
+	if (k == BIP32_CACHE_NONE) {
+		// another thread may have stored the same node meanwhile, otherwise
+		// the tail of the LRU list is reused
+		k = cache->lru_tail;
+		BIP32CacheEntry *e = &cache->entries[k];
+		if (e->set) {
+			uint32_t *p = &cache->entries[bip32_cache_bucket(cache, e->root, e->i, e->depth)].bucket;
+			while (*p != k) {
+				p = &cache->entries[*p].hash_next;
+			}
+			*p = e->hash_next;
+		}
+		memcpy(e->root, root, sizeof(e->root));
+		e->depth = depth;
+		memzero(e->i, sizeof(e->i));
+		memcpy(e->i, i, depth * sizeof(uint32_t));
+		memcpy(&e->node, node, sizeof(HDNode));
+		e->set = true;
+		e->hash_next = cache->entries[bucket].bucket;
+		cache->entries[bucket].bucket = k;
+	}
+	bip32_cache_touch(cache, k);
+}
+
+void bip32_cache_init(BIP32Cache *cache, BIP32CacheEntry *entries, uint32_t size)
+{
+	memzero(cache, sizeof(BIP32Cache));
+	cache->entries = entries;
+	cache->size = size;
+	bip32_cache_clear(cache);
+}
+
+void bip32_cache_clear(BIP32Cache *cache)
+{
+	bip32_cache_lock(cache);
+	memzero(cache->entries, cache->size * sizeof(BIP32CacheEntry));
+	// all entries are on the LRU list, unused ones are at its tail
+	for (uint32_t k = 0; k < cache->size; k++) {
+		cache->entries[k].bucket = BIP32_CACHE_NONE;
+		cache->entries[k].hash_next = BIP32_CACHE_NONE;
+		cache->entries[k].lru_prev = k > 0 ? k - 1 : BIP32_CACHE_NONE;
+		cache->entries[k].lru_next = k + 1 < cache->size ? k + 1 : BIP32_CACHE_NONE;
+	}
+	cache->lru_head = cache->size > 0 ? 0 : BIP32_CACHE_NONE;
+	cache->lru_tail = cache->size > 0 ? cache->size - 1 : BIP32_CACHE_NONE;
+	bip32_cache_unlock(cache);
+}
+
+void bip32_cache_stats(BIP32Cache *cache, uint64_t *hits, uint64_t *misses)
+{
+	bip32_cache_lock(cache);
+	if (hits) {
+		*hits = cache->hits;
+	}
+	if (misses) {
+		*misses = cache->misses;
+	}
+	bip32_cache_unlock(cache);
+}
+
+int hdnode_private_ckd_cached_ctx(BIP32Cache *cache, HDNode *inout, const uint32_t *i, size_t i_count, uint32_t *fingerprint)
 {
+#if !USE_REENTRANT
+	// locking suggests threads, which the static scratch buffers do not allow
+	assert(cache->lock == NULL);
+#endif
+
 	if (i_count == 0) {
 		// no way how to compute parent fingerprint
 		return 1;
@@ -485,44 +766,44 @@ int hdnode_private_ckd_cached(HDNode *inout, const uint32_t *i, size_t i_count,
 		return 1;
 	}
 
+	// the parent of the requested node is cached
+	size_t depth = i_count - 1;
+	bool use_cache = cache->size > 0 && depth <= BIP32_CACHE_MAXDEPTH;
 	bool found = false;
-	// if root is not set or not the same
-	if (!private_ckd_cache_root_set || memcmp(&private_ckd_cache_root, inout, sizeof(HDNode)) != 0) {
-		// clear the cache
-		private_ckd_cache_index = 0;
-		memzero(private_ckd_cache, sizeof(private_ckd_cache));
-		// setup new root
-		memcpy(&private_ckd_cache_root, inout, sizeof(HDNode));
-		private_ckd_cache_root_set = true;
-	} else {
-		// try to find parent
-		int j;
-		for (j = 0; j < BIP32_CACHE_SIZE; j++) {
-			if (private_ckd_cache[j].set &&
-				private_ckd_cache[j].depth == i_count - 1 &&
-				memcmp(private_ckd_cache[j].i, i, (i_count - 1) * sizeof(uint32_t)) == 0 &&
-				private_ckd_cache[j].node.curve == inout->curve) {
-				memcpy(inout, &(private_ckd_cache[j].node), sizeof(HDNode));
-				found = true;
-				break;
-			}
+	uint8_t root[32];
+
+	if (use_cache) {
+		bip32_cache_root_id(inout, root);
+		bip32_cache_lock(cache);
+		uint32_t k = bip32_cache_find(cache, bip32_cache_bucket(cache, root, i, depth), root, i, depth);
+		if (k != BIP32_CACHE_NONE) {
+			memcpy(inout, &cache->entries[k].node, sizeof(HDNode));
+			bip32_cache_touch(cache, k);
+			cache->hits++;
+			found = true;
+		} else {
+			cache->misses++;
 		}
+		bip32_cache_unlock(cache);
 	}
 
-	// else derive parent
+	// else derive parent outside of the lock
 	if (!found) {
 		size_t k;
-		for (k = 0; k < i_count - 1; k++) {
-			if (hdnode_private_ckd(inout, i[k]) == 0) return 0;
+		for (k = 0; k < depth; k++) {
+			if (hdnode_private_ckd(inout, i[k]) == 0) {
+				memzero(root, sizeof(root));
+				return 0;
+			}
 		}
 		// and save it
-		memset(&(private_ckd_cache[private_ckd_cache_index]), 0, sizeof(private_ckd_cache[private_ckd_cache_index]));
-		private_ckd_cache[private_ckd_cache_index].set = true;
-		private_ckd_cache[private_ckd_cache_index].depth = i_count - 1;
-		memcpy(private_ckd_cache[private_ckd_cache_index].i, i, (i_count - 1) * sizeof(uint32_t));
-		memcpy(&(private_ckd_cache[private_ckd_cache_index].node), inout, sizeof(HDNode));
-		private_ckd_cache_index = (private_ckd_cache_index + 1) % BIP32_CACHE_SIZE;
+		if (use_cache) {
+			bip32_cache_lock(cache);
+			bip32_cache_insert(cache, root, i, depth, inout);
+			bip32_cache_unlock(cache);
+		}
 	}
+	memzero(root, sizeof(root));
 
 	if (fingerprint) {
 		*fingerprint = hdnode_fingerprint(inout);
@@ -531,6 +812,14 @@ int hdnode_private_ckd_cached(HDNode *inout, const uint32_t *i, size_t i_count,
 
 	return 1;
 }
+
+int hdnode_private_ckd_cached(HDNode *inout, const uint32_t *i, size_t i_count, uint32_t *fingerprint)
+{
+	if (!private_ckd_cache.entries) {
+		bip32_cache_init(&private_ckd_cache, private_ckd_cache_entries, BIP32_CACHE_SIZE);
+	}
+	return hdnode_private_ckd_cached_ctx(&private_ckd_cache, inout, i, i_count, fingerprint);
+}
 #endif
 
 void hdnode_get_address_raw(HDNode *node, uint32_t version, uint8_t *addr_raw)
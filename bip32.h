@@ -53,6 +53,19 @@ typedef struct {
 	const curve_info *curve;
 } HDNode;
 
+// state of hdnode_public_ckd_range_begin/next
+typedef struct {
+	const ecdsa_curve *curve;
+	curve_point parent;
+	uint8_t parent_public_key[33];
+	uint8_t parent_chain_code[32];
+	uint64_t odig[8], idig[8];    // HMAC-SHA512 states keyed by parent_chain_code
+	uint32_t next, end;           // next index to derive, one past the last one
+	uint32_t pos, count;          // position in and size of the current window
+	curve_point child[ECDSA_MULTIPLY_BATCH_SIZE];
+	uint8_t chain_code[ECDSA_MULTIPLY_BATCH_SIZE][32];
+} HDNodePublicRange;
+
 int hdnode_from_xpub(uint32_t depth, uint32_t child_num, const uint8_t *chain_code, const uint8_t *public_key, const char *curve, HDNode *out);
 
 int hdnode_from_xprv(uint32_t depth, uint32_t child_num, const uint8_t *chain_code, const uint8_t *private_key, const char *curve, HDNode *out);
@@ -72,9 +85,53 @@ int hdnode_public_ckd_cp(const ecdsa_curve *curve, const curve_point *parent, co
 
 int hdnode_public_ckd(HDNode *inout, uint32_t i);
 
+int hdnode_public_ckd_batch(const HDNode *parent, uint32_t i, uint32_t count, uint8_t *public_keys);
+
+int hdnode_public_ckd_range_begin(HDNodePublicRange *range, const HDNode *parent, uint32_t from, uint32_t to);
+
+int hdnode_public_ckd_range_next(HDNodePublicRange *range, uint32_t *i, uint8_t *public_key, uint8_t *chain_code);
+
+void hdnode_public_ckd_range_end(HDNodePublicRange *range);
+
 void hdnode_public_ckd_address_optimized(const curve_point *pub, const uint8_t *chain_code, uint32_t i, uint32_t version, HasherType hasher_pubkey, HasherType hasher_base58, char *addr, int addrsize, int addrformat);
 
 #if USE_BIP32_CACHE
+// one cached node: the node reached from a root by the path i[0 .. depth - 1]
+typedef struct {
+	uint8_t root[32]; // digest identifying the root node
+	size_t depth;
+	uint32_t i[BIP32_CACHE_MAXDEPTH];
+	HDNode node;
+	bool set;
+	uint32_t bucket;    // first entry of hash bucket (index of this entry)
+	uint32_t hash_next; // next entry in the same hash bucket
+	uint32_t lru_prev, lru_next;
+} BIP32CacheEntry;
+
+// LRU cache of derived parent nodes over caller provided entries. lock and
+// unlock are optional and are called around every access of the cache.
+// the derivation itself runs outside of the lock and uses static scratch
+// buffers unless USE_REENTRANT is 1, so a cache shared between threads needs
+// both a mutex in lock and unlock and a build with USE_REENTRANT=1.
+typedef struct {
+	BIP32CacheEntry *entries;
+	uint32_t size;
+	uint32_t lru_head, lru_tail; // most and least recently used entry
+	uint64_t hits, misses;
+	void (*lock)(void *lock_arg);
+	void (*unlock)(void *lock_arg);
+	void *lock_arg;
+} BIP32Cache;
+
+void bip32_cache_init(BIP32Cache *cache, BIP32CacheEntry *entries, uint32_t size);
+
+void bip32_cache_clear(BIP32Cache *cache);
+
+void bip32_cache_stats(BIP32Cache *cache, uint64_t *hits, uint64_t *misses);
+
+int hdnode_private_ckd_cached_ctx(BIP32Cache *cache, HDNode *inout, const uint32_t *i, size_t i_count, uint32_t *fingerprint);
+
+// hdnode_private_ckd_cached_ctx on a global cache of BIP32_CACHE_SIZE entries
 int hdnode_private_ckd_cached(HDNode *inout, const uint32_t *i, size_t i_count, uint32_t *fingerprint);
 #endif
 
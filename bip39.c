@@ -21,6 +21,7 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <assert.h>
 #include <string.h>
 #include <stdbool.h>
 
@@ -35,14 +36,11 @@
 
 #if USE_BIP39_CACHE
 
-static int bip39_cache_index = 0;
+#define BIP39_CACHE_NONE UINT32_MAX
 
-static CONFIDENTIAL struct {
-	bool set;
-	char mnemonic[256];
-	char passphrase[64];
-	uint8_t seed[512 / 8];
-} bip39_cache[BIP39_CACHE_SIZE];
+static CONFIDENTIAL BIP39CacheEntry bip39_cache_entries[BIP39_CACHE_SIZE];
+static BIP39CacheShard bip39_cache_shard;
+static BIP39Cache bip39_cache;
 
 #endif
 
@@ -136,64 +134,78 @@ const uint16_t *mnemonic_from_data_indexes(const uint8_t *data, int len)
 	return mnemo;
 }
 
-int mnemonic_to_entropy(const char *mnemonic, uint8_t *entropy)
+// find the index of the word of length len in wordlist, or -1 if there is
+// none; the first letter selects a bucket, which is then bisected
+static int mnemonic_find_word_len(const char *word, size_t len)
 {
-	if (!mnemonic) {
-		return 0;
+	if (len == 0 || word[0] < 'a' || word[0] > 'z') {
+		return -1;
 	}
-
-	uint32_t i = 0, n = 0;
-
-	while (mnemonic[i]) {
-		if (mnemonic[i] == ' ') {
-			n++;
+	int lo = wordlist_first[word[0] - 'a'];
+	int hi = wordlist_first[word[0] - 'a' + 1];
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int c = strncmp(wordlist[mid], word, len);
+		if (c == 0 && wordlist[mid][len] != 0) {
+			c = 1; // word is a proper prefix of wordlist[mid]
+		}
+		if (c == 0) {
+			return mid;
+		}
+		if (c < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
-		i++;
 	}
-	n++;
+	return -1;
+}
 
-	// check number of words
-	if (n != 12 && n != 18 && n != 24) {
+int mnemonic_find_word(const char *word)
+{
+	return mnemonic_find_word_len(word, strlen(word));
+}
+
+int mnemonic_to_entropy(const char *mnemonic, uint8_t *entropy)
+{
+	if (!mnemonic) {
 		return 0;
 	}
 
-	char current_word[10];
-	uint32_t j, k, ki, bi = 0;
+	uint32_t n = 0, ki, bi = 0;
 	uint8_t bits[32 + 1];
 
 	memzero(bits, sizeof(bits));
-	i = 0;
-	while (mnemonic[i]) {
-		j = 0;
-		while (mnemonic[i] != ' ' && mnemonic[i] != 0) {
-			if (j >= sizeof(current_word) - 1) {
-				return 0;
-			}
-			current_word[j] = mnemonic[i];
-			i++; j++;
+	// words are separated by single spaces and looked up in place
+	const char *word = mnemonic;
+	for (;;) {
+		const char *end = word;
+		while (*end != ' ' && *end != 0) {
+			end++;
 		}
-		current_word[j] = 0;
-		if (mnemonic[i] != 0) {
-			i++;
+		// more words than the longest mnemonic
+		if (n == 24) {
+			return 0;
 		}
-		k = 0;
-		for (;;) {
-			if (!wordlist[k]) { // word not found
-				return 0;
-			}
-			if (strcmp(current_word, wordlist[k]) == 0) { // word found on index k
-				for (ki = 0; ki < 11; ki++) {
-					if (k & (1 << (10 - ki))) {
-						bits[bi / 8] |= 1 << (7 - (bi % 8));
-					}
-					bi++;
-				}
-				break;
+		int k = mnemonic_find_word_len(word, end - word);
+		if (k < 0) { // word not found
+			return 0;
+		}
+		for (ki = 0; ki < 11; ki++) {
+			if (k & (1 << (10 - ki))) {
+				bits[bi / 8] |= 1 << (7 - (bi % 8));
 			}
-			k++;
+			bi++;
 		}
+		n++;
+		if (*end == 0) {
+			break;
+		}
+		word = end + 1;
 	}
-	if (bi != n * 11) {
+
+	// check number of words
+	if (n != 12 && n != 18 && n != 24) {
 		return 0;
 	}
 	memcpy(entropy, bits, sizeof(bits));
@@ -222,27 +234,13 @@ int mnemonic_check(const char *mnemonic)
 }
 
 // passphrase must be at most 256 characters or code may crash
-void mnemonic_to_seed(const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total))
+static void mnemonic_to_seed_derive(const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total))
 {
 	int passphraselen = strlen(passphrase);
-#if USE_BIP39_CACHE
-	int mnemoniclen = strlen(mnemonic);
-	// check cache
-	if (mnemoniclen < 256 && passphraselen < 64) {
-		for (int i = 0; i < BIP39_CACHE_SIZE; i++) {
-			if (!bip39_cache[i].set) continue;
-			if (strcmp(bip39_cache[i].mnemonic, mnemonic) != 0) continue;
-			if (strcmp(bip39_cache[i].passphrase, passphrase) != 0) continue;
-			// found the correct entry
-			memcpy(seed, bip39_cache[i].seed, 512 / 8);
-			return;
-		}
-	}
-#endif
 	uint8_t salt[8 + 256];
 	memcpy(salt, "mnemonic", 8);
 	memcpy(salt + 8, passphrase, passphraselen);
-	static CONFIDENTIAL PBKDF2_HMAC_SHA512_CTX pctx;
+	STATIC_CONFIDENTIAL PBKDF2_HMAC_SHA512_CTX pctx;
 	pbkdf2_hmac_sha512_Init(&pctx, (const uint8_t *)mnemonic, strlen(mnemonic), salt, passphraselen + 8, 1);
 	if (progress_callback) {
 		progress_callback(0, BIP39_PBKDF2_ROUNDS);
@@ -255,18 +253,278 @@ void mnemonic_to_seed(const char *mnemonic, const char *passphrase, uint8_t seed
 	}
 	pbkdf2_hmac_sha512_Final(&pctx, seed);
 	memzero(salt, sizeof(salt));
+}
+
+#if USE_BIP39_CACHE
+
+static void bip39_cache_lock(const BIP39Cache *cache, BIP39CacheShard *shard)
+{
+	if (cache->lock) {
+		cache->lock(shard->lock_arg);
+	}
+}
+
+static void bip39_cache_unlock(const BIP39Cache *cache, BIP39CacheShard *shard)
+{
+	if (cache->unlock) {
+		cache->unlock(shard->lock_arg);
+	}
+}
+
+// the key is the digest of the length prefixed mnemonic and the passphrase,
+// so the cache does not keep them in plain text
+static void bip39_cache_key(const char *mnemonic, const char *passphrase, uint8_t key[32])
+{
+	SHA256_CTX ctx;
+	uint32_t mnemoniclen = strlen(mnemonic);
+	sha256_Init(&ctx);
+	sha256_Update(&ctx, (const uint8_t *)&mnemoniclen, sizeof(mnemoniclen));
+	sha256_Update(&ctx, (const uint8_t *)mnemonic, mnemoniclen);
+	sha256_Update(&ctx, (const uint8_t *)passphrase, strlen(passphrase));
+	sha256_Final(&ctx, key);
+}
+
+static BIP39CacheShard *bip39_cache_shard_of(const BIP39Cache *cache, const uint8_t key[32])
+{
+	uint32_t h;
+	memcpy(&h, key + 4, sizeof(h));
+	return &cache->shards[h % cache->shard_count];
+}
+
+static uint32_t bip39_cache_bucket(const BIP39CacheShard *shard, const uint8_t key[32])
+{
+	uint32_t h;
+	memcpy(&h, key, sizeof(h));
+	return h % shard->size;
+}
+
+static uint32_t bip39_cache_find(const BIP39CacheShard *shard, uint32_t bucket, const uint8_t key[32])
+{
+	uint32_t k;
+	for (k = shard->entries[bucket].bucket; k != BIP39_CACHE_NONE; k = shard->entries[k].hash_next) {
+		if (memcmp(shard->entries[k].key, key, 32) == 0) {
+			break;
+		}
+	}
+	return k;
+}
+
+static void bip39_cache_lru_unlink(BIP39CacheShard *shard, uint32_t k)
+{
+	BIP39CacheEntry *e = &shard->entries[k];
+	if (e->lru_prev != BIP39_CACHE_NONE) {
+		shard->entries[e->lru_prev].lru_next = e->lru_next;
+	} else {
+		shard->lru_head = e->lru_next;
+	}
+	if (e->lru_next != BIP39_CACHE_NONE) {
+		shard->entries[e->lru_next].lru_prev = e->lru_prev;
+	} else {
+		shard->lru_tail = e->lru_prev;
+	}
+}
+
+// move entry k to the front of the LRU list
+static void bip39_cache_touch(BIP39CacheShard *shard, uint32_t k)
+{
+	BIP39CacheEntry *e = &shard->entries[k];
+	bip39_cache_lru_unlink(shard, k);
+	e->lru_prev = BIP39_CACHE_NONE;
+	e->lru_next = shard->lru_head;
+	if (shard->lru_head != BIP39_CACHE_NONE) {
+		shard->entries[shard->lru_head].lru_prev = k;
+	} else {
+		shard->lru_tail = k;
+	}
+	shard->lru_head = k;
+}
+
+// wipe entry k and move it to the back of the LRU list to be reused first
+static void bip39_cache_evict(BIP39CacheShard *shard, uint32_t k)
+{
+	BIP39CacheEntry *e = &shard->entries[k];
+	uint32_t *p = &shard->entries[bip39_cache_bucket(shard, e->key)].bucket;
+	while (*p != k) {
+		p = &shard->entries[*p].hash_next;
+	}
+	*p = e->hash_next;
+	memzero(e->key, sizeof(e->key));
+	memzero(e->seed, sizeof(e->seed));
+	e->time = 0;
+	e->set = false;
+	e->hash_next = BIP39_CACHE_NONE;
+
+	bip39_cache_lru_unlink(shard, k);
+	e->lru_next = BIP39_CACHE_NONE;
+	e->lru_prev = shard->lru_tail;
+	if (shard->lru_tail != BIP39_CACHE_NONE) {
+		shard->entries[shard->lru_tail].lru_next = k;
+	} else {
+		shard->lru_head = k;
+	}
+	shard->lru_tail = k;
+}
+
+static bool bip39_cache_expired(const BIP39Cache *cache, const BIP39CacheEntry *e)
+{
+	return cache->now && cache->now() - e->time >= cache->ttl;
+}
+
+void bip39_cache_init(BIP39Cache *cache, BIP39CacheShard *shards, uint32_t shard_count, BIP39CacheEntry *entries, uint32_t size)
+{
+	memzero(cache, sizeof(BIP39Cache));
+	memzero(shards, shard_count * sizeof(BIP39CacheShard));
+	cache->shards = shards;
+	cache->shard_count = shard_count;
+	for (uint32_t j = 0, first = 0; j < shard_count; j++) {
+		uint32_t n = size / shard_count + (j < size % shard_count);
+		shards[j].entries = entries + first;
+		shards[j].size = n;
+		first += n;
+	}
+	bip39_cache_clear(cache);
+}
+
+void bip39_cache_clear(BIP39Cache *cache)
+{
+	for (uint32_t j = 0; j < cache->shard_count; j++) {
+		BIP39CacheShard *shard = &cache->shards[j];
+		bip39_cache_lock(cache, shard);
+		memzero(shard->entries, shard->size * sizeof(BIP39CacheEntry));
+		// all entries are on the LRU list, unused ones are at its tail
+		for (uint32_t k = 0; k < shard->size; k++) {
+			shard->entries[k].bucket = BIP39_CACHE_NONE;
+			shard->entries[k].hash_next = BIP39_CACHE_NONE;
+			shard->entries[k].lru_prev = k > 0 ? k - 1 : BIP39_CACHE_NONE;
+			shard->entries[k].lru_next = k + 1 < shard->size ? k + 1 : BIP39_CACHE_NONE;
+		}
+		shard->lru_head = shard->size > 0 ? 0 : BIP39_CACHE_NONE;
+		shard->lru_tail = shard->size > 0 ? shard->size - 1 : BIP39_CACHE_NONE;
+		bip39_cache_unlock(cache, shard);
+	}
+}
+
+void bip39_cache_stats(BIP39Cache *cache, uint64_t *hits, uint64_t *misses)
+{
+	uint64_t h = 0, m = 0;
+	for (uint32_t j = 0; j < cache->shard_count; j++) {
+		BIP39CacheShard *shard = &cache->shards[j];
+		bip39_cache_lock(cache, shard);
+		h += shard->hits;
+		m += shard->misses;
+		bip39_cache_unlock(cache, shard);
+	}
+	if (hits) {
+		*hits = h;
+	}
+	if (misses) {
+		*misses = m;
+	}
+}
+
+void mnemonic_to_seed_ctx(BIP39Cache *cache, const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total))
+{
+	uint8_t key[32];
+#if !USE_REENTRANT
+	// locking suggests threads, which the static scratch buffers do not allow
+	assert(cache->lock == NULL);
+#endif
+	if (cache->shard_count == 0) {
+		mnemonic_to_seed_derive(mnemonic, passphrase, seed, progress_callback);
+		return;
+	}
+	bip39_cache_key(mnemonic, passphrase, key);
+	BIP39CacheShard *shard = bip39_cache_shard_of(cache, key);
+	if (shard->size == 0) {
+		mnemonic_to_seed_derive(mnemonic, passphrase, seed, progress_callback);
+		memzero(key, sizeof(key));
+		return;
+	}
+
+	// check cache
+	bool found = false;
+	bip39_cache_lock(cache, shard);
+	uint32_t bucket = bip39_cache_bucket(shard, key);
+	uint32_t k = bip39_cache_find(shard, bucket, key);
+	if (k != BIP39_CACHE_NONE && bip39_cache_expired(cache, &shard->entries[k])) {
+		bip39_cache_evict(shard, k);
+		k = BIP39_CACHE_NONE;
+	}
+	if (k != BIP39_CACHE_NONE) {
+		memcpy(seed, shard->entries[k].seed, 512 / 8);
+		bip39_cache_touch(shard, k);
+		shard->hits++;
+		found = true;
+	} else {
+		shard->misses++;
+	}
+	bip39_cache_unlock(cache, shard);
+	if (found) {
+		memzero(key, sizeof(key));
+		return;
+	}
+
+	// derive outside of the lock
+	mnemonic_to_seed_derive(mnemonic, passphrase, seed, progress_callback);
+
+	// store to cache, unless another caller did meanwhile
+	bip39_cache_lock(cache, shard);
+	k = bip39_cache_find(shard, bucket, key);
+	if (k == BIP39_CACHE_NONE) {
+		k = shard->lru_tail;
+		if (shard->entries[k].set) {
+			bip39_cache_evict(shard, k);
+		}
+		BIP39CacheEntry *e = &shard->entries[k];
+		memcpy(e->key, key, sizeof(e->key));
+		memcpy(e->seed, seed, 512 / 8);
+		e->time = cache->now ? cache->now() : 0;
+		e->set = true;
+		e->hash_next = shard->entries[bucket].bucket;
+		shard->entries[bucket].bucket = k;
+	}
+	bip39_cache_touch(shard, k);
+	bip39_cache_unlock(cache, shard);
+	memzero(key, sizeof(key));
+}
+
+#endif
+
+// passphrase must be at most 256 characters or code may crash
+void mnemonic_to_seed(const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total))
+{
 #if USE_BIP39_CACHE
-	// store to cache
-	if (mnemoniclen < 256 && passphraselen < 64) {
-		bip39_cache[bip39_cache_index].set = true;
-		strcpy(bip39_cache[bip39_cache_index].mnemonic, mnemonic);
-		strcpy(bip39_cache[bip39_cache_index].passphrase, passphrase);
-		memcpy(bip39_cache[bip39_cache_index].seed, seed, 512 / 8);
-		bip39_cache_index = (bip39_cache_index + 1) % BIP39_CACHE_SIZE;
+	if (!bip39_cache.shards) {
+		bip39_cache_init(&bip39_cache, &bip39_cache_shard, 1, bip39_cache_entries, BIP39_CACHE_SIZE);
 	}
+	mnemonic_to_seed_ctx(&bip39_cache, mnemonic, passphrase, seed, progress_callback);
+#else
+	mnemonic_to_seed_derive(mnemonic, passphrase, seed, progress_callback);
 #endif
 }
 
+void mnemonic_to_seed_batch(const char *const mnemonics[], const char *const passphrases[], uint8_t seeds[][512 / 8], size_t count)
+{
+	uint8_t salts[PBKDF2_SHA512_LANES][8 + 256];
+	const uint8_t *pass[PBKDF2_SHA512_LANES], *salt[PBKDF2_SHA512_LANES];
+	int passlen[PBKDF2_SHA512_LANES], saltlen[PBKDF2_SHA512_LANES];
+
+	for (size_t first = 0; first < count; first += PBKDF2_SHA512_LANES) {
+		size_t n = count - first < PBKDF2_SHA512_LANES ? count - first : PBKDF2_SHA512_LANES;
+		for (size_t i = 0; i < n; i++) {
+			int passphraselen = strlen(passphrases[first + i]);
+			memcpy(salts[i], "mnemonic", 8);
+			memcpy(salts[i] + 8, passphrases[first + i], passphraselen);
+			pass[i] = (const uint8_t *)mnemonics[first + i];
+			passlen[i] = strlen(mnemonics[first + i]);
+			salt[i] = salts[i];
+			saltlen[i] = passphraselen + 8;
+		}
+		pbkdf2_hmac_sha512_batch(pass, passlen, salt, saltlen, BIP39_PBKDF2_ROUNDS, seeds + first, n);
+	}
+	memzero(salts, sizeof(salts));
+}
+
 const char * const *mnemonic_wordlist(void)
 {
 	return wordlist;
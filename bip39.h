@@ -25,6 +25,9 @@
 #define __BIP39_H__
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "options.h"
 
 #define BIP39_PBKDF2_ROUNDS 2048
 
@@ -38,9 +41,63 @@ int mnemonic_check(const char *mnemonic);
 
 int mnemonic_to_entropy(const char *mnemonic, uint8_t *entropy);
 
+// index of word in the wordlist, or -1 if it is not a BIP39 word
+int mnemonic_find_word(const char *word);
+
 // passphrase must be at most 256 characters or code may crash
 void mnemonic_to_seed(const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total));
 
+#if USE_BIP39_CACHE
+// one cached seed, keyed by a digest of its mnemonic and passphrase
+typedef struct {
+	uint8_t key[32];
+	uint8_t seed[512 / 8];
+	uint64_t time; // value of now() when the seed was stored
+	bool set;
+	uint32_t bucket;    // first entry of hash bucket (index of this entry)
+	uint32_t hash_next; // next entry in the same hash bucket
+	uint32_t lru_prev, lru_next;
+} BIP39CacheEntry;
+
+// an LRU cache over a part of the entries with its own lock
+typedef struct {
+	BIP39CacheEntry *entries;
+	uint32_t size;
+	uint32_t lru_head, lru_tail; // most and least recently used entry
+	uint64_t hits, misses;
+	void *lock_arg;
+} BIP39CacheShard;
+
+// seed cache striped over shard_count shards, each seed belongs to one
+// shard. lock and unlock are optional and are called with the lock_arg of
+// the shard around every access of it. PBKDF2 runs outside of the lock and
+// uses static scratch buffers unless USE_REENTRANT is 1, so a cache shared
+// between threads also needs a build with USE_REENTRANT=1. when now is set,
+// seeds are dropped ttl units of now() after they were stored. evicted
+// seeds are wiped.
+typedef struct {
+	BIP39CacheShard *shards;
+	uint32_t shard_count;
+	void (*lock)(void *lock_arg);
+	void (*unlock)(void *lock_arg);
+	uint64_t (*now)(void);
+	uint64_t ttl;
+} BIP39Cache;
+
+// the entries are divided evenly between the shards
+void bip39_cache_init(BIP39Cache *cache, BIP39CacheShard *shards, uint32_t shard_count, BIP39CacheEntry *entries, uint32_t size);
+
+void bip39_cache_clear(BIP39Cache *cache);
+
+void bip39_cache_stats(BIP39Cache *cache, uint64_t *hits, uint64_t *misses);
+
+void mnemonic_to_seed_ctx(BIP39Cache *cache, const char *mnemonic, const char *passphrase, uint8_t seed[512 / 8], void (*progress_callback)(uint32_t current, uint32_t total));
+#endif
+
+// mnemonic_to_seed for count mnemonic/passphrase pairs, several of them are
+// hashed in parallel. the seed cache is neither consulted nor updated.
+void mnemonic_to_seed_batch(const char *const mnemonics[], const char *const passphrases[], uint8_t seeds[][512 / 8], size_t count);
+
 const char * const *mnemonic_wordlist(void);
 
 #endif
@@ -2072,3 +2072,11 @@ static const char * const wordlist[] = {
 "zoo",
 0,
 };
+
+// index of the first word starting with each letter 'a' .. 'z', the entry
+// for 'z' + 1 is the size of the wordlist; relies on wordlist being sorted
+static const uint16_t wordlist_first[26 + 1] = {
+	   0,  136,  253,  439,  551,  651,  757,  833,  897,  952,  972,
+	 992, 1068, 1173, 1214, 1269, 1401, 1409, 1517, 1767, 1888, 1923,
+	1969, 2038, 2038, 2044, 2048,
+};
@@ -5,6 +5,11 @@
 #include "chacha20poly1305.h"
 #include "ecrypt-portable.h"
 
+// Encryption and MAC take turns on chunks of this size so that each chunk
+// is still in the L1 cache when the second of them reads it. A multiple of
+// the Chacha20 block size and large enough for the vector kernels of both.
+#define CHACHA20POLY1305_CHUNK 1024
+
 void hchacha20(ECRYPT_ctx *x,u8 *c);
 
 // Initialize the XChaCha20 + Poly1305 context for encryption or decryption
@@ -38,15 +43,27 @@ void xchacha20poly1305_init(chacha20poly1305_ctx *ctx, uint8_t key[32], uint8_t
 // Encrypt n bytes of plaintext where n must be evenly divisible by the
 // Chacha20 blocksize of 64, except for the final n bytes of plaintext.
 void chacha20poly1305_encrypt(chacha20poly1305_ctx *ctx, uint8_t *in, uint8_t *out, size_t n) {
-    ECRYPT_encrypt_bytes(&ctx->chacha20, in, out, n);
-    poly1305_update(&ctx->poly1305, out, n);
+    while (n > 0) {
+        size_t len = n < CHACHA20POLY1305_CHUNK ? n : CHACHA20POLY1305_CHUNK;
+        ECRYPT_encrypt_bytes(&ctx->chacha20, in, out, len);
+        poly1305_update(&ctx->poly1305, out, len);
+        in += len;
+        out += len;
+        n -= len;
+    }
 }
 
 // Decrypt n bytes of ciphertext where n must be evenly divisible by the
 // Chacha20 blocksize of 64, except for the final n bytes of ciphertext.
 void chacha20poly1305_decrypt(chacha20poly1305_ctx *ctx, uint8_t *in, uint8_t *out, size_t n) {
-    poly1305_update(&ctx->poly1305, in, n);
-    ECRYPT_encrypt_bytes(&ctx->chacha20, in, out, n);
+    while (n > 0) {
+        size_t len = n < CHACHA20POLY1305_CHUNK ? n : CHACHA20POLY1305_CHUNK;
+        poly1305_update(&ctx->poly1305, in, len);
+        ECRYPT_encrypt_bytes(&ctx->chacha20, in, out, len);
+        in += len;
+        out += len;
+        n -= len;
+    }
 }
 
 // Include authenticated data in the Poly1305 MAC.
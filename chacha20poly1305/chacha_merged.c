@@ -4,6 +4,7 @@ D. J. Bernstein
 Public domain.
 */
 
+#include <string.h>
 #include "ecrypt-sync.h"
 #include "ecrypt-portable.h"
 
@@ -18,6 +19,119 @@ Public domain.
   a = PLUS(a,b); d = ROTATE(XOR(d,a), 8); \
   c = PLUS(c,d); b = ROTATE(XOR(b,c), 7);
 
+/*
+ * With GCC or clang vector extensions, ECRYPT_encrypt_bytes() produces
+ * four blocks at once in the 32-bit lanes of a vector, eight with AVX2 when
+ * the CPU has it.  The scalar loop below handles the
+ * tail and is the fallback.  Define CHACHA_NO_SIMD to use it for everything.
+ * The vector path stores the lanes to memory as they are, so it is only
+ * used on little-endian targets with SSE2 or NEON; elsewhere the vectors
+ * would be emulated and slower than the scalar loop.
+ */
+#if !defined(CHACHA_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+    (defined(__SSE2__) || defined(__ARM_NEON))
+#define CHACHA_SIMD 1
+typedef u32 chacha_u32x4 __attribute__((vector_size(16)));
+#if defined(__x86_64__) || defined(__i386__)
+#define CHACHA_X86 1
+typedef u32 chacha_u32x8 __attribute__((vector_size(32)));
+#endif
+#endif
+
+#ifdef CHACHA_SIMD
+#define VROTATE(v,c) (((v) << (c)) | ((v) >> (32 - (c))))
+
+#define VQUARTERROUND(a,b,c,d) \
+  a += b; d = VROTATE(d ^ a,16); \
+  c += d; b = VROTATE(b ^ c,12); \
+  a += b; d = VROTATE(d ^ a, 8); \
+  c += d; b = VROTATE(b ^ c, 7);
+
+#ifdef __clang__
+#define VSHUFFLE(T,a,b,...) __builtin_shufflevector(a, b, __VA_ARGS__)
+#else
+#define VSHUFFLE(T,a,b,...) __builtin_shuffle(a, b, (T){__VA_ARGS__})
+#endif
+
+/* interleave 32- and 64-bit words within each 128-bit lane */
+#define VUNPACKLO32_4(T,a,b) VSHUFFLE(T, a, b, 0, 4, 1, 5)
+#define VUNPACKHI32_4(T,a,b) VSHUFFLE(T, a, b, 2, 6, 3, 7)
+#define VUNPACKLO64_4(T,a,b) VSHUFFLE(T, a, b, 0, 1, 4, 5)
+#define VUNPACKHI64_4(T,a,b) VSHUFFLE(T, a, b, 2, 3, 6, 7)
+#define VUNPACKLO32_8(T,a,b) VSHUFFLE(T, a, b, 0, 8, 1, 9, 4, 12, 5, 13)
+#define VUNPACKHI32_8(T,a,b) VSHUFFLE(T, a, b, 2, 10, 3, 11, 6, 14, 7, 15)
+#define VUNPACKLO64_8(T,a,b) VSHUFFLE(T, a, b, 0, 1, 8, 9, 4, 5, 12, 13)
+#define VUNPACKHI64_8(T,a,b) VSHUFFLE(T, a, b, 2, 3, 10, 11, 6, 7, 14, 15)
+
+/*
+ * encrypts n blocks, block k of them with the counter input[12..13] + k.
+ * the words of the blocks are transposed four at a time: after the
+ * unpacks, 128-bit lane h of y[k] holds four words of block k + 4 * h.
+ */
+#define CHACHA_BLOCKS(name, T, n) \
+static void name(u32 *input, const u8 *m, u8 *c) \
+{ \
+  T x[16], j[16], y[4], t[4], lane; \
+  chacha_u32x4 b; \
+  int i, k, h, w; \
+  for (w = 0; w < 16; w++) j[w] = (T){0} + input[w]; \
+  for (k = 0; k < (n); k++) lane[k] = k; \
+  j[12] += lane; \
+  j[13] -= (T)(j[12] < lane); \
+  for (w = 0; w < 16; w++) x[w] = j[w]; \
+  for (i = 20;i > 0;i -= 2) { \
+    VQUARTERROUND( x[0], x[4], x[8],x[12]) \
+    VQUARTERROUND( x[1], x[5], x[9],x[13]) \
+    VQUARTERROUND( x[2], x[6],x[10],x[14]) \
+    VQUARTERROUND( x[3], x[7],x[11],x[15]) \
+    VQUARTERROUND( x[0], x[5],x[10],x[15]) \
+    VQUARTERROUND( x[1], x[6],x[11],x[12]) \
+    VQUARTERROUND( x[2], x[7], x[8],x[13]) \
+    VQUARTERROUND( x[3], x[4], x[9],x[14]) \
+  } \
+  for (w = 0; w < 16; w += 4) { \
+    t[0] = VUNPACKLO32_##n(T, x[w] + j[w], x[w + 1] + j[w + 1]); \
+    t[1] = VUNPACKHI32_##n(T, x[w] + j[w], x[w + 1] + j[w + 1]); \
+    t[2] = VUNPACKLO32_##n(T, x[w + 2] + j[w + 2], x[w + 3] + j[w + 3]); \
+    t[3] = VUNPACKHI32_##n(T, x[w + 2] + j[w + 2], x[w + 3] + j[w + 3]); \
+    y[0] = VUNPACKLO64_##n(T, t[0], t[2]); \
+    y[1] = VUNPACKHI64_##n(T, t[0], t[2]); \
+    y[2] = VUNPACKLO64_##n(T, t[1], t[3]); \
+    y[3] = VUNPACKHI64_##n(T, t[1], t[3]); \
+    for (h = 0; h < (n) / 4; h++) { \
+      for (k = 0; k < 4; k++) { \
+        const int off = 64 * (k + 4 * h) + 4 * w; \
+        memcpy(&b, m + off, 16); \
+        b ^= ((const chacha_u32x4 *)&y[k])[h]; \
+        memcpy(c + off, &b, 16); \
+      } \
+    } \
+  } \
+  input[12] = PLUS(input[12], (n)); \
+  if (input[12] < (u32)(n)) { \
+    input[13] = PLUSONE(input[13]); \
+  } \
+}
+
+CHACHA_BLOCKS(chacha_blocks_x4, chacha_u32x4, 4)
+
+#ifdef CHACHA_X86
+__attribute__((target("avx2")))
+CHACHA_BLOCKS(chacha_blocks_x8_avx2, chacha_u32x8, 8)
+
+static int chacha_has_avx2(void)
+{
+  static int has = -1;
+  if (has < 0) {
+    __builtin_cpu_init();
+    has = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return has;
+}
+#endif
+#endif
+
 void ECRYPT_init(void)
 {
   return;
@@ -69,6 +183,20 @@ void ECRYPT_encrypt_bytes(ECRYPT_ctx *x,const u8 *m,u8 *c,u32 bytes)
 
   if (!bytes) return;
 
+#ifdef CHACHA_SIMD
+#ifdef CHACHA_X86
+  if (bytes >= 512 && chacha_has_avx2()) {
+    for (; bytes >= 512; bytes -= 512, m += 512, c += 512) {
+      chacha_blocks_x8_avx2(x->input, m, c);
+    }
+  }
+#endif
+  for (; bytes >= 256; bytes -= 256, m += 256, c += 256) {
+    chacha_blocks_x4(x->input, m, c);
+  }
+  if (!bytes) return;
+#endif
+
   j0 = x->input[0];
   j1 = x->input[1];
   j2 = x->input[2];
@@ -0,0 +1,177 @@
+/*
+	poly1305 blocks using AVX2, four blocks per step in the 64 bit lanes of a vector
+
+	lane k accumulates every fourth block with r^4, at the end the lanes are
+	multiplied by r^4, r^3, r^2 and r and summed. the message words are split
+	into 26 bit limbs so that the products fit the 32 bit * 32 bit = 64 bit
+	multiplication of vpmuludq. works on top of poly1305-donna-64.h, h and r
+	are converted from and to its 44 bit limbs.
+*/
+
+#include <immintrin.h>
+
+/* below this the setup and the final sum of the lanes cost more than they save */
+#define poly1305_avx2_min_bytes 256
+
+static int
+poly1305_has_avx2(void) {
+	static int has = -1;
+	if (has < 0) {
+		__builtin_cpu_init();
+		has = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return has;
+}
+
+/* out = a * b, limb 1 of out may exceed 26 bits slightly */
+static void
+poly1305_mul26(unsigned long long out[5], const unsigned long long a[5], const unsigned long long b[5]) {
+	unsigned long long d0,d1,d2,d3,d4,c;
+	unsigned long long s1 = b[1] * 5, s2 = b[2] * 5, s3 = b[3] * 5, s4 = b[4] * 5;
+
+	d0 = a[0] * b[0] + a[1] * s4   + a[2] * s3   + a[3] * s2   + a[4] * s1;
+	d1 = a[0] * b[1] + a[1] * b[0] + a[2] * s4   + a[3] * s3   + a[4] * s2;
+	d2 = a[0] * b[2] + a[1] * b[1] + a[2] * b[0] + a[3] * s4   + a[4] * s3;
+	d3 = a[0] * b[3] + a[1] * b[2] + a[2] * b[1] + a[3] * b[0] + a[4] * s4;
+	d4 = a[0] * b[4] + a[1] * b[3] + a[2] * b[2] + a[3] * b[1] + a[4] * b[0];
+
+	              c = d0 >> 26; out[0] = d0 & 0x3ffffff;
+	d1 += c;      c = d1 >> 26; out[1] = d1 & 0x3ffffff;
+	d2 += c;      c = d2 >> 26; out[2] = d2 & 0x3ffffff;
+	d3 += c;      c = d3 >> 26; out[3] = d3 & 0x3ffffff;
+	d4 += c;      c = d4 >> 26; out[4] = d4 & 0x3ffffff;
+	out[0] += c * 5; c = out[0] >> 26; out[0] &= 0x3ffffff;
+	out[1] += c;
+}
+
+/* h = h * r (partial) mod p in every lane, s = 5 * r */
+__attribute__((target("avx2")))
+static inline void
+poly1305_mul_avx2(__m256i h[5], const __m256i r[5], const __m256i s[5]) {
+	const __m256i mask = _mm256_set1_epi64x(0x3ffffff);
+	__m256i d0,d1,d2,d3,d4,c;
+
+#define MULV(a, b) _mm256_mul_epu32((a), (b))
+	d0 = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(MULV(h[0], r[0]), MULV(h[1], s[4])), MULV(h[2], s[3])), MULV(h[3], s[2])), MULV(h[4], s[1]));
+	d1 = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(MULV(h[0], r[1]), MULV(h[1], r[0])), MULV(h[2], s[4])), MULV(h[3], s[3])), MULV(h[4], s[2]));
+	d2 = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(MULV(h[0], r[2]), MULV(h[1], r[1])), MULV(h[2], r[0])), MULV(h[3], s[4])), MULV(h[4], s[3]));
+	d3 = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(MULV(h[0], r[3]), MULV(h[1], r[2])), MULV(h[2], r[1])), MULV(h[3], r[0])), MULV(h[4], s[4]));
+	d4 = _mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(_mm256_add_epi64(MULV(h[0], r[4]), MULV(h[1], r[3])), MULV(h[2], r[2])), MULV(h[3], r[1])), MULV(h[4], r[0]));
+#undef MULV
+
+	/* (partial) h %= p */
+	                              c = _mm256_srli_epi64(d0, 26); h[0] = _mm256_and_si256(d0, mask);
+	d1 = _mm256_add_epi64(d1, c); c = _mm256_srli_epi64(d1, 26); h[1] = _mm256_and_si256(d1, mask);
+	d2 = _mm256_add_epi64(d2, c); c = _mm256_srli_epi64(d2, 26); h[2] = _mm256_and_si256(d2, mask);
+	d3 = _mm256_add_epi64(d3, c); c = _mm256_srli_epi64(d3, 26); h[3] = _mm256_and_si256(d3, mask);
+	d4 = _mm256_add_epi64(d4, c); c = _mm256_srli_epi64(d4, 26); h[4] = _mm256_and_si256(d4, mask);
+	h[0] = _mm256_add_epi64(h[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+	c = _mm256_srli_epi64(h[0], 26); h[0] = _mm256_and_si256(h[0], mask);
+	h[1] = _mm256_add_epi64(h[1], c);
+}
+
+/* h += four blocks, lanes 0 to 3 take blocks 0, 2, 1 and 3 */
+__attribute__((target("avx2")))
+static inline void
+poly1305_add_avx2(__m256i h[5], const unsigned char *m) {
+	const __m256i mask = _mm256_set1_epi64x(0x3ffffff);
+	const __m256i hibit = _mm256_set1_epi64x(1 << 24); /* 1 << 128 */
+	const __m256i a = _mm256_loadu_si256((const __m256i *)(m +  0));
+	const __m256i b = _mm256_loadu_si256((const __m256i *)(m + 32));
+	const __m256i lo = _mm256_unpacklo_epi64(a, b);
+	const __m256i hi = _mm256_unpackhi_epi64(a, b);
+
+	h[0] = _mm256_add_epi64(h[0], _mm256_and_si256(lo, mask));
+	h[1] = _mm256_add_epi64(h[1], _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask));
+	h[2] = _mm256_add_epi64(h[2], _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask));
+	h[3] = _mm256_add_epi64(h[3], _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask));
+	h[4] = _mm256_add_epi64(h[4], _mm256_or_si256(_mm256_srli_epi64(hi, 40), hibit));
+}
+
+/* bytes is a multiple of 64 and at least 64 */
+__attribute__((target("avx2")))
+static void
+poly1305_blocks_avx2(poly1305_state_internal_t *st, const unsigned char *m, size_t bytes) {
+	unsigned long long r[5], r2[5], r3[5], r4[5], h[5], c;
+	unsigned long long h0,h1,h2;
+	unsigned long long lane[4];
+	__m256i H[5], R[5], S[5];
+	int i;
+
+	/* r in 26 bit limbs */
+	r[0] = ( st->r[0]                        ) & 0x3ffffff;
+	r[1] = ((st->r[0] >> 26) | (st->r[1] << 18)) & 0x3ffffff;
+	r[2] = ((st->r[1] >>  8)                 ) & 0x3ffffff;
+	r[3] = ((st->r[1] >> 34) | (st->r[2] << 10)) & 0x3ffffff;
+	r[4] = ((st->r[2] >> 16)                 );
+
+	if (!st->powers) {
+		poly1305_mul26(r2, r, r);
+		poly1305_mul26(r4, r2, r2);
+		for (i = 0; i < 5; i++) {
+			st->r2[i] = (unsigned int)r2[i];
+			st->r4[i] = (unsigned int)r4[i];
+		}
+		st->powers = 1;
+	}
+	for (i = 0; i < 5; i++) {
+		r2[i] = st->r2[i];
+		r4[i] = st->r4[i];
+	}
+	poly1305_mul26(r3, r2, r);
+
+	/* h in 26 bit limbs */
+	h0 = st->h[0];
+	h1 = st->h[1];
+	h2 = st->h[2];
+	c = (h1 >> 44); h1 &= 0xfffffffffff; h2 += c;
+	h[0] = ( h0                    ) & 0x3ffffff;
+	h[1] = ((h0 >> 26) | (h1 << 18)) & 0x3ffffff;
+	h[2] = ((h1 >>  8)             ) & 0x3ffffff;
+	h[3] = ((h1 >> 34) | (h2 << 10)) & 0x3ffffff;
+	h[4] = ((h2 >> 16)             );
+
+	for (i = 0; i < 5; i++) {
+		H[i] = _mm256_set_epi64x(0, 0, 0, (long long)h[i]);
+		R[i] = _mm256_set1_epi64x((long long)r4[i]);
+		S[i] = _mm256_set1_epi64x((long long)(r4[i] * 5));
+	}
+	poly1305_add_avx2(H, m);
+	m += 4 * poly1305_block_size;
+	bytes -= 4 * poly1305_block_size;
+
+	while (bytes >= 4 * poly1305_block_size) {
+		poly1305_mul_avx2(H, R, S);
+		poly1305_add_avx2(H, m);
+		m += 4 * poly1305_block_size;
+		bytes -= 4 * poly1305_block_size;
+	}
+
+	/* the lanes hold blocks 4i, 4i + 2, 4i + 1 and 4i + 3 */
+	for (i = 0; i < 5; i++) {
+		R[i] = _mm256_set_epi64x((long long)r[i], (long long)r3[i], (long long)r2[i], (long long)r4[i]);
+		S[i] = _mm256_set_epi64x((long long)(r[i] * 5), (long long)(r3[i] * 5), (long long)(r2[i] * 5), (long long)(r4[i] * 5));
+	}
+	poly1305_mul_avx2(H, R, S);
+	for (i = 0; i < 5; i++) {
+		_mm256_storeu_si256((__m256i *)lane, H[i]);
+		h[i] = lane[0] + lane[1] + lane[2] + lane[3];
+	}
+
+	/* back to 44 bit limbs */
+	             c = h[0] >> 26; h[0] &= 0x3ffffff;
+	h[1] += c;   c = h[1] >> 26; h[1] &= 0x3ffffff;
+	h[2] += c;   c = h[2] >> 26; h[2] &= 0x3ffffff;
+	h[3] += c;   c = h[3] >> 26; h[3] &= 0x3ffffff;
+	h[4] += c;   c = h[4] >> 26; h[4] &= 0x3ffffff;
+	h[0] += c * 5;
+	h0 = h[0] + (h[1] << 26);                          c = (h0 >> 44); h0 &= 0xfffffffffff;
+	h1 = (h[2] << 8) + (h[3] << 34) + c;               c = (h1 >> 44); h1 &= 0xfffffffffff;
+	h2 = (h[4] << 16) + c;                             c = (h2 >> 42); h2 &= 0x3ffffffffff;
+	h0 += c * 5;                                       c = (h0 >> 44); h0 &= 0xfffffffffff;
+	h1 += c;
+
+	st->h[0] = h0;
+	st->h[1] = h1;
+	st->h[2] = h2;
+}
@@ -1,5 +1,25 @@
 #include "poly1305-donna.h"
+
+/*
+ * 64 bit hosts with a 128 bit product use 44 bit limbs, everything else
+ * 26 bit limbs; define POLY1305_32BIT to force the latter. On x86-64 long
+ * inputs go through an AVX2 kernel when the CPU has it, define
+ * POLY1305_NO_SIMD to skip it and the runtime CPU check.
+ */
+#if !defined(POLY1305_32BIT) && defined(__GNUC__) && defined(__SIZEOF_INT128__) && defined(__LP64__)
+#if !defined(POLY1305_NO_SIMD) && defined(__x86_64__)
+#define POLY1305_AVX2 1
+#endif
+#include "poly1305-donna-64.h"
+#elif !defined(POLY1305_32BIT) && defined(_MSC_VER) && defined(_M_X64)
+#include "poly1305-donna-64.h"
+#else
 #include "poly1305-donna-32.h"
+#endif
+
+#if defined(POLY1305_AVX2)
+#include "poly1305-donna-avx2.h"
+#endif
 
 void
 poly1305_update(poly1305_context *ctx, const unsigned char *m, size_t bytes) {
@@ -25,6 +45,15 @@ poly1305_update(poly1305_context *ctx, const unsigned char *m, size_t bytes) {
 	/* process full blocks */
 	if (bytes >= poly1305_block_size) {
 		size_t want = (bytes & ~(poly1305_block_size - 1));
+#if defined(POLY1305_AVX2)
+		if (want >= poly1305_avx2_min_bytes && poly1305_has_avx2()) {
+			size_t vwant = (want & ~(size_t)(4 * poly1305_block_size - 1));
+			poly1305_blocks_avx2(st, m, vwant);
+			m += vwant;
+			bytes -= vwant;
+			want -= vwant;
+		}
+#endif
 		poly1305_blocks(st, m, want);
 		m += want;
 		bytes -= want;
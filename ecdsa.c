@@ -67,11 +67,11 @@ void point_add(const ecdsa_curve *curve, const curve_point *cp1, curve_point *cp
 	bn_subtractmod(&(cp2->x), &(cp1->x), &inv, &curve->prime);
 	bn_inverse(&inv, &curve->prime);
 	bn_subtractmod(&(cp2->y), &(cp1->y), &lambda, &curve->prime);
-	bn_multiply(&inv, &lambda, &curve->prime);
+	curve->multiply(&inv, &lambda, &curve->prime);
 
 	// xr = lambda^2 - x1 - x2
 	xr = lambda;
-	bn_multiply(&xr, &xr, &curve->prime);
+	curve->multiply(&xr, &xr, &curve->prime);
 	yr = cp1->x;
 	bn_addmod(&yr, &(cp2->x), &curve->prime);
 	bn_subtractmod(&xr, &yr, &xr, &curve->prime);
@@ -80,7 +80,7 @@ void point_add(const ecdsa_curve *curve, const curve_point *cp1, curve_point *cp
 
 	// yr = lambda (x1 - xr) - y1
 	bn_subtractmod(&(cp1->x), &xr, &yr, &curve->prime);
-	bn_multiply(&lambda, &yr, &curve->prime);
+	curve->multiply(&lambda, &yr, &curve->prime);
 	bn_subtractmod(&yr, &(cp1->y), &yr, &curve->prime);
 	bn_fast_mod(&yr, &curve->prime);
 	bn_mod(&yr, &curve->prime);
@@ -108,14 +108,14 @@ void point_double(const ecdsa_curve *curve, curve_point *cp)
 	bn_inverse(&lambda, &curve->prime);
 
 	xr = cp->x;
-	bn_multiply(&xr, &xr, &curve->prime);
+	curve->multiply(&xr, &xr, &curve->prime);
 	bn_mult_k(&xr, 3, &curve->prime);
 	bn_subi(&xr, -curve->a, &curve->prime);
-	bn_multiply(&xr, &lambda, &curve->prime);
+	curve->multiply(&xr, &lambda, &curve->prime);
 
 	// xr = lambda^2 - 2*x
 	xr = lambda;
-	bn_multiply(&xr, &xr, &curve->prime);
+	curve->multiply(&xr, &xr, &curve->prime);
 	yr = cp->x;
 	bn_lshift(&yr);
 	bn_subtractmod(&xr, &yr, &xr, &curve->prime);
@@ -124,7 +124,7 @@ void point_double(const ecdsa_curve *curve, curve_point *cp)
 
 	// yr = lambda (x - xr) - y
 	bn_subtractmod(&(cp->x), &xr, &yr, &curve->prime);
-	bn_multiply(&lambda, &yr, &curve->prime);
+	curve->multiply(&lambda, &yr, &curve->prime);
 	bn_subtractmod(&yr, &(cp->y), &yr, &curve->prime);
 	bn_fast_mod(&yr, &curve->prime);
 	bn_mod(&yr, &curve->prime);
@@ -203,33 +203,37 @@ static void generate_k_random(bignum256 *k, const bignum256 *prime) {
 	} while (bn_is_zero(k) || !bn_is_less(k, prime));
 }
 
-void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp, const bignum256 *prime) {
+void curve_to_jacobian(const curve_point *p, jacobian_curve_point *jp, const ecdsa_curve *curve) {
+	const bignum256 *prime = &curve->prime;
+
 	// randomize z coordinate
 	generate_k_random(&jp->z, prime);
 
 	jp->x = jp->z;
-	bn_multiply(&jp->z, &jp->x, prime);
+	curve->multiply(&jp->z, &jp->x, prime);
 	// x = z^2
 	jp->y = jp->x;
-	bn_multiply(&jp->z, &jp->y, prime);
+	curve->multiply(&jp->z, &jp->y, prime);
 	// y = z^3
 
-	bn_multiply(&p->x, &jp->x, prime);
-	bn_multiply(&p->y, &jp->y, prime);
+	curve->multiply(&p->x, &jp->x, prime);
+	curve->multiply(&p->y, &jp->y, prime);
 }
 
-void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p, const bignum256 *prime) {
+void jacobian_to_curve(const jacobian_curve_point *jp, curve_point *p, const ecdsa_curve *curve) {
+	const bignum256 *prime = &curve->prime;
+
 	p->y = jp->z;
 	bn_inverse(&p->y, prime);
 	// p->y = z^-1
 	p->x = p->y;
-	bn_multiply(&p->x, &p->x, prime);
+	curve->multiply(&p->x, &p->x, prime);
 	// p->x = z^-2
-	bn_multiply(&p->x, &p->y, prime);
+	curve->multiply(&p->x, &p->y, prime);
 	// p->y = z^-3
-	bn_multiply(&jp->x, &p->x, prime);
+	curve->multiply(&jp->x, &p->x, prime);
 	// p->x = jp->x * z^-2
-	bn_multiply(&jp->y, &p->y, prime);
+	curve->multiply(&jp->y, &p->y, prime);
 	// p->y = jp->y * z^-3
 	bn_mod(&p->x, prime);
 	bn_mod(&p->y, prime);
@@ -278,17 +282,17 @@ void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const e
 	 */
 
 	xz = p2->z;
-	bn_multiply(&xz, &xz, prime); // xz = z2^2
+	curve->multiply(&xz, &xz, prime); // xz = z2^2
 	yz = p2->z;
-	bn_multiply(&xz, &yz, prime); // yz = z2^3
+	curve->multiply(&xz, &yz, prime); // yz = z2^3
 	
 	if (a != 0) {
 		az  = xz;
-		bn_multiply(&az, &az, prime);   // az = z2^4
+		curve->multiply(&az, &az, prime);   // az = z2^4
 		bn_mult_k(&az, -a, prime);      // az = -az2^4
 	}
 	
-	bn_multiply(&p1->x, &xz, prime);        // xz = x1' = x1*z2^2;
+	curve->multiply(&p1->x, &xz, prime);        // xz = x1' = x1*z2^2;
 	h = xz;
 	bn_subtractmod(&h, &p2->x, &h, prime);
 	bn_fast_mod(&h, prime);
@@ -303,7 +307,7 @@ void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const e
 	// bn_fast_mod.
 	is_doubling = bn_is_equal(&h, prime);
 
-	bn_multiply(&p1->y, &yz, prime);        // yz = y1' = y1*z2^3;
+	curve->multiply(&p1->y, &yz, prime);        // yz = y1' = y1*z2^3;
 	bn_subtractmod(&yz, &p2->y, &r, prime);
 	// r = y1' - y2;
 
@@ -311,7 +315,7 @@ void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const e
 	// yz = y1' + y2
 
 	r2 = p2->x;
-	bn_multiply(&r2, &r2, prime);
+	curve->multiply(&r2, &r2, prime);
 	bn_mult_k(&r2, 3, prime);
 	
 	if (a != 0) {
@@ -324,31 +328,31 @@ void point_jacobian_add(const curve_point *p1, jacobian_curve_point *p2, const e
 
 	// hsqx = h^2
 	hsqx = h;
-	bn_multiply(&hsqx, &hsqx, prime);
+	curve->multiply(&hsqx, &hsqx, prime);
 
 	// hcby = h^3
 	hcby = h;
-	bn_multiply(&hsqx, &hcby, prime);
+	curve->multiply(&hsqx, &hcby, prime);
 
 	// hsqx = h^2 * (x1 + x2)
-	bn_multiply(&xz, &hsqx, prime);
+	curve->multiply(&xz, &hsqx, prime);
 
 	// hcby = h^3 * (y1 + y2)
-	bn_multiply(&yz, &hcby, prime);
+	curve->multiply(&yz, &hcby, prime);
 
 	// z3 = h*z2
-	bn_multiply(&h, &p2->z, prime);
+	curve->multiply(&h, &p2->z, prime);
 
 	// x3 = r^2 - h^2 (x1 + x2)
 	p2->x = r;
-	bn_multiply(&p2->x, &p2->x, prime);
+	curve->multiply(&p2->x, &p2->x, prime);
 	bn_subtractmod(&p2->x, &hsqx, &p2->x, prime);
 	bn_fast_mod(&p2->x, prime);
 
 	// y3 = 1/2 (r*(h^2 (x1 + x2) - 2x3) - h^3 (y1 + y2))
 	bn_subtractmod(&hsqx, &p2->x, &p2->y, prime);
 	bn_subtractmod(&p2->y, &p2->x, &p2->y, prime);
-	bn_multiply(&r, &p2->y, prime);
+	curve->multiply(&r, &p2->y, prime);
 	bn_subtractmod(&p2->y, &hcby, &p2->y, prime);
 	bn_mult_half(&p2->y, prime);
 	bn_fast_mod(&p2->y, prime);
@@ -384,28 +388,28 @@ void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
 	 */
 
 	m = p->x;
-	bn_multiply(&m, &m, prime);
+	curve->multiply(&m, &m, prime);
 	bn_mult_k(&m, 3, prime);
 
 	az4 = p->z;
-	bn_multiply(&az4, &az4, prime);
-	bn_multiply(&az4, &az4, prime);
+	curve->multiply(&az4, &az4, prime);
+	curve->multiply(&az4, &az4, prime);
 	bn_mult_k(&az4, -curve->a, prime);
 	bn_subtractmod(&m, &az4, &m, prime);
 	bn_mult_half(&m, prime);
 
 	// msq = m^2
 	msq = m;
-	bn_multiply(&msq, &msq, prime);
+	curve->multiply(&msq, &msq, prime);
 	// ysq = y^2
 	ysq = p->y;
-	bn_multiply(&ysq, &ysq, prime);
+	curve->multiply(&ysq, &ysq, prime);
 	// xysq = xy^2
 	xysq = p->x;
-	bn_multiply(&ysq, &xysq, prime);
+	curve->multiply(&ysq, &xysq, prime);
 
 	// z3 = yz
-	bn_multiply(&p->y, &p->z, prime);
+	curve->multiply(&p->y, &p->z, prime);
 
 	// x3 = m^2 - 2*xy^2
 	p->x = xysq;
@@ -416,12 +420,198 @@ void point_jacobian_double(jacobian_curve_point *p, const ecdsa_curve *curve) {
 
 	// y3 = m*(xy^2 - x3) - y^4
 	bn_subtractmod(&xysq, &p->x, &p->y, prime);
-	bn_multiply(&m, &p->y, prime);
-	bn_multiply(&ysq, &ysq, prime);
+	curve->multiply(&m, &p->y, prime);
+	curve->multiply(&ysq, &ysq, prime);
 	bn_subtractmod(&p->y, &ysq, &p->y, prime);
 	bn_fast_mod(&p->y, prime);
 }
 
+// Normalize count Jacobian points at once, sharing a single inversion
+// between all of them (Montgomery's trick).  None of the points may be
+// the point at infinity.  p[i].x is used as scratch space for the
+// partial products before it receives its final value.
+static void jacobian_to_curve_batch(const jacobian_curve_point *jp, curve_point *p, size_t count, const ecdsa_curve *curve)
+{
+	const bignum256 *prime = &curve->prime;
+	size_t i;
+	bignum256 inv, zinv, zinv2;
+
+	if (count == 0) {
+		return;
+	}
+	// p[i].x = z_0 * ... * z_i
+	p[0].x = jp[0].z;
+	for (i = 1; i < count; i++) {
+		p[i].x = jp[i].z;
+		curve->multiply(&p[i - 1].x, &p[i].x, prime);
+	}
+	inv = p[count - 1].x;
+	bn_inverse(&inv, prime);
+	for (i = count; i > 0; i--) {
+		// invariant: inv = (z_0 * ... * z_{i-1})^-1
+		if (i > 1) {
+			zinv = p[i - 2].x;
+			curve->multiply(&inv, &zinv, prime);      // zinv = z_{i-1}^-1
+			curve->multiply(&jp[i - 1].z, &inv, prime);
+		} else {
+			zinv = inv;
+		}
+		zinv2 = zinv;
+		curve->multiply(&zinv2, &zinv2, prime);      // zinv2 = z^-2
+		curve->multiply(&zinv2, &zinv, prime);       // zinv = z^-3
+		p[i - 1].x = jp[i - 1].x;
+		curve->multiply(&zinv2, &p[i - 1].x, prime);
+		p[i - 1].y = jp[i - 1].y;
+		curve->multiply(&zinv, &p[i - 1].y, prime);
+		bn_mod(&p[i - 1].x, prime);
+		bn_mod(&p[i - 1].y, prime);
+	}
+}
+
+// return true iff jp represents the point at infinity (z == 0 mod prime)
+static int point_jacobian_is_infinity(const jacobian_curve_point *jp, const bignum256 *prime)
+{
+	bignum256 z = jp->z;
+	bn_mod(&z, prime);
+	return bn_is_zero(&z);
+}
+
+// res = res + digit * P, where table[j] = (2j+1) * P and digit is odd with
+// |digit| < 16.  Unlike point_jacobian_add this also handles the case where
+// res is the point at infinity.  Not constant time; use for public data only.
+static void point_jacobian_add_digit(const curve_point table[8], int digit, jacobian_curve_point *res, const ecdsa_curve *curve)
+{
+	curve_point p = table[(digit < 0 ? -digit : digit) >> 1];
+
+	if (digit < 0) {
+		bn_subtract(&curve->prime, &p.y, &p.y);
+	}
+	if (point_jacobian_is_infinity(res, &curve->prime)) {
+		res->x = p.x;
+		res->y = p.y;
+		bn_one(&res->z);
+		return;
+	}
+	point_jacobian_add(&p, res, curve);
+}
+
+// Compute table[i][j] = (2j+1) * table[i][0] for 0 <= i < count and
+// 0 < j < 8 with only two inversions for the whole batch.
+// table[i][0] must be valid points other than the point at infinity.
+// twice (count entries) and jp (8 * count entries) are scratch space.
+static void point_odd_multiples_batch(const ecdsa_curve *curve, curve_point (*table)[8], size_t count, curve_point *twice, jacobian_curve_point *jp)
+{
+	size_t i, j;
+
+	// twice[i] = 2 * table[i][0]
+	for (i = 0; i < count; i++) {
+		jp[i].x = table[i][0].x;
+		jp[i].y = table[i][0].y;
+		bn_one(&jp[i].z);
+		point_jacobian_double(&jp[i], curve);
+	}
+	jacobian_to_curve_batch(jp, twice, count, curve);
+
+	// jp[8i+j] = (2j+1) * table[i][0]
+	for (i = 0; i < count; i++) {
+		jp[8 * i].x = table[i][0].x;
+		jp[8 * i].y = table[i][0].y;
+		bn_one(&jp[8 * i].z);
+		for (j = 1; j < 8; j++) {
+			jp[8 * i + j] = jp[8 * i + j - 1];
+			point_jacobian_add(&twice[i], &jp[8 * i + j], curve);
+		}
+	}
+	jacobian_to_curve_batch(jp, &table[0][0], 8 * count, curve);
+}
+
+// Compute the width 5 NAF of k, i.e. k = sum_i naf[i] * 2^i where every
+// non-zero digit is odd, -16 < naf[i] < 16 and any two non-zero digits
+// are at least 5 positions apart.  k must be normalized and smaller than
+// 2^256.  Returns the number of digits.  Not constant time; use for public
+// scalars only.
+static int scalar_wnaf5(const bignum256 *k, int8_t naf[257])
+{
+	bignum256 a = *k;
+	int len = 0;
+
+	while (!bn_is_zero(&a)) {
+		int digit = 0;
+		if (a.val[0] & 1) {
+			digit = a.val[0] & 31;
+			if (digit >= 16) {
+				// a += 32 - digit, this clears the lowest 5 bits
+				digit -= 32;
+				a.val[0] -= digit;
+				bn_normalize(&a);
+			} else {
+				a.val[0] -= digit;
+			}
+		}
+		naf[len++] = digit;
+		bn_rshift(&a);
+	}
+	return len;
+}
+
+// res = k1 * G + k2 * P, where gtable[j] = (2j+1) * G and
+// ptable[j] = (2j+1) * P.  Both scalars are recoded in width 5 NAF and
+// share the same doubling chain (Straus' trick); the result is left in
+// Jacobian coordinates.  Not constant time; use for public data only.
+static void point_multiply_double(const ecdsa_curve *curve, const bignum256 *k1, const curve_point gtable[8], const bignum256 *k2, const curve_point ptable[8], jacobian_curve_point *res)
+{
+	int i, len1, len2;
+	int8_t d1[257], d2[257];
+
+	len1 = scalar_wnaf5(k1, d1);
+	len2 = scalar_wnaf5(k2, d2);
+
+	bn_zero(&res->x);
+	bn_zero(&res->y);
+	bn_zero(&res->z);
+	for (i = (len1 > len2 ? len1 : len2) - 1; i >= 0; i--) {
+		point_jacobian_double(res, curve);
+		if (i < len1 && d1[i] != 0) {
+			point_jacobian_add_digit(gtable, d1[i], res, curve);
+		}
+		if (i < len2 && d2[i] != 0) {
+			point_jacobian_add_digit(ptable, d2[i], res, curve);
+		}
+	}
+}
+
+// return true iff the affine x coordinate of jp reduced modulo the group
+// order equals r.  Compares x * z^-2 with r without computing an inverse.
+static int point_jacobian_x_is_r(const jacobian_curve_point *jp, const bignum256 *r, const ecdsa_curve *curve)
+{
+	const bignum256 *prime = &curve->prime;
+	bignum256 zz, x, t;
+
+	if (point_jacobian_is_infinity(jp, prime)) {
+		return 0;
+	}
+	zz = jp->z;
+	curve->multiply(&zz, &zz, prime);
+	x = jp->x;
+	bn_mod(&x, prime);
+
+	t = *r;
+	curve->multiply(&zz, &t, prime);
+	bn_mod(&t, prime);
+	if (bn_is_equal(&t, &x)) {
+		return 1;
+	}
+	// x could also be r + order if that is still smaller than prime
+	t = *r;
+	bn_add(&t, &curve->order);
+	if (!bn_is_less(&t, prime)) {
+		return 0;
+	}
+	curve->multiply(&zz, &t, prime);
+	bn_mod(&t, prime);
+	return bn_is_equal(&t, &x);
+}
+
 // res = k * p
 void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res)
 {
@@ -432,13 +622,13 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
 	assert (bn_is_less(k, &curve->order));
 
 	int i, j;
-	static CONFIDENTIAL bignum256 a;
+	STATIC_CONFIDENTIAL bignum256 a;
 	uint32_t *aptr;
 	uint32_t abits;
 	int ashift;
 	uint32_t is_even = (k->val[0] & 1) - 1;
 	uint32_t bits, sign, nsign;
-	static CONFIDENTIAL jacobian_curve_point jres;
+	STATIC_CONFIDENTIAL jacobian_curve_point jres;
 	curve_point pmult[8];
 	const bignum256 *prime = &curve->prime;
 
@@ -502,7 +692,7 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
 	sign = (bits >> 4) - 1;
 	bits ^= sign;
 	bits &= 15;
-	curve_to_jacobian(&pmult[bits>>1], &jres, prime);
+	curve_to_jacobian(&pmult[bits>>1], &jres, curve);
 	for (i = 62; i >= 0; i--) {
 		// sign = sign(a[i+1])  (0xffffffff for negative, 0 for positive)
 		// invariant jres = (-1)^sign sum_{j=i+1..63} (a[j] * 16^{j-i-1} * p)
@@ -539,7 +729,7 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
 		sign = nsign;
 	}
 	conditional_negate(sign, &jres.z, prime);
-	jacobian_to_curve(&jres, res, prime);
+	jacobian_to_curve(&jres, res, curve);
 	memzero(&a, sizeof(a));
 	memzero(&jres, sizeof(jres));
 }
@@ -548,15 +738,16 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
 
 // res = k * G
 // k must be a normalized number with 0 <= k < curve->order
-void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res)
+// jres = k * G in Jacobian coordinates.
+// returns 0 (and leaves jres untouched) if k is zero.
+static int scalar_multiply_jacobian(const ecdsa_curve *curve, const bignum256 *k, jacobian_curve_point *jres)
 {
 	assert (bn_is_less(k, &curve->order));
 
 	int i, j;
-	static CONFIDENTIAL bignum256 a;
+	STATIC_CONFIDENTIAL bignum256 a;
 	uint32_t is_even = (k->val[0] & 1) - 1;
 	uint32_t lowbits;
-	static CONFIDENTIAL jacobian_curve_point jres;
 	const bignum256 *prime = &curve->prime;
 
 	// is_even = 0xffffffff if k is even, 0 otherwise.
@@ -577,8 +768,7 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 
 	// special case 0*G:  just return zero. We don't care about constant time.
 	if (!is_non_zero) {
-		point_set_infinity(res);
-		return;
+		return 0;
 	}
 
 	// Now a = k + 2^256 (mod curve->order) and a is odd.
@@ -604,7 +794,7 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 	lowbits = a.val[0] & ((1 << 5) - 1);
 	lowbits ^= (lowbits >> 4) - 1;
 	lowbits &= 15;
-	curve_to_jacobian(&curve->cp[0][lowbits >> 1], &jres, prime);
+	curve_to_jacobian(&curve->cp[0][lowbits >> 1], jres, curve);
 	for (i = 1; i < 64; i ++) {
 		// invariant res = sign(a[i-1]) sum_{j=0..i-1} (a[j] * 16^j * G)
 
@@ -621,14 +811,25 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 		lowbits &= 15;
 		// negate last result to make signs of this round and the
 		// last round equal.
-		conditional_negate((lowbits & 1) - 1, &jres.y, prime);
+		conditional_negate((lowbits & 1) - 1, &jres->y, prime);
 
 		// add odd factor
-		point_jacobian_add(&curve->cp[i][lowbits >> 1], &jres, curve);
+		point_jacobian_add(&curve->cp[i][lowbits >> 1], jres, curve);
 	}
-	conditional_negate(((a.val[0] >> 4) & 1) - 1, &jres.y, prime);
-	jacobian_to_curve(&jres, res, prime);
+	conditional_negate(((a.val[0] >> 4) & 1) - 1, &jres->y, prime);
 	memzero(&a, sizeof(a));
+	return 1;
+}
+
+void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *res)
+{
+	STATIC_CONFIDENTIAL jacobian_curve_point jres;
+
+	if (!scalar_multiply_jacobian(curve, k, &jres)) {
+		point_set_infinity(res);
+		return;
+	}
+	jacobian_to_curve(&jres, res, curve);
 	memzero(&jres, sizeof(jres));
 }
 
@@ -641,6 +842,51 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 
 #endif
 
+// res[i] = k[i] * G + p for 0 <= i < count.
+// p must not be the point at infinity.  The results are computed in
+// Jacobian coordinates and every ECDSA_MULTIPLY_BATCH_SIZE of them share
+// a single inversion for the conversion back to affine coordinates.
+void scalar_multiply_add_batch(const ecdsa_curve *curve, const bignum256 *k, const curve_point *p, curve_point *res, size_t count)
+{
+#if USE_PRECOMPUTED_CP
+	jacobian_curve_point jp[ECDSA_MULTIPLY_BATCH_SIZE];
+	uint8_t infinity[ECDSA_MULTIPLY_BATCH_SIZE];
+	size_t i, j, n;
+
+	for (i = 0; i < count; i += n) {
+		n = count - i < ECDSA_MULTIPLY_BATCH_SIZE ? count - i : ECDSA_MULTIPLY_BATCH_SIZE;
+		for (j = 0; j < n; j++) {
+			if (scalar_multiply_jacobian(curve, &k[i + j], &jp[j])) {
+				point_jacobian_add(p, &jp[j], curve);
+			} else {
+				jp[j].x = p->x;
+				jp[j].y = p->y;
+				bn_one(&jp[j].z);
+			}
+			// k[i + j] * G = -p, give it a valid z for the batch inversion
+			infinity[j] = point_jacobian_is_infinity(&jp[j], &curve->prime);
+			if (infinity[j]) {
+				bn_one(&jp[j].z);
+			}
+		}
+		jacobian_to_curve_batch(jp, res + i, n, curve);
+		for (j = 0; j < n; j++) {
+			if (infinity[j]) {
+				point_set_infinity(&res[i + j]);
+			}
+		}
+	}
+	memzero(jp, sizeof(jp));
+#else
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		scalar_multiply(curve, &k[i], &res[i]);
+		point_add(curve, p, &res[i]);
+	}
+#endif
+}
+
 int ecdh_multiply(const ecdsa_curve *curve, const uint8_t *priv_key, const uint8_t *pub_key, uint8_t *session_key)
 {
 	curve_point point;
@@ -941,9 +1187,9 @@ void uncompress_coords(const ecdsa_curve *curve, uint8_t odd, const bignum256 *x
 {
 	// y^2 = x^3 + a*x + b
 	memcpy(y, x, sizeof(bignum256));         // y is x
-	bn_multiply(x, y, &curve->prime);        // y is x^2
+	curve->multiply(x, y, &curve->prime);        // y is x^2
 	bn_subi(y, -curve->a, &curve->prime);    // y is x^2 + a
-	bn_multiply(x, y, &curve->prime);        // y is x^3 + ax
+	curve->multiply(x, y, &curve->prime);        // y is x^3 + ax
 	bn_add(y, &curve->b);                    // y is x^3 + ax + b
 	bn_sqrt(y, &curve->prime);               // y = sqrt(y)
 	if ((odd & 0x01) != (y->val[0] & 1)) {
@@ -991,13 +1237,13 @@ int ecdsa_validate_pubkey(const ecdsa_curve *curve, const curve_point *pub)
 	memcpy(&x3_ax_b, &(pub->x), sizeof(bignum256));
 
 	// y^2
-	bn_multiply(&(pub->y), &y_2, &curve->prime);
+	curve->multiply(&(pub->y), &y_2, &curve->prime);
 	bn_mod(&y_2, &curve->prime);
 
 	// x^3 + ax + b
-	bn_multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^2
+	curve->multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^2
 	bn_subi(&x3_ax_b, -curve->a, &curve->prime);      // x^2 + a
-	bn_multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^3 + ax
+	curve->multiply(&(pub->x), &x3_ax_b, &curve->prime);  // x^3 + ax
 	bn_addmod(&x3_ax_b, &curve->b, &curve->prime);    // x^3 + ax + b
 	bn_mod(&x3_ax_b, &curve->prime);
 
@@ -1074,9 +1320,57 @@ int ecdsa_recover_pub_from_sig (const ecdsa_curve *curve, uint8_t *pub_key, cons
 }
 
 // returns 0 if verification succeeded
+#if USE_ECDSA_VERIFY_WNAF
+// return true iff z * G + s * pub has the x coordinate r (mod order)
+static int ecdsa_verify_point(const ecdsa_curve *curve, const curve_point *pub, const bignum256 *z, const bignum256 *s, const bignum256 *r)
+{
+#if USE_PRECOMPUTED_CP
+	// pmult[0][j] = (2j+1) * pub, curve->cp[0][j] = (2j+1) * G
+	curve_point pmult[1][8], twice[1];
+	jacobian_curve_point jp[8], res;
+	const curve_point *gtable = curve->cp[0];
+#else
+	// pmult[0][j] = (2j+1) * pub, pmult[1][j] = (2j+1) * G
+	curve_point pmult[2][8], twice[2];
+	jacobian_curve_point jp[2 * 8], res;
+	const curve_point *gtable = pmult[1];
+	pmult[1][0] = curve->G;
+#endif
+	int ok;
+
+	pmult[0][0] = *pub;
+	point_odd_multiples_batch(curve, pmult, sizeof(pmult) / sizeof(*pmult), twice, jp);
+	// res = z * G + s * pub, computed in Jacobian coordinates
+	point_multiply_double(curve, z, gtable, s, pmult[0], &res);
+	ok = point_jacobian_x_is_r(&res, r, curve);
+
+	memzero(pmult, sizeof(pmult));
+	memzero(&res, sizeof(res));
+	return ok;
+}
+#else
+// return true iff z * G + s * pub has the x coordinate r (mod order)
+static int ecdsa_verify_point(const ecdsa_curve *curve, const curve_point *pub, const bignum256 *z, const bignum256 *s, const bignum256 *r)
+{
+	curve_point p, res;
+	int ok;
+
+	scalar_multiply(curve, z, &res);
+	// both p and res can be infinity, can have y = 0 OR can be equal -> false negative
+	point_multiply(curve, s, pub, &p);
+	point_add(curve, &p, &res);
+	bn_mod(&(res.x), &curve->order);
+	ok = bn_is_equal(&res.x, r);
+
+	memzero(&p, sizeof(p));
+	memzero(&res, sizeof(res));
+	return ok;
+}
+#endif
+
 int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key, const uint8_t *sig, const uint8_t *digest)
 {
-	curve_point pub, res;
+	curve_point pub;
 	bignum256 r, s, z;
 
 	if (!ecdsa_read_pubkey(curve, pub_key, &pub)) {
@@ -1103,23 +1397,16 @@ int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key, const
 		// our message hashes to zero
 		// I don't expect this to happen any time soon
 		result = 3;
-	} else {
-		scalar_multiply(curve, &z, &res);
 	}
 
 	if (result == 0) {
-		// both pub and res can be infinity, can have y = 0 OR can be equal -> false negative
-		point_multiply(curve, &s, &pub, &pub);
-		point_add(curve, &pub, &res);
-		bn_mod(&(res.x), &curve->order);
 		// signature does not match
-		if (!bn_is_equal(&res.x, &r)) {
+		if (!ecdsa_verify_point(curve, &pub, &z, &s, &r)) {
 			result = 5;
 		}
 	}
 
 	memzero(&pub, sizeof(pub));
-	memzero(&res, sizeof(res));
 	memzero(&r, sizeof(r));
 	memzero(&s, sizeof(s));
 	memzero(&z, sizeof(z));
@@ -1128,6 +1415,109 @@ int ecdsa_verify_digest(const ecdsa_curve *curve, const uint8_t *pub_key, const
 	return result;
 }
 
+// verify up to ECDSA_VERIFY_BATCH_SIZE signatures, see ecdsa_verify_digest_batch
+static int ecdsa_verify_digest_chunk(const ecdsa_curve *curve, size_t count, const uint8_t *const *pub_keys, const uint8_t *const *sigs, const uint8_t *const *digests, int *results)
+{
+	curve_point pmult[ECDSA_VERIFY_BATCH_SIZE + 1][8];
+	curve_point twice[ECDSA_VERIFY_BATCH_SIZE + 1];
+	jacobian_curve_point jp[(ECDSA_VERIFY_BATCH_SIZE + 1) * 8];
+	bignum256 r[ECDSA_VERIFY_BATCH_SIZE], u1[ECDSA_VERIFY_BATCH_SIZE], u2[ECDSA_VERIFY_BATCH_SIZE];
+	bignum256 tmp[ECDSA_VERIFY_BATCH_SIZE];
+	size_t idx[ECDSA_VERIFY_BATCH_SIZE];
+	int res[ECDSA_VERIFY_BATCH_SIZE];
+	const curve_point *gtable;
+	jacobian_curve_point jres;
+	size_t i, j, valid = 0, bases;
+	int failed = 0;
+
+	for (i = 0; i < count; i++) {
+		res[i] = 0;
+		if (!ecdsa_read_pubkey(curve, pub_keys[i], &pmult[valid][0])) {
+			res[i] = 1;
+			continue;
+		}
+		bn_read_be(sigs[i], &r[valid]);
+		bn_read_be(sigs[i] + 32, &u2[valid]);
+		bn_read_be(digests[i], &u1[valid]);
+		if (bn_is_zero(&r[valid]) || bn_is_zero(&u2[valid]) ||
+			(!bn_is_less(&r[valid], &curve->order)) ||
+			(!bn_is_less(&u2[valid], &curve->order))) {
+			res[i] = 2;
+			continue;
+		}
+		idx[valid++] = i;
+	}
+
+	// u2 = s^-1 for all signatures at the cost of a single inversion
+	bn_inverse_batch(u2, tmp, valid, &curve->order);
+	for (j = 0; j < valid; j++) {
+		bn_multiply(&u2[j], &u1[j], &curve->order); // z*s^-1
+		bn_mod(&u1[j], &curve->order);
+		bn_multiply(&r[j], &u2[j], &curve->order);  // r*s^-1
+		bn_mod(&u2[j], &curve->order);
+		if (bn_is_zero(&u1[j])) {
+			// our message hashes to zero
+			res[idx[j]] = 3;
+		}
+	}
+
+	bases = valid;
+#if USE_PRECOMPUTED_CP
+	// curve->cp[0][j] = (2j+1) * G
+	gtable = curve->cp[0];
+#else
+	pmult[bases++][0] = curve->G;
+	gtable = pmult[valid];
+#endif
+	point_odd_multiples_batch(curve, pmult, bases, twice, jp);
+
+	for (j = 0; j < valid; j++) {
+		if (res[idx[j]] != 0) {
+			continue;
+		}
+		point_multiply_double(curve, &u1[j], gtable, &u2[j], pmult[j], &jres);
+		// signature does not match
+		if (!point_jacobian_x_is_r(&jres, &r[j], curve)) {
+			res[idx[j]] = 5;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		if (res[i] != 0) {
+			failed++;
+		}
+		if (results) {
+			results[i] = res[i];
+		}
+	}
+
+	memzero(r, sizeof(r));
+	memzero(u1, sizeof(u1));
+	memzero(u2, sizeof(u2));
+	memzero(tmp, sizeof(tmp));
+	memzero(&jres, sizeof(jres));
+
+	return failed;
+}
+
+// verify count signatures at once
+// pub_keys, sigs and digests are arrays of count pointers to the
+// respective 33 or 65 byte public key, 64 byte signature and 32 byte digest
+// results (optional) receives the ecdsa_verify_digest error code of every
+// single signature, i.e. 0 for a valid signature.
+// returns the number of invalid signatures, i.e. 0 if all of them verified
+int ecdsa_verify_digest_batch(const ecdsa_curve *curve, size_t count, const uint8_t *const *pub_keys, const uint8_t *const *sigs, const uint8_t *const *digests, int *results)
+{
+	size_t i, n;
+	int failed = 0;
+
+	for (i = 0; i < count; i += n) {
+		n = count - i < ECDSA_VERIFY_BATCH_SIZE ? count - i : ECDSA_VERIFY_BATCH_SIZE;
+		failed += ecdsa_verify_digest_chunk(curve, n, pub_keys + i, sigs + i, digests + i, results ? results + i : NULL);
+	}
+	return failed;
+}
+
 int ecdsa_sig_to_der(const uint8_t *sig, uint8_t *der)
 {
 	int i;
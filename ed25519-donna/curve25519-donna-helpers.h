@@ -20,3 +20,21 @@ void curve25519_recip(bignum25519 out, const bignum25519 z);
  * z^((p-5)/8) = z^(2^252 - 3)
  */
 void curve25519_pow_two252m3(bignum25519 two252m3, const bignum25519 z);
+
+/* set d */
+void curve25519_set_d(bignum25519 r);
+
+/* set 2d */
+void curve25519_set_2d(bignum25519 r);
+
+/* set sqrt(-1) */
+void curve25519_set_sqrtneg1(bignum25519 r);
+
+/* constant time Zmod(2^255-19) negative test */
+int curve25519_isnegative(const bignum25519 f);
+
+/* constant time Zmod(2^255-19) non-zero test */
+int curve25519_isnonzero(const bignum25519 f);
+
+/* u^(m+1)v^(-(m+1)), m = (p-5)/8 */
+void curve25519_divpowm1(bignum25519 r, const bignum25519 u, const bignum25519 v);
@@ -0,0 +1,33 @@
+/*
+	Public domain by Andrew M. <liquidsun@gmail.com>
+*/
+
+#ifndef ED25519_DONNA_BATCHVERIFY_H
+#define ED25519_DONNA_BATCHVERIFY_H
+
+#include "options.h"
+#include "ed25519-donna.h"
+
+#define max_batch_size ED25519_VERIFY_BATCH_SIZE
+#define heap_batch_size ((max_batch_size * 2) + 1)
+
+typedef size_t heap_index_t;
+
+typedef struct batch_heap_t {
+	unsigned char r[heap_batch_size][16]; /* 128 bit random values */
+	ge25519 points[heap_batch_size];
+	bignum256modm scalars[heap_batch_size];
+	heap_index_t heap[heap_batch_size];
+	size_t size;
+} batch_heap;
+
+/*
+	computes [scalars[0]]points[0] + ... + [scalars[count-1]]points[count-1]
+	with the Bos-Coster algorithm, vartime. points and scalars are destroyed.
+
+	the upper half of the scalars (count / 2 + 1 .. count - 1) is expected to be
+	at most 128 bits long, they only enter the heap once the big ones got as small.
+*/
+void ge25519_multi_scalarmult_vartime(ge25519 *r, batch_heap *heap, size_t count);
+
+#endif
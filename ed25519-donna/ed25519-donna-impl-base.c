@@ -2,6 +2,21 @@
 #include "ed25519-donna.h"
 
 /* sqrt(x) is such an integer y that 0 <= y <= p - 1, y % 2 = 0, and y^2 = x (mod p). */
+#if defined(ED25519_64BIT)
+/* d = -121665 / 121666 */
+#if !defined(NDEBUG)
+static const bignum25519 ALIGN(16) fe_d = {0x00034dca135978a3,0x0001a8283b156ebd,0x0005e7a26001c029,0x000739c663a03cbb,0x00052036cee2b6ff}; /* d */
+#endif
+static const bignum25519 ALIGN(16) fe_sqrtm1 = {0x00061b274a0ea0b0,0x0000d5a5fc8f189d,0x0007ef5e9cbd0c60,0x00078595a6804c9e,0x0002b8324804fc1d}; /* sqrt(-1) */
+
+/* A = 2 * (1 - d) / (1 + d) = 486662 */
+static const bignum25519 ALIGN(16) fe_ma2 = {0x0007ffc8db3de3c9,0x0007ffffffffffff,0x0007ffffffffffff,0x0007ffffffffffff,0x0007ffffffffffff}; /* -A^2 */
+static const bignum25519 ALIGN(16) fe_ma = {0x0007fffffff892e7,0x0007ffffffffffff,0x0007ffffffffffff,0x0007ffffffffffff,0x0007ffffffffffff}; /* -A */
+static const bignum25519 ALIGN(16) fe_fffb1 = {0x0000968acde3bdff,0x0002e8dab18e5bab,0x0000139870b9afed,0x0002746fab1d645f,0x000018e04102529e}; /* sqrt(-2 * A * (A + 2)) */
+static const bignum25519 ALIGN(16) fe_fffb2 = {0x00019b7c9f83650d,0x00073f75210405a4,0x0007a68106b887f2,0x000184b715d7241f,0x00032f9e1f5fba5d}; /* sqrt(2 * A * (A + 2)) */
+static const bignum25519 ALIGN(16) fe_fffb3 = {0x00048278e8cfd387,0x00062b4d37bad4fc,0x0003c9744aff6c02,0x00038823b55cdfe0,0x00018b5eef2eb3df}; /* sqrt(-sqrt(-1) * A * (A + 2)) */
+static const bignum25519 ALIGN(16) fe_fffb4 = {0x00051903b6b39186,0x00011427e94930a7,0x0003dd0cbbb91bf0,0x0005fc93607a443f,0x0001a43f3031067d}; /* sqrt(sqrt(-1) * A * (A + 2)) */
+#else
 /* d = -121665 / 121666 */
 #if !defined(NDEBUG)
 static const bignum25519 ALIGN(16) fe_d = {
@@ -25,6 +40,7 @@ static const bignum25519 ALIGN(16) fe_fffb3 = {
 		0x0cfd387, 0x1209e3a, 0x3bad4fc, 0x18ad34d, 0x2ff6c02, 0x0f25d12, 0x15cdfe0, 0x0e208ed, 0x32eb3df, 0x062d7bb}; /* sqrt(-sqrt(-1) * A * (A + 2)) */
 static const bignum25519 ALIGN(16) fe_fffb4 = {
 		0x2b39186, 0x14640ed, 0x14930a7, 0x04509fa, 0x3b91bf0, 0x0f7432e, 0x07a443f, 0x17f24d8, 0x031067d, 0x0690fcc}; /* sqrt(sqrt(-1) * A * (A + 2)) */
+#endif
 
 
 /*
@@ -179,10 +195,9 @@ void ge25519_pnielsadd(ge25519_pniels *r, const ge25519 *p, const ge25519_pniels
 	pack & unpack
 */
 
-void ge25519_pack(unsigned char r[32], const ge25519 *p) {
-	bignum25519 tx, ty, zi;
+static void ge25519_pack_zi(unsigned char r[32], const ge25519 *p, const bignum25519 zi) {
+	bignum25519 tx, ty;
 	unsigned char parity[32];
-	curve25519_recip(zi, p->z);
 	curve25519_mul(tx, p->x, zi);
 	curve25519_mul(ty, p->y, zi);
 	curve25519_contract(r, ty);
@@ -190,6 +205,34 @@ void ge25519_pack(unsigned char r[32], const ge25519 *p) {
 	r[31] ^= ((parity[0] & 1) << 7);
 }
 
+void ge25519_pack(unsigned char r[32], const ge25519 *p) {
+	bignum25519 zi;
+	curve25519_recip(zi, p->z);
+	ge25519_pack_zi(r, p, zi);
+}
+
+/* packs count points with one inversion per 16 points (Montgomery's trick) */
+void ge25519_pack_batch(unsigned char r[][32], const ge25519 *p, size_t count) {
+	bignum25519 acc[16], zi, t;
+	size_t first, n, k;
+
+	for (first = 0; first < count; first += n) {
+		n = (count - first < 16) ? count - first : 16;
+		/* acc[k] = z_0 * ... * z_k */
+		curve25519_copy(acc[0], p[first].z);
+		for (k = 1; k < n; k++) {
+			curve25519_mul(acc[k], acc[k - 1], p[first + k].z);
+		}
+		curve25519_recip(zi, acc[n - 1]);
+		for (k = n - 1; k > 0; k--) {
+			curve25519_mul(t, zi, acc[k - 1]);
+			curve25519_mul(zi, zi, p[first + k].z);
+			ge25519_pack_zi(r[first + k], &p[first + k], t);
+		}
+		ge25519_pack_zi(r[first], &p[first], zi);
+	}
+}
+
 int ge25519_unpack_negative_vartime(ge25519 *r, const unsigned char p[32]) {
 	const unsigned char zero[32] = {0};
 	const bignum25519 one = {1};
@@ -250,6 +293,15 @@ void ge25519_set_neutral(ge25519 *r)
 	r->z[0] = 1;
 }
 
+int ge25519_is_neutral_vartime(const ge25519 *p) {
+	static const unsigned char zero[32] = {0};
+	unsigned char point_buffer[3][32];
+	curve25519_contract(point_buffer[0], p->x);
+	curve25519_contract(point_buffer[1], p->y);
+	curve25519_contract(point_buffer[2], p->z);
+	return (memcmp(point_buffer[0], zero, 32) == 0) && (memcmp(point_buffer[1], point_buffer[2], 32) == 0);
+}
+
 #define S1_SWINDOWSIZE 5
 #define S1_TABLE_SIZE (1<<(S1_SWINDOWSIZE-2))
 #ifdef ED25519_NO_PRECOMP
@@ -532,6 +584,48 @@ void ge25519_scalarmult_base_niels(ge25519 *r, const uint8_t basepoint_table[256
 	}
 }
 
+/* computes [s1]P1 + [s2]P2 from the basepoint tables of P1 and P2, sharing the doublings */
+void ge25519_double_scalarmult_base_niels(ge25519 *r, const uint8_t table1[256][96], const bignum256modm s1, const uint8_t table2[256][96], const bignum256modm s2) {
+	signed char b1[64], b2[64];
+	uint32_t i;
+	ge25519_niels t;
+
+	contract256_window4_modm(b1, s1);
+	contract256_window4_modm(b2, s2);
+
+	ge25519_scalarmult_base_choose_niels(&t, table1, 0, b1[1]);
+	curve25519_sub_reduce(r->x, t.xaddy, t.ysubx);
+	curve25519_add_reduce(r->y, t.xaddy, t.ysubx);
+	memset(r->z, 0, sizeof(bignum25519));
+	curve25519_copy(r->t, t.t2d);
+	r->z[0] = 2;
+	ge25519_scalarmult_base_choose_niels(&t, table2, 0, b2[1]);
+	curve25519_mul(t.t2d, t.t2d, ge25519_ecd);
+	ge25519_nielsadd2(r, &t);
+	for (i = 3; i < 64; i += 2) {
+		ge25519_scalarmult_base_choose_niels(&t, table1, i / 2, b1[i]);
+		ge25519_nielsadd2(r, &t);
+		ge25519_scalarmult_base_choose_niels(&t, table2, i / 2, b2[i]);
+		ge25519_nielsadd2(r, &t);
+	}
+	ge25519_double_partial(r, r);
+	ge25519_double_partial(r, r);
+	ge25519_double_partial(r, r);
+	ge25519_double(r, r);
+	ge25519_scalarmult_base_choose_niels(&t, table1, 0, b1[0]);
+	curve25519_mul(t.t2d, t.t2d, ge25519_ecd);
+	ge25519_nielsadd2(r, &t);
+	ge25519_scalarmult_base_choose_niels(&t, table2, 0, b2[0]);
+	curve25519_mul(t.t2d, t.t2d, ge25519_ecd);
+	ge25519_nielsadd2(r, &t);
+	for(i = 2; i < 64; i += 2) {
+		ge25519_scalarmult_base_choose_niels(&t, table1, i / 2, b1[i]);
+		ge25519_nielsadd2(r, &t);
+		ge25519_scalarmult_base_choose_niels(&t, table2, i / 2, b2[i]);
+		ge25519_nielsadd2(r, &t);
+	}
+}
+
 int ge25519_check(const ge25519 *r){
 	/* return (z % q != 0 and
 						 x * y % q == z * t % q and
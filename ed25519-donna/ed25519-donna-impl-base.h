@@ -45,6 +45,8 @@ void ge25519_pnielsadd(ge25519_pniels *r, const ge25519 *p, const ge25519_pniels
 
 void ge25519_pack(unsigned char r[32], const ge25519 *p);
 
+void ge25519_pack_batch(unsigned char r[][32], const ge25519 *p, size_t count);
+
 int ge25519_unpack_negative_vartime(ge25519 *r, const unsigned char p[32]);
 
 /*
@@ -53,6 +55,9 @@ int ge25519_unpack_negative_vartime(ge25519 *r, const unsigned char p[32]);
 
 void ge25519_set_neutral(ge25519 *r);
 
+/* is p the neutral element (0, 1), vartime */
+int ge25519_is_neutral_vartime(const ge25519 *p);
+
 /* computes [s1]p1 + [s2]base */
 void ge25519_double_scalarmult_vartime(ge25519 *r, const ge25519 *p1, const bignum256modm s1, const bignum256modm s2);
 
@@ -64,6 +69,9 @@ void ge25519_scalarmult_base_choose_niels(ge25519_niels *t, const uint8_t table[
 /* computes [s]basepoint */
 void ge25519_scalarmult_base_niels(ge25519 *r, const uint8_t basepoint_table[256][96], const bignum256modm s);
 
+/* computes [s1]P1 + [s2]P2 from the basepoint tables of P1 and P2 */
+void ge25519_double_scalarmult_base_niels(ge25519 *r, const uint8_t table1[256][96], const bignum256modm s1, const uint8_t table2[256][96], const bignum256modm s2);
+
 /* check if r is on curve */
 int ge25519_check(const ge25519 *r);
 
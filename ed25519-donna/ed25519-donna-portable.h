@@ -22,3 +22,47 @@ static inline uint32_t U8TO32_LE(const unsigned char *p) {
 	 ((uint32_t)(p[2]) << 16) |
 	 ((uint32_t)(p[3]) << 24));
 }
+
+/*
+	64 bit field (radix 2^51) and scalar (radix 2^56) arithmetic needs a 128 bit
+	multiplication result, use it whenever the compiler provides one.
+	define ED25519_FORCE_32BIT to build the 32 bit backends anyway
+*/
+#if defined(__SIZEOF_INT128__) && !defined(ED25519_FORCE_32BIT)
+#define ED25519_64BIT
+
+typedef unsigned __int128 uint128_t;
+
+#define mul64x64_128(out,a,b) out = (uint128_t)a * b;
+#define shr128_pair(out,hi,lo,shift) out = (uint64_t)((((uint128_t)hi << 64) | lo) >> (shift));
+#define shl128_pair(out,hi,lo,shift) out = (uint64_t)(((((uint128_t)hi << 64) | lo) << (shift)) >> 64);
+#define shr128(out,in,shift) out = (uint64_t)(in >> (shift));
+#define shl128(out,in,shift) out = (uint64_t)((in << shift) >> 64);
+#define add128(a,b) a += b;
+#define add128_64(a,b) a += (uint64_t)b;
+#define lo128(a) ((uint64_t)a)
+#define hi128(a) ((uint64_t)(a >> 64))
+
+static inline void U64TO8_LE(unsigned char *p, const uint64_t v) {
+	p[0] = (unsigned char)(v      );
+	p[1] = (unsigned char)(v >>  8);
+	p[2] = (unsigned char)(v >> 16);
+	p[3] = (unsigned char)(v >> 24);
+	p[4] = (unsigned char)(v >> 32);
+	p[5] = (unsigned char)(v >> 40);
+	p[6] = (unsigned char)(v >> 48);
+	p[7] = (unsigned char)(v >> 56);
+}
+
+static inline uint64_t U8TO64_LE(const unsigned char *p) {
+	return
+	(((uint64_t)(p[0])      ) |
+	 ((uint64_t)(p[1]) <<  8) |
+	 ((uint64_t)(p[2]) << 16) |
+	 ((uint64_t)(p[3]) << 24) |
+	 ((uint64_t)(p[4]) << 32) |
+	 ((uint64_t)(p[5]) << 40) |
+	 ((uint64_t)(p[6]) << 48) |
+	 ((uint64_t)(p[7]) << 56));
+}
+#endif
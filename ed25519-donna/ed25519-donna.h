@@ -13,11 +13,19 @@
 
 #include "ed25519-donna-portable.h"
 
+#if defined(ED25519_64BIT)
+#include "curve25519-donna-64bit.h"
+#else
 #include "curve25519-donna-32bit.h"
+#endif
 
 #include "curve25519-donna-helpers.h"
 
+#if defined(ED25519_64BIT)
+#include "modm-donna-64bit.h"
+#else
 #include "modm-donna-32bit.h"
+#endif
 
 typedef unsigned char hash_512bits[64];
 
@@ -45,7 +53,11 @@ typedef struct ge25519_pniels_t {
 
 #include "ed25519-donna-basepoint-table.h"
 
+#if defined(ED25519_64BIT)
+#include "ed25519-donna-64bit-tables.h"
+#else
 #include "ed25519-donna-32bit-tables.h"
+#endif
 
 #include "ed25519-donna-impl-base.h"
 
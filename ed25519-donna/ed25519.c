@@ -15,7 +15,9 @@
 #endif
 
 #include "ed25519-donna.h"
+#include "ed25519-donna-batchverify.h"
 #include "ed25519.h"
+#include "rand.h"
 
 #include "ed25519-hash-custom.h"
 
@@ -201,6 +203,117 @@ ED25519_FN(ed25519_sign_open) (const unsigned char *m, size_t mlen, const ed2551
 	return ed25519_verify(RS, checkR, 32) ? 0 : -1;
 }
 
+/*
+	unpacks a point for the batch equation, which cannot tell a point with a small order
+	component from one without: fails unless P is in the prime order subgroup and p is its
+	canonical encoding, checked as [L-1](-P) == P, one scalar multiplication per point
+*/
+static int
+ed25519_batch_unpack(ge25519 *r, const unsigned char p[32]) {
+	static const unsigned char lminus1[32] = {
+		0xec,0xd3,0xf5,0x5c,0x1a,0x63,0x12,0x58,0xd6,0x9c,0xf7,0xa2,0xde,0xf9,0xde,0x14,
+		0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x10
+	};
+	bignum256modm l1, zero = {0};
+	ge25519 ALIGN(16) t;
+	unsigned char check[32];
+
+	if (!ge25519_unpack_negative_vartime(r, p))
+		return 0;
+	expand_raw256_modm(l1, lminus1);
+	ge25519_double_scalarmult_vartime(&t, r, l1, zero);
+	ge25519_pack(check, &t);
+	return ed25519_verify(check, p, 32);
+}
+
+/*
+	verifies num signatures, valid[i] is set to 1 for a valid and 0 for an invalid one.
+	returns 0 if all of them are valid.
+
+	chunks of up to ED25519_VERIFY_BATCH_SIZE signatures are checked at once, with random
+	128 bit coefficients z_i: sum(z_i S_i) B - sum(z_i H(R_i,A_i,m_i)) A_i - sum(z_i) R_i == 0
+	using the Bos-Coster multi scalar multiplication. If a chunk fails, each of its signatures
+	is verified with ed25519_sign_open to find the bad ones, as is a chunk with an R or A that is
+	not canonical or not in the prime order subgroup, so that both always agree.
+*/
+int
+ED25519_FN(ed25519_sign_open_batch) (const unsigned char **m, size_t *mlen, const unsigned char **pk, const unsigned char **RS, size_t num, int *valid) {
+	batch_heap ALIGN(16) batch;
+	ge25519 ALIGN(16) p;
+	bignum256modm *r_scalars;
+	size_t i, batchsize;
+	hash_512bits hram;
+	int ret = 0;
+
+	for (i = 0; i < num; i++)
+		valid[i] = 1;
+
+	while (num > 3) {
+		batchsize = (num > max_batch_size) ? max_batch_size : num;
+
+		/* generate r (scalars[batchsize+1]..scalars[2*batchsize] */
+		random_buffer(batch.r[0], batchsize * 16);
+		r_scalars = &batch.scalars[batchsize + 1];
+		for (i = 0; i < batchsize; i++)
+			expand256_modm(r_scalars[i], batch.r[i], 16);
+
+		/* compute scalars[0] = ((r1s1 + r2s2 + ...)), S has to be reduced as for a single signature */
+		for (i = 0; i < batchsize; i++) {
+			if (RS[i][63] & 224)
+				goto fallback;
+			expand_raw256_modm(batch.scalars[i], RS[i] + 32);
+			if (!is_reduced256_modm(batch.scalars[i]))
+				goto fallback;
+			mul256_modm(batch.scalars[i], batch.scalars[i], r_scalars[i]);
+		}
+		for (i = 1; i < batchsize; i++)
+			add256_modm(batch.scalars[0], batch.scalars[0], batch.scalars[i]);
+
+		/* compute scalars[1]..scalars[batchsize] as r[i]*H(R[i],A[i],m[i]) */
+		for (i = 0; i < batchsize; i++) {
+			ed25519_hram(hram, RS[i], pk[i], m[i], mlen[i]);
+			expand256_modm(batch.scalars[i+1], hram, 64);
+			mul256_modm(batch.scalars[i+1], batch.scalars[i+1], r_scalars[i]);
+		}
+
+		/* compute points */
+		ge25519_set_base(&batch.points[0]);
+		for (i = 0; i < batchsize; i++) {
+			/* signatures by the same key are common, check each key once */
+			if (i > 0 && memcmp(pk[i], pk[i-1], 32) == 0)
+				batch.points[i+1] = batch.points[i];
+			else if (!ed25519_batch_unpack(&batch.points[i+1], pk[i]))
+				goto fallback;
+		}
+		for (i = 0; i < batchsize; i++)
+			if (!ed25519_batch_unpack(&batch.points[batchsize+i+1], RS[i]))
+				goto fallback;
+
+		ge25519_multi_scalarmult_vartime(&p, &batch, (batchsize * 2) + 1);
+		if (!ge25519_is_neutral_vartime(&p)) {
+			fallback:
+			for (i = 0; i < batchsize; i++) {
+				valid[i] = ED25519_FN(ed25519_sign_open) (m[i], mlen[i], pk[i], RS[i]) ? 0 : 1;
+				ret |= (valid[i] ^ 1);
+			}
+		}
+
+		m += batchsize;
+		mlen += batchsize;
+		pk += batchsize;
+		RS += batchsize;
+		num -= batchsize;
+		valid += batchsize;
+	}
+
+	for (i = 0; i < num; i++) {
+		valid[i] = ED25519_FN(ed25519_sign_open) (m[i], mlen[i], pk[i], RS[i]) ? 0 : 1;
+		ret |= (valid[i] ^ 1);
+	}
+
+	return ret;
+}
+
 int
 ED25519_FN(ed25519_scalarmult) (ed25519_public_key res, const ed25519_secret_key sk, const ed25519_public_key pk) {
 	bignum256modm a;
@@ -4,6 +4,8 @@
 
 #include "ed25519-donna.h"
 
+#if !defined(ED25519_64BIT)
+
 /*
 	Arithmetic modulo the group order n = 2^252 +  27742317777372353535851937790883648493 = 7237005577332262213973186563042994240857116359379907606001950938285454250989
 
@@ -515,3 +517,75 @@ void muladd256_modm(bignum256modm r, const bignum256modm a, const bignum256modm
 	mul256_modm(t, a, b);
 	add256_modm(r, c, t);
 }
+
+/*
+	helpers for batch verification, are allowed to be vartime
+*/
+
+/* out = a - b, a must be larger than b */
+void sub256_modm_batch(bignum256modm out, const bignum256modm a, const bignum256modm b, size_t limbsize) {
+	size_t i = 0;
+	bignum256modm_element_t carry = 0;
+	for (i = 0; i < limbsize; i++) {
+		out[i] = (a[i] - b[i]) - carry;
+		carry = (out[i] >> 31);
+		out[i] &= 0x3fffffff;
+	}
+	out[i] = (a[i] - b[i]) - carry;
+}
+
+/* is a < b */
+int lt256_modm_batch(const bignum256modm a, const bignum256modm b, size_t limbsize) {
+	size_t i = 0;
+	bignum256modm_element_t t, carry = 0;
+	for (i = 0; i <= limbsize; i++) {
+		t = (a[i] - b[i]) - carry;
+		carry = (t >> 31);
+	}
+	return (int)carry;
+}
+
+/* is a <= b */
+int lte256_modm_batch(const bignum256modm a, const bignum256modm b, size_t limbsize) {
+	size_t i = 0;
+	bignum256modm_element_t t, carry = 0;
+	for (i = 0; i <= limbsize; i++) {
+		t = (b[i] - a[i]) - carry;
+		carry = (t >> 31);
+	}
+	return (int)!carry;
+}
+
+/* is a == 0 */
+int iszero256_modm_batch(const bignum256modm a) {
+	size_t i;
+	for (i = 0; i < 9; i++)
+		if (a[i])
+			return 0;
+	return 1;
+}
+
+/* is a == 1 */
+int isone256_modm_batch(const bignum256modm a) {
+	size_t i;
+	if (a[0] != 1)
+		return 0;
+	for (i = 1; i < 9; i++)
+		if (a[i])
+			return 0;
+	return 1;
+}
+
+/* can a fit in to (at most) 128 bits */
+int isatmost128bits256_modm_batch(const bignum256modm a) {
+	uint32_t mask =
+		((a[8]             )  | /*  16 */
+		 (a[7]             )  | /*  46 */
+		 (a[6]             )  | /*  76 */
+		 (a[5]             )  | /* 106 */
+		 (a[4] & 0x3fffff00));  /* 128 */
+
+	return (mask == 0);
+}
+
+#endif // !ED25519_64BIT
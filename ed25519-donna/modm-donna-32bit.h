@@ -78,3 +78,26 @@ void mulsub256_modm(bignum256modm r, const bignum256modm a, const bignum256modm
 
 /* (cc + aa * bb) % l */
 void muladd256_modm(bignum256modm r, const bignum256modm a, const bignum256modm b, const bignum256modm c);
+
+/*
+	helpers for batch verification, are allowed to be vartime
+	limbsize is the index of the most significant limb to consider
+*/
+
+/* out = a - b, a must be larger than b */
+void sub256_modm_batch(bignum256modm out, const bignum256modm a, const bignum256modm b, size_t limbsize);
+
+/* is a < b */
+int lt256_modm_batch(const bignum256modm a, const bignum256modm b, size_t limbsize);
+
+/* is a <= b */
+int lte256_modm_batch(const bignum256modm a, const bignum256modm b, size_t limbsize);
+
+/* is a == 0 */
+int iszero256_modm_batch(const bignum256modm a);
+
+/* is a == 1 */
+int isone256_modm_batch(const bignum256modm a);
+
+/* can a fit in to (at most) 128 bits */
+int isatmost128bits256_modm_batch(const bignum256modm a);
@@ -23,126 +23,220 @@
 #include "hasher.h"
 #include "ripemd160.h"
 
-void hasher_Init(Hasher *hasher, HasherType type) {
-	hasher->type = type;
+static void sha2_init(void *ctx) {
+	sha256_Init(ctx);
+}
+
+static void sha2_update(void *ctx, const uint8_t *data, size_t length) {
+	sha256_Update(ctx, data, length);
+}
+
+static void sha2_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha256_Final(ctx, hash);
+}
+
+static void sha2d_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha256_Final(ctx, hash);
+	sha256_Raw(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void sha2_ripemd_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha256_Final(ctx, hash);
+	ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void sha2d_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha256_Raw(data, length, hash);
+	sha256_Raw(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void sha2_ripemd_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha256_Raw(data, length, hash);
+	ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void sha3_init(void *ctx) {
+	sha3_256_Init(ctx);
+}
+
+static void sha3_update(void *ctx, const uint8_t *data, size_t length) {
+	sha3_Update(ctx, data, length);
+}
+
+static void sha3_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha3_Final(ctx, hash);
+}
+
+static void sha3_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	sha3_256(data, length, hash);
+}
 
-	switch (hasher->type) {
-	case HASHER_SHA2:
-	case HASHER_SHA2D:
-	case HASHER_SHA2_RIPEMD:
-		sha256_Init(&hasher->ctx.sha2);
-		break;
-	case HASHER_SHA3:
 #if USE_KECCAK
-	case HASHER_SHA3K:
+static void sha3k_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	keccak_Final(ctx, hash);
+}
+
+static void sha3k_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	keccak_256(data, length, hash);
+}
 #endif
-		sha3_256_Init(&hasher->ctx.sha3);
-		break;
-	case HASHER_BLAKE:
-	case HASHER_BLAKED:
-	case HASHER_BLAKE_RIPEMD:
-		blake256_Init(&hasher->ctx.blake);
-		break;
-	case HASHER_GROESTLD_TRUNC:
-		groestl512_Init(&hasher->ctx.groestl);
-		break;
-	case HASHER_OVERWINTER_PREVOUTS:
-		blake2b_InitPersonal(&hasher->ctx.blake2b, 32, "ZcashPrevoutHash", 16);
-		break;
-	case HASHER_OVERWINTER_SEQUENCE:
-		blake2b_InitPersonal(&hasher->ctx.blake2b, 32, "ZcashSequencHash", 16);
-		break;
-	case HASHER_OVERWINTER_OUTPUTS:
-		blake2b_InitPersonal(&hasher->ctx.blake2b, 32, "ZcashOutputsHash", 16);
-		break;
-	case HASHER_OVERWINTER_PREIMAGE:
-		blake2b_InitPersonal(&hasher->ctx.blake2b, 32, "ZcashSigHash\x19\x1b\xa8\x5b", 16);  // BRANCH_ID = 0x5ba81b19
-		break;
-	}
+
+static void blake_init(void *ctx) {
+	blake256_Init(ctx);
 }
 
-void hasher_Reset(Hasher *hasher) {
-	hasher_Init(hasher, hasher->type);
+static void blake_update(void *ctx, const uint8_t *data, size_t length) {
+	blake256_Update(ctx, data, length);
 }
 
-void hasher_Update(Hasher *hasher, const uint8_t *data, size_t length) {
-	switch (hasher->type) {
-	case HASHER_SHA2:
-	case HASHER_SHA2D:
-	case HASHER_SHA2_RIPEMD:
-		sha256_Update(&hasher->ctx.sha2, data, length);
-		break;
-	case HASHER_SHA3:
+static void blake_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256_Final(ctx, hash);
+}
+
+static void blaked_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256_Final(ctx, hash);
+	blake256(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void blake_ripemd_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256_Final(ctx, hash);
+	ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void blake_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256(data, length, hash);
+}
+
+static void blaked_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256(data, length, hash);
+	blake256(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void blake_ripemd_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake256(data, length, hash);
+	ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
+}
+
+static void groestl_init(void *ctx) {
+	groestl512_Init(ctx);
+}
+
+static void groestl_update(void *ctx, const uint8_t *data, size_t length) {
+	groestl512_Update(ctx, data, length);
+}
+
+static void groestld_trunc_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	groestl512_DoubleTrunc(ctx, hash);
+}
+
+static void groestld_trunc_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	GROESTL512_CTX ctx;
+
+	groestl512_Init(&ctx);
+	groestl512_Update(&ctx, data, length);
+	groestl512_DoubleTrunc(&ctx, hash);
+}
+
+static void overwinter_prevouts_init(void *ctx) {
+	blake2b_InitPersonal(ctx, 32, "ZcashPrevoutHash", 16);
+}
+
+static void overwinter_sequence_init(void *ctx) {
+	blake2b_InitPersonal(ctx, 32, "ZcashSequencHash", 16);
+}
+
+static void overwinter_outputs_init(void *ctx) {
+	blake2b_InitPersonal(ctx, 32, "ZcashOutputsHash", 16);
+}
+
+static void overwinter_preimage_init(void *ctx) {
+	blake2b_InitPersonal(ctx, 32, "ZcashSigHash\x19\x1b\xa8\x5b", 16);  // BRANCH_ID = 0x5ba81b19
+}
+
+static void overwinter_update(void *ctx, const uint8_t *data, size_t length) {
+	blake2b_Update(ctx, data, length);
+}
+
+static void overwinter_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	blake2b_Final(ctx, hash, 32);
+}
+
+// the raw functions of the personalized BLAKE2b hashers, on a BLAKE2B_CTX
+#define OVERWINTER_RAW(name) \
+static void name##_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) { \
+	BLAKE2B_CTX ctx; \
+	name##_init(&ctx); \
+	blake2b_Update(&ctx, data, length); \
+	blake2b_Final(&ctx, hash, 32); \
+}
+
+OVERWINTER_RAW(overwinter_prevouts)
+OVERWINTER_RAW(overwinter_sequence)
+OVERWINTER_RAW(overwinter_outputs)
+OVERWINTER_RAW(overwinter_preimage)
+
+// unsupported types do nothing, as the switch on the type used to
+static void nop_init(void *ctx) {
+	(void)ctx;
+}
+
+static void nop_update(void *ctx, const uint8_t *data, size_t length) {
+	(void)ctx; (void)data; (void)length;
+}
+
+static void nop_final(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	(void)ctx; (void)hash;
+}
+
+static void nop_raw(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	(void)data; (void)length; (void)hash;
+}
+
+static const HasherDesc hasher_nop = {nop_init, nop_update, nop_final, nop_raw};
+
+static const HasherDesc hasher_descs[] = {
+	[HASHER_SHA2]                = {sha2_init, sha2_update, sha2_final, sha256_Raw},
+	[HASHER_SHA2D]               = {sha2_init, sha2_update, sha2d_final, sha2d_raw},
+	[HASHER_SHA2_RIPEMD]         = {sha2_init, sha2_update, sha2_ripemd_final, sha2_ripemd_raw},
+	[HASHER_SHA3]                = {sha3_init, sha3_update, sha3_final, sha3_raw},
 #if USE_KECCAK
-	case HASHER_SHA3K:
+	[HASHER_SHA3K]               = {sha3_init, sha3_update, sha3k_final, sha3k_raw},
 #endif
-		sha3_Update(&hasher->ctx.sha3, data, length);
-		break;
-	case HASHER_BLAKE:
-	case HASHER_BLAKED:
-	case HASHER_BLAKE_RIPEMD:
-		blake256_Update(&hasher->ctx.blake, data, length);
-		break;
-	case HASHER_GROESTLD_TRUNC:
-		groestl512_Update(&hasher->ctx.groestl, data, length);
-		break;
-	case HASHER_OVERWINTER_PREVOUTS:
-	case HASHER_OVERWINTER_SEQUENCE:
-	case HASHER_OVERWINTER_OUTPUTS:
-	case HASHER_OVERWINTER_PREIMAGE:
-		blake2b_Update(&hasher->ctx.blake2b, data, length);
-		break;
+	[HASHER_BLAKE]               = {blake_init, blake_update, blake_final, blake_raw},
+	[HASHER_BLAKED]              = {blake_init, blake_update, blaked_final, blaked_raw},
+	[HASHER_BLAKE_RIPEMD]        = {blake_init, blake_update, blake_ripemd_final, blake_ripemd_raw},
+	[HASHER_GROESTLD_TRUNC]      = {groestl_init, groestl_update, groestld_trunc_final, groestld_trunc_raw},
+	[HASHER_OVERWINTER_PREVOUTS] = {overwinter_prevouts_init, overwinter_update, overwinter_final, overwinter_prevouts_raw},
+	[HASHER_OVERWINTER_SEQUENCE] = {overwinter_sequence_init, overwinter_update, overwinter_final, overwinter_sequence_raw},
+	[HASHER_OVERWINTER_OUTPUTS]  = {overwinter_outputs_init, overwinter_update, overwinter_final, overwinter_outputs_raw},
+	[HASHER_OVERWINTER_PREIMAGE] = {overwinter_preimage_init, overwinter_update, overwinter_final, overwinter_preimage_raw},
+};
+
+const HasherDesc *hasher_Desc(HasherType type) {
+	if ((unsigned)type >= sizeof(hasher_descs) / sizeof(*hasher_descs) || hasher_descs[type].init == NULL) {
+		return &hasher_nop;
 	}
+	return &hasher_descs[type];
+}
+
+void hasher_Init(Hasher *hasher, HasherType type) {
+	hasher->type = type;
+	hasher->desc = hasher_Desc(type);
+	hasher->desc->init(&hasher->ctx);
+}
+
+void hasher_Reset(Hasher *hasher) {
+	hasher->desc->init(&hasher->ctx);
+}
+
+void hasher_Update(Hasher *hasher, const uint8_t *data, size_t length) {
+	hasher->desc->update(&hasher->ctx, data, length);
 }
 
 void hasher_Final(Hasher *hasher, uint8_t hash[HASHER_DIGEST_LENGTH]) {
-	switch (hasher->type) {
-	case HASHER_SHA2:
-		sha256_Final(&hasher->ctx.sha2, hash);
-		break;
-	case HASHER_SHA2D:
-		sha256_Final(&hasher->ctx.sha2, hash);
-		hasher_Raw(HASHER_SHA2, hash, HASHER_DIGEST_LENGTH, hash);
-		break;
-	case HASHER_SHA2_RIPEMD:
-		sha256_Final(&hasher->ctx.sha2, hash);
-		ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
-		break;
-	case HASHER_SHA3:
-		sha3_Final(&hasher->ctx.sha3, hash);
-		break;
-#if USE_KECCAK
-	case HASHER_SHA3K:
-		keccak_Final(&hasher->ctx.sha3, hash);
-		break;
-#endif
-	case HASHER_BLAKE:
-		blake256_Final(&hasher->ctx.blake, hash);
-		break;
-	case HASHER_BLAKED:
-		blake256_Final(&hasher->ctx.blake, hash);
-		hasher_Raw(HASHER_BLAKE, hash, HASHER_DIGEST_LENGTH, hash);
-		break;
-	case HASHER_BLAKE_RIPEMD:
-		blake256_Final(&hasher->ctx.blake, hash);
-		ripemd160(hash, HASHER_DIGEST_LENGTH, hash);
-		break;
-	case HASHER_GROESTLD_TRUNC:
-		groestl512_DoubleTrunc(&hasher->ctx.groestl, hash);
-		break;
-	case HASHER_OVERWINTER_PREVOUTS:
-	case HASHER_OVERWINTER_SEQUENCE:
-	case HASHER_OVERWINTER_OUTPUTS:
-	case HASHER_OVERWINTER_PREIMAGE:
-		blake2b_Final(&hasher->ctx.blake2b, hash, 32);
-		break;
-	}
+	hasher->desc->final(&hasher->ctx, hash);
 }
 
 void hasher_Raw(HasherType type, const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
-	Hasher hasher;
-
-	hasher_Init(&hasher, type);
-	hasher_Update(&hasher, data, length);
-	hasher_Final(&hasher, hash);
+	hasher_Desc(type)->raw(data, length, hash);
 }
@@ -56,8 +56,21 @@ typedef enum {
     HASHER_OVERWINTER_PREIMAGE,
 } HasherType;
 
+/* The functions of one HasherType, looked up once by hasher_Init so that
+ * hasher_Update and hasher_Final do not dispatch on the type. raw hashes
+ * a whole message on a context of its own algorithm only, without the
+ * union of all of them in Hasher. Types that are not compiled in get
+ * functions that do nothing. */
+typedef struct {
+    void (*init)(void *ctx);
+    void (*update)(void *ctx, const uint8_t *data, size_t length);
+    void (*final)(void *ctx, uint8_t hash[HASHER_DIGEST_LENGTH]);
+    void (*raw)(const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]);
+} HasherDesc;
+
 typedef struct {
     HasherType type;
+    const HasherDesc *desc;
 
     union {
         SHA256_CTX sha2;        // for HASHER_SHA2{,D}
@@ -68,6 +81,8 @@ typedef struct {
     } ctx;
 } Hasher;
 
+const HasherDesc *hasher_Desc(HasherType type);
+
 void hasher_Init(Hasher *hasher, HasherType type);
 void hasher_Reset(Hasher *hasher);
 void hasher_Update(Hasher *hasher, const uint8_t *data, size_t length);
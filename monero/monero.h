@@ -17,5 +17,6 @@
 #include "serialize.h"
 #include "xmr.h"
 #include "range_proof.h"
+#include "scan.h"
 
 #endif //TREZOR_CRYPTO_MONERO_H
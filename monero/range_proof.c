@@ -3,6 +3,7 @@
 //
 
 #include "range_proof.h"
+#include "memzero.h"
 
 
 static void xmr_hash_ge25519_to_scalar(bignum256modm r, const ge25519 *p){
@@ -113,3 +114,166 @@ void xmr_gen_range_sig_ex(xmr_range_sig_t * sig, ge25519 * C, bignum256modm mask
 #undef BB
 }
 
+
+// bits of the amount handled by one job of xmr_gen_range_sig_batch
+#define XMR_RANGE_SIG_JOB_BITS 8
+
+typedef struct {
+	xmr_range_sig_t * sig;
+	xmr_amount amount;
+	bignum256modm * ai;
+	bignum256modm * alpha;
+	bignum256modm si[XMR_ATOMS];   // s1 of the zero bits, s0 of the one bits
+	bignum256modm ee;
+	ge25519 H[XMR_ATOMS];          // 2^i * H
+	ge25519 Ci[XMR_ATOMS];
+	unsigned char L[XMR_ATOMS][32];
+} xmr_range_sig_state;
+
+static void xmr_gen_range_sig_first(void * arg, size_t job){
+	xmr_range_sig_state * st = arg;
+	const unsigned first = job * XMR_RANGE_SIG_JOB_BITS;
+	ge25519 P[2 * XMR_RANGE_SIG_JOB_BITS];
+	unsigned char packed[2 * XMR_RANGE_SIG_JOB_BITS][32];
+	ge25519 C_tmp;
+	bignum256modm c;
+	unsigned k, n = 0;
+
+	// L = alpha * G, Ci = ai * G + bit * 2^i * H, packed together
+	for (k = 0; k < XMR_RANGE_SIG_JOB_BITS; ++k){
+		const unsigned ii = first + k;
+		ge25519_scalarmult_base_niels(&P[2 * k], ge25519_niels_base_multiples, st->alpha[ii]);
+		ge25519_scalarmult_base_niels(&st->Ci[ii], ge25519_niels_base_multiples, st->ai[ii]);
+		if ((st->amount >> ii) & 1){
+			ge25519_add(&st->Ci[ii], &st->Ci[ii], &st->H[ii], 0);
+		}
+		ge25519_copy(&P[2 * k + 1], &st->Ci[ii]);
+	}
+	ge25519_pack_batch(packed, P, 2 * XMR_RANGE_SIG_JOB_BITS);
+
+	// zero bits: L = s1 * G + c * (Ci - 2^i * H), c = H(alpha * G)
+	for (k = 0; k < XMR_RANGE_SIG_JOB_BITS; ++k){
+		const unsigned ii = first + k;
+		memcpy(st->sig->Ci[ii], packed[2 * k + 1], 32);
+		if ((st->amount >> ii) & 1){
+			memcpy(st->L[ii], packed[2 * k], 32);
+			continue;
+		}
+		xmr_hash_to_scalar(c, packed[2 * k], 32);
+		ge25519_add(&C_tmp, &st->Ci[ii], &st->H[ii], 1);
+		xmr_add_keys2_vartime(&P[n], st->si[ii], c, &C_tmp);
+		contract256_modm(st->sig->asig.s1[ii], st->si[ii]);
+		n++;
+	}
+	ge25519_pack_batch(packed, P, n);
+	for (k = 0, n = 0; k < XMR_RANGE_SIG_JOB_BITS; ++k){
+		const unsigned ii = first + k;
+		if (!((st->amount >> ii) & 1)){
+			memcpy(st->L[ii], packed[n++], 32);
+		}
+	}
+}
+
+static void xmr_gen_range_sig_second(void * arg, size_t job){
+	xmr_range_sig_state * st = arg;
+	const unsigned first = job * XMR_RANGE_SIG_JOB_BITS;
+	ge25519 P[XMR_RANGE_SIG_JOB_BITS];
+	unsigned char packed[XMR_RANGE_SIG_JOB_BITS][32];
+	bignum256modm si, c;
+	unsigned k, n = 0;
+
+	for (k = 0; k < XMR_RANGE_SIG_JOB_BITS; ++k){
+		const unsigned ii = first + k;
+		contract256_modm(st->sig->asig.s0[ii], st->si[ii]);
+		if ((st->amount >> ii) & 1){
+			// L = s0 * G + ee * Ci
+			xmr_add_keys2_vartime(&P[n++], st->si[ii], st->ee, &st->Ci[ii]);
+		} else {
+			mulsub256_modm(si, st->ai[ii], st->ee, st->alpha[ii]);
+			contract256_modm(st->sig->asig.s0[ii], si);
+		}
+	}
+	ge25519_pack_batch(packed, P, n);
+	for (k = 0, n = 0; k < XMR_RANGE_SIG_JOB_BITS; ++k){
+		const unsigned ii = first + k;
+		if ((st->amount >> ii) & 1){
+			xmr_hash_to_scalar(c, packed[n++], 32);
+			mulsub256_modm(si, st->ai[ii], c, st->alpha[ii]);
+			contract256_modm(st->sig->asig.s1[ii], si);
+		}
+	}
+}
+
+void xmr_gen_range_sig_batch(xmr_range_sig_t * sig, ge25519 * C, bignum256modm mask, xmr_amount amount, bignum256modm * last_mask,
+														 bignum256modm ai[64], bignum256modm alpha[64], xmr_parallel_for_t parallel_for, void * pool)
+{
+	const unsigned n = XMR_ATOMS;
+	const size_t jobs = XMR_ATOMS / XMR_RANGE_SIG_JOB_BITS;
+	xmr_range_sig_state st;
+	bignum256modm a={0};
+	unsigned char buff[32];
+	Hasher kck;
+	ge25519 C_acc;
+
+	st.sig = sig;
+	st.amount = amount;
+	st.ai = ai;
+	st.alpha = alpha;
+
+	// draw the randomness in the order of xmr_gen_range_sig_ex
+	set256_modm(a, 0);
+	for(unsigned ii=0; ii<n; ++ii){
+		xmr_random_scalar(ai[ii]);
+		if (last_mask != NULL && ii == n - 1){
+			sub256_modm(ai[ii], *last_mask, a);
+		}
+		add256_modm(a, a, ai[ii]);
+		xmr_random_scalar(alpha[ii]);
+		if (((amount >> ii) & 1) == 0){
+			xmr_random_scalar(st.si[ii]);
+		}
+	}
+	for(unsigned ii=0; ii<n; ++ii){
+		if ((amount >> ii) & 1){
+			xmr_random_scalar(st.si[ii]);
+		}
+	}
+
+	ge25519_set_xmr_h(&st.H[0]);
+	for(unsigned ii=1; ii<n; ++ii){
+		ge25519_double(&st.H[ii], &st.H[ii - 1]);
+	}
+
+	// First pass: Ci, s1 of the zero bits and L of all bits
+	if (parallel_for){
+		parallel_for(xmr_gen_range_sig_first, &st, jobs, pool);
+	} else {
+		for (size_t j = 0; j < jobs; ++j){
+			xmr_gen_range_sig_first(&st, j);
+		}
+	}
+
+	// Compute ee
+	xmr_hasher_init(&kck);
+	ge25519_set_neutral(&C_acc);
+	for(unsigned ii=0; ii<n; ++ii){
+		xmr_hasher_update(&kck, st.L[ii], 32);
+		ge25519_add(&C_acc, &C_acc, &st.Ci[ii], 0);
+	}
+	xmr_hasher_final(&kck, buff);
+	expand256_modm(st.ee, buff, sizeof(buff));
+
+	// Second pass, s0, s1
+	if (parallel_for){
+		parallel_for(xmr_gen_range_sig_second, &st, jobs, pool);
+	} else {
+		for (size_t j = 0; j < jobs; ++j){
+			xmr_gen_range_sig_second(&st, j);
+		}
+	}
+
+	ge25519_copy(C, &C_acc);
+	copy256_modm(mask, a);
+	contract256_modm(sig->asig.ee, st.ee);
+	memzero(&st, sizeof(st));
+}
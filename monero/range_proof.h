@@ -27,4 +27,14 @@ void xmr_gen_range_sig(xmr_range_sig_t * sig, ge25519 * C, bignum256modm mask, x
 void xmr_gen_range_sig_ex(xmr_range_sig_t * sig, ge25519 * C, bignum256modm mask, xmr_amount amount, bignum256modm * last_mask,
                           bignum256modm ai[64], bignum256modm alpha[64]);
 
+// runs job(arg, i) for every i < count. the jobs are independent and may
+// run in any order and in parallel, e.g. on the threads of pool.
+typedef void (*xmr_parallel_for_t)(void (*job)(void * arg, size_t i), void * arg, size_t count, void * pool);
+
+// same result as xmr_gen_range_sig_ex for the same randomness, the fixed
+// base multiplications and the packing of points are batched in groups of
+// 8 bits. parallel_for is optional, without it the groups run one by one.
+void xmr_gen_range_sig_batch(xmr_range_sig_t * sig, ge25519 * C, bignum256modm mask, xmr_amount amount, bignum256modm * last_mask,
+                             bignum256modm ai[64], bignum256modm alpha[64], xmr_parallel_for_t parallel_for, void * pool);
+
 #endif //TREZOR_CRYPTO_RANGE_PROOF_H
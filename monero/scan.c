@@ -0,0 +1,256 @@
+//
+// Output scanning for view-only wallets
+//
+
+#include "scan.h"
+#include "serialize.h"
+#include "sha3.h"
+#include "memzero.h"
+
+// points normalized together, one field inversion per batch
+#define XMR_SCAN_BATCH 16
+
+static uint32_t xmr_subaddr_bucket(const xmr_subaddr_table_t * table, const xmr_key_t key){
+	// the keys are curve points, their low bytes are uniform enough
+	const uint32_t h = key[0] | ((uint32_t)key[1] << 8) | ((uint32_t)key[2] << 16) | ((uint32_t)key[3] << 24);
+	return h % table->size;
+}
+
+void xmr_subaddr_table_init(xmr_subaddr_table_t * table, xmr_subaddr_entry_t * entries, uint32_t size){
+	table->entries = entries;
+	table->size = size;
+	table->count = 0;
+	for (uint32_t i = 0; i < size; i++){
+		entries[i].bucket = UINT32_MAX;
+		entries[i].hash_next = UINT32_MAX;
+	}
+}
+
+static void xmr_subaddr_table_insert(xmr_subaddr_table_t * table, const xmr_key_t key, uint32_t major, uint32_t minor){
+	const uint32_t k = table->count++;
+	xmr_subaddr_entry_t * e = &table->entries[k];
+	xmr_subaddr_entry_t * head = &table->entries[xmr_subaddr_bucket(table, key)];
+	memcpy(e->spend_pub, key, sizeof(xmr_key_t));
+	e->major = major;
+	e->minor = minor;
+	e->hash_next = head->bucket;
+	head->bucket = k;
+}
+
+uint32_t xmr_subaddr_table_add(xmr_subaddr_table_t * table, const ge25519 * spend_pub, const bignum256modm view_priv,
+                               uint32_t major, uint32_t minor_begin, uint32_t minor_end){
+	ge25519 D[XMR_SCAN_BATCH];
+	ge25519 mG;
+	unsigned char packed[XMR_SCAN_BATCH][32];
+	bignum256modm m;
+	uint32_t added = 0;
+
+	while (minor_begin < minor_end && table->count < table->size){
+		uint32_t n = minor_end - minor_begin;
+		if (n > XMR_SCAN_BATCH) n = XMR_SCAN_BATCH;
+		if (n > table->size - table->count) n = table->size - table->count;
+
+		// D = B + H_s("SubAddr" || a || major || minor) G, the main address uses B
+		for (uint32_t j = 0; j < n; j++){
+			if (major == 0 && minor_begin + j == 0){
+				ge25519_copy(&D[j], spend_pub);
+				continue;
+			}
+			xmr_get_subaddress_secret_key(m, major, minor_begin + j, view_priv);
+			ge25519_scalarmult_base_niels(&mG, ge25519_niels_base_multiples, m);
+			ge25519_add(&D[j], spend_pub, &mG, 0);
+		}
+		ge25519_pack_batch(packed, D, n);
+
+		for (uint32_t j = 0; j < n; j++){
+			xmr_subaddr_table_insert(table, packed[j], major, minor_begin + j);
+		}
+		minor_begin += n;
+		added += n;
+	}
+
+	memzero(m, sizeof(m));
+	return added;
+}
+
+const xmr_subaddr_entry_t * xmr_subaddr_table_find(const xmr_subaddr_table_t * table, const xmr_key_t spend_pub){
+	if (table->size == 0){
+		return NULL;
+	}
+	uint32_t k = table->entries[xmr_subaddr_bucket(table, spend_pub)].bucket;
+	while (k != UINT32_MAX){
+		const xmr_subaddr_entry_t * e = &table->entries[k];
+		if (memcmp(e->spend_pub, spend_pub, sizeof(xmr_key_t)) == 0){
+			return e;
+		}
+		k = e->hash_next;
+	}
+	return NULL;
+}
+
+typedef struct {
+	const xmr_subaddr_table_t * table;
+	const xmr_scan_tx_t * txs;
+	bignum256modm view_priv;
+	xmr_scan_match_t * matches;
+	size_t match_count;
+	size_t max_matches;
+
+	// transaction keys waiting for their derivation
+	ge25519 R[XMR_SCAN_BATCH];
+	uint32_t key_tx[XMR_SCAN_BATCH];
+	uint32_t key_index[XMR_SCAN_BATCH];  // UINT32_MAX for the main key, else the output of the additional key
+	unsigned char derivation[XMR_SCAN_BATCH][32];
+	size_t key_count;
+
+	// outputs waiting for the lookup of their spend key
+	uint32_t out_key[XMR_SCAN_BATCH];
+	uint32_t out_index[XMR_SCAN_BATCH];
+	size_t out_count;
+} xmr_scan_state;
+
+// D' = P - H_s(8aR || varint(i)) G, looked up in the subaddress table
+static void xmr_scan_flush_outputs(xmr_scan_state * st){
+	const size_t n = st->out_count;
+	unsigned char buff[XMR_SCAN_BATCH][32 + 8];
+	const unsigned char * data[4];
+	unsigned char hash[XMR_SCAN_BATCH][32];
+	size_t len[XMR_SCAN_BATCH];
+	unsigned char valid[XMR_SCAN_BATCH];
+	unsigned char packed[XMR_SCAN_BATCH][32];
+	ge25519 D[XMR_SCAN_BATCH];
+	ge25519 P, sG;
+	bignum256modm s;
+	size_t j;
+
+	if (n == 0){
+		return;
+	}
+	for (j = 0; j < n; j++){
+		memcpy(buff[j], st->derivation[st->out_key[j]], 32);
+		len[j] = 32 + xmr_write_varint(buff[j] + 32, 8, st->out_index[j]);
+	}
+
+	// the varints of outputs in one transaction mostly have the same length
+	for (j = 0; j + 4 <= n && len[j] == len[j + 1] && len[j] == len[j + 2] && len[j] == len[j + 3]; j += 4){
+		data[0] = buff[j];
+		data[1] = buff[j + 1];
+		data[2] = buff[j + 2];
+		data[3] = buff[j + 3];
+		keccak_256_x4(data, len[j], &hash[j]);
+	}
+	for (; j < n; j++){
+		xmr_fast_hash(hash[j], buff[j], len[j]);
+	}
+
+	for (j = 0; j < n; j++){
+		const xmr_scan_tx_t * tx = &st->txs[st->key_tx[st->out_key[j]]];
+		valid[j] = ge25519_unpack_vartime(&P, tx->outputs[st->out_index[j]]);
+		if (!valid[j]){
+			ge25519_set_neutral(&D[j]);
+			continue;
+		}
+		expand256_modm(s, hash[j], 32);
+		ge25519_scalarmult_base_niels(&sG, ge25519_niels_base_multiples, s);
+		ge25519_add(&D[j], &P, &sG, 1);
+	}
+	ge25519_pack_batch(packed, D, n);
+
+	for (j = 0; j < n; j++){
+		const xmr_subaddr_entry_t * e;
+		if (!valid[j] || (e = xmr_subaddr_table_find(st->table, packed[j])) == NULL){
+			continue;
+		}
+		if (st->match_count < st->max_matches){
+			xmr_scan_match_t * m = &st->matches[st->match_count++];
+			m->tx = st->key_tx[st->out_key[j]];
+			m->output = st->out_index[j];
+			m->major = e->major;
+			m->minor = e->minor;
+			memcpy(m->derivation, st->derivation[st->out_key[j]], 32);
+		}
+	}
+
+	memzero(buff, sizeof(buff));
+	memzero(hash, sizeof(hash));
+	memzero(s, sizeof(s));
+	st->out_count = 0;
+}
+
+static void xmr_scan_queue_output(xmr_scan_state * st, uint32_t key, uint32_t index){
+	st->out_key[st->out_count] = key;
+	st->out_index[st->out_count] = index;
+	if (++st->out_count == XMR_SCAN_BATCH){
+		xmr_scan_flush_outputs(st);
+	}
+}
+
+// 8aR of the queued keys, then every output they cover
+static void xmr_scan_flush_keys(xmr_scan_state * st){
+	ge25519 aR[XMR_SCAN_BATCH];
+	size_t k;
+
+	for (k = 0; k < st->key_count; k++){
+		xmr_generate_key_derivation(&aR[k], &st->R[k], st->view_priv);
+	}
+	ge25519_pack_batch(st->derivation, aR, st->key_count);
+
+	for (k = 0; k < st->key_count; k++){
+		const xmr_scan_tx_t * tx = &st->txs[st->key_tx[k]];
+		if (st->key_index[k] != UINT32_MAX){
+			xmr_scan_queue_output(st, k, st->key_index[k]);
+			continue;
+		}
+		for (uint32_t i = 0; i < tx->output_count; i++){
+			xmr_scan_queue_output(st, k, i);
+		}
+	}
+	if (st->out_count > 0){
+		xmr_scan_flush_outputs(st);
+	}
+	st->key_count = 0;
+}
+
+static void xmr_scan_queue_key(xmr_scan_state * st, const uint8_t * pub, uint32_t tx, uint32_t index){
+	if (!ge25519_unpack_vartime(&st->R[st->key_count], pub)){
+		return;
+	}
+	st->key_tx[st->key_count] = tx;
+	st->key_index[st->key_count] = index;
+	if (++st->key_count == XMR_SCAN_BATCH){
+		xmr_scan_flush_keys(st);
+	}
+}
+
+size_t xmr_scan_outputs(const xmr_subaddr_table_t * table, const bignum256modm view_priv,
+                        const xmr_scan_tx_t * txs, size_t tx_count, xmr_scan_match_t * matches, size_t max_matches){
+	xmr_scan_state st;
+
+	st.table = table;
+	st.txs = txs;
+	copy256_modm(st.view_priv, view_priv);
+	st.matches = matches;
+	st.match_count = 0;
+	st.max_matches = max_matches;
+	st.key_count = 0;
+	st.out_count = 0;
+
+	for (size_t t = 0; t < tx_count; t++){
+		if (txs[t].output_count == 0){
+			continue;
+		}
+		xmr_scan_queue_key(&st, txs[t].tx_pub, t, UINT32_MAX);
+		if (txs[t].additional_pubs != NULL){
+			for (uint32_t i = 0; i < txs[t].output_count; i++){
+				xmr_scan_queue_key(&st, txs[t].additional_pubs[i], t, i);
+			}
+		}
+	}
+	if (st.key_count > 0){
+		xmr_scan_flush_keys(&st);
+	}
+
+	memzero(st.view_priv, sizeof(st.view_priv));
+	memzero(st.derivation, sizeof(st.derivation));
+	return st.match_count;
+}
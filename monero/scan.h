@@ -0,0 +1,62 @@
+//
+// Output scanning for view-only wallets
+//
+
+#ifndef TREZOR_CRYPTO_SCAN_H
+#define TREZOR_CRYPTO_SCAN_H
+
+#include "xmr.h"
+
+// spend public key of one subaddress
+typedef struct xmr_subaddr_entry {
+	xmr_key_t spend_pub;
+	uint32_t major;
+	uint32_t minor;
+	uint32_t bucket;     // first entry of hash bucket k is entries[entries[k].bucket]
+	uint32_t hash_next;
+} xmr_subaddr_entry_t;
+
+// hash table of the subaddress spend keys of one account, the entries are
+// provided by the caller
+typedef struct xmr_subaddr_table {
+	xmr_subaddr_entry_t * entries;
+	uint32_t size;
+	uint32_t count;
+} xmr_subaddr_table_t;
+
+// transaction to scan, additional_pubs is NULL or has one key per output
+typedef struct xmr_scan_tx {
+	const uint8_t * tx_pub;
+	const xmr_key_t * additional_pubs;
+	const xmr_key_t * outputs;
+	uint32_t output_count;
+} xmr_scan_tx_t;
+
+// output that belongs to the account, derivation is 8aR of the transaction
+// key the output was found with
+typedef struct xmr_scan_match {
+	uint32_t tx;
+	uint32_t output;
+	uint32_t major;
+	uint32_t minor;
+	xmr_key_t derivation;
+} xmr_scan_match_t;
+
+void xmr_subaddr_table_init(xmr_subaddr_table_t * table, xmr_subaddr_entry_t * entries, uint32_t size);
+
+/* adds the spend keys of subaddresses (major, minor_begin) .. (major, minor_end - 1),
+ * returns the number of keys added, which is less when the table is full */
+uint32_t xmr_subaddr_table_add(xmr_subaddr_table_t * table, const ge25519 * spend_pub, const bignum256modm view_priv,
+                               uint32_t major, uint32_t minor_begin, uint32_t minor_end);
+
+const xmr_subaddr_entry_t * xmr_subaddr_table_find(const xmr_subaddr_table_t * table, const xmr_key_t spend_pub);
+
+/* checks every output of txs against the table, writes at most max_matches
+ * matches and returns their number. the matches of a transaction follow the
+ * ones of the previous transactions, outputs found with the transaction key
+ * come before the ones found with additional keys. keys and outputs that are
+ * not valid points are skipped. */
+size_t xmr_scan_outputs(const xmr_subaddr_table_t * table, const bignum256modm view_priv,
+                        const xmr_scan_tx_t * txs, size_t tx_count, xmr_scan_match_t * matches, size_t max_matches);
+
+#endif //TREZOR_CRYPTO_SCAN_H
@@ -8,18 +8,31 @@
 #include "rand.h"
 
 
+#if defined(ED25519_64BIT)
+const ge25519 ALIGN(16) xmr_h = {
+		{0x00073ab1dd861ec7,0x0007c9874ef11626,0x0001b6312b46107c,0x00059d702654201d,0x00008475cd301c3f},
+		{0x0004b8c33326feb4,0x000445cc14cf54b4,0x0001b3dd5318f5d5,0x00076bc162e578a1,0x00011043a74430a1},
+		{0x0001dd0124fde4d2,0x00016bb0ae2ca951,0x0004e53c4c7a36a5,0x0006b6e493c5385c,0x0002957e92b6c581},
+		{0x00017ba4da4517f7,0x00052c22abacf5d9,0x0004145d17363738,0x0003cfcb2760601e,0x00074f8f7dead2cd}
+};
+#else
 const ge25519 ALIGN(16) xmr_h = {
 		{0x1861ec7, 0x1ceac77, 0x2f11626, 0x1f261d3, 0x346107c, 0x06d8c4a, 0x254201d, 0x1675c09, 0x1301c3f, 0x0211d73},
 		{0x326feb4, 0x12e30cc, 0x0cf54b4, 0x1117305, 0x318f5d5, 0x06cf754, 0x2e578a1, 0x1daf058, 0x34430a1, 0x04410e9},
 		{0x0fde4d2, 0x0774049, 0x22ca951, 0x05aec2b, 0x07a36a5, 0x1394f13, 0x3c5385c, 0x1adb924, 0x2b6c581, 0x0a55fa4},
 		{0x24517f7, 0x05ee936, 0x3acf5d9, 0x14b08aa, 0x3363738, 0x1051745, 0x360601e, 0x0f3f2c9, 0x1ead2cd, 0x1d3e3df}
 };
+#endif
 
 
 void ge25519_set_xmr_h(ge25519 *r){
 	ge25519_copy(r, &xmr_h);
 }
 
+void ge25519_scalarmult_h_niels(ge25519 *r, const bignum256modm s){
+	ge25519_scalarmult_base_niels(r, xmr_h_niels_multiples, s);
+}
+
 void xmr_random_scalar(bignum256modm m){
 	unsigned char buff[32]={0};
 	random_buffer(buff, sizeof(buff));
@@ -27,35 +40,38 @@ void xmr_random_scalar(bignum256modm m){
 }
 
 void xmr_fast_hash(uint8_t * hash, const void *data, size_t length){
-	hasher_Raw(HASHER_SHA3K, data, length, hash);
+	keccak_256(data, length, hash);
 }
 
 void xmr_hasher_init(Hasher * hasher){
 	hasher_Init(hasher, HASHER_SHA3K);
 }
 
+// the hasher is always Keccak, so the updates go to it directly
 void xmr_hasher_update(Hasher * hasher, const void *data, size_t length){
-	hasher_Update(hasher, data, length);
+	keccak_Update(&hasher->ctx.sha3, data, length);
 }
 
 void xmr_hasher_final(Hasher * hasher, uint8_t * hash){
-	hasher_Final(hasher, hash);
+	keccak_Final(&hasher->ctx.sha3, hash);
 }
 
 void xmr_hasher_copy(Hasher * dst, const Hasher * src){
-	memcpy(dst, src, sizeof(Hasher));
+	dst->type = src->type;
+	dst->desc = src->desc;
+	memcpy(&dst->ctx.sha3, &src->ctx.sha3, sizeof(SHA3_CTX));
 }
 
 void xmr_hash_to_scalar(bignum256modm r, const void *data, size_t length){
 	uint8_t hash[HASHER_DIGEST_LENGTH];
-	hasher_Raw(HASHER_SHA3K, data, length, hash);
+	keccak_256(data, length, hash);
 	expand256_modm(r, hash, HASHER_DIGEST_LENGTH);
 }
 
 void xmr_hash_to_ec(ge25519 *P, const void *data, size_t length){
 	ge25519 point2;
 	uint8_t hash[HASHER_DIGEST_LENGTH];
-	hasher_Raw(HASHER_SHA3K, data, length, hash);
+	keccak_256(data, length, hash);
 
 	ge25519_fromfe_frombytes_vartime(&point2, hash);
 	ge25519_mul8(P, &point2);
@@ -101,6 +117,11 @@ void xmr_add_keys2_vartime(ge25519 * r, const bignum256modm a, const bignum256mo
 	ge25519_double_scalarmult_vartime(r, B, b, a);
 }
 
+void xmr_add_keys2_h(ge25519 * r, const bignum256modm a, const bignum256modm b){
+	// aG + bH, both from their tables
+	ge25519_double_scalarmult_base_niels(r, ge25519_niels_base_multiples, a, xmr_h_niels_multiples, b);
+}
+
 void xmr_add_keys3(ge25519 * r, const bignum256modm a, const ge25519 * A, const bignum256modm b, const ge25519 * B){
 	// aA + bB
 	ge25519 aA, bB;
@@ -132,5 +153,5 @@ void xmr_gen_c(ge25519 * r, const bignum256modm a, uint64_t amount){
 	// C = aG + bH
 	bignum256modm b={0};
 	set256_modm(b, amount);
-	xmr_add_keys2(r, a, b, &xmr_h);
+	xmr_add_keys2_h(r, a, b);
 }
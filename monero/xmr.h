@@ -7,6 +7,7 @@
 
 #include "ed25519-donna/ed25519-donna.h"
 #include "hasher.h"
+#include "xmr_h_table.h"
 
 extern const ge25519 ALIGN(16) xmr_h;
 
@@ -20,6 +21,9 @@ typedef struct xmr_ctkey {
 /* sets H point to r */
 void ge25519_set_xmr_h(ge25519 *r);
 
+/* sH, fixed base */
+void ge25519_scalarmult_h_niels(ge25519 *r, const bignum256modm s);
+
 /* random scalar value */
 void xmr_random_scalar(bignum256modm m);
 
@@ -54,6 +58,9 @@ void xmr_derive_public_key(ge25519 * r, const ge25519 * deriv, uint32_t idx, con
 void xmr_add_keys2(ge25519 * r, const bignum256modm a, const bignum256modm b, const ge25519 * B);
 void xmr_add_keys2_vartime(ge25519 * r, const bignum256modm a, const bignum256modm b, const ge25519 * B);
 
+/* aG + bH, G is basepoint, H the commitment generator */
+void xmr_add_keys2_h(ge25519 * r, const bignum256modm a, const bignum256modm b);
+
 /* aA + bB */
 void xmr_add_keys3(ge25519 * r, const bignum256modm a, const ge25519 * A, const bignum256modm b, const ge25519 * B);
 void xmr_add_keys3_vartime(ge25519 * r, const bignum256modm a, const ge25519 * A, const bignum256modm b, const ge25519 * B);
@@ -0,0 +1,261 @@
+#include "xmr_h_table.h"
+
+/* multiples of the commitment generator H in packed {ysubx, xaddy, t2d} form, generated by tools/mkniels H */
+const uint8_t ALIGN(16) xmr_h_niels_multiples[256][96] = {
+	{0x05,0x8d,0xe9,0x37,0xcc,0xd0,0x24,0x47,0x30,0xfb,0xb4,0x19,0x23,0x01,0x04,0x80,0xfb,0x3a,0x82,0xdb,0xc2,0xa8,0x78,0x4c,0x74,0xca,0x39,0x9b,0x92,0xee,0x96,0x32,0xfe,0x3d,0xc9,0xa8,0x5e,0x9d,0x0d,0x18,0x25,0xd9,0x04,0x26,0xc0,0x5a,0x9d,0x55,0xde,0xa9,0x20,0xcf,0xc0,0xff,0x25,0x07,0xe5,0x63,0x3a,0x7f,0x13,0x4b,0xa8,0x75,0xcd,0x70,0xcb,0x12,0x2c,0x90,0x2d,0x6a,0xa1,0x37,0xb4,0x6c,0xef,0x2f,0x90,0x34,0xc4,0x0f,0x3f,0x6a,0x3a,0xc8,0x61,0x8d,0x20,0xc3,0xdd,0xc0,0x1b,0x86,0x22,0x47},
+	{0x1a,0x44,0xe4,0x1b,0x46,0x2d,0xe3,0x5a,0x5e,0x83,0xa4,0x9e,0xf1,0x14,0xd1,0xc7,0xcd,0xdf,0x72,0x51,0x7d,0xb2,0x0e,0xb7,0xf7,0x82,0xc4,0xca,0x15,0x7b,0x23,0x62,0xf1,0x10,0xa5,0xf8,0x82,0x3a,0xe2,0x1c,0x1d,0x17,0x82,0x73,0x20,0xd5,0xee,0xd2,0x25,0x03,0xc6,0xe6,0x88,0xe8,0x6a,0xde,0xc3,0x02,0xd2,0xf8,0x8d,0x41,0xeb,0x42,0xcc,0x53,0x4f,0xbc,0x45,0x7d,0x5a,0xba,0x53,0x6f,0x84,0x9f,0xce,0x0f,0x4c,0xe4,0xe9,0x66,0xba,0xbb,0x0a,0xdf,0x19,0x00,0xd5,0x2f,0x3d,0x09,0x48,0x9c,0xec,0x2b},
+	{0x1c,0xdc,0x0e,0x40,0xe5,0x57,0x60,0xc3,0x30,0x63,0x30,0x85,0x2d,0x96,0xa6,0x97,0x16,0x60,0x4a,0x7f,0xd1,0x82,0x81,0x07,0x54,0x94,0x07,0x60,0x9c,0x9d,0xfe,0x2f,0xe1,0x64,0xc0,0x08,0xed,0xb0,0x1c,0x49,0x59,0x0d,0x43,0x19,0xde,0x7a,0x13,0xc2,0x7d,0xac,0x80,0x98,0x2c,0xbf,0xc3,0xde,0xff,0xd6,0x1e,0x52,0x1f,0x97,0x3d,0x21,0x72,0x84,0xf8,0x1d,0x37,0xae,0xa4,0x78,0x6c,0x34,0x1f,0x9e,0xfd,0x80,0x14,0x0c,0x4c,0x93,0x6f,0xfe,0xfa,0xc3,0xea,0x2c,0x33,0x7e,0xbb,0xb2,0x08,0x3f,0xfa,0x35},
+	{0x71,0xa4,0xf4,0xe5,0xad,0xbc,0xe4,0x0f,0x53,0x7f,0xe5,0xd7,0x4b,0x73,0x5b,0x3b,0x11,0x92,0xde,0xbf,0x65,0xe7,0x17,0xfb,0x1a,0x66,0xd8,0xbc,0x47,0x1a,0xd5,0x41,0xa0,0xa9,0xb8,0x73,0x40,0x66,0xe6,0x84,0x5b,0x67,0xe8,0x15,0xdd,0x67,0x46,0x2d,0x24,0x69,0x5e,0xbf,0x1c,0xe2,0x77,0x46,0x60,0x5f,0x63,0x74,0xb4,0x1e,0xba,0x79,0x34,0xff,0xcd,0xa0,0x90,0x1c,0x9c,0xe7,0xf8,0x66,0xf0,0x12,0xdf,0x46,0x3a,0x2c,0x40,0xb1,0x21,0xc9,0x4a,0x3e,0x10,0x26,0xfe,0xe6,0xd1,0x9e,0xa2,0xc7,0xb5,0x1a},
+	{0xc6,0xe9,0xd0,0x92,0x4c,0x38,0xb5,0x07,0x23,0x62,0x14,0xb8,0xc6,0x8a,0xfb,0x18,0x91,0x83,0x2d,0x38,0x54,0xbb,0x07,0x6a,0xe8,0x31,0x32,0x00,0xbf,0x20,0x5a,0x6e,0xbe,0x1b,0xa2,0x56,0x49,0xc4,0xc1,0x10,0x91,0xab,0x9e,0x7f,0x65,0xce,0xc4,0x95,0xf9,0x13,0x02,0x49,0xbc,0xe3,0xe0,0x99,0xb8,0x4b,0x77,0x00,0x5f,0x32,0xa9,0x51,0x34,0x43,0x2d,0xfb,0x08,0x7c,0xff,0x03,0x18,0xde,0xad,0x30,0x00,0x21,0x14,0x16,0x47,0x83,0x15,0x29,0x6c,0x5e,0xc6,0x2b,0x36,0x02,0x94,0xb9,0x4c,0x21,0x3e,0x24},
+	{0xc4,0x5d,0x18,0xf1,0xed,0x42,0xf8,0xc7,0xa1,0xf7,0xad,0xc6,0xf9,0xd5,0x8e,0xef,0x13,0x4b,0xe9,0xde,0x5b,0x8a,0xb2,0x68,0xa2,0xbb,0x7f,0x6c,0x35,0x12,0xfe,0x56,0x7e,0xc3,0x7e,0x3a,0x14,0x52,0x75,0xec,0x39,0x2d,0xc9,0x77,0x07,0xdf,0xee,0x89,0xe2,0xca,0x50,0xc1,0x57,0x3c,0x4a,0x5d,0x70,0xbe,0x6a,0xea,0x70,0xeb,0x25,0x48,0x52,0x96,0x70,0x7a,0x45,0xab,0x68,0x2f,0x69,0x15,0x22,0x68,0xab,0x63,0xc3,0x69,0x9a,0x7a,0x75,0xf2,0xa0,0xef,0xe8,0x1c,0x54,0xf2,0x0c,0xc5,0x63,0x3d,0x40,0x75},
+	{0x6b,0x33,0x8d,0xf2,0x0d,0xe2,0x3a,0x49,0xa8,0xce,0x14,0x02,0xae,0x61,0xa4,0x13,0x92,0xaf,0x2f,0x92,0x93,0xdf,0x49,0xb8,0xc4,0x8b,0x79,0x7d,0xaf,0x6f,0xdf,0x51,0x76,0x87,0x74,0xe6,0x10,0x6e,0xcb,0x90,0x58,0xfd,0x8e,0xb0,0xf9,0x6a,0x17,0x68,0xfa,0x3f,0x78,0xb2,0xa4,0x75,0xd3,0x89,0x4e,0x1d,0xba,0xbf,0xbe,0x15,0xc1,0x17,0x1e,0x38,0x68,0x07,0xfa,0xbe,0x56,0x3c,0xb9,0xe3,0x97,0x9f,0xe9,0xfa,0x3d,0x1c,0x69,0x59,0x11,0x65,0x70,0x35,0x2b,0xd4,0x99,0x00,0x5e,0x11,0xc0,0xa9,0xc6,0x22},
+	{0xe6,0x64,0x23,0x70,0xde,0xa3,0x20,0x63,0x28,0x03,0x92,0x48,0xf3,0x9c,0xca,0xbf,0xf2,0x11,0xe1,0x7d,0x53,0x77,0x53,0xac,0x42,0xe1,0x56,0xd6,0xc5,0x8b,0xb1,0x03,0x0a,0xd0,0x4f,0xb7,0xb8,0xee,0x67,0x90,0xa5,0xee,0x26,0x92,0xbb,0xab,0x66,0xa7,0xe2,0x97,0xa6,0x62,0x4c,0xaf,0x6a,0x77,0xd5,0xc6,0xf7,0x91,0x1f,0x9e,0xdc,0x6f,0xe9,0x42,0xb6,0x24,0xf5,0xa7,0xb2,0x5c,0x16,0x45,0x4b,0x8c,0x85,0x88,0x32,0x3d,0xcd,0x57,0x9e,0xa8,0x78,0xd3,0x99,0xa4,0xe1,0x89,0xec,0x0a,0x60,0x7b,0x9e,0x25},
+	{0x59,0x82,0xcd,0x76,0x71,0x86,0x46,0x6e,0x3b,0x57,0x94,0xb8,0xcc,0xb2,0xdc,0xec,0xa7,0x32,0xf5,0x99,0x42,0x6c,0x9b,0x20,0x50,0x42,0x7e,0xf8,0xfb,0xdf,0x68,0x13,0x47,0x33,0x43,0x56,0x77,0x39,0xd3,0x6e,0x02,0xf5,0x81,0x82,0x79,0x95,0xae,0x2c,0x7d,0x9c,0xcc,0xc6,0xeb,0xa0,0xff,0x38,0xcf,0x97,0xc5,0xac,0x93,0x72,0x2a,0x3c,0xda,0xe1,0xf2,0x18,0x71,0x1b,0x04,0x63,0x7a,0xad,0x5a,0x0c,0x59,0x98,0x50,0x4a,0x09,0x70,0xbf,0xde,0xbb,0xaa,0x2a,0x42,0xe4,0xe2,0x11,0x39,0xf7,0x99,0x1a,0x6a},
+	{0x3f,0xd8,0x0a,0x7e,0x92,0x5b,0x3d,0x52,0xb2,0x8b,0x9c,0x44,0x5c,0x9b,0x4c,0x51,0x9e,0x17,0xe4,0x7a,0x67,0x93,0xf3,0x8a,0x7d,0x35,0xd4,0x32,0xb6,0xad,0xe5,0x13,0x6b,0xc2,0x4a,0x2d,0x9f,0x1e,0xd2,0xe8,0xef,0x4b,0x5b,0x4a,0xa9,0xe0,0xed,0x2e,0x5d,0xd0,0x83,0xb5,0x61,0x5d,0x2c,0x30,0xde,0x8e,0xff,0xc9,0x87,0x15,0x22,0x47,0x06,0x9b,0x73,0xc4,0xe7,0xaf,0x08,0x0e,0x6e,0x92,0x77,0x05,0xf5,0xdd,0xb3,0xd4,0x0f,0x6e,0xa7,0xc9,0xd9,0x6f,0xa8,0xdb,0xa5,0x92,0xe0,0xcd,0x99,0x08,0xec,0x63},
+	{0x97,0xa0,0x81,0xd3,0x86,0x32,0x14,0xaa,0xff,0xa9,0xba,0x77,0xc3,0xef,0x7d,0x0d,0x06,0x38,0x36,0x7f,0x5c,0xc6,0x30,0x07,0xd9,0x42,0xb3,0xfb,0x5f,0xfe,0xf7,0x39,0x01,0xf6,0x43,0x73,0x55,0xcf,0x97,0x8a,0x4f,0xab,0xd3,0x96,0xd1,0xaa,0xaa,0x08,0xe4,0xf2,0x9e,0x5e,0x52,0xd3,0x46,0xa6,0x0e,0x36,0x49,0x0f,0xaa,0x07,0x30,0x0d,0x47,0xa3,0xc9,0xc5,0x97,0x91,0xcf,0x6b,0xca,0x68,0xd4,0x02,0xed,0xe7,0x0e,0xfb,0xcd,0x04,0x6e,0x47,0xb7,0xdb,0x3f,0xc9,0xe2,0xa7,0xe8,0x3c,0x27,0xba,0x01,0x56},
+	{0x3a,0x6e,0x12,0x41,0xdb,0x8e,0xd5,0x78,0x5b,0xfa,0x70,0x9b,0x5e,0xdd,0x67,0x02,0x46,0x62,0x0a,0xe8,0x75,0x39,0xc2,0xa7,0x08,0xbf,0x99,0xc4,0x9e,0xb7,0x05,0x5d,0x81,0x65,0xea,0xe9,0x59,0xa1,0xc9,0x32,0x88,0x5c,0x97,0xdb,0x6c,0x0a,0x36,0xac,0x21,0x70,0x85,0x96,0x20,0x98,0x18,0xa6,0xd4,0xaf,0x76,0xfa,0x94,0xf8,0x80,0x30,0x73,0x9d,0x0b,0x95,0xc5,0x53,0x27,0x47,0x87,0x1a,0x7d,0x91,0x2f,0x71,0x39,0x7b,0xfc,0x39,0x07,0x82,0x23,0x42,0xdc,0x27,0x29,0x26,0x98,0xf5,0x18,0xfa,0xc6,0x36},
+	{0xb8,0x78,0xc1,0x8b,0x70,0x7c,0xc5,0x9f,0xcd,0x5b,0x50,0xc7,0xb7,0xf3,0x12,0x8d,0x11,0x52,0x51,0x30,0x12,0x04,0xa8,0x0a,0x12,0xe3,0x43,0x11,0xbd,0xed,0x20,0x34,0xb6,0xe1,0x58,0x0e,0x78,0x12,0x79,0xfe,0x8e,0x11,0x87,0x1e,0x98,0xf3,0x66,0xb9,0x12,0xf4,0xc3,0x6b,0x4d,0x44,0xf3,0x34,0x89,0x41,0xd8,0xe4,0x89,0xbf,0x3c,0x4f,0xba,0x79,0x06,0xb5,0x36,0x5a,0xaa,0x8d,0xce,0x7b,0x20,0xba,0x7d,0xa0,0x3b,0x99,0x97,0xce,0x9b,0xad,0xb2,0x71,0x39,0x20,0xa4,0x60,0x23,0x4e,0x3a,0xb2,0x30,0x5f},
+	{0xf7,0xa4,0xea,0xb8,0x46,0x7a,0x4b,0x15,0xf3,0x96,0x3a,0x03,0xd0,0x1a,0x2b,0x17,0x9f,0x8e,0x33,0x9f,0x8e,0x96,0xc5,0x07,0xcc,0xc4,0x98,0xb4,0x14,0x18,0xec,0x28,0xf0,0xa0,0x21,0x55,0xb5,0x5a,0x8b,0x2e,0x11,0x39,0x35,0x28,0x84,0xbd,0x2f,0x02,0x06,0x7e,0x71,0x8c,0xe9,0xe6,0x49,0x55,0x15,0x68,0xd0,0x16,0x64,0x64,0x47,0x3e,0xab,0x24,0x02,0x22,0xda,0x89,0x17,0x1c,0x5a,0x2e,0x5d,0xdc,0x4d,0xcd,0x82,0x43,0x95,0x58,0x28,0x07,0xd8,0x5f,0xcd,0x9b,0x41,0xa1,0x69,0x3c,0x7e,0xbe,0x17,0x3b},
+	{0xd2,0x92,0xc0,0x64,0x35,0xcd,0x2a,0xc3,0xaa,0xb4,0xe4,0x46,0x64,0x34,0xc7,0xb0,0xa9,0x1b,0x6d,0x2e,0xe7,0xbe,0x74,0xa7,0xaf,0x6e,0x87,0x50,0xd3,0x56,0x9c,0x72,0x02,0xc8,0x5d,0x9f,0x16,0xc6,0x89,0x79,0xf3,0xbb,0x6a,0x1b,0x39,0x95,0xb9,0x1b,0x13,0x8c,0xb8,0x64,0xda,0xac,0x41,0xe1,0xd8,0xb0,0xa1,0x96,0xdf,0x57,0x65,0x33,0xd2,0x65,0x46,0x79,0x83,0x99,0x5b,0xf6,0x63,0xed,0xa4,0x7c,0xfd,0xa3,0xf3,0x01,0x61,0xf8,0xa4,0x3e,0x65,0xbb,0xd6,0x2a,0x74,0x15,0xda,0x6c,0x76,0x82,0x41,0x13},
+	{0x72,0x8e,0x4c,0x7b,0x66,0xde,0xb5,0x63,0x15,0x7b,0x28,0xb6,0x31,0xef,0xcd,0x0c,0xde,0xf7,0x99,0x28,0xf4,0x45,0xbd,0x88,0x96,0x84,0xfd,0x75,0x55,0xeb,0x6f,0x58,0x80,0xc7,0xe1,0x9b,0xf5,0x06,0x3b,0xef,0xfc,0x03,0x69,0xbf,0x8c,0x66,0x57,0x3c,0x0b,0x42,0x63,0x02,0x2f,0xd1,0xb9,0xeb,0xe2,0x33,0x02,0x5b,0xc0,0xad,0xab,0x36,0x11,0x65,0x04,0xd2,0x8d,0x8f,0x27,0xe3,0x95,0x84,0xcf,0x6d,0xe5,0xeb,0x0e,0x52,0x10,0x58,0x1c,0x6d,0xd8,0x70,0x05,0x59,0x76,0x1c,0x83,0x86,0x8c,0x14,0x2a,0x66},
+	{0x8c,0xe7,0xa9,0xdd,0x21,0x11,0x06,0x23,0xe4,0x68,0x7c,0xe5,0xb1,0xa7,0xb5,0xf7,0x1a,0x1f,0xca,0x71,0x9e,0x81,0x8f,0x05,0xbc,0x2e,0xcd,0xc3,0xcb,0xa1,0x63,0x53,0xae,0x0c,0xc3,0xd0,0x9a,0x33,0xe4,0x80,0x8f,0x95,0xbd,0xa5,0x6f,0x4c,0x72,0x12,0xf0,0x8e,0x0c,0x55,0x64,0x33,0x99,0xc3,0xa5,0xf6,0xb0,0xe5,0xe3,0xf2,0xf1,0x61,0xf9,0xd2,0x48,0x64,0x33,0xbb,0x2a,0xbc,0xd7,0x88,0xb3,0x96,0xe0,0xf2,0x55,0xb3,0x6d,0xc8,0x1b,0x42,0xc8,0xb6,0x85,0x96,0xbe,0x41,0x87,0x3b,0x11,0xe9,0x9b,0x10},
+	{0x83,0x82,0x8a,0x35,0x5d,0x75,0x26,0x4f,0xe0,0xdd,0xd1,0x17,0xf2,0xa9,0x5b,0x61,0x9f,0x36,0x76,0x80,0x82,0x6b,0x24,0x72,0x75,0xde,0xa7,0x04,0x9a,0xe2,0xbf,0x44,0x0a,0xd7,0x16,0xbf,0xaf,0x27,0x74,0xbc,0x45,0x17,0xfe,0x64,0x09,0x9d,0xca,0x24,0x85,0x6a,0xa7,0xff,0x8b,0x58,0x83,0x1e,0x7b,0xd4,0xbd,0x80,0x28,0x39,0x2c,0x7c,0x01,0x8c,0x25,0xf8,0xb4,0x13,0x06,0x9e,0xf2,0x51,0x8b,0xae,0x9a,0xae,0x74,0x69,0x8d,0xd9,0x58,0x8a,0xdf,0x0a,0x70,0x0f,0xa1,0x1a,0x91,0xb8,0x39,0xa7,0x3c,0x02},
+	{0x88,0xb5,0xf0,0xb7,0x4f,0x4b,0x68,0x27,0xfa,0x8f,0x34,0x8d,0x66,0x9e,0x84,0xe8,0xea,0xb7,0x02,0xeb,0x98,0xc0,0x40,0x3c,0x28,0x4d,0xf6,0x19,0xb3,0x19,0xcc,0x3c,0x33,0xd4,0x35,0x54,0x23,0xe3,0xdb,0x5e,0x91,0x06,0x6d,0x29,0xb2,0x81,0xd9,0x39,0x00,0x88,0xf1,0x45,0x66,0x6e,0x56,0x31,0xcb,0x1e,0x12,0xae,0x1a,0x5c,0xe4,0x60,0x4d,0x58,0x64,0xe5,0x1f,0x3a,0x58,0x00,0x00,0x55,0xc5,0x46,0x31,0x6c,0x9b,0x3a,0x49,0xf3,0xf1,0x84,0x98,0x48,0x28,0x84,0x44,0xf4,0xcf,0x8e,0x5c,0xd6,0x16,0x6c},
+	{0x0f,0x41,0xc2,0x48,0x73,0x02,0x00,0x66,0x6d,0xd2,0x35,0x90,0x36,0xbf,0xd2,0xb6,0x9b,0x94,0x4c,0x22,0x9b,0x65,0x01,0x06,0x7d,0x9a,0x1b,0xbc,0x6e,0xdb,0x6c,0x0c,0xdd,0x4c,0x47,0xce,0xc4,0xe0,0x8b,0x10,0xee,0xc5,0xbb,0x4d,0xf2,0x57,0xed,0x42,0x78,0x87,0x18,0xa4,0x86,0xcc,0xa9,0xd9,0x81,0x26,0xf4,0xbe,0x4c,0xfb,0x34,0x1c,0x64,0x60,0xa6,0xc9,0xb3,0x1b,0x17,0xa4,0xa1,0xce,0x6b,0x62,0x86,0x29,0x39,0x0d,0x06,0xeb,0x2f,0x43,0xb0,0x87,0x7d,0x96,0xa8,0xed,0xc3,0x43,0xdd,0x12,0xd0,0x43},
+	{0xbe,0xcf,0x8a,0xca,0x35,0xe7,0x43,0x6b,0x95,0x41,0x65,0x8b,0x04,0x09,0x13,0x90,0xfb,0xc2,0x16,0xd4,0xb8,0x96,0xec,0x87,0x31,0x94,0x63,0xb3,0x81,0x8a,0xb4,0x5b,0x47,0xfb,0xf3,0x51,0x3e,0x2f,0x8d,0x9e,0xaf,0x04,0xee,0x46,0xae,0xaa,0xf8,0x97,0x48,0xde,0x67,0x6f,0x98,0xe3,0x3f,0x06,0x15,0x75,0xfe,0x48,0x6d,0x77,0x5d,0x16,0x8f,0x6a,0xc0,0x25,0x51,0x71,0xb1,0x50,0xdd,0x22,0x2a,0x5a,0x42,0x9a,0xe4,0x2c,0xdc,0x9a,0x0c,0x10,0x86,0xe2,0xb9,0x6e,0x7a,0x7d,0x0e,0x27,0x5e,0xb0,0xff,0x6d},
+	{0xb8,0x2a,0x9c,0xfb,0xec,0xb6,0x2a,0x28,0xb8,0xb3,0x2e,0xb2,0xd9,0x7c,0x36,0x85,0x98,0x6e,0x5d,0x21,0x8c,0x0c,0x73,0x6b,0x09,0x1c,0x6a,0xea,0xcd,0x17,0x8f,0x41,0xb5,0x2d,0xc6,0xa6,0x91,0x64,0xb3,0x42,0x38,0xdd,0x2a,0x2c,0x1c,0xf2,0xd7,0xf5,0x9e,0x01,0xa1,0x2f,0xb5,0xa7,0x77,0x1e,0x5a,0xe1,0x49,0x23,0x51,0xa6,0xc2,0x72,0x05,0xe2,0x54,0x30,0xbf,0xdc,0x5f,0x39,0x11,0xe5,0xc6,0x98,0xc2,0x73,0xa5,0xac,0x26,0x16,0x4e,0x96,0xe2,0x8f,0x36,0xe3,0x1f,0x03,0x58,0xf2,0xd3,0x69,0xcf,0x06},
+	{0xaa,0x9f,0x1c,0x09,0x8c,0xbf,0xc9,0xa5,0x78,0xfa,0xea,0x92,0xfb,0x29,0x3d,0xdc,0x79,0x38,0xda,0x15,0x27,0x58,0xcb,0x7d,0x3c,0x31,0x2c,0x64,0xa9,0xe4,0xcd,0x77,0xf1,0x79,0xa6,0x0a,0xb3,0x0b,0xab,0xd6,0xfa,0xcb,0x02,0xd1,0x8c,0xfa,0x2e,0x65,0x1d,0x1d,0x7d,0xbd,0x3b,0xd6,0xd0,0xd7,0xd5,0x76,0x76,0x16,0x26,0x28,0x31,0x32,0x1c,0x09,0xd6,0x83,0xdc,0xfc,0x7f,0x59,0x65,0xbb,0x21,0x7a,0xdc,0x00,0xc3,0x3d,0x9c,0x50,0x96,0x13,0x68,0xa1,0xe9,0x57,0xf7,0x05,0x0d,0x8d,0xff,0x93,0x08,0x1a},
+	{0x58,0xdf,0x27,0x49,0x45,0x6c,0x78,0xdc,0x61,0xab,0xdd,0x91,0x34,0x25,0x58,0x5e,0x9c,0xe3,0x6f,0xf8,0xf8,0xcb,0x35,0x8e,0xc1,0x82,0xba,0x0c,0x95,0x77,0xd5,0x1e,0xf8,0x26,0x0d,0x1d,0x3b,0xa2,0xa3,0x85,0x55,0x64,0xa5,0xcb,0xd5,0x0a,0xc3,0x5f,0xca,0xee,0x6f,0x29,0xf8,0xa9,0x5a,0xa0,0xd0,0x66,0x87,0x3a,0xd0,0xd6,0xec,0x10,0x18,0x2c,0x60,0xa3,0xdb,0x50,0xb4,0x38,0x8f,0x7d,0x42,0x65,0xd2,0xa5,0x45,0x9d,0xfb,0x38,0xe9,0x75,0xa0,0x51,0xdb,0x0f,0xb8,0xd9,0x12,0xa9,0x05,0xa2,0xc5,0x06},
+	{0x4a,0xab,0xd3,0xe3,0x8e,0x4f,0x2b,0xe1,0x4d,0xcf,0x2b,0xc2,0x16,0x96,0x0b,0x00,0xf2,0x78,0x68,0x27,0xf6,0xa7,0xe9,0x54,0x64,0x33,0xdb,0x20,0x56,0xfe,0x45,0x32,0x31,0x0b,0x0a,0xe5,0x12,0x72,0xf1,0xdd,0xa2,0x9d,0x74,0xd0,0x9d,0xe0,0x52,0xa4,0xf4,0x11,0xbf,0x74,0xae,0x60,0xdf,0xa6,0x8f,0x9a,0x73,0x55,0xd7,0xc7,0xf7,0x23,0x5a,0xe4,0xa2,0xdd,0xb8,0xe2,0x0c,0x52,0xdf,0xb5,0x44,0x38,0x58,0x96,0x19,0x30,0xec,0x94,0x0e,0xa2,0xc4,0x90,0x72,0xf6,0x20,0x17,0x91,0x6d,0xc0,0x92,0x5f,0x49},
+	{0xfc,0xc8,0xad,0xa7,0x6e,0x49,0x2a,0xd4,0x45,0x62,0x7b,0x6d,0x1e,0xf4,0x8d,0x0d,0x63,0x80,0x20,0xa8,0xda,0xe3,0x13,0xe4,0x6e,0x4a,0xbf,0x46,0xe2,0x7e,0xf2,0x6b,0x20,0x24,0x05,0x4f,0x1d,0xfd,0xc6,0x26,0x89,0x32,0x55,0x62,0x44,0x00,0xb8,0x99,0xb9,0x00,0xdb,0x41,0xab,0x72,0x39,0xee,0x20,0xd9,0x35,0x6f,0x2f,0xa9,0xdc,0x66,0x99,0xfd,0x56,0x0f,0x0d,0x8a,0xcc,0x7e,0xb6,0xc7,0x49,0xd9,0xc8,0x40,0x6e,0x04,0x4b,0x05,0x70,0x85,0x4c,0x58,0x00,0x61,0x45,0x0d,0x83,0x5d,0xef,0x08,0xb0,0x74},
+	{0x57,0x49,0x0a,0x56,0x47,0xb1,0xcb,0x79,0x00,0x51,0x69,0xd8,0x48,0x08,0x4c,0x65,0xc9,0x34,0x0c,0xe5,0x1e,0x0e,0x68,0x3f,0x93,0x6c,0xa3,0x85,0xfe,0x3f,0xe9,0x30,0x5f,0xfc,0x31,0x11,0xb7,0x02,0xd8,0x8a,0xd7,0xcb,0x7d,0xe7,0x89,0x57,0x8a,0x28,0x8b,0x5b,0x30,0x63,0x76,0x80,0x9e,0x63,0x88,0x22,0xec,0x08,0xf6,0x0b,0x9e,0x70,0x7d,0xcf,0x6c,0xee,0x2c,0xd1,0xec,0x14,0x13,0xff,0x13,0x05,0xfd,0xce,0x69,0xe4,0x40,0xee,0xb4,0xc2,0x8a,0xb9,0x32,0x93,0x3d,0x44,0x24,0x6e,0xc1,0xd2,0xc3,0x2f},
+	{0xcf,0xe0,0x38,0x0c,0xc9,0x49,0x87,0xbf,0x63,0xcf,0xfd,0x81,0x13,0x04,0x5e,0xc3,0x1e,0x75,0xe5,0xae,0x2b,0xca,0xf9,0xb9,0xfd,0x1e,0x11,0x09,0x53,0xf6,0x58,0x48,0x7e,0x2b,0x65,0x27,0x4d,0xff,0x5e,0x78,0x04,0xc0,0xcf,0xe7,0xac,0xfc,0xf7,0xcb,0xe4,0x5a,0x6a,0xef,0x4b,0xf1,0xf0,0xa1,0xa0,0x2a,0x4c,0x2f,0x00,0x09,0xb9,0x3b,0xc1,0x6d,0x9d,0xbe,0x88,0xa1,0x07,0xb0,0xb7,0x33,0x6f,0x06,0xc1,0xb5,0x99,0x82,0x9c,0x23,0xd8,0xbc,0x56,0xe0,0x20,0xa7,0xd4,0x3b,0xfb,0x08,0xc3,0xc4,0xd6,0x66},
+	{0x4d,0x18,0xe8,0xb0,0x23,0x94,0x37,0xc5,0xab,0x3f,0xcb,0x7f,0xe6,0xe7,0x70,0x47,0xe8,0x10,0xc4,0xa7,0xb8,0xff,0xea,0x36,0xc8,0x32,0x81,0xa5,0x02,0xd0,0xd9,0x2b,0xce,0x7c,0x0a,0x69,0x59,0x2a,0x3a,0xe6,0xc8,0x6d,0x99,0x7d,0x3a,0x8e,0x85,0x43,0xd2,0x80,0x95,0x43,0x52,0xbc,0xf1,0xe3,0xd9,0x30,0x21,0x11,0x4b,0xf0,0xd2,0x5f,0xbf,0xd6,0x2c,0x70,0x3b,0xd0,0x8e,0x77,0xfe,0x1b,0x2a,0x12,0xc1,0xc3,0x25,0x13,0xbe,0x92,0x9d,0x52,0x8f,0x1b,0x8a,0xd6,0x41,0x45,0x62,0x4b,0x39,0x43,0xb3,0x70},
+	{0x4d,0x35,0x63,0xcc,0x82,0xca,0x32,0x26,0xa9,0xf8,0x14,0xa9,0x7c,0x33,0x2f,0x8b,0xbd,0x1e,0xaa,0x28,0x91,0x73,0x82,0x24,0x61,0xe3,0x9b,0xf6,0x42,0x04,0x76,0x52,0x72,0xc5,0x71,0xec,0xb4,0x1e,0x93,0xda,0xe2,0x2e,0xa6,0x75,0x7a,0xfe,0xf9,0xb7,0xb0,0x4d,0x9d,0x54,0x78,0xaf,0x27,0x35,0x9c,0x46,0xe6,0xf6,0xaf,0xd4,0x0b,0x05,0xda,0x0b,0x7d,0x7d,0xcf,0xfc,0xd9,0x39,0x5e,0x5e,0x22,0x83,0xda,0x22,0xda,0xdf,0x65,0x1d,0xd9,0x07,0x98,0x4b,0x50,0x13,0x69,0xa9,0xd8,0x5b,0xfa,0xd7,0xd6,0x52},
+	{0x3b,0xb8,0xcd,0x3c,0x7f,0xa2,0x8f,0x9f,0xc3,0x52,0x72,0x35,0x7b,0x1c,0x08,0x83,0x4a,0xb6,0xe4,0x6a,0x58,0xc2,0xd1,0xf2,0xed,0x03,0xd8,0x72,0x9d,0x92,0x37,0x32,0xf5,0xac,0x08,0xe3,0x2e,0x2d,0x9b,0x04,0x4e,0x8d,0x07,0x05,0xc5,0x2a,0x02,0x9d,0xc8,0x79,0x38,0xbd,0xa7,0x6b,0x5c,0x55,0x1e,0xd6,0xfa,0x29,0x04,0xad,0x2a,0x20,0x9e,0x00,0x48,0xaf,0xc3,0x05,0xd4,0x38,0x96,0xa6,0x20,0xd7,0xee,0x26,0x76,0xb6,0x53,0x27,0x4e,0x5c,0xfb,0x05,0xb6,0x72,0x2d,0x14,0x0f,0xd6,0xae,0x91,0x87,0x15},
+	{0x81,0xac,0x3b,0xe7,0x22,0xd5,0x5a,0xdc,0xac,0xdf,0xc2,0x0b,0xb7,0x74,0x69,0xb9,0x09,0x4b,0x9a,0xde,0x55,0xcd,0xa7,0xe3,0xbf,0x9b,0x1c,0x2e,0xcf,0x67,0x04,0x11,0x69,0x4f,0x46,0x91,0x49,0xfc,0x22,0x67,0xe1,0x7c,0xab,0xf2,0x43,0x8d,0x4b,0x5f,0xb7,0xbb,0x3a,0xb3,0xb0,0xa2,0xe9,0xc2,0x52,0xfd,0x60,0x4a,0x74,0x56,0xfc,0x42,0x9e,0x5c,0x1c,0x25,0x8e,0x63,0xfb,0xd9,0x72,0x1d,0x11,0x64,0x31,0x3d,0x3b,0xec,0xf4,0x4b,0x71,0x65,0xc6,0x8b,0xe8,0xd8,0x31,0x0d,0xe0,0x50,0x45,0x98,0x43,0x0e},
+	{0x3b,0xba,0x92,0x92,0xca,0x6d,0xcb,0xc3,0xf8,0x7c,0xb3,0xe6,0xdb,0x88,0xb5,0x29,0x26,0xc6,0x40,0x18,0x6d,0x2c,0x0a,0x3c,0xe6,0x88,0x37,0x91,0xec,0x59,0x73,0x46,0x3e,0xfd,0x44,0x14,0x49,0x87,0x2b,0xe0,0xc6,0x02,0x79,0xa2,0x7a,0xba,0xda,0xe1,0xf5,0x77,0xbf,0x57,0xdd,0x32,0xee,0x16,0xcf,0xf7,0x4f,0x2c,0xff,0x56,0x23,0x2f,0x27,0x3a,0xc5,0xab,0x48,0x5f,0x1c,0x39,0xae,0x39,0x05,0xa1,0x9b,0xaf,0xcd,0x26,0xba,0x13,0xd4,0xae,0xe9,0x24,0x2a,0xe6,0xbb,0x26,0x51,0x8e,0x84,0xb8,0x76,0x55},
+	{0xfe,0xfa,0x8a,0x1d,0x30,0xc0,0xba,0x43,0x65,0x20,0x07,0x04,0x99,0xeb,0x28,0xe3,0xc6,0x66,0xd3,0x09,0x5b,0xfa,0x3d,0xf3,0x34,0x68,0x84,0xde,0x8a,0x20,0x21,0x4b,0x17,0x38,0xdb,0x23,0x83,0x3e,0x9f,0x14,0x2c,0x5c,0xcb,0x74,0x10,0x50,0xb1,0x6b,0x61,0xc1,0xbb,0x18,0x2a,0x16,0x39,0xe2,0xa8,0x01,0xa2,0xed,0x2e,0x6d,0x82,0x0c,0x9c,0x92,0xdc,0x62,0x64,0xa3,0xfa,0x2e,0xc1,0xad,0x3b,0x94,0x04,0xfe,0xb0,0x3a,0x01,0x41,0x6e,0x8e,0xa7,0x9b,0xed,0x7d,0xd0,0xdf,0x22,0xc7,0xc8,0x50,0xeb,0x21},
+	{0x99,0x94,0x77,0xc0,0x37,0x48,0x3c,0x2d,0x85,0xbd,0x4f,0x22,0xf2,0x40,0xf1,0x83,0x50,0x7c,0xb1,0x48,0x17,0x47,0x6c,0x2a,0xe8,0xd7,0xdc,0x91,0xb7,0xde,0x51,0x57,0x42,0x3b,0xc3,0xdb,0x62,0xec,0x8d,0x4f,0x74,0x2a,0xd8,0x75,0x6b,0x1a,0xa5,0x5a,0x72,0x24,0x35,0x96,0xd4,0x96,0x4c,0xfd,0xb1,0xf2,0x32,0x48,0x54,0x51,0x61,0x54,0xaf,0xf9,0x29,0x6d,0xdd,0x55,0x77,0x33,0x98,0xba,0xcb,0x19,0xbe,0x39,0x3e,0x12,0xf7,0x7e,0x05,0xe8,0x10,0x24,0xa1,0x73,0xf6,0x25,0xe7,0x46,0x3a,0x66,0x28,0x23},
+	{0xf6,0xb4,0x9a,0xf0,0xea,0x8e,0x02,0x98,0x9a,0xde,0xa1,0x7d,0x59,0x28,0x98,0x11,0xf0,0xb4,0xfa,0xa1,0xce,0x6a,0x15,0x52,0xe6,0x18,0xf8,0x96,0x63,0xbd,0x39,0x70,0x17,0x43,0x17,0xf6,0xd4,0xff,0xfa,0x5d,0x36,0x0d,0x03,0x19,0x11,0xe3,0x68,0xf4,0x0f,0x01,0x04,0x8d,0x4a,0xae,0xb4,0x72,0x6d,0xb2,0x94,0xff,0x76,0x43,0xc8,0x48,0x0c,0x8f,0x36,0xf1,0x06,0x4e,0xcb,0xaa,0x3a,0x3d,0x88,0x66,0x20,0xdf,0xae,0xca,0xcc,0x90,0xf1,0xf8,0x7a,0xed,0xad,0x7f,0xf4,0xd4,0x37,0xfb,0xce,0x56,0x16,0x14},
+	{0x40,0x71,0xeb,0x23,0xea,0xae,0x57,0xbc,0xd2,0xe1,0xda,0xd7,0xdf,0xbe,0x58,0xad,0xc3,0x83,0x16,0x83,0xfa,0x5b,0x9e,0xb5,0x57,0x5d,0xdf,0xf1,0x86,0x2f,0xc9,0x7d,0xb2,0xc8,0x3d,0xaa,0xe6,0xf5,0x11,0x33,0xd8,0x6c,0xab,0x28,0xb6,0x75,0x31,0x1b,0xeb,0x15,0x93,0x94,0x52,0xb7,0x9f,0x4b,0x65,0x2f,0x48,0xc0,0x45,0xa9,0xbb,0x03,0x0a,0x65,0xa2,0x04,0xe2,0xd8,0x6b,0x79,0x7d,0xfe,0x76,0xf7,0xcf,0x4d,0x56,0x72,0xf2,0x76,0x79,0x0d,0x99,0x2d,0xc3,0xa0,0xa4,0xb6,0xb0,0xcc,0xb8,0xb2,0x18,0x52},
+	{0x40,0x67,0x34,0xef,0xf5,0x82,0xe8,0x6a,0x6b,0xa9,0xd6,0xc8,0x0b,0x02,0xb3,0x16,0x89,0xe1,0x9a,0x3a,0xea,0x86,0x65,0x2b,0x13,0x94,0x69,0xca,0x3a,0xa6,0x74,0x32,0xce,0x96,0x6f,0xec,0x67,0x44,0x76,0xdf,0x76,0x02,0xc1,0x9f,0xae,0x42,0x3f,0xcc,0xe4,0x91,0x2d,0x12,0x44,0xcc,0x15,0xbb,0x2a,0xb3,0x59,0xba,0x16,0x17,0x22,0x7f,0xe6,0x10,0xc3,0x9d,0x49,0x0f,0x07,0x65,0xb5,0xef,0xf1,0x9f,0xa4,0x06,0xd6,0x0f,0xc9,0xfb,0xac,0xf9,0x4d,0x79,0x00,0x78,0xf4,0x70,0x45,0x62,0x77,0xe4,0x07,0x2a},
+	{0x7c,0x1d,0x4f,0x08,0x1d,0x49,0x3c,0x1a,0xd9,0x10,0x82,0x42,0x13,0x84,0x85,0x02,0xc8,0xa1,0xaa,0xee,0x3e,0x69,0x73,0x44,0x16,0x98,0xa1,0x4e,0x6b,0x05,0x9e,0x69,0xd0,0xa0,0x06,0x5a,0x6b,0x19,0x6d,0xc5,0x6e,0x76,0x3a,0x89,0x82,0x47,0x08,0x12,0xd8,0x20,0x57,0x43,0xca,0x6a,0x49,0x6f,0xab,0x33,0x3f,0xed,0x35,0x09,0x3a,0x04,0x04,0xd9,0x86,0xd5,0xfb,0x38,0xa7,0xc4,0xb0,0x49,0x15,0xda,0xa8,0x96,0x4e,0x21,0x98,0x65,0x31,0x96,0x94,0xdd,0x74,0x61,0x1c,0x63,0x69,0xd7,0xc3,0x8f,0x66,0x51},
+	{0xb4,0xd9,0x30,0xf2,0x04,0xf6,0x24,0xbf,0xac,0x23,0xe3,0x0a,0x7f,0xf3,0x69,0x20,0x0a,0x0a,0x75,0x5c,0xa6,0x25,0x0a,0x77,0x93,0x87,0xd5,0x97,0x73,0xd5,0x5a,0x63,0x00,0xc1,0xf8,0xe4,0x74,0xb8,0xe1,0x33,0xd6,0xb1,0xce,0x3b,0x08,0xe5,0x35,0x7e,0xe9,0xbb,0x79,0x82,0x20,0x86,0x38,0x51,0x58,0xb9,0xeb,0x43,0x9d,0x21,0x00,0x0f,0x09,0x22,0xd1,0xd6,0x84,0x59,0x5a,0x7f,0xbd,0x3f,0x1b,0x3b,0x12,0xb2,0x8f,0x04,0x46,0xc5,0xd4,0x0e,0xd6,0x5f,0x77,0x56,0x0d,0x04,0x2a,0xb0,0xae,0x74,0xdc,0x78},
+	{0xad,0x16,0x01,0x27,0xe1,0x26,0x92,0xc9,0x67,0xae,0xcb,0x5a,0xbb,0xe1,0xa1,0x7b,0x35,0x02,0xc4,0xea,0x9c,0xf8,0x71,0xa1,0x6e,0x5d,0x78,0x14,0xa5,0x0f,0x63,0x43,0xfd,0xfe,0x8c,0x54,0xd8,0x23,0x95,0xc3,0x45,0x76,0x53,0x16,0xc9,0x1e,0x8d,0x7c,0xc2,0x48,0x41,0x1f,0xfc,0x8d,0x3e,0xe2,0x23,0x43,0x5a,0xc9,0xf1,0x71,0x57,0x43,0x18,0xee,0xea,0xfa,0x3f,0xe5,0x05,0x2c,0xdb,0x86,0x3e,0xf0,0x6a,0xb3,0x19,0x42,0x81,0x9c,0xab,0xd5,0x85,0x4a,0x90,0x3e,0xc2,0xd7,0xcc,0xba,0x25,0x19,0xa0,0x6c},
+	{0x40,0xd3,0xc4,0xcd,0xb6,0x9a,0xe3,0xd3,0xd1,0x2f,0x6c,0x60,0x1b,0x5e,0x02,0xfb,0xb2,0x56,0x21,0x8e,0xbc,0x5f,0xf5,0x9d,0xe2,0x12,0x59,0x7f,0x99,0x87,0x20,0x3c,0xbb,0x12,0xfe,0x4f,0x8c,0xe2,0xa5,0x28,0x64,0xfe,0x58,0x13,0x93,0x1a,0xf2,0xcc,0x16,0x7d,0x9c,0x64,0x99,0xdf,0x5f,0xdf,0x76,0x12,0x8f,0x27,0xc2,0xc5,0x0b,0x4c,0x7f,0xf1,0xbe,0x53,0x0c,0x5e,0xa5,0x8f,0x9b,0x29,0x85,0x23,0x2d,0x21,0x3e,0x27,0x73,0xf5,0x01,0x92,0x8d,0xd2,0xed,0x55,0x1c,0x13,0xf3,0x7e,0xff,0xb5,0xc9,0x28},
+	{0x9e,0x98,0xd4,0xb9,0x74,0x0f,0x25,0x48,0xf8,0x86,0xbc,0x77,0x69,0x61,0x2a,0xe6,0xe4,0xc0,0xbb,0x9a,0xb5,0x08,0xc3,0xa4,0x31,0x4e,0xd7,0x75,0xae,0xe8,0x36,0x0b,0xbb,0xb0,0x99,0xf3,0x96,0xd7,0x2d,0x9e,0x19,0x2f,0x1b,0x1f,0xb8,0xfd,0xf7,0x22,0x55,0x36,0x86,0x20,0x12,0x92,0x42,0x05,0xba,0x81,0xe2,0x9a,0x9f,0xd4,0x80,0x65,0x12,0x0f,0xe2,0x59,0xbb,0x9c,0x32,0x3e,0x43,0x45,0x2a,0x8a,0xda,0x32,0x36,0x61,0xc2,0xc3,0x16,0x0e,0xbb,0x01,0x98,0x32,0x99,0x39,0x4a,0x1d,0x9a,0xc7,0xb7,0x01},
+	{0x19,0xb6,0x78,0x82,0x83,0x27,0x98,0xe3,0xd7,0xa6,0x0f,0xb7,0x31,0x77,0x39,0xdb,0xac,0x83,0xec,0x8b,0x35,0xec,0xb6,0x7f,0x64,0x70,0x06,0x35,0xcf,0x85,0x02,0x0b,0xcc,0xa9,0xa4,0x75,0xcd,0xff,0xc8,0xc0,0x99,0x1c,0xab,0x7f,0x50,0xf7,0x5a,0xe8,0x4f,0xbf,0x65,0x72,0x29,0x2e,0x23,0x9e,0xfe,0xfd,0x9e,0xa0,0xe2,0x5d,0x8a,0x35,0xdd,0x96,0x4e,0x59,0xf6,0x34,0xb9,0x5f,0xfc,0x25,0xe6,0x4a,0x99,0x7a,0x34,0xdb,0x91,0xe1,0xc2,0xdf,0x9d,0x99,0x28,0xc9,0x54,0x1f,0x76,0x9d,0xc2,0x0e,0x81,0x2e},
+	{0xf2,0x09,0x54,0xe0,0xc3,0xa2,0xab,0xd4,0xca,0xb3,0x5d,0x77,0x30,0xcb,0x6e,0xae,0x3a,0xaf,0x40,0x41,0xb0,0xa3,0x37,0x60,0x7d,0xc6,0x78,0x59,0x98,0xe6,0xf2,0x09,0xc6,0x0f,0x6f,0x15,0x5e,0xf0,0xa9,0xe6,0xdb,0xb3,0x54,0x62,0xd6,0x81,0xe0,0xba,0x67,0x5e,0x80,0x28,0x39,0x7f,0x60,0x57,0xd0,0x26,0x26,0xbb,0x3f,0x54,0x54,0x33,0x5f,0x04,0x3b,0xee,0x73,0xa7,0xbd,0x55,0xdf,0xca,0xfc,0x8b,0xe3,0x23,0xac,0x92,0x6b,0x6f,0x53,0x2a,0x0c,0xbb,0xbe,0x1c,0xbe,0xd3,0xe2,0xc5,0x5c,0x7b,0x38,0x32},
+	{0x65,0x4f,0xd6,0xac,0xd2,0x93,0x96,0x82,0x50,0xbd,0x47,0xc0,0xcf,0x89,0x28,0xef,0x7a,0x6c,0xdc,0x84,0x91,0x1f,0xed,0xe9,0x4f,0x9f,0x2a,0x55,0x22,0x0a,0x6d,0x02,0x62,0x8c,0x4c,0x5d,0x61,0x8f,0x29,0xe3,0x45,0xef,0x01,0xff,0xb3,0xe5,0x2b,0x61,0x75,0xa0,0x9b,0xbb,0x42,0x2d,0xeb,0x4d,0x7f,0x9d,0xc4,0x73,0x53,0x9f,0x9f,0x33,0x97,0x51,0xf4,0xfe,0xbd,0x46,0x96,0xe1,0x4b,0x7d,0x14,0x91,0x86,0xcb,0xe9,0x94,0x93,0x43,0x3a,0xb6,0xdd,0x4d,0x03,0x19,0x77,0xb0,0x6a,0x94,0x74,0x83,0x3a,0x3a},
+	{0x35,0x11,0x41,0x2d,0xd2,0x3b,0x78,0x6b,0x1f,0x82,0xa3,0x97,0xf9,0x41,0xb7,0x56,0x7e,0x21,0x8b,0xdf,0x3a,0xce,0x77,0x19,0xfc,0xb4,0x67,0x41,0x1d,0x42,0x84,0x4b,0xc3,0xd9,0x63,0xfe,0x2e,0x7b,0x38,0x56,0x93,0x89,0x50,0x81,0xc5,0xe5,0xd4,0x64,0x88,0x81,0xe5,0x1e,0x75,0x86,0x60,0xff,0x91,0xea,0xc1,0x85,0x23,0x96,0xc0,0x43,0xf0,0x16,0x65,0x9b,0xde,0x33,0x16,0x04,0xde,0x78,0x59,0xc6,0x48,0x45,0x9e,0xef,0x43,0xb3,0xa4,0xb4,0x64,0x7d,0xdc,0xee,0x21,0x3b,0x3c,0x94,0xe9,0xda,0xb5,0x62},
+	{0x01,0xda,0x75,0x51,0x3c,0x9c,0x24,0x5f,0x29,0x4f,0x6b,0xae,0x0d,0xbd,0xe7,0xfc,0x6c,0xe8,0x99,0xca,0xff,0xb7,0x1a,0xe6,0xad,0x8b,0xc7,0xa9,0xea,0xcb,0x42,0x41,0x08,0x4b,0x14,0xb5,0xd6,0x61,0xfc,0xf2,0x16,0x40,0x18,0x74,0xef,0x2a,0x09,0x96,0xb4,0xcb,0xfe,0x16,0xcd,0x72,0xc0,0x43,0x78,0xeb,0x25,0x5d,0x99,0x80,0x07,0x36,0xc6,0x31,0x2a,0x90,0xa0,0x06,0x73,0x1d,0xd2,0x35,0x26,0x00,0xb3,0xf7,0x2c,0xd1,0x2d,0x03,0x45,0x7a,0xef,0xf1,0x16,0x11,0x56,0xa3,0xf6,0x76,0x5b,0x21,0xe2,0x51},
+	{0xb2,0xa9,0x03,0xd5,0xdc,0x2a,0x9b,0xe2,0x4c,0x2a,0xf9,0x08,0xe4,0x4f,0x44,0xaf,0x44,0xfd,0x9a,0x58,0xb6,0xbb,0xe5,0x6a,0x66,0x25,0xab,0x90,0x91,0x83,0xc6,0x1f,0x3d,0x5e,0x02,0x53,0x16,0xa0,0xaa,0x3b,0x6c,0x81,0x3f,0x71,0xeb,0xbf,0xf5,0xb9,0xdf,0xd6,0x96,0x7b,0xec,0x3c,0xb3,0x5c,0x62,0xb8,0x93,0x08,0x38,0x7a,0xaf,0x38,0xaf,0x50,0x10,0x25,0x4d,0x41,0x8b,0x85,0xca,0x20,0x57,0x4a,0x76,0x0e,0xc0,0x0f,0xae,0x35,0x6d,0x93,0x2f,0xab,0x8d,0xb5,0x55,0x64,0x6b,0x3c,0xa2,0x68,0x99,0x6a},
+	{0xda,0x21,0xc8,0x55,0x40,0x8d,0x68,0xb9,0x98,0x9f,0x08,0x56,0xf8,0x51,0x36,0x45,0x69,0xdf,0x9b,0x89,0x5c,0xd2,0x5b,0xd7,0x86,0xae,0x41,0x76,0xfd,0x57,0xc1,0x63,0x63,0x7d,0xa3,0x31,0x64,0x0f,0x96,0x4b,0xd9,0x41,0x83,0x02,0xb3,0x35,0x4e,0xf4,0x04,0x97,0xfc,0xac,0xd4,0x86,0xe5,0xc4,0x02,0x81,0x0a,0x45,0x6e,0x91,0xdb,0x44,0x7c,0x60,0xd4,0x85,0x2e,0xae,0x6b,0x5f,0x4e,0x1c,0x07,0x29,0xc4,0xaf,0x7e,0x85,0xa5,0x3d,0x85,0x14,0xdd,0x3a,0x99,0xfb,0x0b,0x1c,0xff,0x56,0xad,0x84,0xae,0x2e},
+	{0x57,0x1d,0xbe,0x97,0x81,0x41,0x8e,0xbb,0x14,0x7a,0x96,0x9d,0xeb,0x5a,0x1f,0x2a,0x39,0xec,0x57,0x92,0x00,0x4a,0x9c,0x53,0xbf,0x42,0x61,0x43,0xf1,0xe6,0xd5,0x2f,0x00,0x07,0x7d,0xfd,0x60,0x80,0x76,0x45,0x57,0x43,0x42,0xf0,0x81,0xeb,0xa6,0x75,0xd1,0x47,0x97,0xf3,0x5b,0x17,0xda,0x9c,0xb1,0xed,0x09,0xa1,0xa2,0x3a,0x9f,0x0d,0x92,0x22,0x39,0xa0,0x79,0x6d,0xaf,0x08,0x6c,0xb8,0x6f,0x25,0x29,0xa6,0x89,0x47,0x7f,0xa0,0xdb,0xc9,0x5a,0xb0,0x14,0xa3,0xb6,0xad,0x7c,0x99,0x54,0xb4,0x50,0x63},
+	{0xa9,0x2f,0x99,0x12,0x83,0xce,0x26,0x38,0x26,0x40,0x7b,0x8a,0xb9,0x37,0xfd,0x1c,0x57,0x5b,0xc2,0x65,0x48,0x74,0xba,0xa7,0x98,0x6a,0x76,0xfa,0x70,0x12,0xf1,0x36,0x7d,0x27,0x59,0x84,0x6d,0x6b,0xb6,0x7c,0xc5,0x61,0x50,0x8e,0x3e,0x5f,0x5d,0x08,0x2e,0x09,0xeb,0xe6,0x7d,0x89,0xa0,0x0d,0xb6,0x52,0x1a,0x93,0x2c,0x00,0xc9,0x68,0xee,0x79,0xd6,0x43,0xf0,0x4b,0xd9,0xc3,0x11,0x54,0x59,0xae,0xb3,0x27,0x56,0xa9,0xb4,0xf8,0xc5,0x47,0x0d,0x51,0xcf,0x21,0x77,0x29,0x01,0x54,0x97,0x00,0xd0,0x37},
+	{0x16,0xf7,0xbe,0x45,0xc2,0x27,0x60,0x1c,0x4d,0x66,0x13,0xa7,0x24,0x2c,0x55,0xd8,0x66,0xb8,0x3e,0x36,0x4e,0x8a,0xe9,0x0c,0x79,0xe8,0xf5,0x78,0xdb,0x52,0x31,0x7e,0x3c,0xd0,0x08,0xe5,0x9f,0x07,0x88,0xdb,0x28,0xbb,0x41,0x05,0xc5,0xf4,0x1a,0x4e,0xa8,0x35,0xe1,0x2d,0xdb,0x21,0x30,0xe2,0x23,0xc9,0xcb,0x87,0x6e,0xed,0x7b,0x1f,0x9d,0x3e,0xde,0x9b,0xd4,0xcd,0xa1,0xbe,0xa8,0x1d,0xdf,0x57,0x4f,0xd7,0xd5,0x7f,0x30,0x96,0x6f,0x00,0x54,0x09,0x72,0x9e,0xf5,0x1e,0x4a,0xc1,0xc6,0x27,0x13,0x11},
+	{0x0b,0x67,0x9a,0xf4,0xfc,0xf4,0xbf,0x70,0x07,0xa4,0xaa,0xe0,0xcc,0x41,0xc8,0x68,0xdb,0x81,0xdc,0x6c,0xf1,0xdd,0xb5,0xd0,0x41,0x1f,0x64,0x2d,0xaa,0x80,0xb4,0x4c,0x27,0x43,0xc5,0x2e,0x74,0x71,0x17,0x97,0x2e,0x60,0x75,0xf4,0x39,0x04,0x3f,0x92,0xdc,0x8b,0x86,0x33,0xa9,0x59,0x67,0x3e,0x81,0xf8,0xaa,0x39,0x2d,0x6d,0x9f,0x02,0x9b,0x40,0x8c,0xa6,0x20,0xdf,0x25,0x0c,0x36,0x58,0x84,0x22,0xcf,0x98,0x68,0xc4,0x05,0x3e,0x0c,0xe1,0x82,0xf1,0x35,0x9e,0xf3,0x9a,0x1a,0xbf,0xa8,0x93,0x2c,0x77},
+	{0x61,0x5b,0xc3,0xf9,0x81,0x10,0xae,0xc8,0xb0,0xdc,0xa3,0x33,0xa5,0x90,0xba,0x2b,0xf4,0xaf,0xa0,0x56,0xab,0x03,0x9f,0x6a,0xc6,0x68,0x75,0x15,0x06,0xde,0x2f,0x16,0xa3,0x7c,0x5b,0xe8,0x03,0x28,0x12,0x5e,0xfd,0x29,0x69,0x6c,0x4f,0x6f,0x01,0xa5,0xc0,0x7e,0xb7,0xc9,0x65,0xb5,0xdd,0xaa,0x59,0x29,0x6b,0xe5,0xeb,0x9f,0xd2,0x67,0xb8,0xcd,0x3d,0x80,0x49,0x15,0x6d,0x66,0x70,0x61,0x05,0x5e,0x17,0xd8,0xf5,0xe4,0x6d,0x52,0x81,0x7b,0x60,0x3f,0x02,0xb2,0x30,0x26,0x70,0x5d,0xee,0xda,0xef,0x7a},
+	{0xac,0xa3,0x0b,0xab,0x57,0x23,0x98,0x86,0x3f,0xd0,0xd2,0x32,0x73,0xe2,0xf0,0xdf,0x67,0x35,0xd5,0x7b,0xfe,0x68,0x41,0x37,0xfa,0xd6,0x01,0xf0,0x63,0x41,0x7b,0x22,0x93,0xbe,0x0d,0x43,0xe1,0xa7,0x07,0x59,0x74,0xbe,0x10,0xe8,0xe8,0xed,0x97,0x5c,0xe4,0xbf,0xc2,0x55,0xd4,0x02,0xae,0x74,0x6d,0x85,0x15,0x7e,0xb9,0x0f,0x03,0x0d,0x69,0xc4,0x18,0xf7,0x90,0xff,0x32,0x72,0xf7,0x74,0x5a,0x9e,0x93,0x59,0x27,0x04,0xfc,0x81,0x2a,0x82,0x93,0x03,0xc5,0x9a,0x9c,0x50,0xaf,0x8e,0xd3,0xaf,0xf3,0x0c},
+	{0x51,0xeb,0x40,0xfd,0x41,0x97,0xe5,0x5d,0x76,0x2a,0xc0,0x57,0xb3,0x85,0x19,0x0e,0xa7,0x54,0xfd,0xca,0xa8,0x33,0xce,0x85,0x10,0x5e,0xdc,0xe1,0x56,0x69,0x3e,0x07,0xbe,0x55,0xcf,0xc5,0xc8,0x43,0x63,0xfb,0x9f,0x3e,0x15,0x93,0x1b,0x6b,0x0c,0x18,0x1d,0x5e,0xfa,0x7e,0x83,0xaf,0x95,0xc2,0x44,0xc3,0x52,0xbc,0x16,0x6f,0x80,0x16,0x09,0xe3,0x3c,0xa4,0xd3,0x01,0xa5,0x26,0x90,0xae,0xd2,0xee,0x6e,0xc7,0x9a,0xfa,0x7b,0x31,0x3e,0xcc,0xa9,0x84,0x3f,0x6b,0xe2,0x19,0x51,0xdb,0xb4,0xe0,0xef,0x49},
+	{0x5f,0x4a,0xbe,0x2e,0x92,0x58,0x5c,0x66,0x59,0x34,0xd4,0x80,0x3b,0x82,0xa7,0x5c,0x95,0x99,0xaf,0xbc,0xbc,0x76,0x01,0xb8,0x10,0xe2,0x85,0xf8,0xf6,0x03,0x95,0x7f,0x57,0x7e,0x18,0xd0,0x43,0x4a,0xc5,0x9b,0x70,0xd2,0x1f,0x8a,0x70,0x80,0x2c,0xa9,0xd4,0x7e,0x6f,0xc5,0x4d,0xa7,0x38,0x45,0x69,0x48,0x33,0x9f,0xb0,0x0d,0x61,0x41,0x22,0x4b,0x2b,0x8a,0x26,0xf6,0x9d,0x73,0x7d,0x8b,0x83,0x19,0xe5,0xab,0xd7,0x1f,0xcb,0xd8,0x89,0xdd,0x25,0xb1,0x31,0x15,0x05,0x4d,0xbc,0x28,0x04,0x93,0xa7,0x52},
+	{0x21,0x00,0xe7,0xd1,0xb2,0xde,0xf4,0xf9,0x82,0xcf,0x53,0x91,0xd2,0x06,0x4a,0x90,0x72,0x31,0x06,0x0b,0x05,0x92,0x11,0x40,0xee,0xfa,0x90,0x1f,0x90,0x0d,0x85,0x1b,0x65,0x45,0x74,0x27,0xa0,0x71,0x6f,0x25,0x59,0xfa,0x64,0x86,0xf6,0x72,0xbc,0x72,0xca,0xe6,0xb3,0x58,0xf2,0x53,0x9c,0xfb,0x0a,0x91,0x9f,0xc0,0x39,0xad,0xcc,0x36,0x89,0xf9,0x56,0x58,0xf1,0x57,0xed,0x43,0x63,0x3d,0xe0,0x9f,0xef,0x5b,0x77,0x38,0x00,0x77,0x89,0xc0,0x71,0x00,0x56,0xda,0xc1,0x48,0x9f,0x5c,0x07,0xdf,0xea,0x0d},
+	{0xd0,0xaa,0xfa,0x94,0x19,0xd9,0xfe,0x6b,0xa4,0x1b,0x40,0xe0,0x87,0xe6,0x94,0x2e,0x60,0x9f,0x91,0x53,0xfc,0x57,0x30,0x7f,0x61,0xc7,0x0e,0xf3,0x8b,0x0f,0xd9,0x79,0x05,0x30,0x40,0x03,0xe4,0xcc,0xe2,0x93,0x99,0x0a,0x4a,0x5d,0xd2,0xb9,0x15,0x37,0x26,0x4b,0x65,0x58,0x83,0xa1,0x20,0xd6,0xb0,0x9b,0xf5,0x27,0x75,0x2b,0xad,0x5c,0xea,0x6a,0x0a,0xe2,0xef,0x58,0x86,0x62,0x33,0x0a,0x09,0xbc,0x49,0xc6,0x65,0xf9,0xe5,0x81,0x21,0x7b,0x5c,0x21,0x21,0x3c,0xf5,0x34,0x75,0x51,0xd0,0xad,0x71,0x12},
+	{0xd6,0x95,0x2c,0x4d,0x21,0x3f,0x16,0xe9,0x24,0x48,0xb5,0x9f,0x0e,0x13,0x08,0xcf,0x23,0x41,0x7e,0x9c,0x92,0x92,0x59,0x4c,0x5d,0xdf,0x5a,0x9c,0x29,0x6d,0x5c,0x53,0xff,0xc1,0x74,0x97,0x33,0x7c,0x2a,0x7e,0xc3,0x51,0x6f,0x42,0x04,0xb0,0x97,0xf2,0xd4,0x76,0x8a,0xab,0x9b,0x19,0x2f,0xc7,0x26,0xa3,0x57,0x62,0x74,0x8e,0x43,0x25,0xf3,0xab,0xfe,0x33,0xde,0xc7,0x31,0x01,0xcc,0xc0,0x3b,0xc8,0xfd,0xbc,0x4d,0x96,0xdf,0x99,0x7f,0xba,0xd9,0x21,0x4f,0x92,0x81,0xd8,0xcd,0x05,0xcf,0x4a,0x4a,0x49},
+	{0xbb,0xca,0x19,0x6e,0xab,0xf7,0x38,0xc9,0x6a,0xd6,0x93,0x83,0x17,0x7b,0x86,0x6c,0xc0,0x5a,0x4f,0x62,0x14,0x0f,0x27,0x40,0x92,0xb5,0xe8,0xd3,0x6d,0xf2,0x23,0x2b,0x18,0xb4,0x9c,0x20,0x6e,0xaf,0xb7,0xa5,0x92,0x85,0xe0,0xa7,0x06,0x8b,0x4e,0x49,0x19,0x57,0xe4,0x43,0xd9,0x0b,0xcc,0x45,0xf7,0xf3,0x80,0xf9,0xbe,0x63,0x84,0x17,0x7a,0x29,0x21,0x7e,0xe6,0xdf,0xdb,0x0a,0x4e,0x5a,0x7d,0x38,0x7c,0x2d,0x51,0x76,0x8a,0xb1,0xe6,0x33,0x4c,0xcf,0xb2,0x71,0x20,0x65,0xcc,0x88,0x7c,0x88,0xab,0x63},
+	{0x79,0x83,0x73,0xe5,0x82,0xec,0x4a,0x9d,0x0e,0xf2,0x3c,0xc7,0xd6,0xdc,0x22,0xeb,0x50,0xcb,0xc4,0x90,0x0f,0x7c,0xf5,0xe6,0xef,0x7d,0xc7,0x4f,0x89,0x13,0xbe,0x77,0x63,0xd2,0x04,0x78,0x75,0x71,0x17,0xd3,0x16,0x85,0x9e,0xe2,0xc4,0x90,0x03,0x2b,0x9b,0xb6,0x39,0x18,0x84,0x1d,0x32,0xd5,0x6c,0xd1,0xb5,0xdb,0xd2,0xb2,0x9e,0x68,0x36,0xe0,0xa8,0xb7,0x7d,0x8e,0x16,0x57,0xe0,0x3e,0x0a,0x20,0xa7,0xfd,0x81,0x18,0x84,0xdb,0xa7,0xf7,0x21,0x03,0x93,0xbe,0x5d,0xf1,0x01,0x4d,0x33,0x0c,0xe6,0x1b},
+	{0x3e,0x51,0xce,0x1f,0xb0,0x2c,0x4a,0xdd,0x1d,0x24,0x45,0xca,0xc5,0xec,0xa3,0x50,0x5d,0x1b,0x28,0x6e,0x0c,0xcb,0x0f,0x47,0xd4,0x94,0xe6,0x2e,0x52,0xdf,0xa1,0x14,0x58,0xe0,0x54,0xfa,0xe3,0xa9,0x28,0x1e,0x27,0xd8,0x16,0xaf,0x13,0x2e,0x6e,0x10,0x2d,0xd6,0xd1,0x33,0x0a,0x94,0x7a,0x20,0xd3,0xbb,0xbd,0xa8,0xbe,0xd7,0x91,0x47,0x2f,0x73,0xe8,0xb3,0x99,0xef,0x0e,0x55,0x7e,0x37,0xca,0xe4,0x60,0x3a,0xf0,0x83,0x1b,0x6e,0x6a,0x15,0x39,0x16,0xe3,0x4b,0x36,0x35,0xb5,0x91,0x2c,0x4e,0xbe,0x50},
+	{0xda,0xca,0x6b,0x63,0x0a,0x36,0x44,0x2b,0x28,0x8d,0x32,0xa8,0x70,0x34,0x3f,0xf7,0x42,0x1d,0xb7,0xf1,0x64,0xea,0x36,0xa6,0x06,0xa6,0xc9,0x04,0x72,0xc8,0xe8,0x1a,0x9d,0x08,0xf1,0x4c,0x98,0x85,0x8f,0xb4,0xa0,0xd6,0x25,0xf4,0x27,0x09,0x92,0x0d,0xed,0x5a,0x64,0xea,0x41,0x66,0x81,0xf1,0xd7,0xf8,0xb9,0x6a,0x10,0x4f,0xf2,0x74,0x55,0x8a,0x25,0x7d,0x2b,0x77,0x13,0x04,0xc5,0xd3,0x4e,0x15,0x6d,0x6d,0x8e,0x2e,0x62,0xdd,0xd1,0x90,0xc0,0x7a,0xd7,0x40,0x7b,0xc8,0x15,0x8b,0xc2,0xe2,0xe6,0x01},
+	{0xa2,0x4c,0xdc,0x28,0x98,0x6b,0x7a,0xd6,0xf8,0x61,0x03,0x27,0x2a,0x25,0x1e,0xfe,0xe6,0x58,0x69,0xa7,0x9d,0x65,0xfb,0x8f,0xb6,0x3a,0x2c,0x44,0xa5,0x72,0x2e,0x7a,0x7b,0xa8,0xbd,0x74,0x5e,0xe1,0xd8,0x41,0x3b,0x94,0x4e,0x76,0x68,0x64,0xd2,0xde,0x56,0xf6,0x56,0x33,0x69,0x72,0xb4,0xdb,0xe4,0x44,0x6e,0xe1,0x07,0x0c,0x35,0x5d,0x32,0xf9,0xd3,0x8f,0xf0,0x80,0xb8,0xf6,0xd7,0x61,0xd8,0x90,0x04,0x5e,0xc4,0x45,0x2d,0xfe,0x0f,0x08,0x39,0xd1,0x47,0x1c,0x84,0x64,0xdc,0xcb,0xbb,0xed,0x68,0x76},
+	{0x20,0x42,0xf5,0xb7,0x96,0x47,0xc3,0xf7,0xc1,0x10,0x6b,0x05,0x2f,0x2a,0x1a,0xb4,0x81,0xc6,0x33,0x2d,0xd3,0xea,0xf2,0x9e,0x74,0x34,0x5f,0x48,0x8b,0x78,0x3a,0x4e,0x18,0xf3,0x4d,0x4e,0x8b,0x21,0x96,0xe8,0xba,0xb7,0xc1,0x72,0xd0,0xa9,0x7e,0xd7,0x1f,0xc6,0xed,0xbb,0xa2,0x40,0xf6,0xed,0xfa,0x8e,0x73,0x76,0xb9,0x00,0x26,0x54,0x6c,0xd3,0xea,0xd4,0xb4,0x43,0xd6,0xe5,0xb3,0xd9,0x50,0xfb,0xd9,0x4d,0x2f,0x77,0x87,0xaa,0xd6,0x0f,0xb6,0x52,0xd7,0xe8,0x8a,0xff,0xa4,0x46,0xdd,0x53,0x9f,0x5e},
+	{0xac,0x9a,0x00,0xa2,0xa9,0xbe,0x02,0x29,0x5b,0x9e,0x6c,0x01,0x46,0x21,0x60,0xe6,0xd4,0x29,0xbe,0x97,0xe0,0xc3,0x76,0xc3,0x42,0x84,0xe3,0xc0,0x29,0xc4,0x31,0x4a,0x5b,0x2d,0x3d,0xe2,0x20,0xa5,0x8e,0x38,0x0f,0xb9,0x9b,0x51,0xc5,0xee,0xf6,0x5d,0x62,0x73,0x05,0x97,0xd2,0xd6,0x1f,0xfc,0x2c,0x93,0x24,0x20,0x33,0x31,0x4b,0x27,0x7c,0xf3,0x56,0xd6,0x09,0x72,0x14,0x4c,0xeb,0x48,0xeb,0x11,0x9b,0x5e,0x97,0xbc,0x8e,0xe2,0xed,0x12,0xf5,0x69,0xca,0xb4,0x3d,0xeb,0x43,0xc6,0x34,0x7d,0xf1,0x7f},
+	{0x37,0xef,0x7c,0x29,0x1c,0x94,0xfa,0x54,0xca,0x64,0xc7,0xc9,0x7b,0x72,0xd3,0x1b,0x88,0x22,0xb9,0x74,0x1e,0x86,0x42,0x9b,0x8f,0xb8,0x10,0x55,0x5a,0x99,0xd1,0x76,0xee,0x47,0x7d,0x47,0x1c,0x61,0xed,0x94,0x58,0xfc,0x13,0xd4,0x78,0x1e,0x23,0xe3,0xb7,0x01,0xf2,0x8f,0xc2,0x90,0x0a,0x30,0x9b,0xcd,0xed,0x38,0x18,0x53,0xb0,0x2a,0x90,0x81,0x6e,0x8e,0xeb,0x38,0x89,0x3d,0x1c,0x3b,0x32,0x9f,0x12,0x5f,0x5b,0x58,0x84,0x7a,0x41,0x8c,0xb6,0xeb,0x42,0xb7,0x5f,0xf7,0xea,0x3e,0x9e,0xa3,0x6c,0x58},
+	{0x29,0xba,0x5a,0x4d,0xc6,0x18,0x8a,0x35,0xb0,0x3c,0x22,0x1b,0x68,0x93,0x89,0x47,0xfc,0xeb,0x7b,0x2d,0xc7,0x9e,0x0b,0xcf,0x46,0x54,0x95,0xa1,0x22,0x2d,0x77,0x28,0xd2,0xac,0x4e,0x76,0x72,0x68,0xfc,0xd6,0x9f,0xe0,0x9c,0xfb,0x1c,0xfe,0x49,0x24,0x6b,0xfa,0x45,0x12,0xf4,0x16,0xdf,0xfd,0x3a,0x08,0xdb,0xb7,0xaa,0x1b,0x60,0x2b,0x0b,0x70,0xc3,0xae,0x8a,0x6c,0x5f,0x51,0x7e,0x18,0xb9,0xf2,0xae,0x76,0x5d,0xa8,0x62,0xbb,0x4e,0x30,0x48,0x84,0xaf,0x02,0xc0,0x1f,0x35,0xcb,0x70,0x07,0xd2,0x28},
+	{0x9b,0x9e,0xe4,0xc7,0x55,0xb5,0x18,0x5c,0x8a,0x9c,0xd6,0xaa,0x45,0x89,0x9b,0x5c,0xd1,0x74,0x64,0xc1,0x68,0x09,0x45,0xd7,0x71,0xad,0x44,0x50,0x83,0x2c,0x83,0x7c,0x5c,0xad,0xcf,0xef,0x2b,0xd4,0xc5,0xcd,0xcd,0x51,0x04,0xa7,0x6c,0x89,0x14,0x96,0x23,0xdf,0x2a,0x37,0xa5,0x69,0x20,0xd7,0xdc,0x58,0xb5,0x75,0xba,0x42,0x83,0x3f,0xc3,0xd3,0x0c,0x7e,0x10,0xe2,0x9f,0xee,0x02,0x2e,0x3c,0x18,0xb8,0xb4,0xc5,0xf1,0xdf,0x09,0xd3,0x76,0x72,0xe4,0xa2,0x15,0x23,0xb0,0x1c,0x9a,0x31,0x87,0xbc,0x65},
+	{0x1e,0x61,0xf5,0xe9,0x0f,0xa8,0x6f,0xf5,0x26,0x73,0xb5,0x9f,0xcb,0x4b,0xce,0x5f,0x9d,0x36,0x40,0x0d,0xba,0x69,0x3d,0xdc,0x6a,0xac,0x53,0xf7,0x8e,0x68,0x01,0x16,0xeb,0x95,0x18,0xd7,0x1f,0x1a,0x3e,0xa7,0x52,0x2d,0xbe,0x9f,0x59,0x8d,0x30,0xf3,0xc8,0x08,0xed,0x6c,0x2b,0x33,0xa9,0x39,0x39,0xea,0x55,0x7f,0xd2,0xe3,0x0d,0x4e,0xb7,0x08,0xd6,0x69,0x5b,0x84,0xfa,0x29,0xff,0xae,0xa3,0xd5,0x36,0xcb,0x18,0xa6,0xc0,0xdb,0xaa,0xd0,0x31,0x99,0x11,0x70,0xa5,0x5d,0x9a,0x43,0x7f,0x5b,0x76,0x3d},
+	{0x2a,0xf7,0x02,0xdc,0xfc,0xac,0x28,0x22,0x4e,0x2a,0x9d,0x1e,0xc1,0x6b,0x6d,0xe0,0x5a,0xc0,0xed,0x39,0x00,0x9a,0xb3,0xee,0xf2,0x38,0x25,0xa9,0x5d,0x03,0x52,0x3b,0x3f,0x85,0x65,0x12,0x63,0x83,0x72,0xa0,0x0b,0x1f,0xca,0xc3,0xfb,0x74,0x7a,0x8f,0xec,0xb7,0x79,0xdd,0xb7,0xb5,0xed,0x21,0x3b,0x53,0x03,0x3a,0x63,0x3c,0x8c,0x72,0x2c,0xe5,0xcc,0xd0,0x0e,0xc6,0x32,0x4c,0x4f,0xc0,0x09,0x02,0xea,0x33,0x9b,0x97,0x32,0xda,0x62,0xe9,0x46,0x8d,0x22,0x52,0x4a,0xeb,0x27,0x3a,0x98,0xb5,0xd4,0x38},
+	{0x0d,0x34,0x29,0x84,0xab,0xbf,0x95,0xe8,0xb2,0xcd,0x48,0xb6,0xa9,0xc3,0xb5,0x90,0x33,0xa1,0x8e,0xef,0xcf,0x26,0x5e,0x9b,0x85,0x2d,0xe0,0xdf,0x83,0x7e,0x54,0x4e,0x05,0x3c,0xf9,0xa8,0x38,0x04,0xba,0x2e,0x03,0xf3,0xf9,0xc9,0x3a,0x45,0x50,0xf1,0x93,0xd6,0x9e,0x17,0x74,0x59,0xcf,0xda,0xd0,0x6f,0x5f,0x46,0xef,0xe9,0x01,0x4e,0x28,0x60,0x26,0xe7,0xa2,0xb5,0xe0,0x6f,0xab,0xc6,0x6f,0xfe,0xa7,0x78,0x1e,0x7d,0xff,0x37,0xd0,0x6e,0x5d,0x8e,0xdc,0xf2,0x93,0xfb,0x52,0x52,0x03,0x21,0x23,0x18},
+	{0xd8,0x76,0xa3,0xb0,0x3d,0xa8,0x72,0x14,0x49,0x24,0x8e,0x1f,0x87,0x3f,0x3c,0x5c,0xfb,0x3e,0x2b,0xfc,0x03,0x9b,0x38,0x0b,0xa8,0x62,0xfa,0xc3,0xff,0xc1,0x49,0x59,0xdf,0xae,0x71,0x4f,0xa0,0x41,0x68,0x21,0x04,0x34,0x58,0x63,0x6d,0xff,0x48,0x5d,0xeb,0xe2,0xbe,0x39,0xfb,0x17,0x6e,0x95,0xbf,0xe0,0x32,0x4a,0x15,0x95,0x4a,0x3d,0xce,0xd8,0x4f,0x14,0x92,0x5b,0xa4,0xa8,0xb0,0x94,0x8d,0xde,0x3b,0xe4,0xce,0x7f,0xad,0x95,0xfd,0x7d,0x2a,0x57,0x8b,0x20,0xec,0x9a,0x66,0x0c,0x1a,0x8e,0x63,0x7f},
+	{0x7b,0x3f,0xdc,0x97,0xcd,0xed,0x2f,0xf2,0x9c,0xa1,0xa6,0xb3,0x5c,0xd1,0xd7,0x1a,0xdf,0x65,0x54,0x2c,0x12,0x72,0x60,0x38,0x62,0x30,0x1f,0x92,0x06,0xe9,0xb7,0x69,0xc2,0x49,0x3c,0x48,0x54,0x1f,0x04,0x89,0x37,0x12,0x1f,0xee,0x50,0xa1,0x89,0xc9,0x74,0x42,0x7e,0x26,0x37,0xb9,0x5f,0xe8,0x44,0x5c,0x80,0x45,0x65,0xb3,0x47,0x27,0xc3,0x6a,0x64,0x3a,0x51,0xfb,0x8c,0x6c,0x0d,0x1e,0x5f,0xfd,0xa1,0x3d,0xa1,0xef,0x87,0xb6,0xe1,0x3d,0x7d,0x3b,0x2d,0x31,0x1f,0xd0,0x00,0x99,0x44,0x78,0xdd,0x03},
+	{0x03,0x91,0x0a,0xb5,0x0b,0xbd,0xcb,0x38,0xf5,0xf0,0x88,0x1b,0x02,0x72,0xe6,0x69,0x81,0xa6,0x10,0x86,0x61,0xcb,0x8a,0xda,0xcb,0x3f,0xb6,0x84,0x01,0x8b,0x77,0x29,0x50,0x72,0xc5,0x86,0x3c,0x20,0x36,0x95,0xab,0xa5,0x1f,0xe4,0x1b,0x03,0xaf,0x10,0x0a,0x4a,0x91,0xdf,0xa4,0x8e,0xe1,0x85,0x39,0x81,0x11,0x3f,0x64,0xd5,0x59,0x17,0xaf,0x24,0x84,0x1e,0x72,0x6b,0x0e,0xcd,0x47,0xa9,0xea,0xe8,0xf1,0xcf,0xf7,0x48,0x4f,0xc6,0xca,0x86,0xb3,0x21,0x90,0x4b,0x6e,0x81,0xef,0x5f,0x37,0xa1,0x92,0x13},
+	{0xbf,0x21,0xe1,0xd2,0x90,0x6b,0x04,0x1f,0x1e,0x39,0xae,0x6d,0xb4,0x72,0x97,0xd6,0x0b,0xde,0x58,0x6d,0x22,0x04,0x01,0xfa,0x0e,0xa4,0x20,0xb1,0xe0,0x69,0x40,0x38,0x12,0xdb,0x61,0xed,0x52,0x64,0x0b,0x35,0xab,0xea,0x65,0xef,0x6f,0x82,0x74,0xb2,0xcb,0x27,0xb6,0x70,0x8f,0xd0,0x3a,0x0f,0xec,0x24,0x2d,0x4a,0x7b,0x8c,0x81,0x72,0xc2,0xa5,0x70,0xa1,0xae,0x0e,0x35,0xca,0xb4,0xc6,0x31,0xdf,0xe9,0xef,0xca,0x89,0xaf,0x9d,0x01,0xb4,0xf5,0x12,0xb1,0x0b,0x6e,0xd9,0xcf,0xe8,0x58,0xe1,0x49,0x3e},
+	{0xa1,0x67,0x06,0xfe,0xed,0x77,0xd4,0x22,0xde,0xb5,0xd2,0xd6,0x3c,0xed,0xd1,0xfc,0x49,0x5e,0xdc,0x52,0xf4,0xc2,0x91,0x5f,0x73,0x25,0xcc,0x69,0x13,0xe2,0x68,0x1f,0xb4,0xe8,0x54,0x26,0x14,0xe9,0x81,0xe4,0x0f,0x3b,0x1d,0xaf,0xae,0x5d,0x16,0xd4,0xc7,0x67,0xa4,0x2c,0x22,0x21,0xb2,0xb6,0x49,0x6c,0x2c,0xf3,0x21,0xc1,0x5d,0x37,0x65,0x67,0xa7,0x70,0xa3,0x67,0x05,0x2f,0x26,0x88,0x36,0xa1,0x8d,0xf0,0x11,0xd6,0x49,0x63,0x63,0x7a,0xdd,0x83,0x7e,0xc5,0x88,0xf6,0x56,0xd8,0x4e,0x38,0x7d,0x23},
+	{0x63,0x0b,0x91,0xce,0x47,0x49,0x4e,0x5d,0x3e,0x55,0xfc,0x28,0x4b,0x2a,0x02,0x87,0x2a,0xc4,0x83,0xc2,0x3f,0x26,0xfc,0x90,0x78,0xe0,0x8d,0x9b,0x33,0xfb,0x0e,0x5b,0x0b,0x2d,0xc7,0xeb,0xcc,0xdb,0x88,0xaa,0x58,0x7b,0x73,0xbd,0x0b,0x94,0x99,0x6b,0xa2,0xbf,0x59,0x43,0x04,0x9d,0x45,0x86,0xa4,0xe2,0x78,0x97,0x4a,0x90,0x9e,0x4e,0xa4,0xc5,0x61,0x93,0xb6,0xe7,0x23,0xe8,0xeb,0xf3,0xe4,0x17,0x74,0x3a,0xf1,0xc3,0xbe,0xcb,0x8a,0x11,0xd4,0x17,0x97,0xfe,0xb5,0xef,0xbd,0x81,0xbc,0x70,0xa0,0x66},
+	{0x24,0x8f,0xe4,0x54,0xb8,0x91,0xbb,0xbe,0x18,0xed,0xfd,0xbc,0xb4,0x89,0x85,0xbe,0x5e,0xd9,0x89,0xa1,0xbd,0x04,0x3c,0x0c,0x5d,0xbe,0x07,0x70,0xb4,0xb9,0x3d,0x02,0xaf,0x19,0xc7,0x2d,0x6c,0xa3,0x5d,0x92,0x0a,0xc1,0xa3,0xfd,0x39,0xd2,0x03,0x8e,0x1a,0x34,0x4c,0x4f,0xd5,0xec,0x89,0xb4,0xf6,0xc3,0x8d,0x79,0xd4,0x5e,0xaf,0x01,0xda,0x20,0x9b,0xe6,0x0c,0x84,0x17,0x7e,0x22,0x99,0xad,0xcf,0x64,0x2e,0x00,0x70,0xd5,0x4b,0x5e,0x2f,0x5c,0xef,0x39,0xe4,0x9d,0xef,0x93,0x6e,0xea,0x6f,0x3c,0x54},
+	{0x66,0xc2,0x68,0x51,0x78,0x1d,0xa7,0x09,0x72,0x40,0x23,0x82,0x9d,0x6a,0x59,0x6f,0x30,0x2a,0x82,0xf2,0x41,0x62,0xaa,0x27,0x37,0x30,0xef,0x31,0x89,0xee,0x53,0x67,0x39,0x01,0x72,0x82,0xd6,0x4d,0x72,0x18,0xd3,0xb8,0x52,0x93,0xbe,0x8e,0x77,0x25,0xff,0xc3,0x64,0x27,0x75,0xa1,0x93,0xaa,0x53,0x38,0x78,0x8d,0x26,0x91,0xd1,0x4b,0x2d,0x23,0x63,0xce,0xc7,0xaa,0x10,0xe6,0xdd,0x3d,0x56,0x42,0x5e,0x8b,0x0c,0xcb,0x20,0x07,0xbe,0xcd,0x70,0x67,0xf1,0x42,0xdd,0x1f,0xf3,0x51,0xfb,0x5d,0x55,0x03},
+	{0xdb,0x51,0x1b,0x9c,0x3e,0x64,0x0f,0x80,0xaa,0x9e,0x03,0x5d,0x5c,0xd1,0x5e,0x8b,0x5c,0x8b,0x7a,0x96,0xee,0x1f,0x46,0x97,0xe4,0xdf,0xcd,0x96,0x80,0x08,0x3f,0x47,0x72,0x7f,0x9a,0xf6,0xc4,0x66,0x2c,0x1c,0xc0,0x50,0x13,0x96,0x8c,0x78,0xaf,0x31,0xa3,0x15,0x84,0x11,0x05,0xda,0x98,0x0e,0x48,0xf5,0x7e,0x88,0x68,0x49,0xff,0x5c,0x78,0x69,0x65,0xbc,0x48,0x09,0xde,0x37,0x33,0x4d,0xe2,0x88,0xdf,0x66,0xa4,0x01,0xf1,0xe9,0xd8,0x87,0xbc,0x74,0xbc,0x84,0x2c,0x49,0x6a,0x08,0x04,0x01,0x98,0x1d},
+	{0x8f,0x50,0xb7,0x34,0xab,0x65,0x29,0xcc,0x3a,0xca,0xda,0x03,0x24,0x0b,0x81,0x4f,0x2d,0x47,0xa5,0x70,0xc3,0x91,0xb3,0x18,0x07,0xb8,0x3b,0xaf,0x46,0xde,0x6d,0x00,0x07,0x69,0xdb,0x71,0xb8,0x5b,0xda,0xf1,0xf8,0xc2,0x5f,0x9e,0x57,0x06,0x66,0x74,0xf6,0x35,0xb0,0x87,0xe5,0xc7,0x40,0x64,0x15,0x99,0x82,0x71,0x0e,0x5d,0x84,0x48,0x6b,0x74,0x27,0xb1,0xa7,0xd5,0x4c,0xc8,0xe4,0xda,0xbc,0x64,0x20,0xb4,0xd9,0x95,0x2b,0x8a,0x18,0xb2,0x98,0x2d,0xbd,0x54,0xc6,0x98,0xc0,0x92,0xfb,0x77,0xde,0x65},
+	{0xfd,0xf6,0x35,0x89,0x5b,0x3d,0xb9,0x9e,0x7c,0x7e,0xda,0x60,0xde,0x38,0xa2,0xc8,0x49,0xb6,0x06,0xcf,0x06,0xd0,0x93,0xa4,0x18,0x93,0xd6,0xe7,0x94,0x3a,0xef,0x0e,0xb6,0x85,0xf5,0xe2,0x32,0xe0,0x32,0xfa,0xa3,0xc7,0x97,0x4c,0x51,0xf6,0x94,0x63,0x29,0x6a,0xa8,0x41,0xa2,0xd0,0x82,0xb9,0x0f,0xa8,0xa4,0x1e,0x09,0x7e,0xbc,0x25,0x52,0xb2,0x5c,0x54,0xdc,0xf0,0xaf,0x86,0xd0,0x29,0xf2,0xd4,0xd7,0x04,0xc0,0xf5,0xb7,0x0e,0x86,0x3a,0xa1,0xe6,0x00,0x8d,0xc6,0xb9,0x31,0x36,0xce,0xab,0xa3,0x70},
+	{0x76,0x6a,0xc1,0x29,0xa1,0xbb,0xed,0xa7,0xbc,0xde,0xd5,0xe9,0x1c,0xec,0x6c,0x1c,0xc2,0x83,0x04,0xdb,0x3e,0x01,0x34,0xeb,0x9c,0xba,0x84,0xd4,0xc1,0x57,0xe8,0x1e,0xa9,0xca,0x03,0x53,0x2e,0x17,0xeb,0x26,0xc3,0x00,0x0e,0x09,0x0a,0x15,0x8c,0xf3,0xb5,0xd1,0x14,0xb3,0xce,0xaf,0xb2,0xcf,0x25,0x89,0xcb,0x6d,0x59,0x44,0xc9,0x78,0x06,0x57,0xde,0x48,0xf7,0xf2,0x36,0xa0,0x49,0x0d,0x25,0x88,0x88,0xbb,0x6a,0x6f,0x38,0xd3,0x78,0x05,0xd6,0x9d,0x03,0xff,0x2a,0x1a,0x65,0x3e,0xe0,0x5f,0x07,0x57},
+	{0xb7,0x0e,0xfa,0x12,0xef,0xea,0xc2,0x57,0x7d,0xc6,0x5e,0x90,0xc7,0xde,0x1d,0xa1,0x3a,0x94,0xac,0xb5,0xf4,0x88,0x2c,0x4f,0x8e,0x9f,0x15,0x81,0x6f,0x3a,0x3f,0x0b,0xe4,0xcc,0x53,0x05,0x81,0x55,0x61,0x49,0x91,0x0e,0x7b,0xe3,0xed,0xf5,0xe7,0xae,0x51,0x5d,0x9f,0xbe,0x34,0x0c,0xdd,0xfc,0x1d,0xc5,0x90,0x69,0x41,0x0a,0x8f,0x65,0xcf,0x70,0x1a,0xe9,0x07,0xa8,0xe9,0xb6,0x58,0xc5,0x62,0x56,0x4d,0xd2,0xe1,0xd5,0x3c,0x2b,0xc9,0xd5,0xc9,0xd3,0x7f,0x21,0xf0,0x0d,0x2c,0x34,0x7f,0xf6,0x17,0x3d},
+	{0x6a,0x94,0x19,0xa2,0x31,0x87,0x58,0xb5,0x85,0xbe,0x5a,0x95,0x5f,0xc9,0xbb,0x48,0xf4,0xa9,0x39,0x14,0x15,0x56,0x79,0x64,0x0e,0x76,0xe1,0x45,0xfe,0xf9,0x81,0x64,0x23,0xfe,0x9d,0x6c,0x17,0x42,0x39,0x7c,0x7b,0xd8,0x9a,0x37,0x22,0x46,0x8f,0x89,0xdf,0xeb,0xb6,0xa8,0xa9,0x25,0x05,0xbf,0x87,0x6e,0x1d,0xda,0xca,0xf6,0xf9,0x25,0x39,0xcd,0x0d,0x20,0x89,0x94,0x77,0x1e,0xb2,0x39,0xf5,0x09,0xe1,0x94,0x48,0x9c,0xc3,0xb9,0xcf,0x41,0x44,0x68,0xa9,0xf0,0xf0,0xdf,0x84,0x68,0x37,0x4a,0xfd,0x3f},
+	{0x60,0x50,0x1e,0x72,0x1a,0x36,0xb3,0x71,0x2d,0x0b,0x20,0xce,0xdc,0xa4,0xd9,0x63,0xc1,0x4d,0x07,0x2d,0xee,0x22,0x7f,0x10,0x60,0x00,0xb8,0x48,0x34,0x04,0x9c,0x4f,0x60,0xa4,0x36,0x93,0xf7,0x9a,0x4b,0x86,0xc8,0x7a,0xf8,0x63,0xd5,0xf1,0x00,0xa3,0xd9,0xea,0xa9,0xc3,0x63,0x24,0x7b,0xbb,0x16,0x21,0x83,0x1a,0x0c,0x2b,0xb7,0x43,0x3a,0xc3,0xe7,0x33,0x6a,0xfd,0xe0,0x97,0x14,0x06,0x49,0x85,0xa6,0xa0,0x4c,0xa5,0xa0,0xb6,0x4f,0xe4,0x7a,0xea,0x6c,0x8c,0x6a,0xc8,0x82,0x0d,0xb1,0xda,0xcc,0x7c},
+	{0x54,0xeb,0x46,0x4d,0x0a,0x84,0x50,0x7a,0x8e,0x77,0xce,0x02,0xd3,0xd7,0x1b,0xf7,0x27,0x5e,0xf7,0xf7,0x48,0xd8,0xa7,0x76,0x48,0x88,0xb4,0xe9,0x00,0x3c,0xb7,0x47,0x32,0x1c,0x5b,0xa6,0x12,0x93,0xd3,0xe1,0xb8,0xf2,0x51,0x72,0xdd,0xe8,0x9c,0x36,0x1d,0x19,0xbc,0x7e,0xc4,0x3f,0xd6,0xa2,0x6f,0xd3,0x04,0x85,0x2a,0xd1,0xae,0x25,0xb8,0x3f,0xa7,0xde,0x00,0x24,0x0e,0xaa,0x5f,0x2b,0x8d,0xe6,0xff,0x1f,0x63,0xa7,0x96,0xcf,0x13,0xef,0xbe,0x14,0xcd,0x62,0x33,0xc8,0x34,0x46,0x58,0x04,0x61,0x78},
+	{0x14,0x9d,0x03,0x6a,0x4c,0x63,0x18,0x1d,0x83,0x71,0xd6,0xf0,0xe8,0x36,0xc2,0x64,0x3b,0x5b,0xe5,0x39,0xf5,0x94,0xa8,0xd8,0x4b,0x09,0xb3,0x41,0x2a,0xa5,0xc2,0x02,0xde,0xa8,0x0c,0xd7,0xe5,0x1b,0x80,0xc9,0x8b,0xe4,0xcb,0xed,0x17,0xdb,0xe3,0x33,0xf9,0xcd,0xcd,0xfb,0x69,0x33,0x33,0x96,0xbf,0x0b,0x33,0x3e,0x70,0x58,0x00,0x18,0xab,0x0f,0x7d,0x42,0x42,0x32,0xf5,0x07,0x05,0xc7,0x0d,0x3d,0x06,0x9d,0x7b,0x7c,0xc2,0x3d,0x77,0x5b,0x8f,0xce,0xfe,0xf5,0x43,0x46,0xa7,0x5e,0x23,0xec,0x64,0x14},
+	{0x7d,0x61,0x71,0xd2,0xb7,0x27,0x52,0xe1,0x33,0xef,0xb5,0x7d,0x99,0xd7,0x71,0xed,0x6f,0x77,0x1e,0x2d,0xb8,0xea,0xb8,0x69,0x29,0x81,0x28,0x2b,0x06,0x52,0x7f,0x0f,0xdd,0x90,0xf6,0x57,0x0d,0xed,0x2c,0x16,0xbe,0x99,0x47,0x60,0x0c,0x87,0x22,0xfb,0xef,0xfe,0x38,0x31,0xdb,0x43,0x53,0x52,0xa4,0x82,0xd7,0xe1,0xf0,0xbf,0x1f,0x17,0xa8,0x7c,0x9f,0x7c,0x6f,0xd6,0x87,0xbf,0x78,0xdb,0xff,0xac,0xea,0x97,0xe2,0xc0,0x93,0xc6,0xe5,0x2c,0xcd,0x24,0x7b,0x86,0xa4,0x59,0xf4,0xe6,0xfa,0x4c,0xca,0x59},
+	{0xb6,0x48,0xcf,0x2c,0xb1,0x19,0x0c,0xcb,0xe4,0xcf,0x28,0xca,0x54,0xb9,0xce,0x6d,0xbe,0x3f,0xfa,0xa0,0x58,0xb9,0xf5,0xc8,0xb8,0xf7,0x13,0xe1,0xb6,0xbb,0x95,0x62,0xdf,0xa5,0x70,0x6c,0xfe,0x34,0x64,0x3e,0xdb,0x0a,0x6c,0xfe,0x06,0x7b,0xb1,0x4b,0xc9,0x32,0x37,0x71,0xab,0xe3,0xf4,0xfa,0x5e,0x6a,0xb0,0x8f,0x9b,0x93,0x6d,0x2e,0xff,0x69,0x24,0xe9,0x53,0x40,0x0b,0x2d,0x64,0xc0,0xf8,0x2c,0x7e,0x60,0x53,0xa1,0x14,0x1e,0x0c,0xe8,0xfd,0x6c,0x79,0x64,0xb1,0x9f,0xfc,0x3b,0x5d,0x16,0x14,0x24},
+	{0x5d,0x33,0xa4,0xb9,0xf6,0x0d,0xf6,0xd7,0x3d,0x4b,0x12,0xbc,0x36,0x0e,0x8d,0xcc,0x78,0x61,0x97,0xc4,0x75,0x59,0x61,0x56,0x9c,0xf3,0x3f,0x4a,0x76,0x6c,0x98,0x2e,0xa0,0x1f,0x98,0x1f,0x13,0x9f,0xcc,0x59,0x10,0xf3,0x3b,0xc7,0x0d,0xa7,0x6d,0xd8,0xc6,0x37,0x71,0x10,0x90,0x6b,0xcf,0x2b,0x6d,0x1e,0x2e,0x65,0xaa,0x4e,0x70,0x7c,0xa4,0xc3,0x9f,0xae,0x31,0x5c,0x37,0x7e,0x9f,0x36,0x4a,0x52,0x7a,0x15,0xd6,0x24,0x95,0xfc,0xb0,0x7a,0xcd,0xcd,0x23,0x30,0xf2,0x3f,0xba,0x83,0x62,0x7d,0xa6,0x50},
+	{0x20,0x4b,0xc3,0x60,0x6f,0x8e,0xb8,0x03,0x52,0xb5,0x0d,0x57,0x21,0x4a,0x1e,0x8d,0x85,0x5e,0xcf,0x22,0xa0,0x00,0x01,0xe3,0x7d,0xf4,0x23,0xb4,0xb7,0x64,0x28,0x5d,0x80,0xb4,0x48,0x2a,0x28,0x38,0xaa,0x3c,0x4d,0x99,0x61,0x14,0x34,0xf3,0xe2,0xf6,0x23,0x69,0xcd,0xc0,0xd8,0xd9,0x2e,0x6d,0x4a,0x5f,0xa2,0x21,0x65,0x03,0x13,0x6a,0x64,0x34,0xe2,0xbf,0x93,0x8b,0x3a,0x4f,0x50,0xc0,0x5c,0x1a,0x8f,0x63,0x3a,0xcb,0x61,0x8a,0xcd,0x2a,0x30,0x7c,0x0d,0xd7,0xf9,0x21,0xa5,0x80,0xc1,0x21,0x1f,0x22},
+	{0x33,0xba,0xb5,0x6b,0x7d,0xa0,0x10,0xea,0x7c,0x6e,0xb3,0x88,0x8f,0x0d,0x15,0x04,0xc7,0x3a,0x5d,0xfa,0x91,0xf7,0xca,0x50,0xe9,0xc5,0xef,0xfb,0x7e,0x89,0xfc,0x3b,0x99,0x95,0x1f,0x87,0x98,0x25,0xf4,0x0f,0xd7,0x9a,0x79,0x71,0x20,0xfc,0x09,0x7c,0xee,0xab,0x87,0xc6,0xfa,0x36,0x18,0x9f,0xaf,0xef,0xd3,0xb6,0x12,0x62,0x42,0x71,0x57,0x8f,0x6f,0x7e,0xc3,0x5d,0xb7,0x98,0xba,0xb3,0xba,0xa8,0x37,0xf3,0xff,0x42,0x1d,0x88,0xdf,0x17,0xac,0xa3,0xea,0x2a,0x78,0x8f,0xf0,0x11,0x01,0x34,0xb2,0x19},
+	{0x78,0xc7,0x11,0x7e,0xd6,0xa8,0x3f,0x15,0xc7,0x8b,0x5c,0x78,0x94,0xbb,0xae,0xc9,0x72,0x7a,0x17,0xb5,0xd1,0x40,0xa5,0xdc,0x26,0x75,0xe2,0xb7,0xcd,0x5e,0x5b,0x46,0x60,0xa3,0x7a,0x99,0x42,0xb0,0xaa,0xca,0x62,0x27,0xf9,0x91,0xd8,0x99,0x6c,0x7e,0xfb,0xa8,0x4e,0xeb,0x11,0x3f,0x82,0xe4,0xea,0xfa,0xe8,0x1b,0x9e,0x4e,0xf9,0x5f,0xb4,0x35,0xcc,0x71,0xb0,0x0a,0x35,0x60,0x14,0xd3,0x8d,0x8f,0x28,0x3c,0xff,0x14,0xd5,0x51,0x65,0x55,0x00,0xf6,0xb1,0xe6,0xac,0x26,0x27,0x91,0xce,0x4c,0x78,0x41},
+	{0xab,0x72,0x5a,0x52,0x4f,0x92,0x12,0x6e,0x39,0x50,0x84,0xcf,0xdf,0x55,0xf2,0x8b,0x0b,0x65,0xe2,0xcc,0x24,0xc7,0xa3,0x8f,0xa5,0x5d,0x65,0x92,0x01,0xbf,0x30,0x07,0x08,0x2d,0x25,0x7f,0xf2,0xe2,0x76,0xac,0xae,0x36,0x20,0x48,0x69,0xef,0xf7,0x5e,0x92,0x87,0x34,0x60,0xfc,0x24,0xb7,0xfc,0xc4,0xaf,0xbd,0xd9,0x0e,0x09,0x67,0x5b,0xc1,0xc2,0x63,0x9f,0x48,0x6a,0x49,0xab,0xbd,0xd5,0x3a,0x3d,0xf3,0x01,0xb6,0x4b,0xeb,0xf6,0x8d,0x3c,0xce,0xf8,0x55,0x2e,0x36,0x59,0x2c,0x4c,0xce,0xa2,0x93,0x66},
+	{0x1e,0x3c,0xc0,0xa5,0x4f,0xe3,0x18,0x13,0xd1,0x6d,0xfd,0xc9,0x90,0x54,0xec,0xf8,0x55,0x21,0x22,0x6d,0x8f,0xb0,0x69,0x80,0xe0,0x60,0x06,0xe5,0x19,0xd8,0xf0,0x04,0x67,0xf4,0xcd,0x56,0xb2,0x1c,0x11,0x87,0x75,0xdc,0x18,0xca,0x74,0x6b,0x6d,0x62,0x98,0x63,0x25,0x05,0x13,0x1a,0xd5,0xe6,0xa9,0x5b,0x46,0xa8,0xdd,0x48,0x0d,0x60,0x2c,0x42,0xc7,0x14,0xfb,0xc5,0x37,0x25,0x60,0x0a,0xea,0x8d,0x52,0x15,0xd8,0x87,0xd4,0xea,0xf5,0xdf,0xbf,0x34,0x74,0x02,0xbb,0x80,0x03,0xce,0x1d,0xf4,0xaf,0x54},
+	{0x7f,0x9b,0x36,0x02,0xdc,0xa9,0xc4,0x27,0xff,0xf9,0x87,0x3e,0x98,0x6e,0x6b,0x8c,0x79,0xae,0x75,0x21,0x60,0xe0,0xbf,0x9d,0x76,0x1a,0x22,0xf8,0x64,0x18,0x39,0x15,0x46,0xec,0xc7,0x51,0xce,0x48,0xc5,0x70,0xae,0xdf,0xa4,0x90,0xad,0x38,0xd5,0xab,0x24,0x8f,0xf4,0x56,0xf5,0x49,0x0f,0x0e,0x50,0x2d,0xae,0x54,0x3b,0xf5,0x89,0x53,0x82,0x10,0x20,0xad,0xd3,0x62,0x1d,0x43,0xd7,0xd2,0xd9,0x7f,0x90,0xaf,0xc5,0x43,0x9b,0x3b,0xea,0x14,0x03,0xb1,0xe2,0x8d,0x3d,0x88,0x8d,0x2b,0x53,0xa7,0x7f,0x5d},
+	{0x82,0x16,0x54,0xe8,0x15,0x59,0x13,0x7d,0xd0,0xbe,0x6b,0x9b,0xab,0x38,0xc8,0x9b,0x17,0xfb,0xb6,0xd9,0xd2,0x2d,0x89,0x1a,0xb4,0x76,0x45,0x21,0x9d,0x7d,0xdf,0x66,0x4e,0x37,0x50,0xc8,0x28,0x85,0x52,0x48,0x77,0x55,0x50,0x5c,0x27,0x52,0xe0,0xeb,0xe1,0x7f,0xa7,0x47,0x68,0x8d,0x06,0x90,0x56,0x85,0x50,0xf4,0x5c,0xf8,0x62,0x54,0x65,0xb7,0xd4,0xc4,0x7a,0x3d,0x25,0xe6,0x0a,0xdb,0x31,0x74,0xf0,0xe3,0x4e,0xa0,0x08,0x7e,0x76,0xd9,0x42,0x47,0x51,0x13,0xfe,0xce,0x6e,0x89,0x8b,0x68,0xeb,0x01},
+	{0x98,0xa8,0x1e,0xa4,0xd0,0xdc,0x49,0x42,0x87,0x5a,0x48,0x86,0x2b,0x7b,0x95,0xa4,0x4a,0xce,0xd6,0x33,0xaa,0x41,0x38,0x14,0xd4,0x5c,0x97,0x34,0xc0,0xdf,0xd1,0x7b,0x4a,0x0b,0x45,0xdb,0x95,0x78,0xa4,0x4d,0xab,0x8b,0xc3,0xfa,0x58,0x05,0xa4,0x8a,0x1f,0x84,0x65,0xbd,0xb5,0x9b,0xd6,0xeb,0x07,0x10,0xc1,0x47,0x3f,0x7b,0xd7,0x0d,0xec,0x20,0x60,0x4f,0xc7,0xf9,0x26,0xd4,0x45,0xe8,0x46,0x9f,0x5e,0xb5,0xaa,0x0b,0xda,0xa9,0x45,0x09,0x80,0xce,0x74,0xc2,0x01,0x47,0x3b,0xb9,0x86,0x27,0x2e,0x61},
+	{0x3c,0xa4,0x34,0xc2,0x8b,0x14,0x7e,0x0c,0xd8,0xff,0xe2,0xfc,0x8e,0xd5,0xfb,0x1a,0x64,0xee,0xfc,0x4e,0xec,0xab,0xe9,0x22,0x82,0x19,0xc7,0xca,0x3e,0xb2,0x07,0x73,0xcc,0x35,0x68,0x00,0x90,0x57,0x62,0xfc,0xe4,0x37,0x37,0x51,0xa1,0x6c,0x97,0xd7,0x80,0x5d,0xb6,0x34,0x7b,0x43,0x20,0x5c,0xe7,0x16,0x47,0x72,0x8a,0x30,0x3e,0x33,0xab,0x08,0x86,0x4c,0xce,0x27,0x5d,0x59,0x48,0x0b,0x30,0x6a,0xa8,0xb6,0x4d,0xaa,0x30,0x5c,0x48,0xaf,0x8f,0x9e,0x5d,0x8d,0x13,0xe8,0x1c,0x8c,0xb8,0xa1,0x73,0x66},
+	{0x35,0xb0,0x33,0x09,0xde,0xa7,0x05,0x1f,0x27,0x56,0x49,0x73,0x14,0x73,0x16,0x19,0xc4,0x0b,0xac,0x19,0x3b,0xbc,0xcd,0x68,0x45,0xa5,0x75,0xda,0x8d,0x2f,0x8b,0x08,0x40,0x7f,0x7f,0xa5,0x4b,0xbb,0xe8,0x4f,0x78,0xe3,0x65,0x30,0x3b,0x25,0x38,0xd2,0x44,0x19,0x36,0x53,0xde,0x30,0x9f,0xd6,0x86,0x32,0x8f,0x07,0x5d,0x37,0xfc,0x60,0x87,0xba,0x3e,0xf8,0x2d,0x07,0x4a,0x77,0x1e,0xfb,0x6a,0x41,0x03,0x7b,0xfa,0x97,0x90,0xcf,0xeb,0x12,0x75,0x94,0xc1,0x44,0xbb,0xf7,0x21,0x5c,0x89,0x56,0x80,0x16},
+	{0x1b,0x3c,0xb6,0xbf,0xb1,0x96,0x12,0xca,0xfc,0x3b,0x70,0xd9,0x37,0x79,0x1a,0x10,0xbc,0xca,0xab,0xda,0xa8,0xfe,0x9e,0x16,0x99,0x05,0xfa,0x95,0xbb,0x47,0x55,0x22,0x76,0xeb,0xf2,0xcf,0x7d,0xf3,0xfb,0x76,0xac,0x47,0x66,0x71,0xe3,0x13,0x01,0x08,0x7e,0xd6,0x04,0x1c,0x9c,0xc9,0x68,0xf9,0x20,0xbd,0x80,0x12,0x90,0x01,0xcd,0x16,0x2f,0x2a,0x11,0x9a,0x10,0xd3,0xfe,0xd5,0x2d,0x7c,0xa5,0x09,0xf4,0xb2,0x4c,0x54,0x60,0x0e,0x39,0x19,0x56,0xe0,0xa5,0xb6,0x64,0x65,0xfb,0xd1,0xdf,0x28,0x8a,0x7d},
+	{0xd8,0xad,0xd7,0x48,0x53,0x28,0x24,0x68,0x29,0x54,0xa8,0xd8,0x0a,0xfb,0x0c,0x52,0xb3,0xdc,0x86,0x1a,0x94,0xed,0x29,0x78,0xa7,0xf3,0xfc,0xeb,0x1b,0x2a,0x92,0x6b,0x46,0xda,0x08,0x3e,0x79,0xef,0x16,0xe6,0xa2,0x28,0x10,0x1c,0xc4,0x4a,0x0c,0x39,0x39,0x36,0x49,0x96,0x8a,0x9c,0x77,0x2e,0xed,0x45,0xff,0x87,0x98,0xf2,0x5a,0x0a,0xca,0x71,0x1a,0x9d,0xca,0xf1,0x70,0x01,0x88,0x5a,0x98,0x4d,0xa0,0x5b,0xaf,0x46,0xb3,0x48,0x65,0x1e,0xeb,0xa3,0x91,0x6c,0x3a,0x42,0x32,0x6d,0x56,0x89,0x3d,0x57},
+	{0x65,0x33,0xe6,0x6e,0xfd,0x9f,0xd7,0x49,0x0a,0x34,0xcd,0x53,0x5d,0x89,0x34,0xc2,0x98,0x70,0xeb,0xcf,0x57,0x79,0x97,0x63,0x50,0x6c,0x3d,0x92,0x21,0x63,0x06,0x5c,0xb6,0xcb,0xa9,0x39,0x2f,0x62,0x30,0x0a,0x8a,0x19,0xaf,0xb5,0x6f,0xba,0xaa,0xd2,0x46,0xbc,0x9c,0x48,0x15,0x2b,0x1d,0xa5,0x29,0x09,0x90,0x1c,0xd1,0xd3,0xda,0x1d,0x6d,0x92,0x7e,0xf9,0x90,0x5b,0x20,0xf9,0x86,0xbe,0xce,0xf6,0xb6,0x96,0x38,0x9d,0x7f,0x54,0xa2,0x51,0x4b,0xf1,0xcb,0x82,0xbc,0x0c,0xff,0xdd,0x1a,0xb1,0xb6,0x2c},
+	{0x03,0xea,0xfd,0x0a,0x84,0xf0,0x1d,0xa9,0x9b,0x08,0xbe,0x52,0xe0,0xa2,0xea,0xff,0x33,0x8e,0x44,0x70,0x4b,0x32,0x2f,0x6c,0xd0,0xb9,0x2a,0x59,0xb0,0xb8,0x0b,0x3e,0xc1,0xad,0xd1,0x50,0x13,0xdf,0xd6,0xf2,0xc7,0xb6,0x2d,0x8e,0xe6,0x1a,0x93,0x00,0xa9,0xec,0xaf,0x7f,0xcd,0x0d,0xfe,0xa5,0x01,0x5d,0x88,0xa3,0x87,0xf6,0x2f,0x42,0xb1,0xb5,0x91,0xf0,0xc2,0xea,0xe3,0x50,0x47,0x98,0xb4,0xff,0xf1,0xa6,0xfd,0x22,0xdb,0xcb,0x2e,0xab,0x61,0x9f,0x64,0x80,0xf6,0x4c,0x90,0xb7,0x8d,0xa9,0xcb,0x07},
+	{0xad,0x1e,0x3c,0xc8,0x8f,0xf1,0xa2,0xa3,0xc5,0x75,0x47,0x29,0xfa,0xdb,0x02,0xa3,0xba,0x4b,0x40,0xe0,0x52,0x02,0x98,0xc9,0x03,0xbb,0x1e,0x79,0x7b,0xe0,0x4e,0x17,0x20,0xf7,0xc7,0xd0,0x3c,0xbc,0xc8,0x2b,0xca,0x62,0x40,0x41,0x29,0x98,0x93,0xcb,0xab,0x18,0xe4,0x60,0x66,0x57,0xb6,0xdc,0x10,0xc9,0xaa,0xb9,0x36,0x8b,0x98,0x3a,0x90,0xc1,0xb9,0xb1,0x0e,0xda,0x92,0x1d,0xca,0xf3,0xd3,0x23,0x9b,0x1a,0x6f,0xd2,0x8c,0x23,0xeb,0x42,0x68,0xf0,0x8b,0xe5,0xd9,0xbc,0xa8,0x8c,0x3c,0x8c,0x50,0x67},
+	{0x7f,0x55,0x02,0xf1,0x37,0xd0,0xd8,0x27,0x95,0xd1,0xb7,0x30,0xbd,0xf0,0xd3,0xdc,0xfc,0xe5,0xe0,0x45,0x9b,0x7f,0x4e,0xdf,0x95,0x29,0xdf,0x2b,0x47,0x3a,0x8c,0x64,0x9b,0xf4,0xdf,0x1c,0x4e,0x3c,0x3b,0x25,0x64,0x72,0x26,0xa7,0xa9,0xca,0x4e,0xdb,0x4c,0xab,0xe5,0x1d,0x80,0x9d,0x48,0xc5,0x77,0x36,0x1a,0xf6,0x17,0x2f,0x49,0x12,0x4b,0x4b,0xed,0x15,0xeb,0x8b,0xff,0x2e,0x2c,0x28,0x99,0x95,0x6d,0x5f,0x9f,0xde,0x1b,0x99,0xcf,0x08,0x12,0xdf,0x78,0x9c,0x31,0x7e,0xf0,0xd1,0xdf,0xb4,0x14,0x23},
+	{0xad,0x75,0xf2,0x74,0xab,0xea,0x21,0xd2,0xf5,0x5f,0x28,0xf9,0x9e,0xb9,0x55,0xd3,0x22,0x87,0xb3,0xcb,0x2e,0x53,0x3b,0x24,0x00,0x4d,0xed,0xa9,0x8d,0x6c,0x31,0x2f,0xb7,0x56,0x7c,0x92,0xad,0x1e,0x12,0x32,0x58,0xb1,0xa7,0x83,0x26,0x67,0x07,0xb4,0xa8,0x9c,0xf8,0x7a,0x6d,0x14,0xb2,0x27,0xaf,0x5d,0x4d,0x3f,0x70,0x22,0x8a,0x41,0xa2,0x56,0x3f,0x33,0x2b,0x17,0x0e,0x2b,0x0e,0x54,0xc2,0x07,0xae,0xd8,0xcb,0x75,0xb6,0x7e,0x4e,0x7f,0xa4,0x3e,0x85,0x11,0xdc,0xa9,0xb9,0x88,0x7a,0xb9,0xa6,0x3e},
+	{0x7d,0x2d,0xd7,0x62,0x25,0x35,0x9f,0xfc,0xb0,0x49,0x43,0xa6,0x1d,0x1d,0xab,0xf4,0x38,0xc1,0xf4,0xc2,0xc8,0xa0,0x14,0x43,0xe3,0x0a,0x6c,0x13,0x08,0x56,0x19,0x18,0x7d,0xc4,0xb9,0x6b,0x96,0xf8,0x1c,0xa7,0xb6,0xac,0x78,0xf5,0xca,0x03,0xa2,0xbe,0xd0,0xaf,0x8a,0xd1,0xc2,0xff,0x63,0x92,0x87,0xec,0xcd,0xfa,0x77,0xad,0x74,0x58,0x39,0x84,0xc5,0x0c,0x75,0x5d,0x1a,0x88,0xfb,0x3b,0x6a,0x2b,0xdb,0x03,0xfc,0x6a,0x00,0xf9,0xd4,0xd4,0x35,0xf3,0xa1,0x77,0x31,0xde,0xdb,0x93,0xa6,0x39,0x25,0x38},
+	{0x38,0xdd,0x97,0x4e,0xc7,0x44,0x0f,0x03,0x11,0x06,0x93,0x1c,0x37,0x69,0x0d,0xed,0xe8,0x35,0xa0,0xc6,0x86,0xed,0x15,0x18,0xfa,0xf6,0xc6,0xe8,0xa9,0x84,0xef,0x30,0xa4,0x37,0x8e,0xe1,0x77,0xcc,0x08,0x4d,0x71,0xfb,0x6a,0xa4,0x3b,0x47,0xc6,0x1d,0x18,0x77,0x9d,0x35,0xd4,0x2c,0xe7,0x8b,0x3f,0x0f,0x6f,0xdb,0x6f,0x9a,0x7e,0x22,0x58,0x0b,0x9a,0x8a,0x5b,0x5d,0x69,0x7e,0x56,0x7e,0x80,0xca,0x2f,0x0e,0x70,0xf8,0x5a,0xd7,0x63,0x05,0x0a,0x26,0x04,0xd5,0x9b,0xd7,0x4d,0xc4,0x8b,0x42,0xcb,0x19},
+	{0xdb,0xae,0xaf,0x25,0x7a,0xd7,0xeb,0x85,0x7f,0xe9,0x8d,0x35,0xc4,0xf7,0xf0,0xd1,0x9a,0xec,0x7e,0x8b,0xc5,0x8e,0x67,0x24,0x7d,0xd7,0xd6,0xb8,0xa3,0x2e,0x2b,0x75,0xdd,0xe2,0x65,0x34,0x5d,0x2c,0x98,0x39,0x8b,0xf3,0x50,0x3d,0x14,0x3f,0x50,0x90,0x57,0xb5,0x76,0x1e,0x48,0x7f,0x3f,0x6f,0x55,0x22,0xf8,0xb4,0x64,0x2c,0x1a,0x1d,0xb6,0x90,0xa2,0x23,0x3a,0x30,0xba,0x69,0xf0,0xcf,0xbf,0x53,0x36,0x34,0xcf,0x5d,0x56,0x97,0xe2,0xce,0x21,0x6d,0x35,0x4f,0x42,0x8b,0x29,0x01,0x8e,0x48,0xdb,0x7e},
+	{0xc7,0xdd,0xa6,0x16,0xe6,0xd8,0x67,0xc2,0x18,0x86,0x18,0x1a,0xa5,0x5d,0xee,0x01,0xad,0x1c,0x67,0xcd,0x10,0x77,0x42,0x3e,0x0f,0x9b,0x84,0x2a,0x3c,0x46,0x93,0x7d,0x96,0xfe,0x12,0x5d,0x75,0x35,0x78,0x29,0x31,0x15,0xcf,0x29,0xa7,0x93,0xea,0xbc,0x5b,0xc7,0x7f,0x8d,0x07,0x87,0xd6,0x2e,0xff,0x2c,0x64,0xd9,0x25,0x15,0xcc,0x11,0x2b,0x33,0xb7,0xbe,0x36,0x51,0x41,0x87,0x6d,0x07,0xd8,0x49,0xae,0x42,0x05,0x93,0x6c,0x53,0xe8,0xef,0x36,0x61,0x82,0x3e,0x46,0x48,0xbe,0x2e,0xd0,0x6f,0xfa,0x72},
+	{0x05,0x4d,0xb4,0xa8,0x82,0xaf,0x8b,0x4e,0x69,0xe7,0x21,0x8e,0xff,0xdf,0x9f,0xbd,0x5f,0x9d,0x7b,0x35,0xf0,0x09,0x6d,0x0c,0x15,0x8e,0x4d,0xfe,0xc0,0xa4,0xa3,0x53,0x1d,0x51,0x48,0xfb,0xa1,0xf0,0x4f,0x86,0xb4,0x2e,0x26,0xf4,0xda,0x44,0xa1,0x24,0xed,0x82,0xa0,0x98,0xd0,0xfe,0x1f,0xd8,0xec,0xcf,0x66,0xcb,0xe0,0x7f,0x0a,0x55,0xbb,0x68,0x67,0xbf,0xe7,0xc7,0x6e,0x8c,0x15,0x36,0x27,0x33,0xd0,0x23,0xa3,0x08,0xbb,0x21,0x99,0x24,0x31,0x5b,0xd1,0x02,0x2f,0xb0,0x28,0x4e,0x3b,0xfb,0xa2,0x3a},
+	{0xe0,0x9c,0xf9,0xd8,0x63,0xfb,0x78,0xf8,0x6c,0x3d,0x59,0x03,0xc8,0x8e,0x71,0xd0,0x59,0x26,0xc5,0x5b,0xb8,0x5c,0x2e,0xc6,0x38,0x52,0xb2,0x35,0xed,0xcb,0x25,0x71,0xae,0xb6,0x0b,0x12,0xb6,0xac,0x3a,0x2a,0xa8,0x8c,0x84,0x83,0xdf,0x75,0x59,0xb2,0x17,0xb0,0x8b,0xd7,0xbb,0x52,0x19,0xea,0x44,0x24,0xf6,0x25,0xc3,0xf1,0x57,0x0b,0x99,0xe7,0x99,0xe9,0xc3,0xb2,0x9e,0xee,0x0b,0x1d,0x5a,0x35,0xc3,0xbd,0x6f,0x7f,0x44,0x3d,0xdb,0x67,0x96,0xc7,0x7c,0xdb,0xb1,0x83,0xa0,0x24,0x2d,0xe5,0xb6,0x12},
+	{0x3d,0x25,0x54,0x86,0x64,0xfd,0xba,0xdc,0x81,0x68,0xe8,0x33,0xd5,0xdc,0x1c,0x4d,0x9e,0x29,0x01,0xa9,0x7a,0x22,0xb1,0xb6,0x9c,0x5a,0xe0,0x69,0xaa,0x62,0x49,0x50,0x43,0xdd,0xd9,0x98,0x4a,0xdd,0x90,0x53,0x9e,0x82,0x89,0x61,0x2d,0x59,0x92,0xd1,0xdb,0xdd,0xaa,0x5a,0x9d,0x32,0xe9,0xae,0x8c,0xa8,0x3d,0x4b,0xc5,0x2f,0x21,0x4a,0x02,0x28,0xf3,0xc0,0xff,0x3d,0x6b,0x60,0xcb,0x7f,0xba,0xe7,0x3c,0x57,0x34,0x25,0x2f,0x96,0x60,0x34,0x7a,0x30,0x84,0x02,0xf3,0x33,0x21,0xeb,0xb9,0x23,0xdb,0x47},
+	{0x0d,0xac,0xdb,0x4c,0x2b,0x32,0x10,0x72,0x5d,0x27,0x97,0x36,0xbf,0x72,0xfc,0xe3,0xba,0x4f,0x7a,0x4a,0x98,0x55,0x17,0x27,0xe0,0x58,0x00,0x54,0x52,0xa6,0x4f,0x60,0x3e,0x29,0xdd,0x75,0xdc,0x8a,0x99,0x37,0xb2,0x89,0xd7,0x41,0xda,0xea,0x6b,0xd7,0xcb,0x7b,0x22,0xf7,0x10,0x2c,0xeb,0x71,0x59,0x97,0x76,0xa5,0x95,0xc1,0x78,0x27,0x22,0x6e,0x31,0xc2,0x54,0xc1,0xa1,0x20,0x03,0xda,0x97,0xab,0x05,0x57,0x92,0xc9,0x73,0xaf,0xe2,0x61,0x1f,0xa7,0x0b,0xcd,0x5e,0x68,0x10,0x08,0x81,0xf3,0x09,0x7e},
+	{0xaf,0x2d,0xd3,0x08,0x5e,0xc3,0x85,0x62,0x12,0xec,0xb2,0x12,0xfd,0x53,0x9c,0x50,0xa7,0x7f,0xf6,0xac,0xec,0x54,0xd3,0x26,0xe8,0x3f,0x92,0xa4,0x27,0xc3,0xab,0x22,0x10,0x19,0x59,0x59,0x7d,0x6e,0xdd,0x37,0xe0,0xd7,0x15,0xdd,0xe2,0x8c,0x59,0x73,0x9e,0x6d,0x54,0xcf,0x6a,0xa7,0xeb,0x8e,0x1b,0x12,0x22,0x04,0x37,0x73,0xec,0x2c,0x50,0x14,0x0c,0x74,0xf9,0xf2,0x1c,0xe4,0x5d,0xf6,0x76,0x23,0xb6,0xf6,0x71,0xe7,0xd1,0x5e,0x2a,0x70,0xef,0xba,0x8e,0x52,0x44,0x82,0x2b,0x60,0x6e,0x4b,0xb1,0x1d},
+	{0xd6,0xc5,0xf9,0x5d,0xa2,0xb5,0xfe,0x74,0xe9,0x80,0x3d,0x39,0xd3,0x67,0x4a,0x0d,0x13,0x28,0xfa,0x19,0xd9,0x8c,0x8d,0x25,0xde,0x02,0xdd,0x1d,0x76,0x9b,0xd5,0x33,0xf1,0x63,0x31,0x0f,0xb2,0x15,0x83,0x74,0x1d,0x0c,0xb9,0xc4,0x0e,0xca,0xf4,0x8c,0xb3,0xa8,0x16,0x5c,0x32,0x05,0x2a,0x11,0xad,0x55,0xe3,0x88,0xdf,0xd8,0x69,0x67,0x8f,0x9b,0xc1,0xef,0x7b,0x86,0xf5,0xf6,0x5a,0x8e,0xc5,0xda,0x83,0x65,0x38,0xca,0xd8,0x0f,0x08,0x5b,0x7b,0x70,0x03,0x25,0x87,0xf6,0x11,0x00,0xc3,0x59,0xfa,0x25},
+	{0x7c,0x8f,0xc6,0xbf,0xa6,0xde,0x3b,0x55,0xfc,0x40,0x96,0x9a,0x8b,0xc4,0xc0,0xa4,0xb3,0x33,0xeb,0x54,0x01,0x9f,0x3f,0xb1,0x18,0xa2,0x8a,0xb3,0x4a,0xe8,0x1e,0x03,0xe0,0xf2,0x5b,0x70,0x83,0xef,0x88,0x63,0x1c,0xd3,0x05,0xdd,0xdc,0xb1,0x6a,0xc4,0xb9,0x1f,0xe7,0xa1,0x58,0xc8,0x4e,0xc1,0x56,0x32,0xd3,0x43,0x38,0xaf,0x93,0x7d,0xeb,0xf4,0x44,0x4f,0x91,0x26,0x33,0xb8,0x20,0x72,0xc0,0x75,0x43,0x01,0x3f,0x15,0x06,0x47,0xe2,0xa7,0x05,0x0b,0x5c,0xdd,0x8c,0xe8,0x35,0x91,0x5a,0x20,0xee,0x2d},
+	{0x83,0x74,0xc2,0x41,0x95,0x74,0xcc,0xbb,0xbb,0x72,0xc6,0x47,0x19,0x9d,0xc9,0x61,0x14,0x9d,0xbf,0xa4,0x4c,0x7a,0x91,0x88,0x83,0xbd,0xe7,0x4f,0xe7,0x1b,0xf3,0x67,0xfa,0xea,0x1a,0x95,0x13,0xda,0x3d,0x47,0x4a,0x99,0xb1,0x22,0xc6,0x41,0xeb,0xed,0xc8,0x4d,0x61,0x8d,0x27,0x84,0x4a,0x46,0x82,0x77,0x18,0x72,0x6e,0x62,0x31,0x6a,0x36,0xfa,0x63,0x12,0xfd,0xfa,0x60,0x9e,0x49,0x3c,0xd0,0x0a,0xfe,0x5a,0x43,0x1f,0xf8,0xe9,0x6d,0x5b,0x5b,0xf2,0xeb,0x8d,0xa5,0xad,0x56,0x67,0xb3,0xae,0xaa,0x0f},
+	{0x00,0x7b,0xe6,0xe4,0x5d,0x33,0xbf,0xcc,0x5d,0x0e,0x9e,0x7d,0xf3,0xa5,0x45,0xa8,0x71,0x7d,0x15,0x9f,0xa5,0x79,0x42,0x53,0xf2,0xc3,0xad,0x83,0xab,0x89,0x41,0x4f,0xbe,0xc7,0x4b,0x07,0x3d,0x83,0x81,0x0c,0x1e,0xa6,0x86,0xe4,0x5d,0x57,0x99,0x9c,0x0d,0xc6,0x15,0xaf,0xd3,0x44,0xe3,0xd5,0x22,0xe0,0x1e,0x6d,0xd1,0xcd,0xa4,0x71,0x6c,0x9d,0x2d,0x38,0x67,0x62,0xb7,0x43,0x76,0xd0,0x39,0xf6,0x0f,0xdd,0x3b,0xb2,0x0d,0x30,0x8c,0xdb,0x69,0xb0,0x6c,0x13,0xe2,0xfa,0x77,0xbf,0x00,0x21,0x0d,0x55},
+	{0x37,0x88,0x99,0x83,0x6b,0x24,0xa0,0xe7,0x42,0xbb,0xf5,0x13,0xac,0xa3,0x39,0xde,0x91,0x1b,0xc3,0x4b,0x1d,0x9b,0x8e,0x19,0x9c,0xbd,0xbc,0x0d,0xbb,0x9e,0xb0,0x12,0x2d,0x16,0x84,0xd6,0xd6,0x39,0x00,0x73,0xae,0x0c,0xa7,0xda,0xe2,0xf7,0x9c,0x35,0x6c,0xd6,0xcd,0x8e,0x1f,0x8e,0x72,0xbe,0x3d,0x50,0x45,0x41,0x8b,0x97,0xbe,0x04,0x54,0x58,0xa1,0xd1,0x38,0x19,0x1b,0x5c,0xc6,0xab,0x07,0xd3,0x47,0xc4,0x3e,0x7a,0xf7,0xe0,0x40,0xa1,0xa2,0x90,0x63,0xd6,0xe5,0xc4,0xae,0x6f,0xc6,0xa1,0x47,0x14},
+	{0x3d,0xaa,0x5f,0x3c,0x30,0x6b,0xb0,0x0c,0x5a,0xf7,0x8c,0x42,0x65,0x06,0x96,0x3d,0xce,0x56,0x08,0xc5,0xbb,0x35,0x17,0xea,0x6c,0xa0,0x6e,0x67,0xe1,0xfa,0x9f,0x57,0xe8,0x47,0x75,0xfd,0xa5,0x5b,0x64,0xfb,0xd0,0xa3,0x37,0xca,0xac,0x3d,0xf2,0x94,0x18,0x53,0xf5,0xd0,0x8a,0x12,0x40,0xd8,0x19,0xb0,0x71,0xaf,0x47,0x19,0xca,0x1a,0x74,0x5c,0x1f,0x12,0x88,0xbe,0xcb,0x9e,0xb7,0x1a,0x2e,0x01,0xf4,0x1b,0xe2,0x41,0x53,0xe1,0x40,0x40,0x67,0xe2,0x50,0xf4,0x2a,0xe8,0xed,0xe9,0xb8,0xe4,0x48,0x5f},
+	{0x57,0xe2,0xee,0xad,0x8e,0x37,0x7b,0x2a,0x3f,0x3c,0xa3,0xd1,0xa6,0x09,0xe6,0x1a,0xff,0x6a,0x05,0x9b,0x17,0xa2,0x3f,0x8b,0xab,0x1e,0x3c,0xbe,0xd6,0x73,0xab,0x64,0x28,0x65,0x7d,0x8a,0x57,0x1c,0xd2,0xc4,0x04,0xba,0x13,0x77,0x12,0x0c,0x9a,0x6c,0x21,0xea,0x90,0xfe,0x56,0x66,0xa8,0x8e,0x86,0x8e,0x5d,0xbc,0x88,0x64,0x30,0x0c,0xb0,0xdc,0xb5,0x9d,0xcd,0x37,0xac,0x35,0x95,0x8b,0xb9,0xe8,0x06,0x29,0xbc,0xa9,0xa3,0x8f,0x58,0x51,0xbd,0xd5,0x42,0xd6,0x85,0x66,0xed,0x06,0x92,0x6e,0x14,0x7c},
+	{0x6f,0x1e,0x92,0x08,0x2f,0x03,0x6d,0xa7,0x93,0xe3,0x23,0x15,0x69,0xaf,0xe4,0x23,0xa7,0x44,0x8c,0x37,0xf2,0xe0,0xa4,0x32,0x7a,0xed,0x94,0x35,0xb7,0x81,0xfb,0x75,0x42,0x53,0xe6,0xea,0xe3,0x78,0x74,0x4f,0x20,0x3f,0x12,0x3c,0x07,0xd0,0x46,0x3f,0x11,0x89,0x92,0xd0,0xa7,0xd1,0xf4,0xaf,0xc2,0xc3,0x39,0x59,0x1f,0x65,0xad,0x2c,0xd2,0x8f,0xa1,0xad,0x8d,0x56,0x85,0x34,0x2e,0xd7,0x6e,0x4c,0x4f,0x50,0x16,0x5f,0xc2,0x38,0xbe,0x6b,0x00,0x7d,0xcf,0xa8,0x08,0x0d,0x26,0xa9,0x7d,0xd4,0x09,0x21},
+	{0xfb,0xb1,0x52,0xf0,0x4a,0x4a,0x5f,0xeb,0x58,0x57,0xfa,0x3e,0x1a,0x3f,0x1f,0x12,0xd5,0xfb,0x5e,0x66,0xa0,0x39,0x15,0x0e,0xc1,0x73,0x61,0x17,0x1f,0xc8,0x78,0x5e,0x0c,0x4a,0xa1,0x21,0xc8,0xf4,0x1e,0x1e,0xa7,0xa6,0xdd,0x70,0x81,0xd4,0xe5,0xae,0x36,0x58,0x23,0x93,0xb9,0xd5,0xa8,0x4b,0x3f,0xec,0x83,0x27,0x73,0x81,0x06,0x58,0x59,0xdd,0xe1,0x8c,0x8e,0x0a,0xb8,0x67,0x2e,0x1c,0xf4,0xa4,0x86,0x53,0x7f,0xa5,0x4d,0xd3,0x3f,0x84,0xa8,0xe8,0x82,0x90,0xa1,0x26,0x9f,0xe0,0x6e,0xac,0x30,0x59},
+	{0xfa,0x46,0xff,0x52,0x17,0x52,0x8d,0x40,0xf5,0x98,0x5b,0xd9,0x51,0xfd,0x71,0xec,0xe6,0x31,0x97,0x46,0x8d,0x15,0xbd,0x3f,0x5a,0x48,0xcc,0x0b,0x48,0xa2,0xb5,0x4a,0x7a,0x71,0x34,0x06,0x54,0x28,0xb5,0xdc,0xf2,0xc2,0x4e,0x9f,0xc0,0xf3,0x1c,0x01,0x32,0xa1,0xf5,0xea,0x96,0x44,0xfa,0x01,0xf5,0x5c,0x3d,0x2f,0xce,0x6d,0xef,0x0b,0x4b,0xb7,0xcb,0x17,0x64,0xa4,0xc0,0xad,0xb3,0x9a,0x6e,0x08,0xa4,0x6d,0x03,0x58,0xb4,0x41,0x89,0x4f,0x11,0x03,0x05,0x15,0x45,0xea,0x3a,0x4a,0x01,0xcc,0xfb,0x6f},
+	{0x92,0x0b,0xe3,0xed,0x90,0xfd,0x90,0xf0,0x02,0x0a,0x05,0x60,0x7c,0x42,0xcd,0x67,0x14,0x85,0x77,0xb1,0xfc,0x55,0xe5,0x6f,0x35,0xba,0xb3,0xa5,0x8b,0xde,0x5e,0x1b,0x52,0x93,0xd2,0x3b,0x18,0x7e,0x4e,0x3b,0x6b,0x7b,0x21,0x42,0x54,0xf0,0x97,0x25,0xaf,0x44,0xef,0xc4,0xaa,0x77,0x2c,0xe3,0xf7,0x99,0xe1,0x2c,0x3e,0xaf,0xda,0x11,0xe3,0x37,0x11,0xd0,0xad,0xbd,0xc0,0x95,0x17,0x49,0xea,0x40,0x25,0x6d,0x03,0x11,0x86,0x78,0x59,0xa7,0x26,0xe3,0x37,0x7d,0x4b,0x56,0x5e,0x3a,0xbc,0x27,0x45,0x22},
+	{0xbb,0x47,0x36,0x46,0x3b,0xce,0xf0,0x41,0x89,0x72,0x72,0xb6,0xe9,0x2f,0x3f,0x4d,0x3a,0xdc,0x8b,0x36,0x67,0x3c,0x91,0xb7,0x3d,0x3c,0x9c,0x92,0xed,0x37,0x68,0x53,0x34,0x27,0xc3,0xe0,0x26,0x66,0x96,0xfa,0x33,0x36,0x69,0x7c,0x77,0x7a,0x32,0x57,0x0f,0xf5,0x30,0x17,0xe0,0xe8,0x4d,0x92,0xef,0x81,0x72,0xff,0xb1,0x6f,0xad,0x5f,0xbd,0x7d,0x79,0x83,0x31,0xa0,0x47,0x9c,0xb5,0xab,0xc2,0xb0,0x4c,0x8e,0xfe,0x10,0x4c,0x75,0x04,0xf5,0x00,0x01,0x6b,0x8b,0xe5,0x74,0x6b,0x48,0x9f,0xf0,0x7d,0x18},
+	{0xac,0x0d,0x4c,0xf6,0x7e,0x3f,0xad,0x22,0x21,0xab,0x06,0x6f,0x6b,0x15,0x57,0x78,0xef,0x34,0xbb,0x91,0xed,0xa3,0x65,0x4f,0xb0,0x6f,0xf8,0x18,0x61,0x06,0x64,0x64,0x7b,0xb8,0x4b,0xe1,0x1c,0xfa,0x3b,0x4e,0xd9,0xa9,0xf8,0xd9,0x8b,0x91,0x4e,0x2d,0x5a,0xde,0xe3,0x75,0xb4,0x78,0x85,0xce,0x3e,0x0a,0x0f,0x52,0x43,0x85,0x2e,0x2c,0xda,0xac,0x01,0x33,0xfe,0x0e,0xda,0x1f,0x52,0x5b,0x8a,0x21,0x7b,0xd9,0x16,0xf1,0x3f,0x9a,0xe0,0x3d,0x75,0x0f,0xdf,0x55,0x7c,0x2c,0x15,0xe4,0x7a,0xe8,0x8d,0x3d},
+	{0x8b,0x4f,0x47,0x0d,0x35,0xbc,0xab,0x8e,0xbc,0x05,0x9a,0x90,0xd8,0x58,0x5c,0xa3,0x94,0x81,0x20,0x5e,0x83,0x5a,0x22,0x1e,0x68,0xd1,0x1b,0x61,0x9e,0x85,0xc4,0x04,0x4b,0x01,0x44,0xaa,0x35,0xe2,0x30,0xf0,0xfc,0x73,0x1d,0x99,0x60,0x9d,0x18,0xa1,0xc7,0xcc,0x8c,0x7f,0xab,0x47,0xc2,0x62,0x31,0x58,0x97,0xe9,0x93,0xd0,0x47,0x02,0x13,0x73,0x72,0x38,0x9a,0x48,0xc1,0x44,0x2c,0xdb,0x13,0x52,0x90,0x25,0x0f,0xb8,0x60,0x01,0xc7,0x41,0x9d,0xcd,0xc2,0xba,0x8d,0x60,0xcf,0x71,0x9b,0x72,0x6d,0x1e},
+	{0x35,0x2a,0x69,0x3f,0xa2,0x0c,0xd8,0x19,0xc2,0x13,0xc0,0x34,0xbd,0xe9,0xbe,0x6d,0x5b,0xe8,0x93,0xa8,0x9e,0x7e,0xb2,0x04,0x62,0x38,0x5d,0x28,0x1e,0x33,0x18,0x72,0x60,0x20,0xe3,0xab,0xc2,0xd8,0xc2,0x08,0x63,0x38,0x00,0xab,0x26,0x47,0x4a,0x3d,0x8f,0x5a,0x4d,0xa1,0xd2,0x34,0x1f,0xc2,0x85,0x2b,0x82,0x53,0x54,0x4a,0x0e,0x0f,0x60,0xe6,0xb4,0xb2,0xfe,0x23,0x2e,0xf2,0x40,0xe4,0x93,0x16,0xa0,0x1a,0x82,0x6f,0x4b,0x7b,0x20,0x05,0x2d,0xe9,0x7a,0x24,0x39,0xbe,0x38,0xde,0x1c,0x53,0x54,0x0f},
+	{0xfc,0x26,0x0c,0xca,0xab,0xe7,0xd3,0xb4,0xc3,0x19,0x8b,0x70,0x1e,0xaf,0x50,0x2d,0x4f,0x8b,0x1d,0x2b,0x7f,0xec,0xd5,0x9a,0x1e,0x74,0xdd,0x98,0x34,0x8b,0x49,0x26,0x5d,0x0b,0xa5,0x71,0x29,0xbc,0x00,0x44,0x5f,0xfb,0xfc,0x89,0x86,0x12,0xe4,0xa5,0x34,0xd6,0x96,0x06,0x5f,0x4e,0xc3,0x33,0x94,0x3b,0x6e,0xf3,0xe6,0xc2,0x01,0x0b,0x8b,0x6f,0x7a,0xdb,0x42,0xaf,0xd6,0x00,0x3e,0xc5,0x2b,0xba,0xfd,0x4b,0x48,0x68,0x02,0xfc,0xe2,0x5d,0xfc,0x86,0x49,0x12,0x79,0xfb,0x54,0x72,0x41,0x4a,0x0a,0x43},
+	{0xb4,0x9e,0xfa,0x7c,0x51,0x6d,0x46,0x6e,0x87,0x60,0xdc,0xd5,0x14,0x6c,0x8e,0x9a,0x11,0x8d,0x6e,0xf5,0xf0,0x73,0xf6,0x7d,0xf8,0x58,0x96,0x05,0x8c,0xce,0x75,0x51,0xdf,0x35,0xb8,0x33,0xe9,0x9e,0x65,0xd3,0x36,0xe9,0x0d,0x29,0x54,0x6f,0x92,0x15,0x49,0xac,0x73,0x5a,0xe8,0xd9,0x60,0xc2,0xb2,0xe0,0x3a,0x29,0xf6,0xda,0xca,0x2f,0xd0,0x0d,0x42,0xba,0x94,0x5b,0xd8,0xc7,0xdb,0x9f,0x60,0x88,0x8a,0xcc,0x75,0x56,0x02,0x10,0x04,0xc0,0x20,0xdc,0xdb,0x99,0x03,0x7d,0x4b,0xa3,0xd6,0x81,0xaf,0x1c},
+	{0x0a,0xb9,0x0b,0x94,0xfe,0x28,0xb9,0x03,0x49,0x47,0x57,0xee,0xfa,0x86,0x42,0x39,0x70,0x1f,0x29,0x02,0x7c,0x87,0x09,0xcb,0x89,0xc3,0x55,0x38,0xd1,0xe1,0x68,0x25,0x61,0xf4,0x80,0x31,0xf9,0x79,0x32,0x8a,0xc8,0xaf,0xda,0xe6,0x49,0xce,0x5d,0x3b,0x4f,0x9a,0x00,0x41,0xfb,0x00,0x87,0xbd,0x16,0xf9,0x23,0x96,0x57,0x38,0x65,0x5b,0x2f,0xf3,0x36,0xed,0xbf,0xe5,0x9e,0xcd,0xe7,0xa6,0x57,0x26,0x63,0x61,0x5b,0x93,0x3c,0xe2,0x3f,0x30,0x7b,0x81,0xfd,0x2c,0xae,0xbf,0x6e,0x5a,0xcc,0x82,0x50,0x2a},
+	{0xda,0xc4,0x40,0x36,0x70,0xcb,0xb9,0xa3,0xf1,0x00,0x97,0xbe,0xe5,0x48,0xc9,0xc6,0x55,0xaa,0x2c,0x01,0x42,0x31,0x4a,0x6a,0x50,0x76,0x04,0xbc,0x68,0xd2,0x5a,0x13,0x30,0x5f,0x8f,0x6d,0x38,0xfe,0x8d,0x76,0xe6,0x50,0x4c,0xb2,0x0b,0x1a,0x1d,0xd4,0x78,0x49,0xc6,0x71,0x9b,0x4a,0x26,0x8b,0xd7,0xb9,0xfb,0x3d,0xcc,0xb2,0xa0,0x49,0x9d,0xcc,0x76,0x6a,0xa7,0xa9,0x14,0x26,0x99,0x14,0xb8,0x45,0xe2,0x96,0x44,0x15,0x3a,0x96,0x8e,0x6f,0xb0,0x85,0xd4,0x5b,0xeb,0x16,0xc1,0x05,0xdf,0x5a,0x8a,0x56},
+	{0x4c,0x77,0x4f,0x58,0xfa,0x1b,0xf4,0x5a,0x24,0x3c,0x6b,0x82,0xc4,0x24,0x77,0x9d,0xbc,0x5e,0x3f,0x06,0xd3,0xa8,0xfa,0xa7,0x6a,0x31,0x8c,0x16,0x6e,0x6d,0xf4,0x1b,0x0a,0xdb,0x26,0xed,0x47,0x1d,0xe0,0xce,0xb8,0x5b,0x12,0xb7,0xb3,0x9c,0xdf,0xf0,0xf2,0x6c,0x23,0x5e,0x22,0x7d,0x39,0x57,0x23,0xd4,0x70,0x94,0x22,0xfb,0x1d,0x22,0x9e,0x22,0xac,0xa8,0xf3,0x1e,0xa9,0x7e,0x43,0x2b,0x36,0x6c,0x97,0xc1,0xb6,0xa0,0x19,0x95,0x60,0x9d,0xc8,0x35,0x17,0x20,0x18,0x62,0xd6,0x4f,0x08,0xf2,0x56,0x32},
+	{0xa0,0x21,0xb3,0x99,0xbe,0x48,0x4c,0x17,0xf7,0x3c,0xec,0x4f,0x8a,0x33,0x34,0xea,0x78,0x9a,0x01,0x3b,0x80,0xe6,0xe1,0x0a,0x20,0x00,0xb6,0x2a,0x80,0x26,0x85,0x42,0xd0,0x2f,0xb0,0xfa,0xc4,0x5a,0xe5,0x5e,0x25,0x98,0xbe,0x59,0x11,0xe1,0x52,0x67,0xf5,0xeb,0x7a,0x82,0x34,0x38,0x51,0x4e,0xa1,0x32,0x3a,0xc1,0x36,0x85,0x14,0x6f,0x2e,0x24,0xb0,0x3e,0x9b,0xa6,0xac,0xbc,0xed,0xbc,0xb8,0x16,0xc3,0x86,0x28,0xb0,0x1b,0xec,0xc8,0xc1,0x5d,0x8f,0x1a,0xba,0x82,0x19,0xd2,0xde,0x9c,0xe5,0x18,0x39},
+	{0x9f,0xdd,0x13,0x97,0x77,0x44,0x7b,0xe9,0x93,0x2c,0x6d,0xde,0xe0,0xfc,0x7f,0xba,0xdf,0x56,0x2c,0x93,0xb5,0x65,0x5d,0x77,0xbe,0x0a,0x1c,0x7e,0x68,0x81,0xbd,0x43,0xc6,0x50,0x0f,0xdc,0xc2,0x48,0x3e,0xe6,0xfc,0x19,0xc4,0x16,0x48,0xe8,0x99,0xd7,0x6b,0x02,0xc7,0x65,0x66,0xad,0xa7,0xa6,0xf2,0x67,0x18,0xd1,0x12,0xbe,0x64,0x73,0x8f,0xa9,0x49,0x61,0x6c,0x21,0x2e,0x8f,0x22,0xa4,0xa3,0x85,0x6e,0xe1,0x90,0xa9,0xd8,0x1e,0x6a,0x4e,0xe2,0x7d,0x6c,0x5c,0x71,0xcc,0x13,0x5f,0x3e,0xd5,0x3c,0x54},
+	{0xa4,0xe3,0xc1,0x96,0xa7,0xe5,0xcf,0xc1,0xc0,0x3d,0x9a,0xcd,0x2d,0x68,0xdb,0x9c,0x68,0xae,0x4f,0x8c,0xf0,0x02,0xe7,0xfd,0x11,0x67,0xe4,0xb5,0x36,0x75,0xdf,0x3f,0xd0,0xd9,0x3d,0x3f,0x15,0x55,0xa5,0x70,0xa0,0x03,0x3a,0x1d,0x0e,0xa3,0x6d,0xac,0xb9,0xc5,0x71,0x46,0x3c,0x90,0xe7,0x14,0x54,0x13,0x35,0xac,0xf0,0x79,0xbd,0x2f,0x18,0xc6,0x2f,0x54,0x14,0x9f,0xb5,0x40,0xb5,0x9f,0xa7,0x2d,0x51,0x7c,0x21,0x51,0x46,0xd5,0x74,0xff,0x0d,0x06,0xde,0xd7,0x71,0x90,0x48,0x65,0x3e,0xdb,0xf9,0x24},
+	{0xea,0xac,0xdb,0x80,0x16,0x2c,0x8f,0xc3,0x9a,0x28,0x39,0xfd,0xee,0xae,0xe8,0x46,0xd8,0x6c,0xa4,0x61,0xb8,0x04,0x43,0x96,0x61,0x7e,0xd3,0xdc,0xaf,0x90,0x0b,0x10,0xaf,0x7b,0xa6,0xf0,0x94,0xf2,0xb1,0x0a,0xe5,0xc2,0xfc,0x91,0x3c,0xfa,0xc0,0xb7,0x29,0x04,0xf5,0x2c,0x00,0x11,0x14,0x9e,0x1b,0x6e,0xf2,0x25,0xec,0x59,0xbb,0x1f,0xab,0xb9,0x18,0x9a,0x80,0x12,0x1e,0x77,0x07,0x01,0x33,0x07,0xbf,0xf4,0x5b,0x06,0x7c,0xb3,0x5d,0xea,0xc4,0x0c,0x58,0x51,0x3f,0x83,0x86,0x2e,0x49,0x9f,0x23,0x78},
+	{0x7e,0x90,0x0b,0xb2,0x65,0xd7,0xa5,0xbd,0xde,0xce,0xdc,0x4a,0xf2,0xe9,0xd7,0xb7,0xdd,0xfc,0x1b,0xfb,0xa0,0x26,0x59,0xe2,0x6a,0x3b,0x4f,0x8f,0xde,0x3a,0xd9,0x7f,0x71,0x97,0x73,0x5d,0x17,0x51,0xe8,0x87,0x06,0x3a,0xd8,0x92,0x4f,0xf5,0x70,0x48,0x05,0xcb,0x80,0x13,0xd5,0x0d,0x93,0xca,0x74,0x31,0x0d,0x28,0x18,0x9c,0xc2,0x20,0x48,0xd5,0xca,0xbd,0x2a,0xb9,0xa5,0xc0,0xea,0x4c,0x35,0xa4,0xdc,0x4c,0xd0,0x66,0xd7,0xa2,0xf3,0xad,0xf9,0x95,0x67,0x9b,0x13,0xbc,0xb9,0x3b,0x3c,0xba,0x7f,0x4a},
+	{0x4b,0xd4,0x3d,0x11,0xda,0xb3,0x35,0x21,0xa7,0x0b,0x9f,0x7a,0xb2,0x75,0xb4,0xc5,0x22,0xa3,0x2f,0x08,0xde,0x39,0xd7,0xaf,0x67,0x9c,0xd9,0x75,0xf8,0x7c,0xd5,0x45,0x2d,0xd9,0x4b,0xbb,0x66,0xf5,0x7f,0x71,0x0e,0xfa,0xe8,0x32,0xc2,0x28,0x98,0xed,0xf9,0xa8,0x72,0x3f,0x11,0x68,0xf7,0x95,0x4a,0x86,0x93,0x20,0xd7,0x5e,0x3b,0x1c,0xc1,0x3c,0x67,0x93,0x6b,0x82,0x77,0x47,0x6f,0xa9,0xae,0x85,0x35,0x65,0x64,0xd9,0xa2,0xb6,0x18,0x6c,0x50,0xb6,0x45,0x81,0xdc,0x29,0x0a,0x80,0x97,0xf5,0x03,0x5e},
+	{0xd8,0x94,0x29,0x8a,0x62,0x3a,0xc9,0x7b,0x25,0x86,0xbe,0xa4,0xf0,0x4f,0x7a,0xbb,0xa8,0xd6,0xc0,0xc5,0xac,0xd3,0x09,0x86,0x1a,0x0c,0xc1,0x48,0xa9,0xed,0x6f,0x79,0x7f,0x8b,0x72,0xde,0x90,0x1d,0x8b,0xb1,0x55,0xed,0x34,0xe2,0xb7,0xaf,0x9a,0x2a,0xac,0x9f,0x98,0x8e,0xde,0x18,0xd0,0x9a,0x36,0xb3,0xcb,0xb9,0xc6,0x93,0x7e,0x46,0xbf,0xba,0x07,0x5b,0x22,0x24,0x08,0xc0,0xc8,0x0c,0x5f,0xe3,0x14,0x99,0x97,0xa4,0x38,0x33,0x57,0x18,0x55,0x2e,0x22,0x56,0x1f,0x3b,0x87,0x8b,0x2e,0x7e,0xec,0x7f},
+	{0x6c,0xca,0xee,0xda,0xe2,0x0b,0x84,0x2d,0x16,0x2c,0xb5,0x6b,0xf0,0x16,0x07,0xdd,0xd5,0xbb,0xb5,0xf5,0x22,0x83,0xec,0x4f,0xd6,0xb6,0x6e,0xce,0x13,0xed,0x4e,0x3d,0xe5,0x6b,0x44,0x48,0x77,0xd4,0xb3,0x32,0xad,0xa0,0x19,0x93,0xef,0xd4,0x94,0x46,0x93,0x6b,0xd0,0xe8,0xc3,0xb5,0x23,0x60,0x6e,0x35,0x41,0xc3,0x8d,0x6f,0x81,0x5b,0xf5,0x38,0x97,0xd5,0x38,0xae,0x0a,0xb1,0xf9,0x84,0xaa,0x17,0x51,0xd9,0x80,0xfc,0xfb,0xda,0x9f,0x3f,0x26,0x45,0xc1,0xc1,0x0f,0x0a,0x61,0x91,0xbe,0xbf,0x4e,0x64},
+	{0x4f,0x01,0xd4,0xdd,0xe6,0xd8,0xdf,0x9e,0x5f,0xf8,0xad,0x46,0x2f,0x56,0xdc,0xd9,0xd6,0x09,0xf1,0xcd,0xd7,0x4c,0xb6,0xac,0x5b,0x29,0x32,0x21,0x9c,0x29,0xd7,0x0e,0xbf,0x84,0x13,0xf5,0x24,0xb7,0xd9,0x40,0x0e,0xf4,0x0b,0x2a,0x7d,0x36,0xca,0x14,0xdc,0x6b,0x01,0x14,0xab,0xf2,0xaa,0xfb,0xd9,0x1d,0x50,0xd7,0x51,0x9d,0x2c,0x69,0xcc,0x51,0x8d,0xf7,0xed,0x3e,0x6a,0x89,0x17,0x75,0x47,0x52,0xe8,0xf8,0x45,0x7b,0x2c,0xc6,0x23,0x0c,0xf3,0x2c,0xda,0x97,0xdb,0x24,0x59,0xfd,0x45,0x3f,0x98,0x46},
+	{0xa0,0x4a,0x8b,0x82,0xeb,0x27,0xc2,0xb9,0xb5,0x2d,0xfe,0xb9,0xd5,0x7f,0x99,0xb0,0xe2,0x6f,0x6a,0x1e,0xf1,0x46,0x42,0x15,0x7a,0x7d,0xca,0x95,0x3d,0x16,0xb3,0x15,0x58,0xb1,0xc5,0xc4,0x6e,0xb0,0xec,0xac,0xec,0x69,0xeb,0x21,0x44,0x98,0x9c,0xa1,0x3e,0xcf,0xed,0x80,0x87,0x50,0x4a,0x6d,0x12,0x14,0x28,0xda,0xf6,0x21,0x70,0x78,0x69,0x55,0xa5,0x38,0x46,0x96,0x9a,0x5b,0x9b,0x8a,0x52,0x86,0x49,0x7e,0xdb,0x52,0x84,0xb3,0x43,0x26,0xa9,0x0f,0x47,0x27,0x93,0xbe,0x46,0xee,0xbe,0x5a,0xdd,0x40},
+	{0xca,0x99,0xe8,0xa9,0xd6,0x21,0xe1,0xb5,0x5d,0xce,0xc1,0x0a,0xf7,0xcb,0xf5,0x7e,0x80,0x73,0x98,0x8c,0x9d,0x17,0x84,0x30,0x78,0x21,0x0b,0xa7,0x1f,0xf7,0x30,0x0c,0xa6,0x3e,0x07,0x8b,0x87,0x00,0x68,0x8a,0x45,0xc0,0x8b,0xc8,0xb9,0xbc,0x3e,0x22,0xb3,0x6d,0x48,0xd7,0x47,0xa3,0xa6,0x91,0x7f,0x45,0x14,0xa2,0x98,0x1c,0xd4,0x1e,0x1d,0xd1,0x61,0x34,0x9c,0x62,0xb9,0x7d,0x31,0xd8,0x10,0xa3,0x11,0x97,0x81,0x52,0x98,0x1f,0xe9,0x6f,0x60,0x3a,0x7f,0xc2,0x1c,0xa5,0x81,0x7f,0x70,0x44,0xcd,0x54},
+	{0x08,0x3e,0x75,0xe4,0x3f,0x95,0x16,0xac,0xfb,0x3e,0x44,0x4d,0x7f,0x31,0x5e,0xba,0x2c,0x06,0x01,0xf8,0x1a,0xed,0xca,0x82,0x0d,0x38,0x8d,0x86,0xac,0x24,0xfa,0x61,0x44,0x00,0xed,0x29,0x60,0x1e,0x63,0x89,0x43,0x81,0xe4,0x63,0xa5,0x6a,0xf8,0x09,0xed,0x88,0x2f,0x08,0xb5,0xe1,0xb1,0xd2,0xd2,0x73,0x31,0x42,0x98,0xa5,0x35,0x67,0xf0,0xa5,0x47,0x4d,0xb9,0x6a,0xdb,0x53,0x13,0x47,0x24,0x6f,0x0a,0x30,0x16,0x46,0xc0,0xa0,0x0c,0xa5,0xcd,0x96,0xa8,0x23,0xbd,0x2e,0x25,0x0d,0x23,0x3f,0xa7,0x37},
+	{0x81,0xa4,0x6a,0xd6,0x45,0x84,0xdc,0x71,0x6c,0x57,0x76,0x06,0x26,0x5b,0xa1,0x3d,0xa2,0xa4,0x65,0x4d,0x9b,0x15,0x8e,0xaa,0x25,0xe7,0xe7,0xdf,0x19,0xf7,0x6e,0x3e,0x4d,0x6b,0xbe,0x2b,0x76,0x82,0x8c,0xbb,0xac,0xcf,0xf1,0xab,0x17,0x1f,0xc8,0xbd,0x7f,0xaa,0x66,0x12,0x76,0x10,0x53,0xfa,0xaa,0x8f,0xb4,0x31,0x39,0x7e,0xfa,0x73,0x83,0x7d,0x0a,0x09,0xd2,0xb8,0x57,0x60,0x4d,0x64,0x70,0x0b,0x95,0x53,0xdd,0x59,0x60,0x8f,0x6c,0xd7,0xa7,0x52,0xe4,0xc8,0x7c,0x5b,0x35,0x7c,0x1d,0x68,0x66,0x0b},
+	{0xd5,0xce,0x1c,0x86,0x24,0xac,0x96,0x1e,0x09,0x7b,0x67,0xcf,0xa4,0x9c,0xbf,0x40,0x50,0xfd,0x4c,0x5f,0x36,0x86,0x3b,0x25,0xb7,0x8f,0x47,0x0e,0x8d,0x67,0xa7,0x17,0x37,0xd4,0x67,0x86,0xd5,0xf5,0xf3,0xa1,0x81,0x13,0x24,0x6e,0xb9,0xd2,0x6f,0xc6,0x2e,0xf3,0x7a,0x85,0x16,0x58,0x6b,0x6c,0x1a,0xab,0x14,0x8b,0xd3,0x0f,0x6a,0x42,0x2c,0x85,0x0c,0xb8,0xa2,0x3f,0x2d,0xd4,0xde,0x1b,0x1a,0x50,0x08,0xea,0xcc,0xef,0x4a,0x5f,0x57,0x5d,0x20,0x40,0x50,0x23,0xc9,0x74,0xc9,0x52,0x4e,0xf4,0x8e,0x18},
+	{0x84,0x5b,0x56,0x3d,0xbc,0x48,0xe4,0x44,0xd6,0xb7,0x7b,0x0e,0xd0,0x65,0x97,0x59,0x99,0x2f,0xf9,0xd0,0x8a,0x38,0xba,0xc2,0x68,0x64,0x3c,0xae,0x45,0xeb,0xdd,0x25,0x63,0x4b,0x9a,0xc8,0x0a,0xcf,0x29,0x8f,0x40,0x4c,0xc0,0x18,0x74,0x3e,0x27,0xcf,0x40,0x75,0x61,0xbf,0xb2,0xbc,0x11,0xf9,0xac,0x73,0x72,0x0c,0x12,0x3c,0xaf,0x33,0x79,0x82,0x39,0xe4,0x9c,0x83,0x04,0xb1,0x94,0x03,0xa3,0x82,0x12,0xe6,0xe2,0xa8,0xde,0x1e,0x66,0x81,0xa6,0xe7,0x86,0x10,0x0e,0x11,0x53,0xf5,0xee,0x8a,0x38,0x0d},
+	{0x07,0x7b,0x59,0x77,0x64,0x5a,0xe7,0x01,0xe6,0x4b,0x93,0x7b,0x21,0xe2,0xf7,0xe4,0xca,0xb7,0x70,0x4a,0x98,0x3e,0x96,0x7a,0xd4,0x03,0xbe,0x8b,0x69,0x71,0x17,0x68,0x36,0xf5,0x02,0x75,0x9a,0x2d,0x84,0x77,0x02,0x77,0x32,0xd6,0x1e,0x42,0x26,0x25,0xc7,0xec,0x9f,0x1c,0x8a,0xae,0xcc,0x63,0x45,0x82,0xfa,0xc3,0xe9,0xa6,0x6b,0x5f,0x86,0xcc,0x94,0x26,0x1f,0x51,0x7a,0xa7,0x9d,0xf3,0x37,0x98,0x7b,0x2c,0xd5,0x64,0x46,0xcd,0x97,0x18,0xaa,0xf8,0xe8,0xef,0x20,0x4d,0x57,0x15,0xb1,0x0e,0x42,0x56},
+	{0x80,0x3d,0x33,0xdb,0x03,0x47,0x88,0x2d,0x08,0x25,0x89,0xa1,0x28,0x34,0xa4,0xd3,0x51,0xa9,0x0b,0x06,0x70,0xa4,0xf2,0xb2,0x11,0x0e,0xdd,0xa7,0xd8,0x6b,0x68,0x1a,0x2c,0x50,0xe3,0xe6,0x21,0xdf,0x7f,0x03,0x81,0x8e,0x20,0x92,0x39,0xcc,0x3d,0x51,0x6c,0xf0,0xc7,0x99,0xeb,0x12,0xaa,0xe2,0x40,0xcd,0x16,0x7b,0xc3,0xfc,0xd6,0x20,0x49,0x9a,0xb0,0xed,0x3a,0x08,0xe0,0x85,0x05,0x84,0x2c,0xdc,0xea,0xa4,0x1d,0x60,0xd3,0xe2,0x16,0x2d,0xbd,0xf1,0x38,0x0f,0x58,0x7f,0x6f,0x45,0x6d,0x3a,0x37,0x53},
+	{0x6c,0x99,0xfa,0x3e,0xbc,0xd2,0xe2,0x41,0xfe,0x92,0xf7,0x1d,0xa7,0x0a,0x70,0xa8,0x42,0x9c,0x1e,0x1f,0x0d,0xb4,0xfd,0x80,0xd5,0xb5,0x06,0xd3,0x00,0xa2,0xdc,0x3e,0xb2,0x49,0x99,0x17,0xc1,0x40,0x5a,0x2f,0x93,0xbc,0x76,0x98,0x38,0x4c,0xbc,0x95,0xf7,0x5c,0x69,0x5f,0x02,0x54,0xb7,0x60,0x87,0xb8,0xad,0xcc,0x81,0x39,0x50,0x50,0xfd,0xf8,0x7b,0xad,0xd8,0xd8,0x1f,0xab,0xf3,0xc5,0xfe,0x06,0xe3,0x2d,0x91,0xf2,0x73,0xea,0x37,0x9a,0x07,0xfa,0xbe,0x00,0x45,0x7c,0x00,0x92,0x57,0x16,0x1b,0x06},
+	{0x7e,0x35,0xf9,0x4c,0xbe,0x38,0x4a,0x04,0xdd,0x05,0x37,0x2c,0xb8,0x6a,0xd0,0xb4,0xd7,0x75,0x8b,0xfe,0x83,0xa4,0xb7,0x2a,0x46,0x40,0xfa,0xbf,0xd9,0xa6,0x23,0x4e,0xab,0x1b,0x32,0x53,0xd0,0xe0,0x3a,0xae,0x84,0x2b,0x3b,0x4c,0xfb,0x40,0x26,0xfd,0xae,0x75,0xda,0x1b,0xcc,0x71,0x45,0xab,0x13,0x72,0xbf,0x92,0x0a,0x58,0xac,0x53,0xa2,0xa7,0xd4,0xec,0xb4,0xc6,0x05,0x5a,0xa6,0x1f,0xcc,0xfd,0x19,0x2e,0x29,0x77,0xe8,0xdb,0xd1,0x82,0x0c,0xf6,0xd5,0x7d,0xa6,0x93,0xea,0x9a,0x20,0xf9,0xc9,0x6c},
+	{0x40,0xef,0x6e,0xa6,0x59,0x9f,0xa6,0xde,0xb3,0x02,0xb7,0x38,0x2f,0xbc,0x98,0x63,0x41,0xdc,0xc2,0xa0,0xfe,0x20,0x49,0xe5,0x8c,0xab,0x9b,0xfb,0x83,0x29,0xe3,0x03,0x71,0xde,0x1a,0xa7,0xa0,0x06,0x51,0xc6,0xc5,0xe7,0x13,0x6c,0x58,0x64,0x9c,0xd9,0x65,0xa1,0x4f,0x19,0x36,0xa7,0xcd,0x47,0x85,0x88,0x44,0x8e,0x62,0xec,0xb0,0x78,0x80,0x6a,0x16,0x33,0xca,0xc1,0xe0,0x78,0x4a,0x6b,0x76,0x12,0xa0,0xd2,0xac,0xba,0x3f,0xd1,0x0b,0x32,0x16,0x70,0x69,0x5e,0x53,0x22,0x6a,0x49,0x32,0x90,0xb2,0x33},
+	{0x69,0x5e,0xd2,0xb4,0xc1,0xfa,0xb2,0x24,0x4d,0xa4,0x52,0x55,0x43,0x83,0xff,0x76,0x6f,0x99,0x3f,0x1a,0xd7,0x50,0x73,0xb4,0xab,0x5d,0x63,0x36,0x92,0x76,0xa2,0x2d,0x40,0xf0,0x7c,0x49,0x47,0x0e,0x72,0xce,0xd2,0xd2,0xcd,0x00,0x2e,0x9b,0xba,0xbb,0xce,0x63,0x01,0xef,0x4b,0x09,0x15,0x33,0xd6,0x67,0x99,0xa3,0x6f,0xd1,0xf0,0x30,0xa0,0x33,0x4f,0xb9,0x9e,0x2b,0x3b,0x9e,0x02,0x31,0xa2,0x66,0xc0,0xbf,0x0d,0xdf,0x2b,0x20,0x49,0x85,0x58,0xf2,0xc1,0xdb,0x51,0x82,0x7a,0xed,0x0a,0x1f,0x87,0x10},
+	{0x0f,0xbb,0xf3,0x28,0x1f,0x19,0x57,0xe3,0xb3,0x39,0x88,0x6a,0xb3,0xc7,0xe8,0xd7,0x65,0xc3,0x58,0x17,0xc0,0x22,0xbb,0xa1,0x7a,0x04,0xf5,0x52,0xe0,0x90,0x3b,0x6e,0x22,0x34,0x26,0x48,0xe6,0x1b,0xdb,0x5e,0x04,0x43,0xe8,0xf5,0x94,0x98,0xf9,0xf8,0x7e,0x92,0x1f,0x95,0xf5,0x2c,0x9c,0x63,0x3c,0xbd,0x61,0x56,0xcb,0xba,0x37,0x4c,0xc6,0x48,0x77,0x11,0x4d,0x34,0x1c,0xfa,0x3e,0x90,0x8c,0xdc,0xef,0x61,0xdb,0x1a,0xc0,0x57,0x30,0x94,0x1d,0x99,0x78,0xb1,0x05,0xf3,0xd7,0x0f,0x91,0xa6,0x94,0x21},
+	{0x51,0xd5,0x8e,0x6d,0xbd,0xae,0xd4,0x8d,0xd4,0x95,0x70,0xfc,0x71,0xb0,0xc8,0x88,0x8d,0x32,0xf3,0xcd,0x1b,0xd0,0x9a,0xee,0x07,0x0b,0x25,0x73,0x59,0xfc,0xbc,0x4d,0x1c,0x26,0x5f,0x97,0x17,0x93,0xcf,0x25,0x54,0xaa,0xe1,0x93,0xdd,0x36,0xad,0x8c,0x41,0xd3,0x80,0x2f,0xcc,0xd0,0x34,0xbe,0x7a,0x0d,0x8c,0x12,0x4b,0x1a,0x7a,0x22,0x7e,0xb3,0x75,0x72,0x2c,0x01,0x8b,0x82,0x2d,0xf2,0x35,0x0f,0xfe,0x47,0x35,0x48,0x9c,0xc3,0xf8,0x58,0xeb,0xd4,0x82,0x33,0x2a,0x14,0xd5,0xe4,0x74,0xbb,0x44,0x79},
+	{0x9d,0x7e,0xfe,0x99,0x16,0x64,0x35,0x5b,0x4a,0xf5,0xf8,0x9f,0xb3,0x56,0x75,0x1d,0xa9,0x6d,0x3d,0x14,0x03,0xdf,0xd4,0xd9,0xe5,0x04,0x14,0xa0,0x19,0x4a,0x18,0x39,0x94,0xf6,0xf4,0x98,0xe5,0xbf,0x07,0xd5,0xca,0xf3,0x32,0x76,0xd2,0x7e,0xa7,0xbf,0x32,0xea,0xf8,0x3c,0x07,0x6c,0xcb,0x15,0x59,0xf8,0xd3,0x3d,0xab,0x0f,0x07,0x05,0x0a,0x62,0x53,0x82,0x9b,0xf6,0xab,0x46,0xb2,0x3e,0xd2,0x0c,0xdd,0xc9,0xf1,0x16,0xa6,0x5b,0x61,0x08,0xa8,0xa5,0xb9,0xb2,0xf1,0x2d,0x82,0x9d,0xa3,0x6b,0x3c,0x4a},
+	{0xa0,0xb7,0x48,0xa9,0x12,0x87,0x02,0x65,0x7e,0x8c,0xb3,0x61,0x21,0x97,0xff,0x02,0x01,0xd1,0x45,0x90,0x6d,0x8d,0x1d,0xc0,0x31,0x3e,0xa8,0x93,0x2a,0x61,0x34,0x16,0xe7,0x21,0xf5,0x50,0xec,0x9a,0x1a,0xfd,0xd7,0x07,0xd9,0xf7,0xcb,0x34,0xec,0xff,0xd7,0xc1,0x65,0x13,0xe8,0xf2,0x47,0xdd,0x1c,0xb3,0x2e,0x88,0x8a,0x17,0xf5,0x7a,0x83,0x44,0xbe,0x81,0x27,0x1a,0x08,0x48,0x27,0x04,0x84,0xe9,0xca,0xa3,0xf8,0xf8,0xab,0xa4,0xff,0xfe,0xe3,0xf1,0xc1,0x78,0x09,0x1d,0x99,0x8b,0x5b,0xff,0xc5,0x06},
+	{0x43,0xa3,0xec,0xb8,0xff,0xbe,0x77,0x90,0xa9,0xb6,0xbc,0x66,0xff,0x4d,0xaf,0xb7,0x58,0x83,0x55,0x70,0x68,0xfc,0x8c,0x15,0xed,0x1c,0xd5,0x44,0x71,0x94,0x25,0x47,0x26,0x51,0xa8,0x7a,0x48,0xad,0x09,0xfa,0x84,0x54,0xd0,0xa3,0xf1,0x2a,0x30,0x3b,0xc2,0x70,0x9d,0xd1,0xa5,0xd3,0xbe,0xe0,0xfa,0x8e,0x70,0x0e,0x73,0x7d,0x6c,0x3d,0xed,0xf4,0xd5,0x01,0x2c,0x0e,0x63,0xd1,0xcf,0x1c,0x0e,0x30,0x2b,0x89,0x0d,0x2c,0x25,0x9c,0x48,0x28,0x47,0x90,0x4f,0xbf,0x47,0xc5,0xc6,0x20,0x15,0x79,0xb4,0x40},
+	{0x30,0x04,0xcb,0x8b,0x60,0x67,0xc8,0xf5,0x09,0x59,0x0b,0xe0,0x2d,0x5d,0xde,0xde,0x41,0x3e,0x4e,0x26,0xaf,0xa7,0x3d,0xf9,0xf0,0xac,0xf7,0x5f,0x51,0x1c,0x3a,0x63,0x0e,0xb7,0x53,0x7c,0x90,0x31,0xe6,0xf1,0x3f,0x31,0x9e,0xd3,0xad,0x8a,0x78,0x46,0x20,0xd9,0xbf,0x88,0x82,0xaa,0xdd,0x95,0xa0,0xc4,0xcd,0xb5,0x98,0x79,0x68,0x76,0x19,0xe1,0x39,0x85,0x53,0x68,0x02,0x56,0x7b,0x9d,0x08,0xf3,0x76,0x38,0x35,0x31,0x8b,0x4c,0x8e,0x5f,0xf4,0xa6,0xf8,0xeb,0xc6,0xc4,0xd6,0x7e,0x45,0x96,0x0c,0x77},
+	{0x6b,0x61,0x58,0xd0,0x5f,0x0e,0x12,0xe4,0x2c,0xe2,0xec,0xcb,0x20,0x33,0x91,0x79,0xac,0xe3,0x3d,0x47,0x22,0x90,0xac,0x92,0xdf,0x5a,0xa0,0x6b,0x79,0xb6,0x9d,0x34,0x90,0x74,0x0b,0x85,0xb8,0x1e,0xef,0xb8,0x56,0xb4,0x85,0x9c,0x63,0x0a,0xa6,0xea,0x4a,0x01,0xeb,0x1e,0x5c,0x0e,0xf3,0x51,0xd7,0x44,0x81,0x7c,0x69,0xf0,0x8f,0x49,0x35,0xed,0x8c,0x79,0x61,0x11,0x6a,0xd7,0x24,0x3d,0x48,0x76,0x13,0xe3,0xae,0x96,0xed,0x4b,0x85,0x73,0x73,0xba,0x8f,0x53,0x89,0xb0,0x5e,0x18,0x9a,0xab,0x64,0x57},
+	{0x19,0x23,0x16,0x09,0x70,0xa8,0xbf,0xff,0x8f,0xe4,0x5b,0xc7,0x44,0xa7,0x23,0x3a,0x08,0x7d,0x19,0x42,0xa3,0xf0,0xfd,0x26,0xf0,0x9f,0xdb,0x54,0x23,0x5c,0xc1,0x7f,0x11,0xdd,0x74,0xfd,0x44,0x9f,0x69,0x80,0x2e,0x31,0x2c,0xc2,0xf1,0xaa,0xf5,0xf4,0xcb,0xde,0x43,0xa9,0x16,0xb9,0x85,0x73,0xf6,0xc4,0x50,0x22,0xe5,0xba,0x71,0x08,0x7c,0xf5,0xb8,0xf8,0x8f,0x29,0x8f,0xae,0xc8,0x02,0x24,0xae,0x4e,0xcf,0x88,0x91,0x99,0x59,0x3a,0xf3,0xa7,0xda,0xeb,0x79,0xe1,0x79,0x4e,0x47,0x1a,0x68,0x88,0x3a},
+	{0x8f,0x95,0x77,0x1d,0x06,0xb4,0xbc,0xc3,0xe7,0x98,0x19,0xf4,0xbc,0xf2,0x2d,0xb2,0x27,0xad,0x52,0xa3,0xb4,0x6a,0x9b,0xee,0xba,0x96,0xf2,0xa7,0x72,0xbb,0x2f,0x3e,0x9b,0x72,0x13,0x73,0x95,0xdd,0x4e,0x6b,0xf4,0x39,0x11,0x21,0xe5,0xe0,0x93,0x52,0xb6,0x16,0x91,0x6b,0xdb,0xde,0xd6,0x53,0x94,0x65,0xb0,0x93,0x95,0xb1,0x83,0x74,0xc8,0x4c,0x2c,0xf2,0x4d,0xb1,0x36,0x8a,0xa5,0xec,0x5c,0xbd,0x4c,0xdb,0x2f,0x54,0xe2,0xe7,0x1a,0xd1,0x8a,0x6b,0x47,0xb2,0x21,0xe4,0x43,0x56,0x35,0xbe,0xf1,0x14},
+	{0x61,0xb8,0x3d,0x11,0x47,0x86,0x3e,0x33,0x84,0xaf,0x98,0x44,0xda,0xd6,0x1e,0x5b,0x7c,0x79,0xc4,0x89,0x27,0x33,0x48,0xfc,0x02,0x24,0xb5,0x18,0xd3,0x98,0x52,0x10,0x17,0x70,0x16,0xef,0xfc,0xe4,0x27,0x94,0xa7,0xed,0xf6,0x41,0x0a,0xc7,0x80,0xeb,0x7c,0x0e,0x1b,0xfd,0xd6,0x29,0x36,0x07,0xec,0xdd,0x4b,0x4e,0x2a,0xbc,0x0a,0x3f,0x22,0xca,0x6d,0x46,0x01,0xdf,0x74,0xf5,0xc3,0xa0,0xa2,0x53,0xcf,0x79,0x5e,0xf7,0xf4,0xd8,0xa7,0x15,0xad,0x9c,0xa9,0x48,0xf0,0x61,0xa4,0xe1,0x98,0xbc,0x3c,0x52},
+	{0xd6,0x1a,0x0a,0xfe,0xee,0x15,0x63,0xfd,0xe9,0x0b,0x7e,0x1a,0x5a,0xa7,0x6a,0x93,0xa1,0x07,0x78,0x04,0xa1,0xcd,0x10,0x4c,0xe3,0x3c,0xca,0x92,0xf9,0x4a,0xd3,0x44,0x14,0x6f,0x6f,0x80,0x02,0x3b,0x9a,0xf3,0x4d,0x6f,0xd0,0x92,0x99,0x8e,0xdc,0x24,0x9c,0x78,0x98,0x66,0xb9,0xbb,0xe2,0x1c,0xc5,0x77,0xea,0x65,0x91,0xd5,0xc7,0x5e,0x8a,0x10,0x38,0xf7,0x92,0x5f,0x1b,0xb8,0xde,0xb2,0x4b,0xa9,0x53,0x28,0x99,0x50,0x92,0xd3,0xb0,0x85,0x70,0x48,0xa2,0xb7,0xc7,0x30,0x8f,0xee,0x00,0xe9,0xd7,0x7b},
+	{0x67,0x7c,0xad,0xc5,0x74,0x84,0x46,0x93,0xf8,0x60,0xa1,0xf5,0xad,0xa7,0x7f,0x66,0x20,0xe4,0x6f,0xef,0xd5,0x5d,0x07,0x99,0xdd,0xc1,0x2f,0x91,0x12,0xbc,0xa0,0x76,0xc2,0x45,0x92,0xa3,0xdc,0x07,0xc0,0x36,0xf2,0x27,0x7b,0xbb,0x32,0xe0,0xd6,0x11,0xee,0xd0,0x2f,0x02,0xa8,0xdb,0xe3,0xe4,0x2c,0x1b,0xf7,0x75,0xfe,0xe6,0x1e,0x5c,0x18,0xaf,0x25,0xa2,0x14,0x86,0xc9,0xd1,0xbb,0x1e,0x63,0x3a,0x52,0x7e,0x74,0x94,0xde,0x78,0x51,0xd0,0xaf,0x1a,0xed,0x3f,0x61,0xb0,0x0e,0x94,0x8b,0x0c,0xc0,0x18},
+	{0x38,0x1d,0x2e,0x52,0x63,0x8e,0xa2,0xd4,0x0e,0xad,0xe7,0x53,0x5f,0xe3,0x88,0xe5,0x6b,0x68,0x2b,0xbc,0x97,0x30,0x6a,0xa1,0x85,0x1e,0x64,0xcf,0x93,0xa7,0xea,0x1a,0x18,0x1a,0x10,0x52,0x02,0x3b,0xa7,0xb9,0x5c,0xfe,0xcb,0x55,0x12,0xde,0x59,0x2e,0x31,0x87,0x65,0x89,0x4c,0x9a,0x20,0x55,0xc5,0xbe,0xb7,0xb3,0x6b,0xdd,0xa4,0x60,0x43,0x12,0xc3,0xb7,0x21,0xf9,0x2d,0xe4,0x20,0x3c,0x2d,0x8a,0x65,0x62,0x51,0xc4,0x4d,0x96,0xaf,0xcb,0xdf,0x8b,0x7e,0xc7,0x0f,0x10,0x02,0xbf,0x3a,0xfc,0x7f,0x4b},
+	{0x66,0x54,0xd5,0x7c,0x3e,0x9f,0xec,0xb4,0x69,0x46,0x4c,0xae,0x64,0xc2,0x88,0x44,0xf2,0xa6,0x3d,0xdf,0x09,0x09,0x17,0x82,0x0d,0x6a,0x2c,0xe3,0x98,0x60,0xa9,0x7a,0x46,0xc7,0x21,0xa5,0xb9,0xca,0x16,0x62,0x5d,0xd4,0x22,0x81,0x2b,0xf4,0x66,0x8f,0xa4,0xe3,0x89,0x1d,0x26,0x67,0xe9,0x5c,0xf0,0x6d,0xfa,0xfe,0x6a,0x3d,0xcd,0x05,0x24,0x5a,0xac,0x29,0x1f,0x58,0x76,0x45,0xbc,0x44,0x41,0xc1,0xae,0x52,0x6a,0x3b,0x04,0xd3,0x21,0xb3,0xbf,0xa5,0x9f,0x0c,0x7e,0x5d,0x27,0xd8,0xbc,0x92,0x3e,0x6e},
+	{0x1a,0x9f,0x82,0x14,0x91,0xc6,0xb5,0x77,0x6a,0xf9,0x9f,0xbb,0x43,0x44,0xe7,0xa1,0x2b,0x4f,0x7e,0xed,0x43,0x00,0xe0,0x86,0x9f,0x89,0x59,0x43,0xad,0xd4,0x29,0x7f,0x17,0x16,0x10,0xfa,0x32,0x56,0x28,0x3f,0x4e,0x3c,0xf6,0xb3,0x4b,0x2e,0x9a,0x11,0x64,0x69,0x73,0x3a,0x7a,0x58,0x1f,0xa4,0xfe,0xb4,0x57,0xc2,0x6b,0x1f,0x0c,0x6c,0x34,0xca,0x59,0x11,0x7e,0xd7,0x9b,0x43,0x9a,0x13,0xcb,0xe7,0x21,0xc6,0xc5,0x9e,0x0b,0x28,0x1d,0x01,0xa8,0x8a,0x57,0x8e,0xcb,0x75,0x95,0x15,0xd6,0x99,0x82,0x2c},
+	{0xf1,0x4e,0xd2,0xe0,0xef,0x37,0xfa,0x47,0x72,0x16,0x85,0x5d,0x38,0xf8,0x88,0x76,0x06,0x76,0x61,0xfc,0x7b,0xb4,0x64,0x0d,0x3a,0x05,0x6d,0xfc,0x22,0xef,0x05,0x5c,0xb1,0x15,0xce,0x89,0x87,0x0b,0x69,0xa6,0xf3,0xea,0x04,0x43,0x7f,0x06,0x96,0x25,0x11,0x7c,0xa8,0x2a,0xe5,0x75,0x35,0x2d,0x62,0x36,0xa4,0x55,0x5c,0x5a,0xba,0x1e,0xae,0xc9,0x89,0xd4,0xa1,0x5e,0xbd,0xe3,0xbb,0xda,0x09,0xc4,0x16,0x71,0x1f,0x0b,0xd9,0x0b,0xb0,0xcc,0xc7,0x79,0x75,0x87,0xa2,0xfb,0x89,0x21,0x13,0xf3,0xb7,0x51},
+	{0xa4,0xf8,0xb3,0x9b,0x5d,0x4a,0xb7,0xf8,0x76,0x75,0xeb,0xc3,0x40,0x98,0x47,0x48,0xcc,0x75,0x42,0xc6,0x48,0xb6,0xd1,0x53,0xcb,0x9c,0x05,0x31,0x62,0x3a,0x7a,0x65,0x41,0xf5,0x8d,0x37,0x6a,0xa7,0x38,0x75,0x93,0x8b,0xb8,0xff,0x7d,0x59,0x06,0x2b,0xd6,0xb0,0xb2,0xd3,0xe8,0xaa,0x3a,0x98,0x3b,0x01,0x09,0x78,0xc3,0x37,0x65,0x15,0xf1,0x03,0xa3,0x70,0xf0,0xfb,0x66,0x2a,0xa7,0x41,0x65,0x9c,0x36,0x96,0xa5,0x70,0x54,0xc9,0xc3,0x55,0x8d,0xf4,0xe7,0x1d,0xef,0x71,0xd2,0x02,0x8a,0xa7,0xb7,0x70},
+	{0x28,0x55,0xf1,0xba,0xb6,0x0a,0xc2,0x0a,0xed,0x79,0x2b,0x1a,0xe0,0x0e,0xab,0x27,0x09,0x1c,0xeb,0xc0,0xec,0x5e,0xce,0xd5,0x2d,0xe2,0xba,0xf7,0xf8,0x2f,0xc1,0x3d,0x5d,0x5c,0x56,0xfd,0xa1,0xf7,0xd8,0x45,0xe3,0x1c,0x6c,0xe1,0x52,0x33,0xab,0xc6,0x79,0x57,0x60,0xec,0xcb,0xc8,0x1c,0x37,0xd3,0x13,0x3e,0xb6,0x51,0x9b,0xc2,0x09,0xe5,0x43,0x76,0x55,0x2b,0xa6,0x9c,0xa2,0x10,0x24,0x9a,0xe2,0xfc,0x5b,0xd7,0xda,0xf1,0x91,0x39,0x57,0x2c,0x09,0x04,0xd0,0x56,0x68,0x3f,0x80,0x97,0x9d,0x63,0x1b},
+	{0xd7,0xb1,0x73,0x37,0x96,0xef,0x6b,0x53,0x5b,0xac,0x82,0xb5,0xee,0x9f,0x1a,0x0a,0x65,0x9e,0xe5,0xe0,0x88,0xc2,0xa3,0x28,0xf8,0x73,0xeb,0xd7,0xb4,0x0a,0x66,0x4b,0x17,0x53,0xd0,0x59,0xcd,0xf2,0x1f,0x1f,0xa4,0x0e,0xba,0xe8,0xbe,0x46,0xe9,0xcf,0x1b,0xb0,0x11,0x4d,0xf2,0xdd,0xbd,0xd7,0x36,0xd3,0xb6,0xed,0x67,0xb2,0x41,0x71,0x3a,0x61,0x26,0x36,0x7b,0xc0,0xa6,0x5a,0x9e,0x7e,0x8a,0xaa,0xaa,0xff,0x2b,0xaf,0x1a,0xc4,0xde,0x34,0x29,0xed,0xc8,0x7a,0xa4,0xe2,0xec,0x0b,0xc8,0xe5,0x3d,0x17},
+	{0xaf,0x30,0x27,0xd4,0x7c,0xb2,0xf5,0x7b,0x6e,0x04,0xaa,0x37,0xdc,0x02,0x15,0x5d,0xec,0x31,0xce,0x46,0x25,0x6e,0x88,0xd9,0x5f,0xdf,0x8e,0xd4,0x76,0xef,0x07,0x3f,0xf4,0x6c,0x4c,0x23,0x20,0x8b,0x3e,0xfb,0x8e,0xf7,0xd4,0x67,0xf0,0x7c,0x2f,0xe7,0x60,0xd6,0x61,0xc1,0x12,0xa4,0x45,0x0e,0xd4,0x22,0xae,0xb3,0x6d,0xb4,0x99,0x70,0x32,0xdb,0xf6,0xbb,0x12,0x8c,0xb4,0x74,0x02,0x0b,0x09,0xf2,0xa1,0xb7,0x80,0x3a,0x47,0xf2,0x58,0xd9,0x6d,0xd8,0x1a,0xd8,0x41,0x67,0x79,0xe7,0x2d,0x14,0x48,0x31},
+	{0xe9,0xe0,0xfd,0x42,0xa8,0xe7,0xf1,0x82,0x12,0x0c,0x13,0x83,0xfd,0x70,0x1e,0xd2,0x15,0x54,0x74,0xc5,0xf3,0x63,0x8b,0x5a,0x61,0xd8,0x5a,0xd3,0xf4,0xe9,0xea,0x4f,0x05,0xc5,0xd2,0xd2,0x5f,0xe0,0xb6,0x21,0x05,0x33,0xb7,0x2b,0x74,0xde,0x8a,0x2d,0xf7,0x71,0x3a,0xc0,0x5a,0xf1,0x92,0x19,0x48,0x9b,0xc4,0x0f,0x87,0x81,0xad,0x5b,0x1d,0xce,0xc6,0xab,0xee,0x72,0x19,0x39,0x7a,0x47,0xcb,0x27,0xe4,0x43,0x65,0xe8,0x72,0xe8,0x9b,0x1d,0xd4,0xc0,0xb5,0x4b,0xc9,0x10,0x30,0x2c,0xd1,0x72,0x92,0x38},
+	{0xfc,0x56,0x32,0x29,0x3a,0xf8,0x6f,0xb0,0x23,0xaf,0x2c,0xd5,0x15,0x07,0x23,0xba,0xd9,0x5f,0x65,0xb8,0x39,0xd4,0xd7,0x19,0x84,0x10,0x7a,0xaf,0x9b,0x3a,0x98,0x41,0x4b,0xae,0xa2,0x43,0x66,0x11,0x34,0xe5,0x21,0x85,0x1e,0x9b,0x92,0xd1,0x35,0x7b,0x01,0xb7,0x50,0xe4,0x9b,0x54,0x70,0xae,0xfc,0x54,0x8a,0xa4,0x9b,0x20,0x69,0x5b,0xfd,0x8c,0xba,0xe1,0xf7,0xfb,0x60,0xce,0x65,0x6b,0xde,0x43,0xb5,0xd9,0xb0,0x25,0x1c,0x3a,0x33,0xac,0xe6,0xd3,0xee,0x1b,0xe7,0x5a,0xa3,0xb3,0x30,0x5d,0xf2,0x6b},
+	{0x18,0xc1,0xa0,0x1e,0xe6,0xad,0xc1,0xcf,0x94,0x60,0xd0,0x63,0x71,0xac,0x79,0x35,0x27,0xb6,0xa1,0x19,0x7f,0xd8,0x7d,0xde,0xa0,0xff,0x69,0x02,0x3a,0xae,0xb6,0x7e,0xbd,0x86,0xac,0xa3,0x86,0x56,0xc9,0x87,0x15,0xc5,0xb0,0xf2,0xa4,0x9d,0x2e,0x79,0x68,0x6d,0x13,0x0e,0x59,0x44,0x18,0x1a,0x88,0x34,0x71,0xe9,0xa6,0x59,0x5b,0x2d,0xe3,0xca,0xa2,0x45,0x25,0xf6,0x13,0x14,0x46,0x55,0x23,0x15,0x24,0x4b,0x8b,0x6d,0x2f,0x49,0x48,0xe9,0x66,0xcc,0x8b,0xba,0xaf,0x54,0x66,0xaa,0x1c,0x95,0x6f,0x6d},
+	{0x60,0xe4,0xb6,0xd0,0x78,0x88,0x2b,0x9e,0x49,0x44,0xc8,0xd3,0xa3,0x86,0x82,0x1c,0xb6,0x0e,0x96,0x22,0x73,0xc7,0xaf,0xbe,0xe9,0xaf,0x3e,0xaf,0x7f,0xb2,0xe2,0x49,0x62,0xb4,0xa6,0x76,0x2b,0x74,0x61,0x0c,0x7c,0x5f,0x61,0xbd,0xeb,0x2c,0x26,0x29,0x05,0x1a,0x2c,0x07,0xed,0x25,0xb2,0x9b,0x0e,0xe4,0x11,0x66,0x44,0x54,0xc3,0x02,0xf6,0x3b,0x7f,0xa1,0x6f,0x42,0x8e,0xbf,0xfb,0x12,0x13,0x54,0xa6,0x8d,0x4c,0x89,0x08,0xfc,0xe3,0xfa,0x25,0x22,0xfd,0x8d,0x42,0x94,0x49,0x68,0xaa,0x7e,0x1b,0x42},
+	{0x7c,0x8e,0x3e,0x12,0xaf,0xfe,0x46,0x20,0xaa,0xe8,0x92,0x4c,0x69,0x8a,0xb3,0xfb,0xbe,0x62,0x95,0xad,0x96,0x0d,0x3a,0xc7,0x84,0x3a,0xf5,0xea,0xa9,0xf1,0x8c,0x0b,0x89,0x7c,0xf4,0xe2,0x3a,0xf1,0x9d,0xb6,0x20,0xd1,0x27,0x3f,0xd3,0x59,0x6e,0xdd,0x74,0x76,0x43,0xd1,0x52,0x96,0x51,0x3b,0x27,0x93,0xa2,0x7b,0x50,0x08,0xd9,0x60,0xe9,0xed,0x94,0x41,0xe4,0x8f,0xdd,0x44,0xd6,0xc0,0xc6,0x1e,0x03,0x88,0x9a,0xc2,0x93,0xb9,0x8a,0xec,0x8f,0x31,0x78,0xba,0x51,0x30,0x5c,0x75,0x94,0x70,0x45,0x19},
+	{0x3c,0x51,0x7d,0xe8,0x9a,0xd4,0x9a,0xb4,0x4e,0xf1,0xfe,0xce,0x44,0xee,0x7c,0xd8,0xe4,0x6e,0x57,0xdc,0x32,0x3e,0x4e,0x6a,0x1a,0xd1,0x95,0x0e,0x06,0x37,0x55,0x4a,0x13,0x99,0x3e,0x02,0xd1,0x17,0x7e,0x0f,0xe6,0x3c,0x7c,0xad,0xa9,0x8f,0x1f,0x42,0xce,0x90,0xe5,0x8d,0x79,0xc2,0xc1,0x1e,0x11,0xf4,0x3b,0xd7,0x04,0x5e,0xad,0x01,0x36,0x4e,0xaf,0x40,0x4e,0xe2,0x77,0x31,0xbd,0xbb,0xc2,0xb9,0x70,0x39,0xfa,0xeb,0x64,0xde,0x0f,0x85,0x34,0x8b,0x65,0xdb,0xfe,0x9a,0x6b,0x60,0x32,0xcf,0x8a,0x46},
+	{0x9d,0x13,0x13,0xcd,0x84,0xd8,0x82,0x7c,0xe1,0xfa,0xa2,0x37,0xec,0xe7,0xba,0x0c,0x30,0x3c,0x04,0x18,0x8d,0xb7,0x87,0x62,0x47,0x71,0x98,0x93,0xfd,0x25,0x62,0x01,0xe3,0x3e,0x83,0x9a,0x5b,0x71,0x04,0xcf,0xd9,0xc6,0xbe,0x22,0x86,0x12,0x45,0x0d,0x2a,0x9f,0x69,0x97,0x4a,0x20,0x0a,0x85,0x37,0xa9,0x19,0x47,0xb2,0x22,0xbc,0x28,0x30,0x1b,0x70,0x70,0x01,0x69,0x10,0xf8,0x61,0xc7,0x35,0xc0,0x64,0x39,0xc3,0x41,0x2e,0x51,0x4d,0xc3,0x4b,0x0a,0x2b,0xd7,0x88,0x61,0xec,0xbd,0x8e,0x99,0xc2,0x39},
+	{0x29,0x9b,0x1b,0xea,0x91,0xeb,0xc9,0x0d,0x26,0x83,0x0b,0x8b,0x76,0x7a,0x92,0xd0,0x32,0x89,0xc3,0x05,0x6a,0xba,0xb1,0x6d,0x38,0x8b,0x41,0x29,0x8c,0xb2,0xcc,0x08,0x0a,0x13,0xf5,0x64,0x92,0x6a,0xd3,0x59,0x96,0xf9,0xbe,0x9f,0xe9,0x6f,0x92,0x66,0xc3,0xca,0x65,0x67,0xfc,0xc6,0x33,0x73,0x69,0xf6,0x25,0xb9,0x99,0x4a,0x81,0x2e,0xf2,0x7a,0x5a,0xe9,0x4a,0x07,0xcb,0x03,0xec,0xc3,0x22,0x15,0xb8,0xf0,0x18,0x25,0x19,0x65,0xde,0x45,0xec,0x95,0xa9,0x1c,0x58,0xaf,0x0f,0xb3,0x3d,0x0d,0x51,0x35},
+	{0x36,0x45,0xbe,0x30,0x1e,0xd1,0x66,0xa0,0x3b,0x02,0x51,0xe5,0x84,0x34,0x30,0x60,0x6a,0xa3,0x48,0xf0,0x03,0xdf,0x67,0xe4,0x11,0x89,0xca,0x76,0x61,0x50,0x21,0x7b,0xea,0xe6,0x4f,0xd7,0x7d,0x1d,0x4e,0x79,0xce,0x17,0x7f,0x72,0x30,0x44,0x32,0xe5,0x4d,0xd5,0x6f,0x00,0x9c,0x1f,0x92,0xcb,0x86,0x70,0xaa,0x65,0x6f,0x3a,0xe6,0x3d,0xa5,0x5d,0x25,0xf2,0xaa,0x8d,0x86,0x1c,0x68,0xcc,0xeb,0x02,0x06,0x20,0x5d,0xac,0xf0,0x17,0x08,0x6f,0x21,0x08,0xde,0xb7,0x1d,0x3e,0x89,0xb5,0x26,0x60,0x26,0x70},
+	{0x75,0x88,0xb8,0x3a,0x1a,0xd3,0xa9,0xc8,0xb2,0xe3,0xb1,0x35,0xbf,0xe0,0x6b,0xc9,0x50,0x2f,0x65,0x02,0xf8,0x52,0xf5,0x2e,0x7d,0x52,0x4c,0xe8,0x3d,0xa4,0x54,0x31,0x4e,0xf1,0xea,0x72,0x71,0x66,0x07,0x8f,0xfa,0xc3,0x4d,0x7d,0xed,0xf9,0x28,0xc3,0x70,0x90,0x49,0x87,0x5d,0x86,0x58,0xc9,0xdc,0x4c,0xe5,0xd2,0xfd,0x6c,0xdc,0x3c,0xcf,0x11,0xb9,0xf6,0x14,0x1a,0xa4,0x6a,0x8a,0x92,0x46,0xd5,0xc7,0x8f,0xf8,0xcd,0x1d,0x69,0x8d,0x7a,0x58,0x51,0x2f,0xa5,0xd0,0x29,0xf0,0x70,0xe5,0x99,0x66,0x5f},
+	{0xfb,0x9d,0x59,0x67,0xd5,0xc4,0xd8,0x9d,0xff,0x46,0x31,0x15,0x2e,0x44,0x45,0x46,0x7d,0xe4,0x56,0xd3,0xb1,0x56,0xb5,0x02,0xfa,0xa5,0x1a,0x01,0x3c,0xe5,0x88,0x61,0xcb,0xdd,0xe6,0xf5,0xee,0xc9,0x4c,0xc9,0x30,0x92,0x8a,0xe9,0xb9,0x1f,0x07,0xfd,0x66,0x0f,0x7e,0x13,0x24,0xca,0x92,0xc9,0x64,0xaf,0x59,0x53,0xb8,0xe4,0x14,0x55,0x95,0x80,0x55,0x5b,0x59,0x88,0x7b,0x8a,0x87,0xe1,0x27,0xb7,0x05,0x66,0x66,0xb3,0xff,0x91,0xda,0x69,0x92,0xae,0x77,0x78,0xfb,0x68,0x30,0xf6,0x47,0xf1,0x49,0x32},
+	{0xb7,0x60,0x32,0x4e,0xd6,0x5c,0xb1,0xbc,0xe9,0x67,0xb8,0x4a,0xbe,0x8f,0xf2,0x1c,0x92,0x26,0x7c,0x46,0x87,0x95,0x9d,0x24,0x0a,0xb1,0x1c,0xca,0x57,0xb1,0x7d,0x39,0x13,0x1d,0xaf,0x40,0xee,0x3b,0x76,0xaf,0x05,0xf3,0xe4,0xec,0x35,0x09,0x62,0x8c,0x5e,0x98,0x13,0x1a,0x11,0x0f,0xb7,0x15,0x4f,0xa7,0x5f,0xe5,0x83,0xca,0x4d,0x06,0x33,0x56,0x41,0xac,0x69,0xe0,0xa1,0xe5,0xe3,0x59,0x2b,0xf5,0x79,0xb0,0x43,0x9c,0x9e,0x8b,0x83,0xae,0xd8,0xae,0x9b,0x9b,0x53,0x3f,0xff,0x5a,0x44,0x42,0x92,0x50},
+	{0xfc,0x5a,0x63,0xa9,0xbf,0x7d,0x86,0x63,0xff,0xd5,0xfa,0x55,0xb3,0xa4,0xc5,0x37,0x89,0xee,0x4b,0x78,0x1b,0xdb,0x3a,0xed,0xd9,0x5f,0xd6,0x54,0x81,0xaf,0xde,0x69,0x03,0x4d,0x80,0xbd,0x40,0x22,0x14,0xfa,0x9d,0x64,0x48,0x4c,0xf4,0x64,0x31,0xec,0xc5,0x20,0x19,0xaf,0x28,0x4d,0x73,0xbf,0xca,0x08,0x50,0x14,0xa9,0x61,0xff,0x15,0x6d,0xa4,0x77,0xda,0x1e,0x50,0xae,0x3f,0xe4,0x1d,0xec,0xef,0x9d,0x7d,0xbb,0x70,0xe5,0x89,0x17,0xbe,0xb5,0xa7,0x68,0x9e,0xb7,0x3f,0xc5,0x15,0x58,0xa1,0xa2,0x62},
+	{0x25,0xb9,0x38,0x59,0x8d,0xf7,0x10,0x74,0x9b,0xf9,0xc6,0x14,0x6e,0xd6,0x91,0x62,0x7a,0x64,0x4f,0x55,0x6c,0x5e,0x9b,0xed,0x48,0x2c,0x9f,0xb6,0xa4,0xeb,0xdb,0x03,0x7f,0x6b,0x8c,0x4d,0xe9,0xac,0xd5,0xe4,0xd9,0x1d,0xbb,0x7e,0x6f,0x62,0x92,0x23,0xd8,0xb7,0x00,0xd2,0x79,0x2b,0xdb,0x57,0xc7,0xc1,0xd4,0xfc,0x9d,0xc2,0x3d,0x02,0x3e,0x2d,0xa3,0x6e,0xd7,0x86,0xc9,0x89,0x5d,0x5a,0x6b,0xe2,0x79,0xe2,0xda,0x7c,0x4e,0x7d,0x44,0xf4,0xe2,0xc2,0x70,0xa3,0xb1,0xcc,0xe9,0x41,0xb5,0xc1,0x39,0x07},
+	{0x41,0x0f,0xfb,0x20,0xdd,0x94,0x66,0xbc,0xfe,0xa3,0xb6,0xb8,0x22,0x88,0xc4,0x25,0xe8,0x09,0x57,0xa2,0xa5,0xa3,0xa4,0xa4,0x82,0xde,0xbf,0x11,0x9c,0x11,0x9c,0x6c,0x4f,0x14,0xde,0x99,0x0b,0x66,0x53,0xdc,0xa0,0x7b,0x26,0xba,0xe3,0x49,0x8b,0x8f,0x49,0x81,0xdd,0xaa,0x39,0x5d,0x46,0x39,0xee,0x69,0x85,0xc4,0xbe,0xbe,0x30,0x2d,0xa4,0xaa,0x24,0x67,0x39,0xe1,0x38,0x6a,0x52,0xc0,0x40,0xcc,0x13,0xcd,0x79,0x32,0xc5,0x61,0xf4,0xb6,0x3a,0x20,0x44,0x3f,0xf7,0xe6,0xfe,0x8b,0xdb,0x9f,0x3a,0x03},
+	{0xc1,0x8c,0x2c,0x11,0xaf,0x1e,0x45,0x81,0xd3,0xf1,0x82,0x27,0x81,0xe0,0xa7,0xa9,0x75,0x54,0x02,0x3b,0xce,0x8b,0x0c,0xc3,0x00,0x59,0x23,0xbc,0xf8,0x16,0xbd,0x50,0xbe,0x73,0x5d,0xbc,0x20,0x90,0xfd,0xd5,0x7d,0xc7,0xd4,0x5b,0x58,0xa1,0xd0,0x99,0xa7,0xad,0xc5,0xf9,0xf5,0xdc,0xa4,0xa5,0x07,0x00,0x2a,0x50,0x84,0x64,0xc0,0x7e,0xe9,0xe8,0xcf,0xe5,0xe3,0xd6,0xa2,0x65,0xa5,0xcb,0x61,0x9e,0x31,0x95,0x2a,0x6b,0xdd,0x3e,0x15,0x72,0xf6,0xfc,0x99,0xb3,0xa6,0x9c,0x07,0x9f,0x56,0x51,0x52,0x70},
+	{0x72,0x19,0xf6,0xd7,0x71,0x38,0x82,0xe7,0xa4,0x42,0xa4,0x42,0xf8,0x71,0x29,0x7c,0xd9,0xd0,0xc8,0x23,0xb5,0x08,0x97,0x35,0x61,0xff,0xfc,0x52,0x11,0xb9,0x02,0x3d,0x1d,0xf6,0x5c,0xbd,0xbe,0x94,0xe3,0xb2,0xff,0x83,0x55,0x4c,0x8b,0xab,0x34,0x09,0x0f,0xdc,0x3a,0xda,0x80,0xb7,0xfb,0x41,0xfa,0x40,0x4f,0x19,0x77,0x2e,0x96,0x66,0x8c,0x97,0xf0,0x21,0x85,0xc3,0xb2,0xb2,0x55,0x4f,0xc6,0xee,0x54,0x25,0xbc,0x3e,0xdb,0x48,0x2f,0x7f,0x15,0x15,0x33,0x2a,0x71,0x95,0xf3,0x54,0x61,0x6f,0xa2,0x5c},
+	{0x53,0xe9,0x34,0xf8,0xc2,0x02,0x30,0xad,0x1c,0xf9,0xef,0xbd,0xe5,0x83,0x8d,0x6e,0x1d,0x42,0x27,0x91,0xa2,0x15,0x7c,0x87,0x87,0xea,0x64,0x7f,0xd9,0x06,0xc0,0x55,0xda,0xd0,0x75,0xc5,0xca,0x1b,0x81,0x91,0x53,0xde,0xb2,0xba,0x28,0x57,0xc1,0xf2,0xa6,0xbe,0x69,0x3f,0xcf,0xac,0x9c,0xe0,0x4a,0xcd,0x69,0x89,0x42,0x45,0x48,0x66,0x1b,0xfc,0x8d,0x08,0xb3,0x09,0x81,0xcd,0xc6,0x70,0x6f,0x68,0x88,0x24,0x95,0x72,0x9c,0xf8,0x4c,0x30,0xd0,0x26,0xa6,0x0c,0x51,0x2d,0x44,0xeb,0x76,0x35,0x21,0x15},
+	{0xfb,0x8b,0xcb,0x29,0xf0,0x40,0xec,0x18,0x77,0xd8,0xad,0x74,0x14,0xdc,0x99,0x04,0x7a,0xc0,0xe4,0x15,0x78,0xb9,0xbe,0x92,0x75,0x50,0xb8,0x9e,0x12,0xe3,0x13,0x34,0xec,0xc4,0xcd,0x28,0x07,0x05,0xac,0x44,0x4b,0xd3,0xd1,0xd3,0xe5,0x04,0x6c,0x0e,0xa9,0x6b,0xf3,0x67,0x39,0xe6,0x00,0x76,0x8a,0x8f,0x61,0x4a,0xb0,0xc3,0x22,0x4d,0x34,0x6f,0x04,0x0e,0x4a,0x93,0x60,0x63,0x13,0xcf,0x3b,0x32,0xc8,0x59,0x3e,0xea,0xc2,0x73,0x37,0x9e,0xf9,0xbf,0x4a,0x69,0x06,0xd7,0x32,0xb7,0xa8,0x88,0x67,0x18},
+	{0x87,0xb4,0xb3,0x0c,0x26,0x1b,0x03,0xf4,0x2a,0x26,0x5e,0x88,0x29,0x3b,0x17,0x9d,0xf0,0x13,0x70,0x6a,0x1c,0x0d,0xc6,0xc6,0x8d,0xa6,0x9c,0xcb,0x0c,0x3c,0xf9,0x5c,0x7d,0xf2,0xec,0x8d,0x18,0xd1,0xcc,0x6e,0x2a,0x3e,0xa2,0x3a,0x1b,0x89,0x9d,0x35,0x0a,0x93,0x28,0x2f,0x13,0x16,0xbc,0x89,0xe7,0x59,0xd1,0x19,0x82,0x50,0x3c,0x58,0xdb,0xe3,0x98,0xec,0x42,0x58,0x9d,0x30,0x83,0x1a,0x5a,0x0b,0xd3,0x62,0x57,0x99,0xe6,0xdd,0xa0,0x47,0xed,0x07,0x24,0xc1,0x53,0x71,0x8e,0x0c,0x39,0xa2,0x85,0x21},
+	{0x91,0x36,0xb4,0x67,0x9e,0xf7,0x3d,0xae,0xee,0xc3,0xcc,0xd3,0xea,0xbe,0x12,0x7f,0x24,0x40,0x60,0x18,0xdf,0x16,0x0f,0x58,0x23,0xd0,0x6b,0x8c,0xfb,0x71,0x1b,0x27,0x52,0x62,0x1b,0xe0,0x10,0x26,0x7c,0x69,0x02,0xca,0x99,0x77,0x1d,0x6f,0x98,0x96,0xbb,0xa9,0xf4,0xc9,0x84,0x24,0xfa,0x41,0x90,0x4c,0xa7,0x38,0x19,0x15,0x08,0x63,0x1d,0x66,0x0a,0x3d,0xd8,0x96,0x61,0x19,0xca,0xa5,0xc5,0x1b,0x7e,0x50,0xad,0xd2,0x94,0xf3,0x4c,0x78,0xd2,0xd2,0x68,0x62,0xc8,0x0e,0xaa,0x7b,0x4e,0xe2,0x87,0x78},
+	{0x30,0x82,0xd7,0x15,0xfd,0xe9,0x77,0x33,0x7a,0xa8,0xde,0x80,0xf2,0xec,0xa8,0xd4,0x81,0xfa,0xd2,0x0d,0xce,0x06,0x17,0x5b,0x33,0x2e,0xbd,0x3a,0xa4,0xeb,0x09,0x01,0x93,0x2c,0xf5,0xa1,0x3f,0xe3,0xb1,0x4a,0x9a,0xac,0xc3,0x96,0x7e,0xbd,0xb3,0x89,0x9f,0xe0,0x1c,0x26,0xb6,0x1c,0x1f,0xfc,0x54,0xfe,0xa1,0xda,0x31,0x78,0xce,0x7d,0x06,0xb6,0xe9,0xe3,0x5e,0x7a,0x9f,0x73,0xcd,0xe1,0x4a,0x2c,0xbe,0xac,0x2f,0xfa,0x44,0x7f,0x14,0xa8,0x70,0x1f,0xf5,0xf3,0x14,0xb8,0x86,0xd8,0x1d,0x47,0xe9,0x11},
+	{0xdc,0x1b,0xec,0x0d,0x11,0x2c,0x6c,0xc1,0xec,0x66,0x97,0x09,0xd5,0x0a,0x0c,0x39,0xda,0x9c,0xda,0x9a,0x20,0x93,0xba,0x8e,0x1f,0xab,0x62,0xb1,0x9f,0xa9,0xf0,0x6a,0x95,0x81,0x3a,0x6a,0x53,0x99,0x1d,0x1a,0x0f,0x99,0xc1,0xc9,0x8c,0x0c,0xd2,0xd2,0x37,0x6a,0x7b,0x67,0xa4,0x28,0x38,0x84,0x79,0x75,0x62,0xd1,0x75,0xa8,0xf6,0x3d,0xc2,0x6b,0xe0,0xed,0xdf,0xc9,0xaa,0xab,0x42,0xec,0x9a,0xd6,0xfd,0xbd,0xfc,0x9b,0x42,0xa4,0x67,0x8e,0xf7,0xf4,0x54,0x04,0x76,0xab,0x9a,0x74,0x17,0x7f,0x25,0x15},
+	{0x57,0x84,0xcf,0x76,0x73,0x0c,0x2a,0xee,0x99,0x90,0x84,0xac,0x58,0x26,0x63,0x4f,0x28,0x07,0x9e,0x55,0x63,0xe4,0x55,0x77,0xa6,0xee,0x19,0x45,0x74,0x67,0x57,0x77,0xd4,0x69,0x1b,0xe5,0xfb,0xac,0x40,0xc0,0xe1,0xd0,0x9a,0xb0,0x8c,0x8c,0xa1,0xf1,0xbc,0xcd,0xe9,0xdc,0x9c,0x4c,0x75,0xa0,0xa4,0x7f,0xa4,0xfa,0x80,0xde,0x32,0x52,0xbc,0x70,0xea,0x43,0x36,0x42,0x72,0x99,0x56,0xbe,0x40,0xf8,0x0d,0x26,0x7d,0x0a,0xc1,0x70,0x3a,0x20,0xa9,0x7b,0x3e,0xcc,0xfc,0xc3,0x82,0xe2,0x26,0xb9,0x38,0x6c},
+	{0x50,0x3a,0x0f,0x3e,0xbd,0x5a,0xcd,0x4b,0xb6,0x5e,0x76,0xff,0x66,0x2c,0xb1,0x2b,0x6c,0xa9,0x29,0xe3,0x98,0xf1,0x77,0x68,0x48,0x99,0x05,0x82,0x7b,0x56,0x73,0x6e,0x54,0x69,0xd1,0x33,0x6c,0xbd,0x8e,0xb4,0x9e,0x97,0x35,0x56,0x38,0x32,0x09,0xc0,0xc3,0xc8,0x5e,0xe2,0x98,0xef,0x2f,0x3a,0x42,0x42,0x39,0x4a,0x25,0xf5,0x9f,0x11,0x9f,0xd3,0x48,0x06,0x91,0xbb,0xd5,0x2c,0x1c,0x84,0x6b,0x14,0x4d,0x08,0xd3,0x56,0xf8,0x16,0x5a,0x60,0xcc,0xe3,0xd0,0x37,0xde,0x09,0xf2,0xf5,0xaf,0x82,0xa1,0x2e},
+	{0xa2,0xa8,0x62,0xcd,0x2a,0xfb,0xc0,0xf1,0xd9,0x7d,0xa5,0x09,0xe0,0x85,0xc4,0x2b,0x64,0x61,0x82,0x2f,0xaf,0xe5,0xfe,0x6a,0xa7,0xc1,0xb1,0x99,0x7c,0xfd,0xf9,0x1e,0xde,0x09,0xf0,0xe7,0x1d,0x53,0xc5,0x5a,0x62,0x29,0x39,0x3c,0x82,0x2a,0x34,0xc7,0x5f,0x60,0xd4,0x03,0x1b,0xcf,0x2b,0xca,0xd4,0xfb,0x17,0xfc,0xf8,0x7b,0x95,0x75,0xd3,0x1f,0xc5,0xde,0xbc,0xbb,0x4c,0x30,0xbf,0x66,0xe6,0x93,0x93,0x45,0x13,0x81,0xbf,0xa6,0xa2,0xc1,0xc6,0x9a,0xa8,0xb4,0x3b,0x08,0x9d,0xc7,0x75,0x53,0x53,0x14},
+	{0x59,0x54,0xe5,0x08,0x0b,0x5d,0xe4,0x60,0xf3,0x9f,0x37,0x6f,0x88,0xc7,0xfe,0xb8,0x88,0xb3,0xeb,0x8b,0xb7,0xa8,0x34,0x26,0x05,0x08,0x36,0x76,0x91,0x5d,0x81,0x3d,0x18,0xfd,0x96,0xeb,0x72,0x7f,0x83,0x01,0xbb,0x65,0xa5,0x14,0x51,0x91,0x7d,0x62,0xf8,0x30,0xcc,0xbb,0x9b,0xff,0xc0,0x4d,0xba,0x2c,0x3f,0xd2,0x12,0xf3,0x12,0x39,0x6a,0x21,0x83,0x34,0x7d,0xd2,0x1a,0x30,0x36,0xe9,0xc4,0x35,0xa2,0x88,0x2a,0x48,0x1e,0x0b,0xc9,0xf8,0xc3,0x6c,0x88,0x41,0x3a,0xc8,0x9d,0xe9,0x08,0xd4,0x64,0x7f},
+	{0x3d,0x26,0x29,0x2e,0xe6,0x47,0x1f,0x3f,0x6f,0x3c,0xcf,0x90,0x49,0x50,0x5d,0x5d,0x7a,0x09,0x4b,0x1f,0xfb,0x68,0x5d,0xd9,0x59,0xd5,0xaf,0x77,0xa2,0x43,0x3d,0x77,0x4d,0x3b,0x5f,0x38,0x32,0x0b,0x02,0xae,0xc5,0x27,0xfa,0x16,0x7f,0x20,0xde,0x1a,0x24,0xa9,0xb8,0xa6,0x8d,0x59,0xb6,0xa3,0xc4,0xd8,0x91,0x29,0xd9,0x16,0xf5,0x36,0xa0,0x66,0x78,0xb8,0x6c,0x8f,0x13,0x1c,0x46,0x7c,0x14,0xb7,0xff,0x6d,0x90,0x71,0x85,0x20,0xd9,0x27,0x2c,0x9f,0xee,0x91,0x74,0x63,0x74,0x67,0x6b,0xb1,0x91,0x24},
+	{0xe2,0x39,0x5c,0x61,0x19,0xd8,0x71,0x55,0x2f,0x18,0x66,0x49,0x1c,0xb5,0x42,0x41,0x55,0xed,0xa8,0xe3,0x3d,0x62,0x65,0xc8,0xe1,0x12,0xa9,0xb8,0xa5,0xdc,0x44,0x37,0x2a,0x67,0x3c,0x53,0x58,0x18,0x5f,0xb8,0x82,0x03,0xbd,0xf3,0xd8,0x0c,0xe3,0xca,0x9f,0x63,0x69,0x11,0xe1,0xd6,0x80,0x18,0x0d,0x7d,0x50,0x73,0x92,0xc3,0x2b,0x09,0xc8,0x39,0x83,0x2d,0x03,0xfe,0xa3,0x8d,0x8a,0x28,0x02,0xb9,0x79,0xf7,0x37,0x92,0xf5,0xfe,0x92,0xf8,0x8c,0x20,0xc2,0xab,0xbb,0x81,0xb5,0xe3,0x87,0x1c,0xee,0x23},
+	{0x64,0xfa,0xe8,0x3d,0xbe,0x8d,0x73,0x5b,0x6a,0x77,0x41,0x8d,0xad,0x24,0x27,0xe9,0xe7,0x20,0xc1,0xfe,0x15,0x6e,0xdf,0x07,0x44,0xdf,0x6a,0x8c,0x5e,0x00,0xf2,0x18,0xcf,0x74,0x71,0x17,0xeb,0xe4,0x57,0x5c,0x2a,0x25,0x94,0x81,0x40,0xc4,0x41,0x07,0xbf,0x7d,0x33,0xc4,0x81,0xc6,0x1c,0xb7,0xc9,0x1a,0x82,0x01,0x91,0xeb,0xe0,0x4f,0x11,0xc1,0xd7,0xa3,0x94,0x65,0x79,0xda,0x84,0x50,0x71,0xc1,0x69,0xe8,0x25,0xab,0x7a,0xd2,0x9d,0x38,0xf7,0x1c,0xe9,0xa0,0x9c,0xb9,0xec,0xc7,0x4f,0x6a,0xa8,0x64},
+	{0x50,0x63,0x32,0x5d,0x4a,0x36,0x92,0xeb,0x4d,0x1d,0xf5,0xa2,0xbe,0x46,0xfe,0x30,0x99,0x13,0xa9,0xd6,0x8b,0x9d,0xf2,0xaf,0xa9,0x35,0x43,0xb7,0xd4,0x23,0x65,0x3d,0x5a,0xab,0xcf,0x69,0x77,0xfa,0x16,0x7d,0x16,0x89,0xfb,0x83,0x55,0x4b,0x20,0x94,0x16,0x80,0x42,0xe6,0x48,0x27,0x42,0xaa,0xb4,0x5f,0xc9,0x9d,0x61,0x39,0xb9,0x03,0x83,0xda,0x3f,0xae,0xb8,0x9f,0x6a,0x7c,0xfb,0x11,0x8b,0x74,0xb4,0x2d,0x55,0xde,0xf2,0x72,0xd4,0x80,0x75,0x51,0xce,0x4a,0x04,0x68,0x2c,0xa5,0xef,0x31,0x87,0x6c},
+	{0xb8,0xe8,0x10,0x2a,0x78,0x17,0x29,0x7a,0x0d,0xe8,0x1d,0x85,0x3e,0x7b,0xcb,0xd5,0xc7,0xd1,0x5c,0x87,0xef,0x7a,0xfd,0x5c,0xf1,0x65,0x18,0xcd,0x7d,0xf2,0x0e,0x2e,0x4c,0x95,0xa7,0x1f,0x94,0x01,0xdb,0xc0,0xf1,0x64,0x03,0x40,0x6d,0xed,0x34,0x87,0x00,0x17,0x62,0x74,0x84,0xc5,0x70,0x3a,0x9c,0x0d,0x67,0x98,0xc2,0xe7,0x14,0x2b,0xf9,0x27,0x12,0xff,0xcc,0x94,0x2d,0x2e,0x88,0xe0,0x78,0x06,0xf4,0x09,0xeb,0x66,0x31,0xc1,0x40,0x59,0xa6,0xff,0x6c,0x96,0x94,0x41,0xa8,0xeb,0x18,0x16,0x33,0x0b},
+	{0xa6,0xb2,0xf4,0xdb,0xcb,0xf8,0x51,0x1a,0xc6,0x9b,0x8e,0xa2,0x42,0x62,0x06,0x19,0xa1,0xae,0xa7,0x5e,0x5e,0xa1,0x89,0x3a,0xa2,0x5f,0x20,0xdc,0xbb,0xc0,0x2c,0x37,0x7b,0x54,0xa8,0x04,0x35,0x22,0x3d,0x82,0x6e,0xa2,0xa5,0x9d,0xc8,0xad,0x30,0x7b,0x36,0xb9,0xf0,0x28,0x3e,0xf7,0x25,0x30,0xa6,0x5e,0x49,0x2e,0xef,0x12,0xe0,0x2a,0x3f,0xbc,0x0b,0x81,0xdc,0x25,0x99,0x90,0xa6,0x77,0x7c,0x0a,0x52,0x8f,0x34,0x1a,0xc0,0xcd,0xed,0xee,0xf5,0xd5,0x60,0xef,0xf1,0xf6,0xa0,0x07,0x5e,0x39,0x84,0x74},
+	{0x25,0xf1,0xd7,0xdb,0x42,0xf9,0x1f,0x75,0xdd,0xa6,0x2e,0xff,0x4a,0x10,0x1f,0x25,0x18,0x78,0x4d,0xfa,0xc0,0xd2,0x79,0x72,0x55,0x79,0xbc,0xb1,0x37,0x71,0xde,0x48,0x08,0x30,0xcc,0xa2,0x50,0x5b,0x7a,0x2e,0xc6,0xd5,0x42,0xe1,0x62,0x88,0x56,0x69,0x67,0xc3,0x75,0x35,0x1a,0x2f,0xba,0x77,0x5a,0xdd,0x1b,0x76,0x14,0xd3,0x7b,0x2a,0xb2,0xa1,0x8c,0x88,0x1a,0xa3,0x22,0xde,0xf6,0x5f,0x87,0xa5,0x6b,0xe6,0xd5,0xe3,0xb1,0xc5,0x17,0xf4,0x95,0x6b,0x57,0x52,0xd6,0xfd,0x49,0x2c,0xec,0x1a,0x5a,0x63},
+	{0xbf,0x08,0xfa,0x42,0xff,0x19,0xc5,0xb7,0x0b,0x5e,0x84,0x9c,0x0d,0xc9,0xc6,0xcc,0xc2,0xd0,0xa7,0xab,0xef,0x01,0xc6,0xb2,0x24,0x4c,0x9d,0xd9,0x47,0x09,0xfc,0x4d,0x52,0xa8,0x91,0x87,0x30,0x59,0xa3,0xf7,0xea,0xc6,0x81,0x9a,0x43,0x30,0xf9,0x38,0x4e,0xbd,0xf1,0x72,0x8e,0x9d,0x9c,0x12,0x38,0x94,0xe5,0x34,0x92,0x45,0xb9,0x6d,0x9f,0x60,0xa8,0xcc,0xf6,0xfd,0xea,0x5e,0xaf,0x5f,0x6b,0xc7,0x50,0x2a,0x19,0xd6,0xe4,0x3f,0xb3,0xd7,0x8a,0xb2,0xa3,0x2b,0x35,0x2e,0xff,0x24,0x20,0xd2,0xa6,0x21},
+	{0xfa,0xf6,0x59,0x04,0xbe,0x28,0xad,0xf9,0x52,0x83,0x46,0x85,0x23,0x35,0x7e,0x1b,0x0d,0x9d,0x11,0x29,0xcb,0xb1,0x7c,0x54,0xb0,0xeb,0x5e,0x63,0x0d,0x9c,0x57,0x4c,0x3d,0x1d,0x3c,0x98,0xa2,0x5c,0x19,0xa2,0x6d,0xc8,0x0b,0x59,0xf8,0xe5,0x7c,0x8d,0x3d,0x1f,0x29,0xef,0x39,0x77,0xd3,0x38,0x5a,0x66,0x90,0xdd,0xaa,0x32,0x03,0x76,0xaf,0xe0,0x1b,0x3d,0x55,0xff,0x07,0x2b,0xf0,0xb5,0xac,0x76,0xe6,0xeb,0x57,0x03,0x76,0xf1,0x5d,0xba,0x4f,0xb5,0xfe,0xf0,0x89,0xe7,0x25,0xdf,0x1e,0x56,0x6f,0x1d},
+	{0x4a,0xab,0x51,0x9d,0x97,0x34,0x38,0xdb,0xd1,0x31,0x9e,0x60,0x12,0xae,0x49,0xbf,0x75,0x9f,0x56,0xaa,0x9e,0x5a,0x75,0x20,0x9a,0x85,0x05,0x19,0x3e,0x84,0x77,0x6e,0xb3,0xb8,0x1d,0xcb,0xbe,0x87,0x55,0xed,0x47,0x7a,0xcd,0xfa,0xf5,0xe7,0x19,0xfa,0xf6,0x4a,0x5b,0x57,0x9b,0x7b,0x22,0x03,0x7f,0x8e,0xc4,0xa2,0xa1,0x8c,0xd8,0x71,0xb1,0xdd,0x6e,0xea,0x0e,0x57,0x25,0xa1,0x95,0x23,0xce,0x24,0xcf,0x91,0x05,0x35,0x85,0x80,0xff,0x86,0x65,0x0d,0x06,0x22,0xe2,0x6f,0x0e,0xf2,0x5b,0xb7,0xc8,0x42},
+	{0xe7,0x5d,0x7d,0xcb,0x8f,0xeb,0x93,0xd5,0xa1,0xcc,0x3d,0xe7,0xa1,0x92,0x7e,0x3b,0x19,0x37,0x67,0xf9,0xbd,0xa2,0xc3,0x8e,0xe7,0xda,0x32,0xc0,0x04,0xd9,0x38,0x4a,0x70,0xc0,0xa2,0xd0,0xba,0xac,0x80,0xbe,0x32,0x81,0xee,0xd5,0x97,0x9d,0x25,0x65,0x79,0xf4,0x74,0x4e,0x09,0xa2,0xcd,0x4e,0x4a,0x03,0x8e,0xd2,0xe5,0x4f,0x1a,0x08,0x39,0x05,0x06,0x9e,0x09,0x1f,0x16,0x6c,0x5e,0xc7,0x4d,0x09,0x33,0xc1,0xb6,0x57,0xda,0x81,0xe2,0x63,0x1a,0xe0,0x37,0x5d,0xc9,0xad,0xc1,0xb1,0x11,0x75,0xd4,0x37},
+	{0x64,0x59,0xba,0x11,0x45,0x4e,0xf6,0x1e,0x82,0x05,0xcc,0xe4,0x43,0xc9,0x7f,0x10,0xaa,0x57,0x5d,0xfa,0xe4,0x9c,0xee,0x53,0xe9,0x26,0xfe,0xb2,0x46,0xdd,0x0f,0x4a,0x36,0xfd,0x1a,0x14,0xf1,0x7d,0x08,0x0a,0x52,0x59,0xa2,0x95,0xa5,0x9d,0x14,0x54,0x77,0x9f,0xad,0x04,0x0c,0xa8,0xae,0x33,0xbb,0x40,0x70,0x99,0xf7,0x59,0xc0,0x24,0xbe,0x7c,0x4d,0xa8,0x0c,0x1a,0xe5,0x35,0x04,0x9d,0xf1,0x9a,0xc7,0x72,0x2f,0x6e,0x94,0xcd,0x3b,0x82,0x24,0xd2,0x70,0x4b,0x43,0xcf,0x38,0xac,0x59,0x6d,0x5e,0x10},
+	{0xbe,0x91,0xf8,0x02,0x3d,0xa8,0x99,0x4b,0x25,0x39,0xe1,0xe2,0xc1,0x80,0x11,0xbd,0xd7,0x6d,0x64,0x6a,0x6b,0x90,0x7c,0x15,0xda,0xb6,0xfe,0x0d,0x76,0xf9,0xb8,0x59,0xdd,0xf8,0xea,0xec,0x9c,0x95,0xe1,0xee,0x56,0x34,0xb1,0x72,0x8e,0x2f,0xd2,0xc4,0x04,0x34,0xea,0x2e,0x6a,0x62,0x51,0x95,0xae,0xc1,0x69,0x06,0x80,0x1a,0xf4,0x04,0x59,0xb1,0x5d,0x9b,0x89,0x3b,0x0c,0x0a,0x9f,0x10,0x8a,0x60,0x70,0xc2,0x38,0x28,0xe1,0x54,0xb8,0x2e,0x61,0xfd,0x49,0xa9,0xf8,0x2c,0xf1,0x6c,0x00,0xba,0xae,0x5e},
+	{0xf4,0x2b,0x9f,0x43,0x17,0x87,0x30,0x60,0x36,0x85,0xf7,0x5b,0xf2,0x40,0xec,0xf9,0x78,0xf2,0x1b,0x56,0xfe,0x81,0xf1,0xdc,0xf1,0x03,0x5f,0xa9,0x25,0xd6,0x59,0x7b,0x02,0xb7,0x99,0xd3,0x2f,0x47,0xa7,0x2c,0x98,0x59,0x7f,0xfe,0x2d,0xf7,0xea,0x0a,0x9b,0x6c,0x22,0x75,0x23,0x93,0x24,0x35,0x00,0x95,0xe7,0xd1,0xbc,0xfa,0x45,0x44,0xbd,0xc9,0xff,0x38,0x39,0x1d,0x31,0xe7,0x59,0x41,0x20,0x1a,0xa1,0x24,0xb6,0x23,0x8f,0x38,0xe5,0x0d,0x96,0x33,0xa9,0x73,0x19,0xf6,0x02,0x24,0x1b,0xd8,0x16,0x3d},
+	{0xd3,0x64,0xd0,0x8c,0x1d,0xa3,0x92,0x8b,0x89,0xb0,0x75,0x69,0xd1,0xa6,0x21,0x59,0x5f,0xef,0x3a,0xb3,0x68,0xbe,0x5d,0xd1,0x3f,0x1b,0x7e,0xaa,0xb0,0x81,0xfa,0x31,0xc9,0x99,0x78,0xca,0xfd,0x33,0x38,0x07,0x58,0xc2,0x1c,0xc7,0xf8,0x23,0xf3,0xb8,0xe1,0x79,0xce,0x63,0x23,0xd7,0xfc,0xbc,0x5e,0xa4,0xfe,0x48,0xd7,0x05,0x5b,0x19,0x5a,0xa5,0x94,0x6b,0x70,0x00,0xcd,0x03,0x7e,0x8d,0xdb,0x3c,0x78,0x2e,0xb7,0x04,0xca,0xb3,0xd7,0x01,0x14,0x20,0x96,0x50,0x93,0x44,0x4c,0x5d,0x27,0xa6,0x16,0x4a},
+	{0x3b,0x84,0x3b,0xe8,0x5b,0x2b,0xe8,0x97,0x8e,0xd2,0xbb,0xc1,0xea,0xc6,0x6d,0x3d,0x95,0xe6,0x4c,0x65,0x86,0xfe,0xa2,0x93,0xa9,0x5e,0x3d,0x05,0xcb,0x86,0x48,0x27,0x38,0x5f,0x10,0xd8,0xef,0x91,0xf4,0xf3,0x77,0xb9,0x35,0x75,0x34,0xd1,0x9b,0xdb,0x5e,0x4f,0x4c,0x93,0x70,0xd1,0x76,0x1d,0x76,0xc0,0xe0,0xa0,0x56,0x43,0xd1,0x17,0x3c,0x6e,0x84,0xe2,0x92,0xc2,0xbc,0xbe,0xe3,0x85,0x6b,0xf5,0x28,0xe2,0xd7,0x4f,0x36,0x57,0xfb,0xe7,0x77,0x0e,0xa1,0xad,0x0a,0x73,0x62,0xb9,0x2d,0x76,0x64,0x04},
+	{0x7b,0x80,0x45,0xf3,0x5b,0x03,0x40,0x77,0x98,0x1b,0xa6,0x47,0x30,0x56,0x67,0x7c,0xb9,0x26,0xf9,0xec,0xb3,0x4f,0x66,0x8b,0xc6,0xfb,0x6b,0x1e,0x14,0xe8,0x69,0x3c,0x4e,0xcb,0xd1,0xd1,0xbe,0x22,0x34,0xfd,0xb9,0x84,0x5b,0x52,0xd5,0x07,0xea,0x02,0x65,0x52,0xc6,0x88,0xb5,0x2f,0xf7,0xe2,0x7e,0x24,0xe2,0x53,0x89,0xfd,0xdc,0x55,0x39,0x7b,0x1d,0x25,0xd4,0x1e,0x37,0x4d,0x52,0xf6,0x27,0xf5,0x74,0x81,0x2f,0xb4,0x47,0xd1,0x3a,0x4b,0x82,0xf8,0x18,0x5a,0x67,0x5c,0x85,0x3e,0x20,0x32,0xb5,0x5d},
+	{0x0d,0xf1,0x50,0x43,0xcd,0x46,0x6f,0x1b,0xe3,0x46,0xbc,0x10,0xe3,0x32,0x90,0x44,0xe1,0x40,0x7d,0x98,0xaf,0xd9,0xfa,0x80,0x81,0x15,0x0c,0x8c,0x2d,0xea,0x2b,0x4b,0x57,0x95,0xec,0xbf,0xfc,0x17,0xf9,0x0c,0xbb,0x63,0xc3,0x7b,0xe0,0xdf,0xc7,0xcd,0xe8,0x61,0xb9,0x01,0x64,0x16,0xa3,0xe7,0xba,0x01,0x0f,0x2f,0x24,0xe0,0xec,0x40,0x92,0x2b,0x9e,0x06,0xcf,0xb0,0x72,0x3a,0x07,0x14,0xac,0xec,0x7f,0x85,0xa2,0xe7,0xac,0x4d,0xd8,0x26,0x96,0x70,0xd3,0x58,0xa7,0xc0,0xa7,0x26,0x37,0x96,0x73,0x58},
+	{0x96,0x42,0x6d,0x0f,0x3c,0x04,0xf6,0x92,0xf2,0x44,0xbc,0x54,0x75,0x88,0xfe,0x98,0xd8,0x5d,0x9b,0x89,0x55,0xba,0x93,0x1f,0x9a,0x2f,0xe5,0x22,0xf6,0xdd,0xaf,0x77,0x22,0xbb,0x5d,0x24,0xb6,0xe5,0xe1,0x27,0xf0,0xb2,0x79,0xb9,0x8c,0xe3,0xbc,0x49,0x2d,0x9c,0x35,0x84,0x1e,0xeb,0xb3,0x7e,0xe4,0x43,0x5e,0x01,0x14,0x50,0xb3,0x39,0xfc,0xb0,0xf2,0x59,0x2c,0x47,0xbc,0xde,0xf5,0xd7,0xe2,0x80,0x0c,0xe9,0xa9,0x6b,0xd2,0xea,0x0c,0xe4,0xe3,0xc6,0x05,0xca,0x93,0x42,0xa1,0x3d,0x57,0x5d,0x8a,0x21},
+	{0xa8,0xd6,0x02,0x47,0x72,0xbb,0x42,0x17,0x7a,0x32,0xd2,0xbc,0x69,0x4e,0x84,0xec,0x92,0x61,0xc2,0x1a,0x32,0x60,0x26,0x0b,0x97,0xcd,0xf5,0xa0,0xed,0x63,0xdc,0x3a,0x48,0x81,0x18,0x75,0x06,0x94,0x83,0x5f,0x51,0x21,0xd7,0x24,0xd5,0x45,0x10,0x8b,0x39,0x5f,0x10,0x15,0xf2,0x07,0x14,0x17,0x21,0x7f,0xec,0x37,0x49,0xe4,0x20,0x4b,0x86,0x81,0x2d,0x93,0x90,0x64,0x39,0x9a,0x0a,0xf5,0x30,0x29,0x3d,0x09,0xcb,0x39,0xe2,0xd1,0xb6,0x9e,0x11,0x83,0xf3,0xc5,0xbb,0xf0,0xd5,0xf2,0x8b,0xdd,0x82,0x40},
+	{0x2e,0x85,0x01,0x45,0xbe,0x65,0x89,0x28,0xb7,0x0a,0x35,0x10,0xfc,0xe3,0x48,0x24,0xcd,0x93,0xeb,0x4e,0x3f,0x89,0x7d,0x94,0x40,0xc1,0x0a,0x07,0xf2,0xdd,0xa4,0x65,0x88,0x67,0x33,0x40,0x45,0xb3,0x8a,0x05,0xa7,0x82,0xd5,0x6c,0xce,0x01,0xdd,0x76,0x27,0x75,0x81,0x8b,0xb1,0x9c,0x62,0x89,0x37,0xaf,0x55,0x79,0x83,0x2f,0x80,0x27,0x57,0x0f,0xfc,0xc6,0x06,0x72,0x4d,0xcb,0x2d,0xfe,0x90,0xbe,0x1a,0xa6,0xff,0x4f,0x2d,0x1c,0x9a,0x16,0x9d,0x9a,0x85,0xf2,0x59,0x0c,0x48,0x69,0xa2,0xcf,0x28,0x29},
+	{0x94,0x7f,0x5e,0xb1,0x57,0xd9,0x1e,0x88,0xc0,0xac,0x88,0x88,0xa1,0xeb,0x32,0x78,0x04,0x3a,0x70,0xe6,0x67,0x3c,0x2e,0xdb,0xc4,0xb1,0x39,0xfb,0xd1,0x72,0x2c,0x64,0xf6,0x0d,0x45,0xac,0xa6,0xb1,0x79,0x65,0xfe,0xd2,0x49,0x00,0xda,0xfe,0x0b,0xbc,0x02,0xf1,0x31,0x43,0x7a,0x3b,0x2f,0x26,0xcd,0x28,0xc5,0xba,0x9e,0x1d,0x12,0x06,0x73,0xd2,0xb7,0x37,0xbd,0xed,0x10,0xea,0x39,0xa2,0xc1,0xfd,0xd0,0x36,0x84,0x21,0x7a,0x4f,0x87,0x5a,0x21,0x3b,0x08,0xe0,0xee,0x06,0xf1,0xd1,0xa9,0xe0,0x7e,0x0f},
+	{0xba,0x1d,0x0b,0xd0,0xde,0x54,0xff,0xe5,0x59,0xe5,0x01,0x62,0x7d,0x92,0x59,0x98,0x14,0x65,0x82,0x0a,0xae,0xd7,0x58,0x42,0x3d,0x06,0x61,0xaa,0xe0,0x84,0xdf,0x32,0x85,0x3a,0xd5,0xac,0xea,0xbd,0x9b,0xc1,0x83,0x8e,0x9a,0x30,0xfa,0x3a,0x41,0x7e,0x08,0x7d,0x13,0xb8,0x83,0x31,0xbc,0x56,0xa9,0x1d,0x97,0x1c,0x47,0x6a,0xbe,0x5f,0x3d,0x48,0x82,0xe3,0x57,0x53,0xe2,0x90,0x1b,0xd7,0x4c,0x5b,0xd6,0x3d,0xde,0xae,0x95,0xc8,0xef,0x71,0xab,0x24,0x24,0x56,0x09,0x72,0x47,0xee,0xba,0x72,0x55,0x71},
+	{0xd0,0xe0,0xa7,0x72,0xba,0x59,0x0d,0x2e,0xae,0xbe,0x30,0x3d,0xe3,0xc5,0xfd,0x3e,0xa4,0x02,0x98,0xfd,0xf8,0x8f,0x3d,0x1b,0xe8,0xa0,0xc5,0x22,0x00,0x60,0x63,0x0a,0xae,0x4a,0xb0,0xfc,0x79,0x9d,0x14,0x74,0xa3,0x6e,0x72,0x9e,0x8d,0xc6,0x04,0xe9,0xba,0xf0,0x38,0x45,0xbd,0x0a,0x82,0xf1,0x71,0xd6,0x82,0xa2,0x36,0x0a,0x88,0x26,0xd9,0xd7,0x90,0xe9,0xd5,0xe2,0x37,0x95,0xff,0x4f,0x4f,0x01,0x24,0xf2,0xb1,0xa7,0x40,0x7f,0x8c,0xfc,0x3d,0x7a,0x6d,0x8e,0x36,0xdc,0x27,0x17,0x5e,0x44,0x71,0x6a},
+	{0xd5,0xd5,0xa2,0x87,0x71,0xf8,0x84,0x90,0x17,0x8a,0x5f,0x27,0x31,0x63,0x5f,0x34,0xbe,0xbf,0x72,0xf5,0xdc,0xf8,0xef,0xde,0x68,0x00,0x6f,0xb4,0x32,0xdb,0x81,0x31,0x78,0xa6,0x70,0x62,0xd1,0xa6,0xb5,0x89,0x26,0xb4,0x33,0x8b,0xc2,0x4d,0x70,0x29,0x5b,0x51,0x60,0xc6,0x30,0xa6,0xe8,0xd6,0x4e,0x02,0x43,0x19,0x83,0xe6,0xab,0x41,0xa5,0x19,0xe3,0x4f,0x9a,0x6b,0x8f,0x63,0x09,0xb0,0xa0,0xb6,0xb6,0x73,0xcf,0x2b,0x01,0xe5,0x82,0x3d,0xe9,0x02,0xf8,0x58,0x87,0xd5,0xe3,0x8e,0x18,0xcc,0xce,0x03},
+	{0x5f,0x73,0x86,0xc0,0xc7,0xf7,0x4f,0x1b,0x4b,0x48,0x3a,0xbc,0xee,0x82,0xee,0x18,0x60,0x40,0x99,0x13,0xe2,0x67,0x58,0x35,0x00,0xc5,0x7c,0x70,0x92,0x4d,0xe5,0x4e,0xbb,0x9c,0xa9,0x88,0x7b,0x44,0x8b,0xb1,0x3b,0x7f,0x66,0x96,0xa3,0x30,0x1d,0x20,0x21,0x21,0x58,0xb9,0xcf,0xbd,0xd0,0x9c,0xfe,0xbd,0x8b,0xca,0x1c,0x27,0x1c,0x43,0x31,0x3e,0xf6,0xdc,0x6e,0xcb,0x88,0x09,0xf3,0x0f,0x9a,0xbc,0xab,0xe5,0x46,0x6a,0xef,0xe6,0x68,0x77,0x1a,0x5c,0x59,0x7a,0x37,0xfa,0xdb,0x16,0x18,0xc4,0x6b,0x10},
+	{0x53,0x03,0x26,0xd9,0xcf,0xa2,0xcb,0x9e,0x5d,0x96,0xf8,0x0c,0xfc,0x41,0x64,0x3f,0x7c,0x3f,0x51,0x58,0x42,0x51,0x15,0x7a,0x17,0x1e,0xf6,0xa6,0x0f,0x51,0xd2,0x55,0x2f,0x4f,0x53,0xf1,0x0d,0x73,0x6e,0x30,0x29,0x9d,0x37,0x10,0xe3,0x63,0x56,0xac,0xf5,0xec,0x22,0x76,0xc9,0x59,0x45,0xb7,0xbf,0x67,0xe7,0xb4,0xfc,0x89,0x23,0x3d,0xf0,0xe3,0x7f,0x3c,0x99,0x83,0xa6,0xce,0x52,0x5a,0xde,0xbd,0xd9,0x99,0xc9,0xdf,0xda,0x4e,0x55,0x13,0xb0,0x80,0x5a,0x7b,0x07,0xbd,0x57,0x3c,0x3f,0xe6,0x8b,0x45},
+	{0xe7,0x6a,0x5b,0x4d,0x9e,0x42,0x80,0xd1,0x22,0x43,0x23,0xd1,0x73,0x7c,0xaf,0x0d,0x4a,0x18,0x75,0x02,0x07,0x2a,0xac,0xad,0x50,0x35,0xdd,0xda,0xcd,0x4b,0x02,0x30,0xbc,0x4e,0x9d,0x0a,0x4e,0xda,0xad,0xdb,0xa1,0xe2,0x59,0x16,0x07,0xd9,0x44,0x39,0xd4,0xae,0x90,0x42,0x30,0x1b,0xb3,0xe0,0x31,0x5b,0xf4,0x6f,0x8b,0x5b,0xa8,0x73,0x94,0x5d,0xa8,0x79,0x25,0xb9,0x8b,0x67,0xa0,0xd0,0x90,0xb8,0x35,0xac,0x05,0x9c,0x72,0xc3,0xa0,0x2d,0x8d,0x1f,0x2e,0xc8,0x78,0xdf,0xf1,0xca,0xca,0x23,0x83,0x74},
+	{0xa2,0xf2,0x92,0xa5,0x0d,0x54,0xc1,0x46,0x19,0xe4,0x61,0x53,0xe2,0xf8,0xdf,0x80,0xd2,0x40,0x44,0x11,0xad,0x50,0x0f,0xbc,0x64,0x80,0xd8,0x9c,0x05,0x18,0x09,0x0d,0xc7,0x85,0xc3,0x06,0x42,0x9c,0x7a,0x4b,0x08,0x2a,0xb6,0x6d,0x03,0x6f,0x92,0x23,0x0b,0x23,0xd0,0xeb,0xd9,0xd0,0xab,0x71,0xa4,0x54,0x1a,0x77,0x38,0x06,0xae,0x23,0x8d,0x07,0xbd,0x2c,0x52,0x75,0xb1,0x93,0xf7,0x5b,0x34,0xfc,0xc5,0x03,0x31,0x74,0x9a,0xee,0x35,0x87,0x35,0x3c,0x08,0xa5,0x0d,0xb1,0xec,0xb5,0x3b,0x30,0x3b,0x2c},
+	{0xd5,0x49,0xd6,0x36,0x5a,0xa1,0xf7,0x1c,0x73,0xbb,0x1f,0x2e,0x51,0xd5,0xa7,0xf1,0x20,0xdc,0x46,0x00,0xf5,0xf9,0xa0,0x9d,0x9a,0x38,0xfc,0x4d,0x1b,0xac,0x5c,0x38,0x21,0x44,0xf5,0xa2,0x82,0xf5,0xbe,0xb6,0x51,0x97,0x20,0x92,0x18,0x7e,0x09,0x82,0x64,0xbe,0x5a,0x84,0x6d,0x55,0x23,0xe8,0xbd,0xa0,0xa0,0x3d,0xf2,0x61,0x1a,0x09,0x18,0x25,0x10,0xa5,0x42,0x7b,0x7b,0x5b,0x47,0xc8,0x9e,0xf6,0xab,0xcc,0xe5,0xc6,0x9c,0xc0,0xa7,0x4b,0x2c,0x2b,0x23,0xf4,0xf6,0x8e,0x54,0x52,0x4b,0xe1,0x4d,0x50},
+	{0xd3,0xf2,0x71,0xe0,0x9c,0x80,0xf3,0xf1,0xe9,0x2b,0xda,0x21,0xe4,0x91,0xde,0xd7,0x48,0xc8,0x17,0x84,0xe1,0x21,0x59,0x71,0x0e,0x22,0x21,0xda,0x67,0xc4,0x0e,0x77,0x83,0xfc,0x7a,0x0b,0x9b,0x02,0x5c,0xe6,0x0e,0x8e,0x2f,0x13,0x52,0x57,0x3c,0xf7,0x9d,0x3c,0xce,0xc3,0x1b,0x4e,0x0b,0x85,0x36,0xa1,0x58,0xcc,0x8c,0xac,0x8e,0x0b,0x2d,0xd5,0x9b,0x16,0x8d,0xd3,0xc1,0x24,0xb7,0xed,0x3f,0x4d,0x69,0x90,0x83,0x4e,0x0a,0x3a,0x03,0xbf,0x4e,0x10,0xea,0xde,0x64,0x6d,0x11,0x13,0x8d,0xbe,0x31,0x62},
+	{0xa5,0x9c,0x11,0x2b,0x07,0xf7,0xeb,0x80,0x75,0x16,0x08,0x95,0x7b,0xed,0xd1,0xea,0x3e,0x89,0x21,0xbb,0xe0,0x4d,0x91,0x42,0xe8,0x8b,0x56,0xb7,0xaf,0x2a,0x7c,0x5e,0xae,0x10,0xa9,0xfe,0x53,0xab,0x45,0x36,0xc2,0xe4,0x81,0x89,0xb4,0x02,0x45,0xf7,0x08,0x11,0x44,0x96,0x70,0x97,0xbd,0xd4,0x3b,0xc1,0x4f,0x99,0x84,0x8d,0x4a,0x43,0x1b,0xfb,0xb6,0x98,0x3c,0xec,0x3f,0x67,0x1c,0x18,0xe5,0x6b,0x75,0x1d,0xe1,0xfb,0x71,0x02,0x22,0x95,0xff,0x8f,0x86,0xca,0x3f,0x81,0x59,0xc3,0x10,0x2d,0xa3,0x61},
+	{0xa7,0xbb,0x90,0xc0,0xed,0x1a,0x59,0x22,0x5c,0xff,0x84,0xc3,0x41,0x6e,0xef,0xca,0x81,0x53,0xf2,0x5a,0x68,0x25,0xd8,0xa2,0x1e,0xa2,0xf4,0x07,0x6e,0xd2,0xe4,0x2a,0xb0,0x08,0x63,0x1b,0xe5,0x65,0xf9,0xc3,0xd5,0xeb,0x77,0x97,0xb9,0x8e,0x89,0x56,0x0c,0x45,0x84,0x60,0x3f,0x84,0x20,0x75,0x11,0x9a,0x7a,0x92,0xa6,0x9c,0x40,0x25,0xff,0x08,0x15,0x7f,0x20,0x08,0x4e,0xf5,0x04,0x6f,0x08,0xc7,0x06,0x6f,0xf4,0x3a,0x3b,0x62,0x4d,0x80,0x33,0x89,0x20,0x1f,0x68,0xc0,0xbc,0x3b,0x9e,0xfa,0x61,0x4e},
+	{0x09,0x10,0xd8,0xb1,0xfa,0x9c,0xab,0x0e,0xa2,0xb7,0x4b,0xde,0x58,0x17,0x0a,0xfc,0xb5,0xd6,0x29,0x8c,0x16,0x20,0xe9,0x51,0xea,0x03,0xc7,0xdb,0x19,0x1c,0xd3,0x0b,0x74,0x03,0x74,0x33,0x4c,0x64,0x3d,0x73,0xbb,0xd1,0x57,0x89,0xbd,0xdf,0xa4,0x80,0x04,0xd8,0x15,0x4c,0xf5,0xed,0x1f,0x3c,0x08,0xc3,0xe4,0xb1,0x03,0x60,0xd0,0x14,0x86,0x41,0xa7,0xbe,0x97,0x27,0x09,0x5f,0x44,0xf2,0xd6,0x40,0xf6,0x34,0x61,0xde,0x4f,0xdd,0xc5,0xc1,0x78,0x20,0x8d,0xeb,0x3f,0xbe,0xe0,0x1d,0x20,0x34,0xcb,0x33},
+	{0x1d,0x60,0x35,0x6f,0x2d,0x68,0x00,0xe2,0xaf,0x02,0xff,0x34,0xe4,0x64,0x50,0xc3,0xbe,0x02,0xe6,0xa9,0xc9,0xf0,0x54,0x75,0xeb,0xa7,0xc2,0xf7,0x61,0x88,0x9d,0x08,0x37,0xb4,0xe8,0xe1,0x00,0x8e,0x4c,0x0c,0x34,0xe8,0x30,0x47,0x88,0x45,0xa8,0x2e,0xad,0xa3,0x7b,0xd0,0x18,0x5d,0x3a,0x17,0x70,0x78,0xa2,0x13,0x1a,0x0d,0x47,0x56,0x9d,0x39,0x76,0x5e,0xda,0xed,0x84,0xad,0x38,0x73,0x50,0x18,0x89,0xcf,0x7c,0xc8,0x6a,0x91,0x0b,0xcc,0x23,0xd5,0x1e,0x8c,0x4e,0x59,0x93,0x02,0x9c,0xbc,0xc0,0x38},
+	{0x72,0x96,0x05,0x4a,0xdf,0x55,0xec,0xfe,0xff,0x87,0xf9,0x32,0x48,0x09,0x6a,0xd8,0x5e,0x92,0x53,0x80,0x9c,0x7f,0xdd,0x07,0x26,0x8c,0x32,0x40,0x0e,0xc5,0xd7,0x41,0xaf,0x1a,0x1b,0x26,0x83,0x5e,0xca,0xdf,0xab,0x28,0x90,0x54,0x2e,0xba,0x0b,0xc1,0xb8,0x32,0x75,0xab,0x18,0xa0,0x06,0x36,0xa3,0x27,0x89,0xe5,0x37,0xbe,0x59,0x7e,0xb3,0x57,0x1f,0x2a,0x53,0xfb,0xf0,0xd8,0xbb,0xc3,0xbe,0x6e,0x00,0x60,0xf3,0x2b,0x85,0x1b,0x83,0x90,0xee,0xbf,0xa0,0x3f,0x7a,0x20,0x08,0x00,0xdc,0x60,0x27,0x4b},
+	{0x07,0xfd,0xa2,0xd6,0x8f,0xda,0xa2,0x21,0xdd,0x8e,0x05,0x9d,0xee,0x5c,0x78,0x53,0xef,0xed,0xec,0x95,0xb5,0x9f,0x3e,0xe5,0x79,0x8f,0xae,0x02,0xe2,0xfe,0xea,0x14,0xbf,0x99,0x59,0x18,0x42,0xf9,0xc6,0x19,0x5d,0x3d,0x06,0x04,0x98,0x28,0xb4,0xef,0xba,0x11,0x74,0x4e,0x18,0xac,0xca,0x6e,0xe4,0x75,0x87,0xcb,0xb4,0x7c,0x2c,0x79,0xe8,0xc0,0x2c,0x77,0x19,0x58,0x41,0xc7,0xf3,0x05,0xd1,0xba,0xf3,0xa9,0x96,0x97,0x08,0xe6,0xc1,0x14,0x62,0xf9,0x0f,0xe3,0x53,0x69,0x90,0xed,0xc2,0xd7,0xab,0x03},
+	{0xb4,0x40,0x73,0xe8,0x2f,0xe2,0x19,0xa9,0xce,0xf1,0xf7,0xf8,0xb9,0x40,0xeb,0xd5,0x93,0x89,0x0d,0x8f,0x3c,0x24,0x58,0x8b,0xee,0xaa,0xfb,0x80,0x8d,0x09,0x96,0x0b,0x17,0x00,0x0f,0x8c,0xde,0xab,0x68,0x6d,0xd1,0xe2,0xb9,0x03,0x60,0x76,0x48,0x63,0x93,0xd1,0xd6,0x0f,0xa7,0xc3,0x52,0x85,0x60,0x37,0xe6,0x3a,0x7e,0xd3,0x2e,0x7e,0x4d,0xd0,0xd4,0xf1,0x8d,0x52,0xa9,0xc3,0xea,0x73,0x18,0x5d,0x8c,0x99,0xfd,0x0f,0x0d,0x22,0xe0,0xdc,0xbf,0xb5,0x0b,0xf6,0x34,0x6c,0x59,0x3b,0x9c,0xb2,0x15,0x02},
+	{0xa7,0x27,0x90,0x76,0xf3,0x2d,0x56,0x0e,0x39,0x47,0xe1,0x64,0xf0,0xc7,0x24,0x8d,0xc3,0x17,0xea,0x26,0xca,0xc2,0x00,0x6c,0x0d,0xab,0x92,0x17,0xdd,0x2e,0x4b,0x40,0xb1,0xc0,0x30,0x90,0x60,0x36,0xe8,0x10,0xc8,0x51,0x31,0x20,0xfc,0xce,0x0a,0x63,0x1c,0xf4,0x82,0x59,0x04,0xa9,0x85,0x63,0xff,0x68,0xf7,0x49,0x12,0xd4,0x25,0x22,0x25,0x45,0x12,0xa4,0x45,0xa3,0x4c,0xbe,0xdc,0x58,0xa1,0xea,0x5a,0xbc,0x31,0x78,0xd6,0xe7,0x1c,0x85,0x0f,0x70,0x89,0x0c,0x03,0xd6,0xca,0x4d,0xb8,0x3b,0xca,0x43},
+	{0xd5,0xee,0x67,0xff,0xf1,0x2c,0x60,0x21,0xf6,0xc7,0x63,0x01,0xb3,0xaf,0x43,0x53,0x09,0xeb,0x91,0x86,0xa6,0x72,0xee,0x17,0xfb,0xae,0xe1,0x12,0x4f,0x86,0x04,0x25,0xd3,0x4d,0xc4,0xd3,0xec,0x3d,0xe4,0xef,0x22,0x77,0x80,0x0d,0xf9,0xca,0xd2,0xec,0xa6,0x3e,0xb1,0x46,0xd9,0x82,0x1f,0x3b,0xba,0xec,0xd1,0x88,0x38,0x17,0x95,0x0e,0x0c,0x96,0xbc,0xd7,0x88,0x5f,0x8a,0x4a,0x9b,0xbd,0xe2,0x89,0xfc,0x9d,0xcd,0xd8,0x4d,0x36,0x84,0x86,0x69,0x30,0xed,0x82,0x0c,0xf9,0xa0,0x48,0x03,0x38,0x9c,0x77},
+	{0xf2,0x35,0x24,0x23,0x54,0xf5,0xa3,0xa5,0xa6,0xc3,0xf2,0xe3,0x36,0xf0,0xc8,0xfb,0xab,0x76,0x85,0xe4,0xfa,0x74,0x21,0xc8,0xf7,0x7a,0xd0,0x54,0xf2,0x4c,0x5e,0x4e,0x3e,0xf1,0x39,0x76,0x18,0xc1,0x0a,0xfb,0x16,0x72,0x53,0x17,0xaf,0x40,0x8b,0x0d,0x09,0xec,0x6b,0x9b,0xf2,0x61,0xe6,0xe2,0x5a,0x3e,0x1b,0x1f,0x45,0x3c,0x94,0x4f,0x82,0xa7,0x00,0x3f,0x7e,0xf5,0x8a,0x87,0xf2,0x05,0x23,0x5e,0x13,0xe4,0x28,0x69,0x53,0x0e,0xbf,0xa1,0xac,0x28,0x78,0x3e,0x41,0x58,0xb5,0x24,0x80,0x7a,0x95,0x00},
+	{0x1e,0x1e,0x29,0xa0,0x02,0xb2,0x51,0x40,0x28,0x6f,0xb1,0x61,0x7d,0x2d,0x02,0x74,0x06,0xcd,0x42,0x84,0xac,0xe3,0x93,0x29,0x1e,0xa6,0x37,0xd4,0x11,0xa3,0x06,0x5a,0x92,0x82,0xf5,0x31,0x2b,0xd9,0xee,0x8f,0x1a,0x75,0x99,0x4f,0xac,0x2a,0x12,0x4e,0x0a,0x4f,0x67,0xd8,0xd2,0x19,0x47,0x1c,0xb4,0x9c,0x9f,0x47,0x96,0x04,0xf9,0x5e,0x8d,0x4d,0xf5,0x61,0x9a,0x6c,0xfa,0x85,0x0a,0x6b,0x6b,0x17,0xef,0x8a,0x90,0xf3,0x82,0x07,0x0a,0x22,0xd7,0x95,0x41,0x38,0x23,0x97,0xb6,0x12,0x4b,0xd7,0xec,0x4a},
+	{0xe6,0x5b,0xed,0x7b,0x77,0x97,0x91,0x1f,0x4b,0xb2,0xce,0xee,0x18,0x4a,0x81,0x29,0x89,0x51,0x36,0x08,0x2d,0x9a,0x66,0xd0,0x38,0x26,0xdd,0x0f,0x53,0x55,0x2c,0x01,0xb4,0x04,0x06,0x6f,0xab,0x2d,0x89,0xea,0x96,0xa7,0x24,0x45,0x4a,0xd6,0x5b,0xc6,0x1c,0x35,0x2e,0x75,0x0c,0x9f,0x60,0xf2,0x8d,0xfd,0xdc,0xaa,0x35,0x20,0xee,0x58,0xaa,0x71,0x3f,0x7b,0x46,0x50,0xf2,0x87,0xd7,0x2d,0x61,0x5e,0x57,0x3a,0x5c,0xfb,0xfe,0xf0,0x0e,0xa4,0xe2,0xd8,0x55,0x07,0x0b,0x4f,0x3e,0x09,0x5e,0x1b,0x52,0x0a},
+	{0xf8,0x91,0x5a,0x62,0x0d,0xa2,0x87,0xd7,0xcc,0x2d,0x84,0x2f,0x50,0x95,0xa9,0xa0,0x76,0x02,0x04,0x18,0xe7,0xbe,0x42,0x07,0x22,0xfe,0x01,0xe7,0xef,0x6f,0x1b,0x30,0xc1,0x9b,0x56,0x55,0x32,0x1b,0xee,0x7f,0x11,0x4c,0x8d,0x21,0x65,0xb9,0xc8,0x9a,0x0a,0xfb,0x5d,0xc0,0x17,0x50,0x1e,0xbc,0xcb,0x27,0xf5,0xf6,0x2f,0xf3,0xa4,0x26,0x3c,0xfa,0x53,0xac,0x9e,0x95,0x64,0x79,0x62,0xe0,0xe9,0xa7,0x5a,0xa6,0x27,0xa1,0xdf,0x3a,0x2d,0x11,0x01,0xc6,0x08,0xca,0x42,0x7b,0x19,0x32,0x2d,0x59,0xec,0x14},
+	{0xab,0xb0,0x97,0xa9,0xaf,0x24,0xc1,0x64,0x82,0x3c,0xd2,0x51,0x2a,0xf0,0x3e,0xb2,0x72,0x91,0xa2,0xf8,0x8a,0x6b,0x2a,0x93,0x6f,0x1b,0x11,0x26,0x76,0xe9,0x4a,0x2b,0x36,0xcb,0x0e,0x84,0x6c,0x10,0x42,0x89,0xeb,0x7b,0x82,0x9b,0x64,0x63,0xbc,0x38,0xab,0x8d,0x96,0xbd,0xf9,0xa2,0x79,0x5a,0x20,0xee,0x79,0xf0,0x8e,0x69,0x3f,0x55,0xef,0xf5,0x2e,0x21,0x92,0x32,0xd3,0xd8,0x87,0x67,0x72,0xfe,0xa3,0x1b,0x75,0x6e,0x45,0x2b,0x61,0xac,0xa7,0x3c,0x29,0xdb,0x7a,0x2d,0xe9,0x8a,0x98,0xa1,0xc8,0x33},
+	{0xc1,0xbd,0xb0,0x4e,0x86,0xc0,0xc2,0xc0,0x91,0x74,0x39,0x9b,0xe4,0xca,0x3d,0x8f,0x98,0x0e,0xee,0x40,0xd1,0x4c,0xb6,0x16,0x6d,0x5d,0xda,0x57,0x20,0xd3,0xd7,0x6b,0x69,0xbc,0x98,0xc3,0xd0,0x63,0x53,0x67,0xff,0xa3,0xeb,0xb6,0x5f,0x4e,0xd1,0x1e,0x84,0xb7,0xe8,0x61,0x56,0x3a,0xa2,0xa3,0xdc,0x1f,0x73,0x52,0x6b,0x4a,0x39,0x7f,0xcb,0x30,0xf0,0x3d,0x92,0x59,0xed,0x09,0xb2,0xa6,0x22,0xe9,0x47,0x8a,0x4e,0x21,0xcd,0x0b,0x28,0x78,0xa3,0x8d,0xa4,0x12,0x29,0x20,0x65,0xe0,0x0e,0xb0,0x3e,0x48},
+	{0x22,0x2c,0x95,0x47,0x62,0xc4,0x53,0x71,0x08,0x3c,0x03,0x2c,0x33,0xc4,0x63,0xea,0xbf,0x3c,0x73,0x8f,0x79,0x81,0xba,0xbf,0x98,0x7b,0x8a,0xb8,0x9b,0x39,0x10,0x46,0xb2,0x1d,0xab,0x4f,0xf6,0x93,0x4d,0x3b,0x2a,0x29,0x89,0x88,0x58,0x33,0x5a,0x99,0x1a,0x0a,0x73,0x74,0x6a,0xe3,0x4b,0xc1,0x22,0x03,0x5b,0x27,0x77,0xa2,0xac,0x7a,0xbe,0x96,0xac,0x7b,0x4f,0xcd,0x52,0x57,0x5f,0x3c,0xf7,0x3e,0x61,0xba,0xf3,0x10,0x98,0x04,0xf2,0x0d,0x44,0xb8,0xe3,0xbe,0x75,0x8e,0xe4,0xa9,0xa0,0x64,0x60,0x62},
+	{0xb8,0x15,0xc2,0xe1,0xb7,0xf2,0xf6,0x38,0xfb,0x62,0xe6,0x47,0xe4,0xce,0xd6,0x38,0x83,0x1f,0x4a,0x2c,0x94,0x96,0xf0,0xd6,0xa1,0xbe,0x65,0xd8,0x8f,0xde,0xf3,0x55,0xa0,0xed,0x4c,0x04,0x3a,0x0d,0x4d,0xac,0x12,0xd6,0x9d,0x4d,0xb6,0x9d,0x97,0x51,0x29,0x57,0x5a,0xac,0x18,0x99,0xc5,0x52,0x84,0xe2,0xc7,0xde,0xf0,0xa3,0x7e,0x4e,0x45,0xd8,0xff,0xcb,0x4e,0x23,0xe7,0xdf,0x4a,0x47,0x91,0x85,0x30,0x80,0x03,0x4e,0x2f,0x63,0xd1,0x68,0x56,0xe0,0xfd,0xa7,0xd8,0xbe,0x3b,0x52,0x4f,0x21,0x1f,0x76}
+};
@@ -0,0 +1,13 @@
+//
+// Precomputed multiples of the commitment generator H
+//
+
+#ifndef TREZOR_CRYPTO_XMR_H_TABLE_H
+#define TREZOR_CRYPTO_XMR_H_TABLE_H
+
+#include "ed25519-donna/ed25519-donna.h"
+
+/* multiples of H in packed {ysubx, xaddy, t2d} form, same layout as ge25519_niels_base_multiples */
+extern const uint8_t ALIGN(16) xmr_h_niels_multiples[256][96];
+
+#endif //TREZOR_CRYPTO_XMR_H_TABLE_H
@@ -45,7 +45,9 @@ const ecdsa_curve nist256p1 = {
 
 	/* b */ {
 		/*.val =*/{0x27d2604b, 0x2f38f0f8, 0x53b0f63, 0x741ac33, 0x1886bc65, 0x2ef555da, 0x293e7b3e, 0xd762a8e, 0x5ac6}
-	}
+	},
+
+	/* multiply */ bn_multiply_nist256p1
 
 #if USE_PRECOMPUTED_CP
 	,
@@ -33,6 +33,23 @@
 #define USE_INVERSE_FAST 1
 #endif
 
+// verify single ECDSA signatures with a joint wNAF multiplication, which
+// takes about 1.7 kB more stack (3.3 kB without USE_PRECOMPUTED_CP) than
+// the two separate point multiplications used otherwise
+#ifndef USE_ECDSA_VERIFY_WNAF
+#define USE_ECDSA_VERIFY_WNAF 1
+#endif
+
+// use 64 bit limbs and 128 bit products for the long product in bn_multiply,
+// the generic reduction keeps its 30 bit steps (see bignum.c)
+#ifndef USE_BN_INT128
+#ifdef __SIZEOF_INT128__
+#define USE_BN_INT128 1
+#else
+#define USE_BN_INT128 0
+#endif
+#endif
+
 // support for printing bignum256 structures via printf
 #ifndef USE_BN_PRINT
 #define USE_BN_PRINT 0
@@ -43,7 +60,24 @@
 #define USE_RFC6979 1
 #endif
 
-// implement BIP32 caching
+// number of signatures that ecdsa_verify_digest_batch processes together
+#ifndef ECDSA_VERIFY_BATCH_SIZE
+#define ECDSA_VERIFY_BATCH_SIZE 16
+#endif
+
+// number of points that scalar_multiply_add_batch normalizes together
+#ifndef ECDSA_MULTIPLY_BATCH_SIZE
+#define ECDSA_MULTIPLY_BATCH_SIZE 16
+#endif
+
+// number of signatures that ed25519_sign_open_batch processes together,
+// the batch state takes about 420 bytes of stack per signature
+#ifndef ED25519_VERIFY_BATCH_SIZE
+#define ED25519_VERIFY_BATCH_SIZE 64
+#endif
+
+// implement BIP32 caching, BIP32_CACHE_SIZE is the size of the global cache
+// used by hdnode_private_ckd_cached
 #ifndef USE_BIP32_CACHE
 #define USE_BIP32_CACHE 1
 #define BIP32_CACHE_SIZE 10
@@ -96,4 +130,23 @@
 #define CONFIDENTIAL
 #endif
 
+// keep scratch buffers for confidential data on the stack instead of in
+// static CONFIDENTIAL memory. this makes signing, ECDH and BIP32 derivation
+// reentrant, i.e. they can be called from several threads at once.
+// note that the global BIP39 and BIP32 caches are still shared between
+// threads, use mnemonic_to_seed_ctx with a locked BIP39Cache and
+// hdnode_private_ckd_cached_ctx with a locked BIP32Cache instead of
+// mnemonic_to_seed and hdnode_private_ckd_cached. locked caches require
+// USE_REENTRANT, their locks do not cover the derivation.
+#ifndef USE_REENTRANT
+#define USE_REENTRANT 0
+#endif
+
+// storage class of scratch buffers for confidential data, see USE_REENTRANT
+#if USE_REENTRANT
+#define STATIC_CONFIDENTIAL
+#else
+#define STATIC_CONFIDENTIAL static CONFIDENTIAL
+#endif
+
 #endif
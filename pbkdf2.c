@@ -175,3 +175,46 @@ void pbkdf2_hmac_sha512(const uint8_t *pass, int passlen, const uint8_t *salt, i
 		}
 	}
 }
+
+void pbkdf2_hmac_sha512_batch(const uint8_t *const pass[], const int passlen[], const uint8_t *const salt[], const int saltlen[], uint32_t iterations, uint8_t key[][SHA512_DIGEST_LENGTH], size_t count)
+{
+	PBKDF2_HMAC_SHA512_CTX pctx[PBKDF2_SHA512_LANES];
+	uint64_t idig[8 * PBKDF2_SHA512_LANES], odig[8 * PBKDF2_SHA512_LANES];
+	uint64_t f[8 * PBKDF2_SHA512_LANES], g[16 * PBKDF2_SHA512_LANES];
+
+	for (size_t first = 0; first < count; first += PBKDF2_SHA512_LANES) {
+		// unused lanes of the last group repeat its first password
+		for (size_t l = 0; l < PBKDF2_SHA512_LANES; l++) {
+			size_t i = (first + l < count) ? first + l : first;
+			pbkdf2_hmac_sha512_Init(&pctx[l], pass[i], passlen[i], salt[i], saltlen[i], 1);
+			for (size_t k = 0; k < 16; k++) {
+				g[k * PBKDF2_SHA512_LANES + l] = pctx[l].g[k];
+			}
+			for (size_t k = 0; k < 8; k++) {
+				idig[k * PBKDF2_SHA512_LANES + l] = pctx[l].idig[k];
+				odig[k * PBKDF2_SHA512_LANES + l] = pctx[l].odig[k];
+				f[k * PBKDF2_SHA512_LANES + l] = pctx[l].f[k];
+			}
+		}
+		for (uint32_t i = 1; i < iterations; i++) {
+			sha512_Transform_x8(idig, g, g);
+			sha512_Transform_x8(odig, g, g);
+			for (size_t j = 0; j < 8 * PBKDF2_SHA512_LANES; j++) {
+				f[j] ^= g[j];
+			}
+		}
+		for (size_t l = 0; l < PBKDF2_SHA512_LANES; l++) {
+			for (size_t k = 0; k < 8; k++) {
+				pctx[l].f[k] = f[k * PBKDF2_SHA512_LANES + l];
+			}
+			if (first + l < count) {
+				pbkdf2_hmac_sha512_Final(&pctx[l], key[first + l]);
+			}
+		}
+	}
+	memzero(pctx, sizeof(pctx));
+	memzero(idig, sizeof(idig));
+	memzero(odig, sizeof(odig));
+	memzero(f, sizeof(f));
+	memzero(g, sizeof(g));
+}
@@ -53,4 +53,11 @@ void pbkdf2_hmac_sha512_Update(PBKDF2_HMAC_SHA512_CTX *pctx, uint32_t iterations
 void pbkdf2_hmac_sha512_Final(PBKDF2_HMAC_SHA512_CTX *pctx, uint8_t *key);
 void pbkdf2_hmac_sha512(const uint8_t *pass, int passlen, const uint8_t *salt, int saltlen, uint32_t iterations, uint8_t *key, int keylen);
 
+// number of passwords pbkdf2_hmac_sha512_batch hashes in parallel
+#define PBKDF2_SHA512_LANES 8
+
+// derive the first 64 byte block of pbkdf2_hmac_sha512 for count independent
+// password/salt pairs, PBKDF2_SHA512_LANES at a time
+void pbkdf2_hmac_sha512_batch(const uint8_t *const pass[], const int passlen[], const uint8_t *const salt[], const int saltlen[], uint32_t iterations, uint8_t key[][SHA512_DIGEST_LENGTH], size_t count);
+
 #endif
@@ -45,7 +45,9 @@ const ecdsa_curve secp256k1 = {
 
 	/* b */ {
 		/*.val =*/{7}
-	}
+	},
+
+	/* multiply */ bn_multiply_secp256k1
 
 #if USE_PRECOMPUTED_CP
 	,
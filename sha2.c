@@ -51,6 +51,23 @@
  *
  *   #define SHA2_UNROLL_TRANSFORM
  *
+ * MULTI-BUFFER NOTE:
+ * sha256_Raw_x4() and sha256_Raw_x8() hash independent messages of the
+ * same length in lockstep, one message per 32-bit lane of a vector
+ * register.  With GCC or clang vector extensions the 4-way transform
+ * compiles to SSE2 (NEON on ARM), and on x86 an AVX2 8-way transform is
+ * picked at runtime when the CPU supports it.  Other compilers, or
+ * defining SHA2_NO_SIMD, fall back to hashing the messages one by one.
+ * sha512_Transform_x8() does the same for eight SHA-512 blocks, using
+ * AVX-512 or AVX2 when available.
+ *
+ * SHA EXTENSIONS NOTE:
+ * On x86 CPUs with the SHA extensions (SHA-NI), sha1_Transform() and
+ * sha256_Transform() run the compression function with the dedicated
+ * instructions.  The CPU is checked once at runtime, the portable rounds
+ * below remain the fallback.  Define SHA2_NO_SHANI (or SHA2_NO_SIMD) to
+ * always use the portable rounds.
+ *
  */
 
 
@@ -91,6 +108,25 @@ typedef uint8_t  sha2_byte;	/* Exactly 1 byte */
 typedef uint32_t sha2_word32;	/* Exactly 4 bytes */
 typedef uint64_t sha2_word64;	/* Exactly 8 bytes */
 
+#if !defined(SHA2_NO_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define SHA2_MULTI_SIMD 1
+typedef sha2_word32 sha2_word32x4 __attribute__((vector_size(16)));
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA2_MULTI_AVX2 1
+#define SHA2_MULTI_AVX512 1
+#ifndef SHA2_NO_SHANI
+#define SHA2_SHANI 1
+#endif
+typedef sha2_word32 sha2_word32x8 __attribute__((vector_size(32)));
+#endif
+typedef sha2_word64 sha2_word64x8 __attribute__((vector_size(64)));
+#endif
+
+#ifdef SHA2_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 /*** SHA-256/384/512 Various Length Definitions ***********************/
 /* NOTE: Most of these are in sha2.h */
 #define   SHA1_SHORT_BLOCK_LENGTH	(SHA1_BLOCK_LENGTH - 8)
@@ -279,6 +315,121 @@ const sha2_word64 sha512_initial_hash_value[8] = {
 static const char *sha2_hex_digits = "0123456789abcdef";
 
 
+/*** SHA-1 and SHA-256 with x86 SHA extensions: **********************/
+#ifdef SHA2_SHANI
+
+static int sha2_has_shani(void) {
+	static int has_shani = -1;
+	if (has_shani < 0) {
+		unsigned int eax, ebx, ecx, edx;
+		has_shani = 0;
+		if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) &&
+		    (ecx & bit_SSSE3) && (ecx & bit_SSE4_1) &&
+		    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) &&
+		    (ebx & bit_SHA)) {
+			has_shani = 1;
+		}
+	}
+	return has_shani;
+}
+
+/*
+ * Four rounds of SHA-1.  M[] holds the message schedule of the last four
+ * round groups, group i+1..i+3 are prepared while group i is hashed.
+ * The words are in host order already, only the lane order is reversed.
+ */
+#define SHA1_ROUNDS4_NI(i, f) { \
+	if ((i) < 4) \
+		M[i] = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data + 4 * (i))), 0x1B); \
+	if ((i) == 0) \
+		E[0] = _mm_add_epi32(E[0], M[0]); \
+	else \
+		E[(i) & 1] = _mm_sha1nexte_epu32(E[(i) & 1], M[(i) & 3]); \
+	E[((i) + 1) & 1] = ABCD; \
+	if ((i) >= 3 && (i) <= 18) \
+		M[((i) + 1) & 3] = _mm_sha1msg2_epu32(M[((i) + 1) & 3], M[(i) & 3]); \
+	ABCD = _mm_sha1rnds4_epu32(ABCD, E[(i) & 1], f); \
+	if ((i) >= 1 && (i) <= 16) \
+		M[((i) - 1) & 3] = _mm_sha1msg1_epu32(M[((i) - 1) & 3], M[(i) & 3]); \
+	if ((i) >= 2 && (i) <= 17) \
+		M[((i) + 2) & 3] = _mm_xor_si128(M[((i) + 2) & 3], M[(i) & 3]); \
+}
+
+__attribute__((target("sha,sse4.1")))
+static void sha1_Transform_shani(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	__m128i	ABCD, ABCD_SAVE, E_SAVE, E[2], M[4];
+
+	ABCD = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)state_in), 0x1B);
+	E[0] = _mm_set_epi32((int)state_in[4], 0, 0, 0);
+	ABCD_SAVE = ABCD;
+	E_SAVE = E[0];
+
+	SHA1_ROUNDS4_NI( 0, 0); SHA1_ROUNDS4_NI( 1, 0); SHA1_ROUNDS4_NI( 2, 0);
+	SHA1_ROUNDS4_NI( 3, 0); SHA1_ROUNDS4_NI( 4, 0); SHA1_ROUNDS4_NI( 5, 1);
+	SHA1_ROUNDS4_NI( 6, 1); SHA1_ROUNDS4_NI( 7, 1); SHA1_ROUNDS4_NI( 8, 1);
+	SHA1_ROUNDS4_NI( 9, 1); SHA1_ROUNDS4_NI(10, 2); SHA1_ROUNDS4_NI(11, 2);
+	SHA1_ROUNDS4_NI(12, 2); SHA1_ROUNDS4_NI(13, 2); SHA1_ROUNDS4_NI(14, 2);
+	SHA1_ROUNDS4_NI(15, 3); SHA1_ROUNDS4_NI(16, 3); SHA1_ROUNDS4_NI(17, 3);
+	SHA1_ROUNDS4_NI(18, 3); SHA1_ROUNDS4_NI(19, 3);
+
+	/* Compute the current intermediate hash value */
+	E[0] = _mm_sha1nexte_epu32(E[0], E_SAVE);
+	ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+	_mm_storeu_si128((__m128i*)state_out, _mm_shuffle_epi32(ABCD, 0x1B));
+	state_out[4] = (sha2_word32)_mm_extract_epi32(E[0], 3);
+}
+
+/*
+ * Four rounds of SHA-256, the message schedule is kept like in
+ * SHA1_ROUNDS4_NI.  The state is held as ABEF and CDGH.
+ */
+#define SHA256_ROUNDS4_NI(i) { \
+	if ((i) < 4) \
+		M[i] = _mm_loadu_si128((const __m128i*)(data + 4 * (i))); \
+	MSG = _mm_add_epi32(M[(i) & 3], _mm_loadu_si128((const __m128i*)(K256 + 4 * (i)))); \
+	STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, MSG); \
+	if ((i) >= 3 && (i) <= 14) { \
+		TMP = _mm_alignr_epi8(M[(i) & 3], M[((i) - 1) & 3], 4); \
+		M[((i) + 1) & 3] = _mm_add_epi32(M[((i) + 1) & 3], TMP); \
+		M[((i) + 1) & 3] = _mm_sha256msg2_epu32(M[((i) + 1) & 3], M[(i) & 3]); \
+	} \
+	MSG = _mm_shuffle_epi32(MSG, 0x0E); \
+	STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, MSG); \
+	if ((i) >= 1 && (i) <= 12) \
+		M[((i) - 1) & 3] = _mm_sha256msg1_epu32(M[((i) - 1) & 3], M[(i) & 3]); \
+}
+
+__attribute__((target("sha,sse4.1")))
+static void sha256_Transform_shani(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	__m128i	STATE0, STATE1, ABEF_SAVE, CDGH_SAVE, MSG, TMP, M[4];
+
+	TMP = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state_in + 0)), 0xB1);	/* CDAB */
+	STATE1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(state_in + 4)), 0x1B);	/* EFGH */
+	STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);	/* ABEF */
+	STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);	/* CDGH */
+	ABEF_SAVE = STATE0;
+	CDGH_SAVE = STATE1;
+
+	SHA256_ROUNDS4_NI( 0); SHA256_ROUNDS4_NI( 1); SHA256_ROUNDS4_NI( 2); SHA256_ROUNDS4_NI( 3);
+	SHA256_ROUNDS4_NI( 4); SHA256_ROUNDS4_NI( 5); SHA256_ROUNDS4_NI( 6); SHA256_ROUNDS4_NI( 7);
+	SHA256_ROUNDS4_NI( 8); SHA256_ROUNDS4_NI( 9); SHA256_ROUNDS4_NI(10); SHA256_ROUNDS4_NI(11);
+	SHA256_ROUNDS4_NI(12); SHA256_ROUNDS4_NI(13); SHA256_ROUNDS4_NI(14); SHA256_ROUNDS4_NI(15);
+
+	/* Compute the current intermediate hash value */
+	STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+	STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+	TMP = _mm_shuffle_epi32(STATE0, 0x1B);		/* FEBA */
+	STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);	/* DCHG */
+	_mm_storeu_si128((__m128i*)(state_out + 0), _mm_blend_epi16(TMP, STATE1, 0xF0));	/* DCBA */
+	_mm_storeu_si128((__m128i*)(state_out + 4), _mm_alignr_epi8(STATE1, TMP, 8));	/* HGFE */
+}
+
+#else
+
+#define sha2_has_shani() 0
+
+#endif /* SHA2_SHANI */
+
 /*** SHA-1: ***********************************************************/
 void sha1_Init(SHA1_CTX* context) {
 	MEMCPY_BCOPY(context->state, sha1_initial_hash_value, SHA1_DIGEST_LENGTH);
@@ -320,7 +471,7 @@ void sha1_Init(SHA1_CTX* context) {
 	(b) = ROTL32(30, b);	\
 	j++;
 
-void sha1_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha1_Transform_c(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e;
 	sha2_word32	T1;
 	sha2_word32	W1[16];
@@ -438,7 +589,7 @@ void sha1_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_w
 
 #else  /* SHA2_UNROLL_TRANSFORM */
 
-void sha1_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha1_Transform_c(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e;
 	sha2_word32	T1;
 	sha2_word32	W1[16];
@@ -519,6 +670,16 @@ void sha1_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_w
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+void sha1_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+#ifdef SHA2_SHANI
+	if (sha2_has_shani()) {
+		sha1_Transform_shani(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha1_Transform_c(state_in, data, state_out);
+}
+
 void sha1_Update(SHA1_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -698,7 +859,7 @@ void sha256_Init(SHA256_CTX* context) {
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_c(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1;
 	sha2_word32 W256[16];
@@ -755,7 +916,7 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+static void sha256_Transform_c(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, T2, W256[16];
 	int		j;
@@ -826,6 +987,16 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+#ifdef SHA2_SHANI
+	if (sha2_has_shani()) {
+		sha256_Transform_shani(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha256_Transform_c(state_in, data, state_out);
+}
+
 void sha256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -974,6 +1145,153 @@ char* sha256_Data(const sha2_byte* data, size_t len, char digest[SHA256_DIGEST_S
 }
 
 
+/*** SHA-256 multi-buffer: ********************************************/
+#ifdef SHA2_MULTI_SIMD
+
+/*
+ * SHA-256 compression of one block per lane.  state and data are
+ * interleaved: word i of lane l lives at index i * lanes + l.  The round
+ * logic is the rolled sha256_Transform, the logical function macros work
+ * unchanged on vector types.
+ */
+#define SHA256_TRANSFORM_MULTI(name, vec)	\
+static void name(sha2_word32* state, const sha2_word32* data) { \
+	vec	a, b, c, d, e, f, g, h, s0, s1; \
+	vec	T1, T2, W256[16], S[8]; \
+	int	j; \
+	\
+	memcpy(S, state, sizeof(S)); \
+	memcpy(W256, data, sizeof(W256)); \
+	a = S[0]; b = S[1]; c = S[2]; d = S[3]; \
+	e = S[4]; f = S[5]; g = S[6]; h = S[7]; \
+	\
+	for (j = 0; j < 64; j++) { \
+		if (j >= 16) { \
+			s0 = W256[(j+1)&0x0f]; \
+			s0 = sigma0_256(s0); \
+			s1 = W256[(j+14)&0x0f]; \
+			s1 = sigma1_256(s1); \
+			W256[j&0x0f] += s1 + W256[(j+9)&0x0f] + s0; \
+		} \
+		T1 = h + Sigma1_256(e) + Ch(e, f, g) + K256[j] + W256[j&0x0f]; \
+		T2 = Sigma0_256(a) + Maj(a, b, c); \
+		h = g; \
+		g = f; \
+		f = e; \
+		e = d + T1; \
+		d = c; \
+		c = b; \
+		b = a; \
+		a = T1 + T2; \
+	} \
+	\
+	S[0] += a; S[1] += b; S[2] += c; S[3] += d; \
+	S[4] += e; S[5] += f; S[6] += g; S[7] += h; \
+	memcpy(state, S, sizeof(S)); \
+}
+
+SHA256_TRANSFORM_MULTI(sha256_Transform_x4, sha2_word32x4)
+
+#ifdef SHA2_MULTI_AVX2
+__attribute__((target("avx2")))
+SHA256_TRANSFORM_MULTI(sha256_Transform_x8_avx2, sha2_word32x8)
+
+static int sha2_has_avx2(void) {
+	static int has_avx2 = -1;
+	if (has_avx2 < 0) {
+		__builtin_cpu_init();
+		has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return has_avx2;
+}
+#endif
+
+static sha2_word32 sha256_load_be32(const sha2_byte* p) {
+	return ((sha2_word32)p[0] << 24) | ((sha2_word32)p[1] << 16) |
+	       ((sha2_word32)p[2] <<  8) |  (sha2_word32)p[3];
+}
+
+/*
+ * Pads every message into its own tail blocks and feeds one block of
+ * each lane to transform at a time.  All messages have the same length,
+ * so every lane needs the same number of blocks.
+ */
+static void sha256_Raw_multi(const sha2_byte* const data[], size_t len, uint8_t digest[][SHA256_DIGEST_LENGTH], int lanes, void (*transform)(sha2_word32*, const sha2_word32*)) {
+	sha2_word32	state[8 * 8], W256[16 * 8];
+	sha2_byte	tail[8][2 * SHA256_BLOCK_LENGTH];
+	size_t		full = len / SHA256_BLOCK_LENGTH;
+	size_t		rest = len % SHA256_BLOCK_LENGTH;
+	size_t		blocks = full + (rest < SHA256_SHORT_BLOCK_LENGTH ? 1 : 2);
+	sha2_word64	bitcount = (sha2_word64)len << 3;
+	size_t		i, k;
+	int		l, j;
+
+	memzero(tail, sizeof(tail));
+	for (l = 0; l < lanes; l++) {
+		sha2_byte* end = tail[l] + (blocks - full) * SHA256_BLOCK_LENGTH;
+		memcpy(tail[l], data[l] + full * SHA256_BLOCK_LENGTH, rest);
+		tail[l][rest] = 0x80;
+		for (j = 1; j <= 8; j++) {
+			end[-j] = (sha2_byte)(bitcount >> (8 * (j - 1)));
+		}
+		for (j = 0; j < 8; j++) {
+			state[j * lanes + l] = sha256_initial_hash_value[j];
+		}
+	}
+
+	for (i = 0; i < blocks; i++) {
+		for (l = 0; l < lanes; l++) {
+			const sha2_byte* block = (i < full) ?
+				data[l] + i * SHA256_BLOCK_LENGTH :
+				tail[l] + (i - full) * SHA256_BLOCK_LENGTH;
+			for (k = 0; k < 16; k++) {
+				W256[k * lanes + l] = sha256_load_be32(block + 4 * k);
+			}
+		}
+		transform(state, W256);
+	}
+
+	for (l = 0; l < lanes; l++) {
+		for (j = 0; j < 8; j++) {
+			sha2_word32 w = state[j * lanes + l];
+			digest[l][4 * j + 0] = (sha2_byte)(w >> 24);
+			digest[l][4 * j + 1] = (sha2_byte)(w >> 16);
+			digest[l][4 * j + 2] = (sha2_byte)(w >>  8);
+			digest[l][4 * j + 3] = (sha2_byte)(w      );
+		}
+	}
+
+	memzero(tail, sizeof(tail));
+	memzero(W256, sizeof(W256));
+	memzero(state, sizeof(state));
+}
+
+#endif /* SHA2_MULTI_SIMD */
+
+void sha256_Raw_x4(const sha2_byte* const data[4], size_t len, uint8_t digest[4][SHA256_DIGEST_LENGTH]) {
+#ifdef SHA2_MULTI_SIMD
+	/* one SHA-NI stream beats four vector lanes */
+	if (!sha2_has_shani()) {
+		sha256_Raw_multi(data, len, digest, 4, sha256_Transform_x4);
+		return;
+	}
+#endif
+	for (int l = 0; l < 4; l++) {
+		sha256_Raw(data[l], len, digest[l]);
+	}
+}
+
+void sha256_Raw_x8(const sha2_byte* const data[8], size_t len, uint8_t digest[8][SHA256_DIGEST_LENGTH]) {
+#ifdef SHA2_MULTI_AVX2
+	if (!sha2_has_shani() && sha2_has_avx2()) {
+		sha256_Raw_multi(data, len, digest, 8, sha256_Transform_x8_avx2);
+		return;
+	}
+#endif
+	sha256_Raw_x4(data, len, digest);
+	sha256_Raw_x4(data + 4, len, digest + 4);
+}
+
 /*** SHA-512: *********************************************************/
 void sha512_Init(SHA512_CTX* context) {
 	if (context == (SHA512_CTX*)0) {
@@ -1281,3 +1599,102 @@ char* sha512_Data(const sha2_byte* data, size_t len, char digest[SHA512_DIGEST_S
 	sha512_Update(&context, data, len);
 	return sha512_End(&context, digest);
 }
+
+/*** SHA-512 multi-buffer: ********************************************/
+#ifdef SHA2_MULTI_SIMD
+
+/*
+ * SHA-512 compression of one block per lane, laid out like
+ * SHA256_TRANSFORM_MULTI.  state_out may alias state_in or data.
+ */
+#define SHA512_TRANSFORM_MULTI(name, vec)	\
+static void name(const sha2_word64* state_in, const sha2_word64* data, sha2_word64* state_out) { \
+	vec	a, b, c, d, e, f, g, h, s0, s1; \
+	vec	T1, T2, W512[16], S[8]; \
+	int	j; \
+	\
+	memcpy(S, state_in, sizeof(S)); \
+	memcpy(W512, data, sizeof(W512)); \
+	a = S[0]; b = S[1]; c = S[2]; d = S[3]; \
+	e = S[4]; f = S[5]; g = S[6]; h = S[7]; \
+	\
+	for (j = 0; j < 80; j++) { \
+		if (j >= 16) { \
+			s0 = W512[(j+1)&0x0f]; \
+			s0 = sigma0_512(s0); \
+			s1 = W512[(j+14)&0x0f]; \
+			s1 = sigma1_512(s1); \
+			W512[j&0x0f] += s1 + W512[(j+9)&0x0f] + s0; \
+		} \
+		T1 = h + Sigma1_512(e) + Ch(e, f, g) + K512[j] + W512[j&0x0f]; \
+		T2 = Sigma0_512(a) + Maj(a, b, c); \
+		h = g; \
+		g = f; \
+		f = e; \
+		e = d + T1; \
+		d = c; \
+		c = b; \
+		b = a; \
+		a = T1 + T2; \
+	} \
+	\
+	S[0] += a; S[1] += b; S[2] += c; S[3] += d; \
+	S[4] += e; S[5] += f; S[6] += g; S[7] += h; \
+	memcpy(state_out, S, sizeof(S)); \
+}
+
+SHA512_TRANSFORM_MULTI(sha512_Transform_x8_vec, sha2_word64x8)
+
+#ifdef SHA2_MULTI_AVX512
+/* without AVX-512 the 512-bit vectors are split into AVX2 halves */
+__attribute__((target("avx2")))
+SHA512_TRANSFORM_MULTI(sha512_Transform_x8_avx2, sha2_word64x8)
+
+__attribute__((target("avx512f")))
+SHA512_TRANSFORM_MULTI(sha512_Transform_x8_avx512, sha2_word64x8)
+
+static int sha2_has_avx512f(void) {
+	static int has_avx512f = -1;
+	if (has_avx512f < 0) {
+		__builtin_cpu_init();
+		has_avx512f = __builtin_cpu_supports("avx512f") ? 1 : 0;
+	}
+	return has_avx512f;
+}
+#endif
+
+#endif /* SHA2_MULTI_SIMD */
+
+void sha512_Transform_x8(const sha2_word64* state_in, const sha2_word64* data, sha2_word64* state_out) {
+#ifdef SHA2_MULTI_SIMD
+#ifdef SHA2_MULTI_AVX512
+	if (sha2_has_avx512f()) {
+		sha512_Transform_x8_avx512(state_in, data, state_out);
+		return;
+	}
+	if (sha2_has_avx2()) {
+		sha512_Transform_x8_avx2(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha512_Transform_x8_vec(state_in, data, state_out);
+#else
+	sha2_word64	S[8], W512[16];
+	int		l, j;
+
+	for (l = 0; l < 8; l++) {
+		for (j = 0; j < 16; j++) {
+			W512[j] = data[j * 8 + l];
+		}
+		for (j = 0; j < 8; j++) {
+			S[j] = state_in[j * 8 + l];
+		}
+		sha512_Transform(S, W512, S);
+		for (j = 0; j < 8; j++) {
+			state_out[j * 8 + l] = S[j];
+		}
+	}
+	memzero(W512, sizeof(W512));
+	memzero(S, sizeof(S));
+#endif
+}
@@ -104,8 +104,14 @@ void sha256_Final(SHA256_CTX*, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_End(SHA256_CTX*, char[SHA256_DIGEST_STRING_LENGTH]);
 void sha256_Raw(const uint8_t*, size_t, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_Data(const uint8_t*, size_t, char[SHA256_DIGEST_STRING_LENGTH]);
+// hash 4 (8) independent messages of the same length len in parallel
+void sha256_Raw_x4(const uint8_t* const data[4], size_t len, uint8_t digest[4][SHA256_DIGEST_LENGTH]);
+void sha256_Raw_x8(const uint8_t* const data[8], size_t len, uint8_t digest[8][SHA256_DIGEST_LENGTH]);
 
 void sha512_Transform(const uint64_t* state_in, const uint64_t* data, uint64_t* state_out);
+// sha512_Transform of 8 independent blocks, state and data are interleaved:
+// word i of lane l is at index i * 8 + l
+void sha512_Transform_x8(const uint64_t* state_in, const uint64_t* data, uint64_t* state_out);
 void sha512_Init(SHA512_CTX*);
 void sha512_Update(SHA512_CTX*, const uint8_t*, size_t);
 void sha512_Final(SHA512_CTX*, uint8_t[SHA512_DIGEST_LENGTH]);
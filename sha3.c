@@ -32,6 +32,22 @@
 /* constants */
 #define NumberOfRounds 24
 
+/*
+ * With GCC or clang vector extensions keccak_256_x4() runs four
+ * permutations in the 64-bit lanes of a vector, on x86 with AVX2 or
+ * AVX-512VL when the CPU has them.  Define SHA3_NO_SIMD to hash the inputs
+ * one by one and to skip the runtime CPU checks.
+ */
+#if !defined(SHA3_NO_SIMD) && (defined(__GNUC__) || defined(__clang__))
+#define SHA3_SIMD 1
+#if defined(__x86_64__) || defined(__i386__)
+#define SHA3_X86 1
+#define SHA3_CPU_BMI 0
+#define SHA3_CPU_AVX2 1
+#define SHA3_CPU_AVX512 2
+#endif
+#endif
+
 /* SHA3 (Keccak) constants for 24 rounds */
 static uint64_t keccak_round_constants[NumberOfRounds] = {
 	I64(0x0000000000000001), I64(0x0000000000008082), I64(0x800000000000808A), I64(0x8000000080008000),
@@ -93,117 +109,154 @@ void sha3_512_Init(SHA3_CTX *ctx)
 	keccak_Init(ctx, 512);
 }
 
-/* Keccak theta() transformation */
-static void keccak_theta(uint64_t *A)
-{
-	unsigned int x;
-	uint64_t C[5], D[5];
-
-	for (x = 0; x < 5; x++) {
-		C[x] = A[x] ^ A[x + 5] ^ A[x + 10] ^ A[x + 15] ^ A[x + 20];
-	}
-	D[0] = ROTL64(C[1], 1) ^ C[4];
-	D[1] = ROTL64(C[2], 1) ^ C[0];
-	D[2] = ROTL64(C[3], 1) ^ C[1];
-	D[3] = ROTL64(C[4], 1) ^ C[2];
-	D[4] = ROTL64(C[0], 1) ^ C[3];
-
-	for (x = 0; x < 5; x++) {
-		A[x]      ^= D[x];
-		A[x + 5]  ^= D[x];
-		A[x + 10] ^= D[x];
-		A[x + 15] ^= D[x];
-		A[x + 20] ^= D[x];
-	}
+/*
+ * The permutation keeps the 25 lanes in local variables named after their
+ * position, e.g. Ake is x = 1 ("e") in row y = 2 ("k"), and runs two rounds
+ * per iteration from A to E and back.  theta, rho and pi are merged so
+ * every lane is loaded and rotated once per round, and chi is written as
+ * x ^ (~y & z), which compiles to a single ANDN where the CPU has one
+ * (BMI on x86, BIC on ARM).  The same round is instantiated for vectors of
+ * independent states, see keccak_256_x4().
+ */
+#define KECCAK_ROL(T, x, n) ((T)((x) << (n)) ^ (T)((x) >> (64 - (n))))
+
+/* theta and rho of lane l, moved to its place in B by pi */
+#define KECCAK_TR(T, A, l, d, n) KECCAK_ROL(T, A##l ^ D##d, n)
+
+/* chi of one plane, from B0..B4 to lanes a..u of row r in E */
+#define KECCAK_CHI(E, r) \
+	E##r##a = B0 ^ (~B1 & B2); \
+	E##r##e = B1 ^ (~B2 & B3); \
+	E##r##i = B2 ^ (~B3 & B4); \
+	E##r##o = B3 ^ (~B4 & B0); \
+	E##r##u = B4 ^ (~B0 & B1);
+
+#define KECCAK_ROUND(T, A, E, rc) \
+	Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+	Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+	Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+	Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+	Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+	Da = Cu ^ KECCAK_ROL(T, Ce, 1); \
+	De = Ca ^ KECCAK_ROL(T, Ci, 1); \
+	Di = Ce ^ KECCAK_ROL(T, Co, 1); \
+	Do = Ci ^ KECCAK_ROL(T, Cu, 1); \
+	Du = Co ^ KECCAK_ROL(T, Ca, 1); \
+	B0 = A##ba ^ Da; \
+	B1 = KECCAK_TR(T, A, ge, e, 44); \
+	B2 = KECCAK_TR(T, A, ki, i, 43); \
+	B3 = KECCAK_TR(T, A, mo, o, 21); \
+	B4 = KECCAK_TR(T, A, su, u, 14); \
+	KECCAK_CHI(E, b) \
+	E##ba ^= (rc); \
+	B0 = KECCAK_TR(T, A, bo, o, 28); \
+	B1 = KECCAK_TR(T, A, gu, u, 20); \
+	B2 = KECCAK_TR(T, A, ka, a,  3); \
+	B3 = KECCAK_TR(T, A, me, e, 45); \
+	B4 = KECCAK_TR(T, A, si, i, 61); \
+	KECCAK_CHI(E, g) \
+	B0 = KECCAK_TR(T, A, be, e,  1); \
+	B1 = KECCAK_TR(T, A, gi, i,  6); \
+	B2 = KECCAK_TR(T, A, ko, o, 25); \
+	B3 = KECCAK_TR(T, A, mu, u,  8); \
+	B4 = KECCAK_TR(T, A, sa, a, 18); \
+	KECCAK_CHI(E, k) \
+	B0 = KECCAK_TR(T, A, bu, u, 27); \
+	B1 = KECCAK_TR(T, A, ga, a, 36); \
+	B2 = KECCAK_TR(T, A, ke, e, 10); \
+	B3 = KECCAK_TR(T, A, mi, i, 15); \
+	B4 = KECCAK_TR(T, A, so, o, 56); \
+	KECCAK_CHI(E, m) \
+	B0 = KECCAK_TR(T, A, bi, i, 62); \
+	B1 = KECCAK_TR(T, A, go, o, 55); \
+	B2 = KECCAK_TR(T, A, ku, u, 39); \
+	B3 = KECCAK_TR(T, A, ma, a, 41); \
+	B4 = KECCAK_TR(T, A, se, e,  2); \
+	KECCAK_CHI(E, s)
+
+#define KECCAK_LANES(X) \
+	X(ba,  0) X(be,  1) X(bi,  2) X(bo,  3) X(bu,  4) \
+	X(ga,  5) X(ge,  6) X(gi,  7) X(go,  8) X(gu,  9) \
+	X(ka, 10) X(ke, 11) X(ki, 12) X(ko, 13) X(ku, 14) \
+	X(ma, 15) X(me, 16) X(mi, 17) X(mo, 18) X(mu, 19) \
+	X(sa, 20) X(se, 21) X(si, 22) X(so, 23) X(su, 24)
+
+/* permutation of the state[25] of element type T, RC(i) is round constant i */
+#define KECCAK_PERMUTATION(name, T, RC) \
+static void name(T *state) \
+{ \
+	T Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku; \
+	T Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu; \
+	T Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku; \
+	T Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu; \
+	T B0, B1, B2, B3, B4, Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du; \
+	int round; \
+	KECCAK_LANES(KECCAK_LOAD) \
+	for (round = 0; round < NumberOfRounds; round += 2) { \
+		KECCAK_ROUND(T, A, E, RC(round)) \
+		KECCAK_ROUND(T, E, A, RC(round + 1)) \
+	} \
+	KECCAK_LANES(KECCAK_STORE) \
 }
 
-/* Keccak pi() transformation */
-static void keccak_pi(uint64_t *A)
-{
-	uint64_t A1;
-	A1 = A[1];
-	A[ 1] = A[ 6];
-	A[ 6] = A[ 9];
-	A[ 9] = A[22];
-	A[22] = A[14];
-	A[14] = A[20];
-	A[20] = A[ 2];
-	A[ 2] = A[12];
-	A[12] = A[13];
-	A[13] = A[19];
-	A[19] = A[23];
-	A[23] = A[15];
-	A[15] = A[ 4];
-	A[ 4] = A[24];
-	A[24] = A[21];
-	A[21] = A[ 8];
-	A[ 8] = A[16];
-	A[16] = A[ 5];
-	A[ 5] = A[ 3];
-	A[ 3] = A[18];
-	A[18] = A[17];
-	A[17] = A[11];
-	A[11] = A[ 7];
-	A[ 7] = A[10];
-	A[10] = A1;
-	/* note: A[ 0] is left as is */
-}
+#define KECCAK_LOAD(l, i) A##l = state[i];
+#define KECCAK_STORE(l, i) state[i] = A##l;
 
-/* Keccak chi() transformation */
-static void keccak_chi(uint64_t *A)
+#define KECCAK_RC(i) keccak_round_constants[i]
+
+KECCAK_PERMUTATION(sha3_permutation_c, uint64_t, KECCAK_RC)
+
+#ifdef SHA3_X86
+__attribute__((target("bmi")))
+KECCAK_PERMUTATION(sha3_permutation_bmi, uint64_t, KECCAK_RC)
+
+static int sha3_has_cpu(int feature)
 {
-	int i;
-	for (i = 0; i < 25; i += 5) {
-		uint64_t A0 = A[0 + i], A1 = A[1 + i];
-		A[0 + i] ^= ~A1 & A[2 + i];
-		A[1 + i] ^= ~A[2 + i] & A[3 + i];
-		A[2 + i] ^= ~A[3 + i] & A[4 + i];
-		A[3 + i] ^= ~A[4 + i] & A0;
-		A[4 + i] ^= ~A0 & A1;
+	static int has[3] = {-1, -1, -1};
+	if (has[feature] < 0) {
+		__builtin_cpu_init();
+		switch (feature) {
+		case SHA3_CPU_BMI:
+			has[feature] = __builtin_cpu_supports("bmi") ? 1 : 0;
+			break;
+		case SHA3_CPU_AVX2:
+			has[feature] = __builtin_cpu_supports("avx2") ? 1 : 0;
+			break;
+		case SHA3_CPU_AVX512:
+			has[feature] = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") ? 1 : 0;
+			break;
+		}
 	}
+	return has[feature];
 }
+#endif
 
 static void sha3_permutation(uint64_t *state)
 {
-	int round;
-	for (round = 0; round < NumberOfRounds; round++)
-	{
-		keccak_theta(state);
-
-		/* apply Keccak rho() transformation */
-		state[ 1] = ROTL64(state[ 1],  1);
-		state[ 2] = ROTL64(state[ 2], 62);
-		state[ 3] = ROTL64(state[ 3], 28);
-		state[ 4] = ROTL64(state[ 4], 27);
-		state[ 5] = ROTL64(state[ 5], 36);
-		state[ 6] = ROTL64(state[ 6], 44);
-		state[ 7] = ROTL64(state[ 7],  6);
-		state[ 8] = ROTL64(state[ 8], 55);
-		state[ 9] = ROTL64(state[ 9], 20);
-		state[10] = ROTL64(state[10],  3);
-		state[11] = ROTL64(state[11], 10);
-		state[12] = ROTL64(state[12], 43);
-		state[13] = ROTL64(state[13], 25);
-		state[14] = ROTL64(state[14], 39);
-		state[15] = ROTL64(state[15], 41);
-		state[16] = ROTL64(state[16], 45);
-		state[17] = ROTL64(state[17], 15);
-		state[18] = ROTL64(state[18], 21);
-		state[19] = ROTL64(state[19],  8);
-		state[20] = ROTL64(state[20], 18);
-		state[21] = ROTL64(state[21],  2);
-		state[22] = ROTL64(state[22], 61);
-		state[23] = ROTL64(state[23], 56);
-		state[24] = ROTL64(state[24], 14);
-
-		keccak_pi(state);
-		keccak_chi(state);
-
-		/* apply iota(state, round) */
-		*state ^= keccak_round_constants[round];
+#ifdef SHA3_X86
+	if (sha3_has_cpu(SHA3_CPU_BMI)) {
+		sha3_permutation_bmi(state);
+		return;
 	}
+#endif
+	sha3_permutation_c(state);
 }
 
+#if USE_KECCAK && defined(SHA3_SIMD)
+typedef uint64_t sha3_word64x4 __attribute__((vector_size(32)));
+
+KECCAK_PERMUTATION(sha3_permutation_x4_vec, sha3_word64x4, KECCAK_RC)
+
+#ifdef SHA3_X86
+__attribute__((target("avx2")))
+KECCAK_PERMUTATION(sha3_permutation_x4_avx2, sha3_word64x4, KECCAK_RC)
+
+/* AVX-512VL adds 256-bit rotates and three-input logic for chi */
+__attribute__((target("avx512f,avx512vl")))
+KECCAK_PERMUTATION(sha3_permutation_x4_avx512, sha3_word64x4, KECCAK_RC)
+#endif
+#endif
+
 /**
  * The core transformation. Process the specified block of data.
  *
@@ -378,6 +431,66 @@ void keccak_512(const unsigned char* data, size_t len, unsigned char* digest)
 	keccak_Update(&ctx, data, len);
 	keccak_Final(&ctx, digest);
 }
+
+#ifdef SHA3_SIMD
+/* absorb four messages of length len in lockstep and squeeze their digests */
+static void keccak_Raw_x4(void (*permutation)(sha3_word64x4 *), const unsigned char *const data[4], size_t len, unsigned char digest[4][sha3_256_hash_size], size_t block_size)
+{
+	sha3_word64x4 state[sha3_max_permutation_size];
+	uint64_t block[4][sha3_max_rate_in_qwords];
+	size_t offset, rest, i, l;
+
+	memset(state, 0, sizeof(state));
+	for (offset = 0; ; offset += block_size) {
+		rest = len - offset;
+		for (l = 0; l < 4; l++) {
+			if (rest >= block_size) {
+				memcpy(block[l], data[l] + offset, block_size);
+			} else {
+				/* final block with keccak padding */
+				memset(block[l], 0, block_size);
+				memcpy(block[l], data[l] + offset, rest);
+				((unsigned char*)block[l])[rest] |= 0x01;
+				((unsigned char*)block[l])[block_size - 1] |= 0x80;
+			}
+		}
+		for (i = 0; i < block_size / 8; i++) {
+			state[i] ^= (sha3_word64x4){le2me_64(block[0][i]), le2me_64(block[1][i]), le2me_64(block[2][i]), le2me_64(block[3][i])};
+		}
+		permutation(state);
+		if (rest < block_size) {
+			break;
+		}
+	}
+	for (l = 0; l < 4; l++) {
+		for (i = 0; i < sha3_256_hash_size / 8; i++) {
+			uint64_t w = state[i][l];
+			me64_to_le_str(digest[l] + 8 * i, &w, 8);
+		}
+	}
+	memzero(state, sizeof(state));
+	memzero(block, sizeof(block));
+}
+#endif
+
+void keccak_256_x4(const unsigned char *const data[4], size_t len, unsigned char digest[4][sha3_256_hash_size])
+{
+#ifdef SHA3_SIMD
+	void (*permutation)(sha3_word64x4 *) = sha3_permutation_x4_vec;
+#ifdef SHA3_X86
+	if (sha3_has_cpu(SHA3_CPU_AVX512)) {
+		permutation = sha3_permutation_x4_avx512;
+	} else if (sha3_has_cpu(SHA3_CPU_AVX2)) {
+		permutation = sha3_permutation_x4_avx2;
+	}
+#endif
+	keccak_Raw_x4(permutation, data, len, digest, SHA3_256_BLOCK_LENGTH);
+#else
+	for (int l = 0; l < 4; l++) {
+		keccak_256(data[l], len, digest[l]);
+	}
+#endif
+}
 #endif /* USE_KECCAK */
 
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest)
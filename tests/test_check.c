@@ -27,6 +27,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#if USE_REENTRANT
+#include <pthread.h>
+#endif
 
 #include <check.h>
 #include "check_mem.h"
@@ -39,6 +42,7 @@
 #include "options.h"
 
 #include "aes/aes.h"
+#include "aes/aes_gcm.h"
 #include "bignum.h"
 #include "base32.h"
 #include "base58.h"
@@ -58,10 +62,12 @@
 #include "ed25519-donna/ed25519.h"
 #include "ed25519-donna/ed25519-donna.h"
 #include "ed25519-donna/ed25519-keccak.h"
+#include "ed25519-donna/ed25519-sha3.h"
 #include "script.h"
 #include "rfc6979.h"
 #include "address.h"
 #include "rc4.h"
+#include "chacha20poly1305/rfc7539.h"
 #include "nem.h"
 #include "monero/monero.h"
 
@@ -769,6 +775,113 @@ START_TEST(test_base58)
 }
 END_TEST
 
+// byte by byte long division, the textbook encoder
+static void test_base58_reference(char *b58, const uint8_t *bin, size_t binsz)
+{
+	uint8_t buf[256] = {0};
+	size_t size = binsz * 138 / 100 + 1, zcount = 0, i, j;
+	int carry;
+
+	while (zcount < binsz && !bin[zcount]) zcount++;
+	for (i = zcount; i < binsz; i++) {
+		for (carry = bin[i], j = size; j--; ) {
+			carry += 256 * buf[j];
+			buf[j] = carry % 58;
+			carry /= 58;
+		}
+	}
+	for (j = 0; j < size && !buf[j]; j++);
+	memset(b58, '1', zcount);
+	for (i = zcount; j < size; i++, j++) b58[i] = b58digits_ordered[buf[j]];
+	b58[i] = 0;
+}
+
+START_TEST(test_base58_raw)
+{
+	uint8_t data[160], out[160];
+	char expected[240], str[240];
+	size_t len, zeros, sz;
+
+	for (len = 0; len <= sizeof(data); len++) {
+		for (zeros = 0; zeros <= 2 && zeros <= len; zeros++) {
+			sha256_Raw((const uint8_t *)&len, sizeof(len), data);
+			for (size_t i = 0; i < len; i++) {
+				data[i] = i < zeros ? 0 : data[i % 32] ^ (i * 0x9d);
+			}
+			test_base58_reference(expected, data, len);
+
+			sz = sizeof(str);
+			ck_assert_int_eq(b58enc(str, &sz, data, len), true);
+			ck_assert_str_eq(str, expected);
+			ck_assert_int_eq(sz, strlen(expected) + 1);
+
+			// the required size is reported when the buffer is too small
+			sz = strlen(expected);
+			ck_assert_int_eq(b58enc(str, &sz, data, len), false);
+			ck_assert_int_eq(sz, strlen(expected) + 1);
+
+			sz = len;
+			ck_assert_int_eq(b58tobin(out, &sz, expected), true);
+			ck_assert_int_eq(sz, len);
+			ck_assert_mem_eq(out, data, len);
+
+			// a value with a leading nonzero byte does not fit a byte less
+			if (zeros == 0 && len > 0) {
+				sz = len - 1;
+				ck_assert_int_eq(b58tobin(out, &sz, expected), false);
+			}
+		}
+	}
+
+	// invalid digits
+	sz = sizeof(out);
+	ck_assert_int_eq(b58tobin(out, &sz, "11I1"), false);
+	sz = sizeof(out);
+	ck_assert_int_eq(b58tobin(out, &sz, "2NEpo7TZRRrLZSi2U\xff"), false);
+	sz = 4;
+	ck_assert_int_eq(b58tobin(out, &sz, "7YXq9G"), true);
+	ck_assert_int_eq(sz, 4);
+	ck_assert_mem_eq(out, fromhex("ffffffff"), 4);
+	sz = 4;
+	ck_assert_int_eq(b58tobin(out, &sz, "7YXq9H"), false);
+}
+END_TEST
+
+START_TEST(test_base58_batch)
+{
+	static const HasherType hashers[] = {HASHER_SHA2D, HASHER_SHA2, HASHER_GROESTLD_TRUNC};
+	uint8_t data[11][34];
+	char str[11][56], expected[56];
+	size_t h, i;
+	int r;
+
+	for (i = 0; i < 11; i++) {
+		sha256_Raw((const uint8_t *)&i, sizeof(i), data[i]);
+		sha256_Raw(data[i], 32, data[i] + 2);
+		data[i][0] = 0x80;
+	}
+	// zero bytes take one digit instead of about 1.37, this makes the string
+	// of payload 3 the shortest one
+	memset(data[3], 0, 8);
+	for (h = 0; h < sizeof(hashers) / sizeof(*hashers); h++) {
+		ck_assert_int_eq(base58_encode_check_batch(data[0], 34, 11, hashers[h], str[0], sizeof(str[0])), 11);
+		for (i = 0; i < 11; i++) {
+			r = base58_encode_check(data[i], 34, hashers[h], expected, sizeof(expected));
+			ck_assert_int_eq((size_t)r, strlen(expected) + 1);
+			ck_assert_str_eq(str[i], expected);
+		}
+	}
+
+	// only payload 3 fits
+	r = base58_encode_check(data[3], 34, HASHER_SHA2D, expected, sizeof(expected));
+	ck_assert_int_eq(base58_encode_check_batch(data[0], 34, 11, HASHER_SHA2D, str[0], r), 1);
+	ck_assert_str_eq(str[0] + 3 * r, expected);
+	ck_assert_str_eq(str[0] + 4 * r, "");
+	ck_assert_int_eq(base58_encode_check_batch(data[0], 34, 11, HASHER_SHA2D, str[0], r - 1), 0);
+	ck_assert_int_eq(base58_encode_check_batch(data[0], 34, 0, HASHER_SHA2D, str[0], sizeof(str[0])), 0);
+}
+END_TEST
+
 #if USE_GRAPHENE
 
 // Graphene Base85CheckEncoding
@@ -835,6 +948,57 @@ START_TEST(test_bignum_divmod)
 }
 END_TEST
 
+static void test_bignum_multiply_curve(const ecdsa_curve *curve)
+{
+	bignum256 a, b, x, y;
+	int i, j;
+
+	for (i = 0; i < 1000; i++) {
+		// inputs may be as large as 179 * prime
+		for (j = 0; j < 8; j++) {
+			a.val[j] = random32() & 0x3FFFFFFF;
+			b.val[j] = random32() & 0x3FFFFFFF;
+		}
+		a.val[8] = random32() % (179 * 0x10000);
+		b.val[8] = random32() % (179 * 0x10000);
+		if (i < 4) {
+			// edge cases: prime - 1 and 179 * 2^256 - 1
+			bn_copy(&curve->prime, &a);
+			a.val[0] -= 1;
+			if (i & 1) {
+				for (j = 0; j < 8; j++) {
+					a.val[j] = 0x3FFFFFFF;
+				}
+				a.val[8] = 179 * 0x10000 - 1;
+			}
+			if (i & 2) {
+				b = a;
+			}
+		}
+		x = b;
+		bn_multiply(&a, &x, &curve->prime);
+		y = b;
+		curve->multiply(&a, &y, &curve->prime);
+		bn_mod(&x, &curve->prime);
+		bn_mod(&y, &curve->prime);
+		// y was partly reduced iff bn_mod fully reduced it
+		ck_assert_int_eq(bn_is_less(&y, &curve->prime), 1);
+		ck_assert_int_eq(bn_is_equal(&x, &y), 1);
+	}
+}
+
+START_TEST(test_bignum_multiply_secp256k1)
+{
+	test_bignum_multiply_curve(&secp256k1);
+}
+END_TEST
+
+START_TEST(test_bignum_multiply_nist256p1)
+{
+	test_bignum_multiply_curve(&nist256p1);
+}
+END_TEST
+
 // test vector 1 from https://github.com/bitcoin/bips/blob/master/bip-0032.mediawiki#test-vector-1
 START_TEST(test_bip32_vector_1)
 {
@@ -1218,6 +1382,57 @@ START_TEST(test_bip32_optimized)
 }
 END_TEST
 
+START_TEST(test_bip32_batch)
+{
+	HDNode root, node;
+	uint8_t public_keys[40 * 33];
+
+	hdnode_from_seed((uint8_t *)"NothingToSeeHere", 16, SECP256K1_NAME, &root);
+	hdnode_fill_public_key(&root);
+
+	// 40 keys span several normalization batches
+	ck_assert_int_eq(hdnode_public_ckd_batch(&root, 1000, 40, public_keys), 1);
+	for (int i = 0; i < 40; i++) {
+		memcpy(&node, &root, sizeof(HDNode));
+		hdnode_public_ckd(&node, 1000 + i);
+		ck_assert_mem_eq(node.public_key, public_keys + 33 * i, 33);
+	}
+
+	// hardened indices cannot be derived from the public key
+	ck_assert_int_eq(hdnode_public_ckd_batch(&root, 0x7ffffffe, 3, public_keys), 0);
+	ck_assert_int_eq(hdnode_public_ckd_batch(&root, 0x80000000, 1, public_keys), 0);
+}
+END_TEST
+
+START_TEST(test_bip32_range)
+{
+	HDNode root, node;
+	HDNodePublicRange range;
+	uint8_t public_key[33], chain_code[32];
+	uint32_t i, n = 0;
+
+	hdnode_from_seed((uint8_t *)"NothingToSeeHere", 16, SECP256K1_NAME, &root);
+	hdnode_fill_public_key(&root);
+
+	ck_assert_int_eq(hdnode_public_ckd_range_begin(&range, &root, 5, 42), 1);
+	while (hdnode_public_ckd_range_next(&range, &i, public_key, chain_code)) {
+		ck_assert_int_eq(i, 5 + n);
+		memcpy(&node, &root, sizeof(HDNode));
+		hdnode_public_ckd(&node, i);
+		ck_assert_mem_eq(node.public_key, public_key, 33);
+		ck_assert_mem_eq(node.chain_code, chain_code, 32);
+		n++;
+	}
+	ck_assert_int_eq(n, 37);
+	hdnode_public_ckd_range_end(&range);
+
+	// empty and hardened ranges
+	ck_assert_int_eq(hdnode_public_ckd_range_begin(&range, &root, 7, 7), 1);
+	ck_assert_int_eq(hdnode_public_ckd_range_next(&range, &i, public_key, NULL), 0);
+	ck_assert_int_eq(hdnode_public_ckd_range_begin(&range, &root, 0x7fffffff, 0x80000001), 0);
+}
+END_TEST
+
 START_TEST(test_bip32_cache_1)
 {
 	HDNode node1, node2;
@@ -1290,6 +1505,127 @@ START_TEST(test_bip32_cache_2)
 }
 END_TEST
 
+// derive m/44'/0'/account'/0/index from the root of wallet and compare to the
+// uncached derivation
+static int test_bip32_cache_derive(BIP32Cache *cache, uint8_t wallet, uint32_t account, uint32_t index)
+{
+	HDNode node1, node2;
+	uint8_t seed[32] = {wallet};
+	uint32_t ii[] = {0x8000002c, 0x80000000, 0x80000000 | account, 0, index};
+	int i;
+
+	hdnode_from_seed(seed, sizeof(seed), SECP256K1_NAME, &node1);
+	hdnode_from_seed(seed, sizeof(seed), SECP256K1_NAME, &node2);
+	for (i = 0; i < 5; i++) {
+		hdnode_private_ckd(&node1, ii[i]);
+	}
+	hdnode_private_ckd_cached_ctx(cache, &node2, ii, 5, NULL);
+	return memcmp(&node1, &node2, sizeof(HDNode)) == 0;
+}
+
+START_TEST(test_bip32_cache_ctx)
+{
+	BIP32CacheEntry entries[3];
+	BIP32Cache cache;
+	uint64_t hits, misses;
+	uint32_t ii[] = {0x80000001, 0x80000002, 0x80000003};
+	HDNode node;
+
+	bip32_cache_init(&cache, entries, 3);
+
+	// three wallets fill the cache, one miss each
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 1, 0, 0), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 2, 0, 0), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 3, 0, 0), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 0);
+	ck_assert_int_eq(misses, 3);
+
+	// using wallet 1 again makes wallet 2 the least recently used one
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 1, 0, 1), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 4, 0, 0), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 1, 0, 2), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 3, 0, 1), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 4, 0, 1), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 4);
+	ck_assert_int_eq(misses, 4);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 2, 0, 1), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 4);
+	ck_assert_int_eq(misses, 5);
+
+	// a different account of the same wallet is a different prefix
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 2, 1, 0), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 2, 1, 5), 1);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 2, 0, 5), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 6);
+	ck_assert_int_eq(misses, 6);
+
+	// the same path from a node at another depth is not a hit
+	hdnode_from_seed((const uint8_t *)"\x02", 1, SECP256K1_NAME, &node);
+	node.depth = 1;
+	ck_assert_int_eq(hdnode_private_ckd_cached_ctx(&cache, &node, ii, 3, NULL), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(misses, 7);
+
+	bip32_cache_clear(&cache);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 1, 0, 3), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 6);
+	ck_assert_int_eq(misses, 8);
+
+	// an empty cache only derives
+	bip32_cache_init(&cache, entries, 0);
+	ck_assert_int_eq(test_bip32_cache_derive(&cache, 1, 0, 4), 1);
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits + misses, 0);
+}
+END_TEST
+
+#if USE_REENTRANT
+static void test_bip32_cache_lock(void *arg) { pthread_mutex_lock(arg); }
+static void test_bip32_cache_unlock(void *arg) { pthread_mutex_unlock(arg); }
+
+static void *test_bip32_cache_thread(void *arg)
+{
+	uintptr_t errors = 0;
+	int i;
+
+	for (i = 0; i < 48; i++) {
+		errors += !test_bip32_cache_derive(arg, i % 6, 0, i);
+	}
+	return (void *)errors;
+}
+
+START_TEST(test_bip32_cache_threads)
+{
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+	BIP32CacheEntry entries[4];
+	BIP32Cache cache;
+	pthread_t threads[4];
+	uint64_t hits, misses;
+	void *errors;
+	int i;
+
+	bip32_cache_init(&cache, entries, 4);
+	cache.lock = test_bip32_cache_lock;
+	cache.unlock = test_bip32_cache_unlock;
+	cache.lock_arg = &mutex;
+	for (i = 0; i < 4; i++) {
+		ck_assert_int_eq(pthread_create(&threads[i], NULL, test_bip32_cache_thread, &cache), 0);
+	}
+	for (i = 0; i < 4; i++) {
+		ck_assert_int_eq(pthread_join(threads[i], &errors), 0);
+		ck_assert_int_eq((uintptr_t)errors, 0);
+	}
+	bip32_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits + misses, 4 * 48);
+}
+END_TEST
+#endif
+
 START_TEST(test_bip32_nist_seed)
 {
 	HDNode node;
@@ -1989,6 +2325,122 @@ START_TEST(test_ecdsa_signature)
 }
 END_TEST
 
+static void test_ecdsa_verify_batch_curve(const ecdsa_curve *curve)
+{
+	enum { N = 2 * ECDSA_VERIFY_BATCH_SIZE + 5 };
+	uint8_t priv[32], pubs[N][65], sigs[N][64], digests[N][32];
+	const uint8_t *ppubs[N], *psigs[N], *pdigests[N];
+	int results[N];
+	int i, res;
+
+	for (i = 0; i < N; i++) {
+		sha256_Raw((const uint8_t *)&i, sizeof(i), priv);
+		sha256_Raw(priv, sizeof(priv), digests[i]);
+		if (i & 1) {
+			ecdsa_get_public_key33(curve, priv, pubs[i]);
+		} else {
+			ecdsa_get_public_key65(curve, priv, pubs[i]);
+		}
+		res = ecdsa_sign_digest(curve, priv, digests[i], sigs[i], NULL, NULL);
+		ck_assert_int_eq(res, 0);
+		ppubs[i] = pubs[i];
+		psigs[i] = sigs[i];
+		pdigests[i] = digests[i];
+	}
+
+	res = ecdsa_verify_digest_batch(curve, N, ppubs, psigs, pdigests, results);
+	ck_assert_int_eq(res, 0);
+	for (i = 0; i < N; i++) {
+		ck_assert_int_eq(results[i], 0);
+	}
+
+	// break some of the signatures
+	sigs[3][40] ^= 1;                          // wrong s
+	pubs[7][0] = 0x05;                         // invalid public key
+	memset(sigs[11], 0, 32);                   // r = 0
+	digests[ECDSA_VERIFY_BATCH_SIZE][0] ^= 1;  // wrong digest
+	ppubs[N - 1] = pubs[N - 2];                // wrong public key
+
+	res = ecdsa_verify_digest_batch(curve, N, ppubs, psigs, pdigests, results);
+	ck_assert_int_eq(res, 5);
+	for (i = 0; i < N; i++) {
+		ck_assert_int_eq(results[i], ecdsa_verify_digest(curve, ppubs[i], psigs[i], pdigests[i]));
+	}
+	ck_assert_int_eq(results[3], 5);
+	ck_assert_int_eq(results[7], 1);
+	ck_assert_int_eq(results[11], 2);
+	ck_assert_int_eq(results[ECDSA_VERIFY_BATCH_SIZE], 5);
+	ck_assert_int_eq(results[N - 1], 5);
+
+	ck_assert_int_eq(ecdsa_verify_digest_batch(curve, 0, ppubs, psigs, pdigests, results), 0);
+}
+
+START_TEST(test_ecdsa_verify_batch_secp256k1) { test_ecdsa_verify_batch_curve(&secp256k1); } END_TEST
+START_TEST(test_ecdsa_verify_batch_nist256p1) { test_ecdsa_verify_batch_curve(&nist256p1); } END_TEST
+
+#if USE_REENTRANT
+#define REENTRANT_THREADS 4
+#define REENTRANT_ROUNDS 16
+
+// sign, derive and run ECDH; the output depends only on seed
+static void test_reentrant_work(uint8_t seed, uint8_t out[REENTRANT_ROUNDS][64 + 33 + 65])
+{
+	HDNode node;
+	uint8_t digest[32], peer[33];
+	int i, key_size;
+
+	for (i = 0; i < REENTRANT_ROUNDS; i++) {
+		digest[0] = seed;
+		digest[1] = i;
+		sha256_Raw(digest, 2, digest);
+		hdnode_from_seed(digest, 32, SECP256K1_NAME, &node);
+		hdnode_private_ckd_prime(&node, i);
+		hdnode_private_ckd(&node, seed);
+		hdnode_fill_public_key(&node);
+		ecdsa_sign_digest(&secp256k1, node.private_key, digest, out[i], NULL, NULL);
+		memcpy(out[i] + 64, node.public_key, 33);
+		ecdsa_get_public_key33(&secp256k1, digest, peer);
+		hdnode_get_shared_key(&node, peer, out[i] + 64 + 33, &key_size);
+	}
+}
+
+static uint8_t reentrant_expected[REENTRANT_ROUNDS][64 + 33 + 65];
+
+static void *test_reentrant_thread(void *arg)
+{
+	uint8_t out[REENTRANT_ROUNDS][64 + 33 + 65];
+	uintptr_t errors = 0;
+	int round;
+
+	(void)arg;
+	for (round = 0; round < 4; round++) {
+		test_reentrant_work(0x42, out);
+		if (memcmp(reentrant_expected, out, sizeof(out)) != 0) {
+			errors++;
+		}
+	}
+	return (void *)errors;
+}
+
+START_TEST(test_reentrant)
+{
+	pthread_t threads[REENTRANT_THREADS];
+	void *errors;
+	int i;
+
+	// compute the reference single-threaded
+	test_reentrant_work(0x42, reentrant_expected);
+	for (i = 0; i < REENTRANT_THREADS; i++) {
+		ck_assert_int_eq(pthread_create(&threads[i], NULL, test_reentrant_thread, NULL), 0);
+	}
+	for (i = 0; i < REENTRANT_THREADS; i++) {
+		ck_assert_int_eq(pthread_join(threads[i], &errors), 0);
+		ck_assert_int_eq((uintptr_t)errors, 0);
+	}
+}
+END_TEST
+#endif
+
 #define test_deterministic(KEY, MSG, K) do { \
 	sha256_Raw((uint8_t *)MSG, strlen(MSG), buf); \
 	init_rfc6979(fromhex(KEY), buf, &rng); \
@@ -2162,6 +2614,144 @@ START_TEST(test_aes)
 }
 END_TEST
 
+// long buffers take the multiple block paths, the expected bytes come from the table implementation
+START_TEST(test_aes_multi_block)
+{
+	static uint8_t buf[1000], pt[1000], ct[1000];
+	uint8_t key[32], cbuf[16], iv[16];
+	aes_encrypt_ctx ctxe;
+	aes_decrypt_ctx ctxd;
+	size_t i;
+
+	for (i = 0; i < sizeof(key); i++) key[i] = i;
+	for (i = 0; i < sizeof(pt); i++) pt[i] = i * 13 + 5;
+	aes_encrypt_key256(key, &ctxe);
+	aes_decrypt_key256(key, &ctxd);
+
+	// CTR, the counter carries out of the low 64 bits
+	memcpy(buf, pt, sizeof(buf));
+	memcpy(cbuf, fromhex("0000000000000000fffffffffffffff0"), 16);
+	aes_ctr_crypt(buf, buf, sizeof(buf), cbuf, aes_ctr_cbuf_inc, &ctxe);
+	ck_assert_mem_eq(buf, fromhex("a8a92d53627b3dc9c34ff0ce9369a829"), 16);
+	ck_assert_mem_eq(buf + 256, fromhex("540fcac3a32e781dc9e5165ccde1c10b"), 16);
+	ck_assert_mem_eq(buf + 984, fromhex("ae0fb96d53b2083d06d26083ae15dc3b"), 16);
+	ck_assert_mem_eq(cbuf, fromhex("0000000000000001000000000000002e"), 16);
+	memcpy(ct, buf, sizeof(ct));
+
+	// the same stream in pieces that do not end on block boundaries
+	aes_mode_reset(&ctxe);
+	memcpy(cbuf, fromhex("0000000000000000fffffffffffffff0"), 16);
+	aes_ctr_crypt(ct, buf, 7, cbuf, aes_ctr_cbuf_inc, &ctxe);
+	aes_ctr_crypt(ct + 7, buf + 7, 500, cbuf, aes_ctr_cbuf_inc, &ctxe);
+	aes_ctr_crypt(ct + 507, buf + 507, sizeof(buf) - 507, cbuf, aes_ctr_cbuf_inc, &ctxe);
+	ck_assert_mem_eq(buf, pt, sizeof(pt));
+
+	// CBC
+	memcpy(buf, pt, 992);
+	memset(iv, 0x5a, 16);
+	aes_cbc_encrypt(buf, buf, 992, iv, &ctxe);
+	ck_assert_mem_eq(buf, fromhex("52abed6d59db96db49dc9a59e41cb7e6"), 16);
+	ck_assert_mem_eq(buf + 976, fromhex("8afae1d965eb94f8466dfc4da14aff15"), 16);
+	memset(iv, 0x5a, 16);
+	aes_cbc_decrypt(buf, buf, 992, iv, &ctxd);
+	ck_assert_mem_eq(buf, pt, 992);
+	ck_assert_mem_eq(iv, fromhex("8afae1d965eb94f8466dfc4da14aff15"), 16);
+
+	// ECB
+	aes_ecb_encrypt(pt, ct, 992, &ctxe);
+	for (i = 0; i < 992; i += 16) {
+		aes_encrypt(pt + i, buf, &ctxe);
+		ck_assert_mem_eq(ct + i, buf, 16);
+	}
+	aes_ecb_decrypt(ct, buf, 992, &ctxd);
+	ck_assert_mem_eq(buf, pt, 992);
+
+	// CFB
+	aes_mode_reset(&ctxe);
+	memset(iv, 0xa5, 16);
+	aes_cfb_encrypt(pt, ct, sizeof(ct), iv, &ctxe);
+	aes_mode_reset(&ctxe);
+	memset(iv, 0xa5, 16);
+	aes_cfb_decrypt(ct, buf, 3, iv, &ctxe);
+	aes_cfb_decrypt(ct + 3, buf + 3, sizeof(buf) - 3, iv, &ctxe);
+	ck_assert_mem_eq(buf, pt, sizeof(pt));
+}
+END_TEST
+
+// test vectors from the GCM specification (McGrew and Viega), test cases 13 to 18
+START_TEST(test_aes_gcm)
+{
+	static const struct {
+		const char *key, *iv, *aad, *pt, *ct, *tag;
+	} tests[] = {
+		{"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "", "", "", "530f8afbc74536b9a963b4f1c4cb738b"},
+		{"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "", "00000000000000000000000000000000", "cea7403d4d606b6e074ec5d3baf39d18", "d0d1c8a799996bf0265b98b5d48ab919"},
+		{"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "", "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255", "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad", "b094dac5d93471bdec1a502270e3cc6c"},
+		{"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888", "feedfacedeadbeeffeedfacedeadbeefabaddad2", "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39", "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662", "76fc6ece0f4e1768cddf8853bb2d551b"},
+		{"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbad", "feedfacedeadbeeffeedfacedeadbeefabaddad2", "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39", "c3762df1ca787d32ae47c13bf19844cbaf1ae14d0b976afac52ff7d79bba9de0feb582d33934a4f0954cc2363bc73f7862ac430e64abe499f47c9b1f", "3a337dbf46a792c45e454913fe2ea8f2"},
+		{"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "9313225df88406e555909c5aff5269aa6a7a9538534f7da1e4c303d2a318a728c3c0c95156809539fcf0e2429a6b525416aedbf5a0de6a57a637b39b", "feedfacedeadbeeffeedfacedeadbeefabaddad2", "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39", "5a8def2f0c9e53f1f75d7853659e2a20eeb2b22aafde6419a058ab4f6f746bf40fc0c3b780f244452da3ebf1c5d82cdea2418997200ef82e44ae7e3f", "a44a8266ee1c8eb0c8b5d4cf5ae9f19a"},
+	};
+	static uint8_t key[32], iv[64], aad[32], pt[64], ct[64], buf[1000], msg[1000];
+	uint8_t tag[16];
+	aes_gcm_ctx ctx;
+	size_t i, iv_len, aad_len, len;
+
+	for (i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+		memcpy(key, fromhex(tests[i].key), 32);
+		iv_len = strlen(tests[i].iv) / 2;
+		memcpy(iv, fromhex(tests[i].iv), iv_len);
+		aad_len = strlen(tests[i].aad) / 2;
+		memcpy(aad, fromhex(tests[i].aad), aad_len);
+		len = strlen(tests[i].pt) / 2;
+		memcpy(pt, fromhex(tests[i].pt), len);
+		memcpy(ct, fromhex(tests[i].ct), len);
+
+		ck_assert_int_eq(aes_gcm_init_key(key, 32, &ctx), EXIT_SUCCESS);
+		ck_assert_int_eq(aes_gcm_encrypt_message(iv, iv_len, aad, aad_len, pt, buf, len, tag, 16, &ctx), EXIT_SUCCESS);
+		ck_assert_mem_eq(buf, ct, len);
+		ck_assert_mem_eq(tag, fromhex(tests[i].tag), 16);
+
+		ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 16, &ctx), EXIT_SUCCESS);
+		ck_assert_mem_eq(buf, pt, len);
+		tag[15] ^= 1;
+		ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 16, &ctx), EXIT_FAILURE);
+	}
+
+	// short tags are refused, a zero length tag would authenticate nothing
+	ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 0, &ctx), EXIT_FAILURE);
+	ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 1, &ctx), EXIT_FAILURE);
+	ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 8, &ctx), EXIT_FAILURE);
+	ck_assert_int_eq(aes_gcm_encrypt_message(iv, iv_len, aad, aad_len, pt, buf, len, tag, 8, &ctx), EXIT_FAILURE);
+	ck_assert_int_eq(aes_gcm_compute_tag(tag, 17, &ctx), EXIT_FAILURE);
+	// a truncated 12 byte tag is accepted
+	ck_assert_int_eq(aes_gcm_encrypt_message(iv, iv_len, aad, aad_len, pt, buf, len, tag, 12, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_decrypt_message(iv, iv_len, aad, aad_len, ct, buf, len, tag, 12, &ctx), EXIT_SUCCESS);
+	ck_assert_mem_eq(buf, pt, len);
+
+	// a long message in pieces that do not end on block boundaries, in place
+	for (i = 0; i < 32; i++) key[i] = i;
+	for (i = 0; i < 20; i++) aad[i] = i;
+	for (i = 0; i < sizeof(msg); i++) msg[i] = i * 7 + 3;
+	memcpy(buf, msg, sizeof(buf));
+	ck_assert_int_eq(aes_gcm_init_key(key, 32, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_init_message(aad, 12, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_auth_header(aad, 7, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_auth_header(aad + 7, 13, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_encrypt(buf, buf, 5, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_auth_header(aad, 1, &ctx), EXIT_FAILURE);
+	ck_assert_int_eq(aes_gcm_encrypt(buf + 5, buf + 5, 300, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_encrypt(buf + 305, buf + 305, sizeof(buf) - 305, &ctx), EXIT_SUCCESS);
+	ck_assert_int_eq(aes_gcm_compute_tag(tag, 16, &ctx), EXIT_SUCCESS);
+	ck_assert_mem_eq(buf, fromhex("4408c703dac3ef2fb603dedbe6b71d01"), 16);
+	ck_assert_mem_eq(buf + 984, fromhex("b9432f2cabbfbb51cfd893667cff3971"), 16);
+	ck_assert_mem_eq(tag, fromhex("e725a981b840aaaf1eefde117544580c"), 16);
+
+	ck_assert_int_eq(aes_gcm_decrypt_message(aad, 12, aad, 20, buf, buf, sizeof(buf), tag, 16, &ctx), EXIT_SUCCESS);
+	ck_assert_mem_eq(buf, msg, sizeof(msg));
+	aes_gcm_end(&ctx);
+}
+END_TEST
+
 #define TEST1    "abc"
 #define TEST2_1  \
         "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
@@ -2321,6 +2911,37 @@ START_TEST(test_sha256)
 }
 END_TEST
 
+START_TEST(test_sha256_multi)
+{
+	static const size_t lengths[] = { 0, 1, 32, 33, 55, 56, 63, 64, 65, 119, 120, 200 };
+	uint8_t msgs[8][200];
+	const uint8_t *pmsgs[8];
+	uint8_t digests[8][SHA256_DIGEST_LENGTH];
+	uint8_t expected[SHA256_DIGEST_LENGTH];
+
+	for (int l = 0; l < 8; l++) {
+		for (size_t k = 0; k < sizeof(msgs[l]); k++) {
+			msgs[l][k] = (uint8_t)(l * 31 + k * 7);
+		}
+		pmsgs[l] = msgs[l];
+	}
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(*lengths); i++) {
+		sha256_Raw_x4(pmsgs, lengths[i], digests);
+		for (int l = 0; l < 4; l++) {
+			sha256_Raw(msgs[l], lengths[i], expected);
+			ck_assert_mem_eq(digests[l], expected, SHA256_DIGEST_LENGTH);
+		}
+
+		sha256_Raw_x8(pmsgs, lengths[i], digests);
+		for (int l = 0; l < 8; l++) {
+			sha256_Raw(msgs[l], lengths[i], expected);
+			ck_assert_mem_eq(digests[l], expected, SHA256_DIGEST_LENGTH);
+		}
+	}
+}
+END_TEST
+
 #define TEST7_512 \
   "\x08\xec\xb5\x2e\xba\xe1\xf7\x42\x2d\xb6\x2b\xcd\x54\x26\x70"
 #define TEST8_512 \
@@ -2498,6 +3119,31 @@ START_TEST(test_keccak_256)
 }
 END_TEST
 
+START_TEST(test_keccak_256_x4)
+{
+	static const size_t lengths[] = { 0, 1, 64, 65, 135, 136, 137, 271, 272, 300 };
+	uint8_t msgs[4][300];
+	const uint8_t *pmsgs[4];
+	uint8_t digests[4][SHA3_256_DIGEST_LENGTH];
+	uint8_t expected[SHA3_256_DIGEST_LENGTH];
+
+	for (int l = 0; l < 4; l++) {
+		for (size_t k = 0; k < sizeof(msgs[l]); k++) {
+			msgs[l][k] = (uint8_t)(l * 31 + k * 7);
+		}
+		pmsgs[l] = msgs[l];
+	}
+
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(*lengths); i++) {
+		keccak_256_x4(pmsgs, lengths[i], digests);
+		for (int l = 0; l < 4; l++) {
+			keccak_256(msgs[l], lengths[i], expected);
+			ck_assert_mem_eq(digests[l], expected, SHA3_256_DIGEST_LENGTH);
+		}
+	}
+}
+END_TEST
+
 // test vectors from https://raw.githubusercontent.com/monero-project/monero/master/tests/hash/tests-extra-blake.txt
 START_TEST(test_blake256)
 {
@@ -2580,6 +3226,63 @@ START_TEST(test_blake2s)
 }
 END_TEST
 
+// the digests of bytes 0..199 for every HasherType, streamed and raw
+START_TEST(test_hasher)
+{
+	static const struct {
+		HasherType type;
+		const char *hash;
+	} tests[] = {
+		{HASHER_SHA2, "1901da1c9f699b48f6b2636e65cbf73abf99d0441ef67f5c540a42f7051dec6f"},
+		{HASHER_SHA2D, "4b52df5ba999154217be8504fe1bee153e48b88c26ea15f9e559bc89f829d570"},
+		{HASHER_SHA2_RIPEMD, "0a5fca858f700e54c7c016672829eef2d18d91c4"},
+		{HASHER_SHA3, "5f728f63bf5ee48c77f453c0490398fa645b8d4c4e56be9a41cfec344d6ca899"},
+		{HASHER_SHA3K, "bfb0aa97863e797943cf7c33bb7e880bb4543f3d2703c0923c6901c2af57b890"},
+		{HASHER_BLAKE, "c4d944c2b1c00a8ee627726b35d4cd7fe018de090bc637553cc782e25f974cba"},
+		{HASHER_BLAKED, "cf3d4629059756a736bd6ce876acece78135fbb616353b3f0fd291f4deb72efd"},
+		{HASHER_BLAKE_RIPEMD, "37081471e0f695e489c06a062ec13b4594abef5f"},
+		{HASHER_GROESTLD_TRUNC, "e9b05d62162b417a0ea94f7027d765b34963d61ad589afd4b108c43aed47feca"},
+		{HASHER_OVERWINTER_PREVOUTS, "6c69cced2826bd0ca156536f125b3dfde851911f0aa7a4d35cc3c98d39afd020"},
+		{HASHER_OVERWINTER_SEQUENCE, "961eb3fd9114b37327a671411335e9a64206008ca1251f9ee67d7238787698f6"},
+		{HASHER_OVERWINTER_OUTPUTS, "57ccd07fcfb64f197d0079db050778892d9e05d69023a80efecc67937ed69630"},
+		{HASHER_OVERWINTER_PREIMAGE, "79454e14a3939c1c8b1f5260ce8711c960fb00e4530605711c70f2c647edacdc"},
+	};
+	uint8_t msg[200], hash[HASHER_DIGEST_LENGTH];
+	Hasher hasher;
+	size_t i, j, len;
+
+	for (i = 0; i < sizeof(msg); i++) msg[i] = i;
+
+	for (i = 0; i < sizeof(tests) / sizeof(*tests); i++) {
+		len = strlen(tests[i].hash) / 2;
+
+		hasher_Raw(tests[i].type, msg, sizeof(msg), hash);
+		ck_assert_mem_eq(hash, fromhex(tests[i].hash), len);
+
+		hasher_Init(&hasher, tests[i].type);
+		ck_assert(hasher.desc == hasher_Desc(tests[i].type));
+		hasher_Update(&hasher, msg, 1);
+		hasher_Final(&hasher, hash);
+
+		// Reset starts over with the same type
+		hasher_Reset(&hasher);
+		for (j = 0; j < sizeof(msg); j += 50) {
+			hasher_Update(&hasher, msg + j, 50);
+		}
+		hasher_Final(&hasher, hash);
+		ck_assert_mem_eq(hash, fromhex(tests[i].hash), len);
+	}
+
+	// an unknown type hashes nothing and leaves the output alone
+	memset(hash, 0xaa, sizeof(hash));
+	hasher_Raw((HasherType)1000, msg, sizeof(msg), hash);
+	hasher_Init(&hasher, (HasherType)1000);
+	hasher_Update(&hasher, msg, sizeof(msg));
+	hasher_Final(&hasher, hash);
+	ck_assert_mem_eq(hash, fromhex("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"), sizeof(hash));
+}
+END_TEST
+
 START_TEST(test_pbkdf2_hmac_sha256)
 {
 	uint8_t k[64];
@@ -2625,6 +3328,41 @@ START_TEST(test_pbkdf2_hmac_sha512)
 }
 END_TEST
 
+START_TEST(test_pbkdf2_hmac_sha512_batch)
+{
+	static const char *passwords[] = {
+		"password", "passwordPASSWORDpassword", "", "pass\x00word",
+		"all all all all all all all all all all all all", "x", "password", "abc",
+		"0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789",
+		"legal winner thank year wave sausage worth useful legal winner thank yellow", "p",
+	};
+	static const int passlens[] = { 8, 24, 0, 9, 47, 1, 8, 3, 130, 75, 1 };
+	static const char *salts[] = {
+		"salt", "saltSALTsaltSALTsaltSALTsaltSALTsalt", "mnemonic", "sa\x00lt",
+		"mnemonicTREZOR", "s", "", "mnemonic", "salt", "mnemonicTREZOR", "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef",
+	};
+	static const int saltlens[] = { 4, 36, 8, 5, 14, 1, 0, 8, 4, 14, 128 };
+	const size_t count = sizeof(passlens) / sizeof(*passlens);
+	const uint8_t *pass[sizeof(passlens) / sizeof(*passlens)], *salt[sizeof(passlens) / sizeof(*passlens)];
+	uint8_t keys[sizeof(passlens) / sizeof(*passlens)][64];
+	uint8_t k[64];
+
+	for (size_t i = 0; i < count; i++) {
+		pass[i] = (const uint8_t *)passwords[i];
+		salt[i] = (const uint8_t *)salts[i];
+	}
+
+	for (uint32_t iterations = 1; iterations <= 2048; iterations *= 8) {
+		// odd count leaves unused lanes in the last group
+		pbkdf2_hmac_sha512_batch(pass, passlens, salt, saltlens, iterations, keys, count);
+		for (size_t i = 0; i < count; i++) {
+			pbkdf2_hmac_sha512(pass[i], passlens[i], salt[i], saltlens[i], iterations, k, 64);
+			ck_assert_mem_eq(keys[i], k, 64);
+		}
+	}
+}
+END_TEST
+
 START_TEST(test_mnemonic)
 {
 	static const char *vectors[] = {
@@ -2723,6 +3461,21 @@ START_TEST(test_mnemonic)
 #endif
 		a += 3; b += 3; c += 3;
 	}
+
+	// all vectors at once through the batch interface
+	char mnemonics[32][256];
+	const char *pmnemonics[32], *passphrases[32];
+	uint8_t seeds[32][64];
+	size_t n = 0;
+	for (a = vectors; *a && n < 32; a += 3, n++) {
+		strcpy(mnemonics[n], mnemonic_from_data(fromhex(*a), strlen(*a) / 2));
+		pmnemonics[n] = mnemonics[n];
+		passphrases[n] = "TREZOR";
+	}
+	mnemonic_to_seed_batch(pmnemonics, passphrases, seeds, n);
+	for (size_t i = 0; i < n; i++) {
+		ck_assert_mem_eq(seeds[i], fromhex(vectors[3 * i + 2]), 64);
+	}
 }
 END_TEST
 
@@ -2895,6 +3648,151 @@ START_TEST(test_mnemonic_to_entropy)
 }
 END_TEST
 
+START_TEST(test_mnemonic_find_word)
+{
+	const char * const *wordlist = mnemonic_wordlist();
+	for (int i = 0; i < 2048; i++) {
+		ck_assert_int_eq(mnemonic_find_word(wordlist[i]), i);
+	}
+	static const char *invalid[] = {
+		"", " ", "a", "aban", "abandonx", "Abandon", "zoom", "zzz", "ab andon", "{", "`",
+		0,
+	};
+	for (const char **w = invalid; *w; w++) {
+		ck_assert_int_eq(mnemonic_find_word(*w), -1);
+	}
+	// separators are single spaces
+	ck_assert_int_eq(mnemonic_to_entropy("abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon  about", (uint8_t[33]){0}), 0);
+	ck_assert_int_eq(mnemonic_to_entropy("abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about ", (uint8_t[33]){0}), 0);
+	ck_assert_int_eq(mnemonic_to_entropy("", (uint8_t[33]){0}), 0);
+}
+END_TEST
+
+static uint64_t test_mnemonic_clock;
+
+static uint64_t test_mnemonic_now(void)
+{
+	return test_mnemonic_clock;
+}
+
+static const char *test_mnemonic_cache_words[] = {
+	"abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about",
+	"legal winner thank year wave sausage worth useful legal winner thank yellow",
+	"letter advice cage absurd amount doctor acoustic avoid letter advice cage above",
+	"zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo zoo wrong",
+};
+
+// run mnemonic_to_seed_ctx on word j and compare to the uncached seed
+static int test_mnemonic_cache_seed(BIP39Cache *cache, int j, const char *passphrase)
+{
+	uint8_t seed[64], expected[1][64];
+	mnemonic_to_seed_batch(&test_mnemonic_cache_words[j], &passphrase, expected, 1);
+	mnemonic_to_seed_ctx(cache, test_mnemonic_cache_words[j], passphrase, seed, 0);
+	return memcmp(seed, expected[0], 64) == 0;
+}
+
+START_TEST(test_mnemonic_seed_cache)
+{
+	BIP39CacheEntry entries[3];
+	BIP39CacheShard shards[2];
+	BIP39Cache cache;
+	uint64_t hits, misses;
+	int j;
+
+	bip39_cache_init(&cache, shards, 1, entries, 3);
+	for (j = 0; j < 3; j++) {
+		ck_assert_int_eq(test_mnemonic_cache_seed(&cache, j, "TREZOR"), 1);
+	}
+	// the passphrase is part of the key
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 2, ""), 1);
+	bip39_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 0);
+	ck_assert_int_eq(misses, 4);
+
+	// word 0 was evicted as the least recently used, words 1 and 2 are still cached
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 2, "TREZOR"), 1);
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 1, "TREZOR"), 1);
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 0, "TREZOR"), 1);
+	bip39_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 2);
+	ck_assert_int_eq(misses, 5);
+	// evicted entries are wiped
+	for (j = 0; j < 3; j++) {
+		ck_assert_int_eq(entries[j].set, 1);
+	}
+
+	// entries expire ttl after they were stored
+	bip39_cache_init(&cache, shards, 2, entries, 3);
+	ck_assert_int_eq(shards[0].size + shards[1].size, 3);
+	cache.now = test_mnemonic_now;
+	cache.ttl = 10;
+	test_mnemonic_clock = 100;
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 3, "TREZOR"), 1);
+	test_mnemonic_clock = 109;
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 3, "TREZOR"), 1);
+	bip39_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 1);
+	ck_assert_int_eq(misses, 1);
+	test_mnemonic_clock = 110;
+	ck_assert_int_eq(test_mnemonic_cache_seed(&cache, 3, "TREZOR"), 1);
+	bip39_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits, 1);
+	ck_assert_int_eq(misses, 2);
+
+	// cleared entries are wiped
+	bip39_cache_clear(&cache);
+	for (j = 0; j < 3; j++) {
+		ck_assert_int_eq(entries[j].set, 0);
+		ck_assert_mem_eq(entries[j].seed, fromhex("00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"), 64);
+	}
+}
+END_TEST
+
+#if USE_REENTRANT
+static void test_mnemonic_cache_lock(void *arg) { pthread_mutex_lock(arg); }
+static void test_mnemonic_cache_unlock(void *arg) { pthread_mutex_unlock(arg); }
+
+static void *test_mnemonic_cache_thread(void *arg)
+{
+	uintptr_t errors = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		errors += !test_mnemonic_cache_seed(arg, i % 4, "TREZOR");
+	}
+	return (void *)errors;
+}
+
+START_TEST(test_mnemonic_seed_cache_threads)
+{
+	pthread_mutex_t mutexes[4] = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER};
+	BIP39CacheEntry entries[8];
+	BIP39CacheShard shards[4];
+	BIP39Cache cache;
+	pthread_t threads[4];
+	uint64_t hits, misses;
+	void *errors;
+	int i;
+
+	bip39_cache_init(&cache, shards, 4, entries, 8);
+	cache.lock = test_mnemonic_cache_lock;
+	cache.unlock = test_mnemonic_cache_unlock;
+	for (i = 0; i < 4; i++) {
+		shards[i].lock_arg = &mutexes[i];
+	}
+	for (i = 0; i < 4; i++) {
+		ck_assert_int_eq(pthread_create(&threads[i], NULL, test_mnemonic_cache_thread, &cache), 0);
+	}
+	for (i = 0; i < 4; i++) {
+		ck_assert_int_eq(pthread_join(threads[i], &errors), 0);
+		ck_assert_int_eq((uintptr_t)errors, 0);
+	}
+	bip39_cache_stats(&cache, &hits, &misses);
+	ck_assert_int_eq(hits + misses, 4 * 8);
+}
+END_TEST
+#endif
+
 START_TEST(test_address)
 {
 	char address[36];
@@ -3447,6 +4345,202 @@ START_TEST(test_ed25519_keccak)
 }
 END_TEST
 
+START_TEST(test_ed25519_batch)
+{
+	static const struct {
+		void (*publickey)(const ed25519_secret_key, ed25519_public_key);
+		void (*sign)(const unsigned char *, size_t, const ed25519_secret_key, const ed25519_public_key, ed25519_signature);
+		int (*sign_open_batch)(const unsigned char **, size_t *, const unsigned char **, const unsigned char **, size_t, int *);
+	} variants[] = {
+		{ ed25519_publickey, ed25519_sign, ed25519_sign_open_batch },
+		{ ed25519_publickey_sha3, ed25519_sign_sha3, ed25519_sign_open_batch_sha3 },
+		{ ed25519_publickey_keccak, ed25519_sign_keccak, ed25519_sign_open_batch_keccak },
+	};
+	// more than one full batch and a tail verified one by one
+	enum { N = ED25519_VERIFY_BATCH_SIZE + 7 };
+	// S + L, same signature with a non-canonical S
+	static const uint8_t L[32] = { 0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 };
+	static ed25519_public_key pks[N];
+	static ed25519_signature sigs[N];
+	static uint8_t msgs[N][40];
+	const unsigned char *m[N], *pk[N], *RS[N];
+	size_t mlen[N];
+	int valid[N];
+	ed25519_secret_key sk;
+
+	for (size_t v = 0; v < sizeof(variants) / sizeof(*variants); v++) {
+		for (size_t i = 0; i < N; i++) {
+			memset(sk, 0x42, sizeof(sk));
+			sk[0] = i;
+			sk[1] = v;
+			variants[v].publickey(sk, pks[i]);
+			memset(msgs[i], i, sizeof(msgs[i]));
+			mlen[i] = 1 + i % sizeof(msgs[i]);
+			variants[v].sign(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+			m[i] = msgs[i];
+			pk[i] = pks[i];
+			RS[i] = sigs[i];
+		}
+
+		ck_assert_int_eq(variants[v].sign_open_batch(m, mlen, pk, RS, N, valid), 0);
+		for (size_t i = 0; i < N; i++) {
+			ck_assert_int_eq(valid[i], 1);
+		}
+
+		// small batches are verified one by one
+		ck_assert_int_eq(variants[v].sign_open_batch(m, mlen, pk, RS, 3, valid), 0);
+		ck_assert_int_eq(variants[v].sign_open_batch(m, mlen, pk, RS, 0, valid), 0);
+
+		// wrong message, S, R, public key, non-canonical S and the tail
+		msgs[3][0] ^= 1;
+		sigs[10][40] ^= 1;
+		sigs[11][0] ^= 1;
+		pks[12][5] ^= 1;
+		uint32_t carry = 0;
+		for (int j = 0; j < 32; j++) {
+			carry += sigs[13][32 + j] + L[j];
+			sigs[13][32 + j] = carry & 0xff;
+			carry >>= 8;
+		}
+		sigs[N - 1][63] ^= 0x40;
+		ck_assert_int_ne(variants[v].sign_open_batch(m, mlen, pk, RS, N, valid), 0);
+		for (size_t i = 0; i < N; i++) {
+			int bad = i == 3 || i == 10 || i == 11 || i == 12 || i == 13 || i == N - 1;
+			ck_assert_int_eq(valid[i], !bad);
+		}
+
+		// a batch with the only non-canonical signature must fail
+		ck_assert_int_ne(variants[v].sign_open_batch(m + 13, mlen + 13, pk + 13, RS + 13, 8, valid), 0);
+		ck_assert_int_eq(valid[0], 0);
+		for (size_t i = 1; i < 8; i++) {
+			ck_assert_int_eq(valid[i], 1);
+		}
+	}
+}
+END_TEST
+
+START_TEST(test_ed25519_batch_torsion)
+{
+	// R of order 8 and S = H(R,A,m)a, so SB - H(R,A,m)A - R is -R instead of
+	// the neutral element, which random coefficients divisible by 8 would hide
+	static const char *R8 = "c7176a703d4dd84fba3c0b760d10670f2a2053fa2c39ccc64ec7fd7792ac037a";
+	enum { N = 8 };
+	ed25519_public_key pks[N];
+	ed25519_signature sigs[N];
+	uint8_t msgs[N][32];
+	const unsigned char *m[N], *pk[N], *RS[N];
+	size_t mlen[N];
+	int valid[N];
+	ed25519_secret_key sk;
+	uint8_t extsk[SHA512_DIGEST_LENGTH], hram[SHA512_DIGEST_LENGTH];
+	bignum256modm a, h;
+	SHA512_CTX ctx;
+
+	for (size_t i = 0; i < N; i++) {
+		memset(sk, 0x24, sizeof(sk));
+		sk[0] = i;
+		ed25519_publickey(sk, pks[i]);
+		memset(msgs[i], i, sizeof(msgs[i]));
+		mlen[i] = sizeof(msgs[i]);
+		ed25519_sign(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+		m[i] = msgs[i];
+		pk[i] = pks[i];
+		RS[i] = sigs[i];
+	}
+
+	sha512_Raw(sk, sizeof(sk), extsk);
+	extsk[0] &= 248;
+	extsk[31] &= 127;
+	extsk[31] |= 64;
+	expand256_modm(a, extsk, 32);
+	memcpy(sigs[N - 1], fromhex(R8), 32);
+	sha512_Init(&ctx);
+	sha512_Update(&ctx, sigs[N - 1], 32);
+	sha512_Update(&ctx, pks[N - 1], 32);
+	sha512_Update(&ctx, msgs[N - 1], mlen[N - 1]);
+	sha512_Final(&ctx, hram);
+	expand256_modm(h, hram, 64);
+	mul256_modm(h, h, a);
+	contract256_modm(sigs[N - 1] + 32, h);
+
+	ck_assert_int_ne(ed25519_sign_open(m[N - 1], mlen[N - 1], pk[N - 1], RS[N - 1]), 0);
+	// fresh coefficients on every call, each would miss the torsion with probability 1/8
+	for (int j = 0; j < 32; j++) {
+		ck_assert_int_ne(ed25519_sign_open_batch(m, mlen, pk, RS, N, valid), 0);
+		for (size_t i = 0; i < N; i++) {
+			ck_assert_int_eq(valid[i], i != N - 1);
+		}
+	}
+}
+END_TEST
+
+START_TEST(test_ed25519_batch_mixed_torsion)
+{
+	// R' = rB + (0,-1), a point of order 2L, and S = r + H(R',A,m)a, so
+	// SB - H(R',A,m)A - R' is the order 2 point, hidden by even coefficients
+	enum { N = 8 };
+	ed25519_public_key pks[N];
+	ed25519_signature sigs[N];
+	uint8_t msgs[N][32];
+	const unsigned char *m[N], *pk[N], *RS[N];
+	size_t mlen[N];
+	int valid[N];
+	ed25519_secret_key sk;
+	uint8_t extsk[SHA512_DIGEST_LENGTH], hash[SHA512_DIGEST_LENGTH];
+	bignum256modm a, r, h;
+	ge25519 R;
+	SHA512_CTX ctx;
+
+	for (size_t i = 0; i < N; i++) {
+		memset(sk, 0x35, sizeof(sk));
+		sk[0] = i;
+		ed25519_publickey(sk, pks[i]);
+		memset(msgs[i], i, sizeof(msgs[i]));
+		mlen[i] = sizeof(msgs[i]);
+		ed25519_sign(msgs[i], mlen[i], sk, pks[i], sigs[i]);
+		m[i] = msgs[i];
+		pk[i] = pks[i];
+		RS[i] = sigs[i];
+	}
+
+	// recover the nonce r of the last signature, R = rB
+	sha512_Raw(sk, sizeof(sk), extsk);
+	extsk[0] &= 248;
+	extsk[31] &= 127;
+	extsk[31] |= 64;
+	expand256_modm(a, extsk, 32);
+	sha512_Init(&ctx);
+	sha512_Update(&ctx, extsk + 32, 32);
+	sha512_Update(&ctx, msgs[N - 1], mlen[N - 1]);
+	sha512_Final(&ctx, hash);
+	expand256_modm(r, hash, 64);
+
+	// the unpack gives -R = (-x, y), negating y makes it (-x, -y) = R + (0, -1)
+	ck_assert_int_eq(ge25519_unpack_negative_vartime(&R, sigs[N - 1]), 1);
+	curve25519_neg(R.y, R.y);
+	curve25519_neg(R.t, R.t);
+	ge25519_pack(sigs[N - 1], &R);
+
+	sha512_Init(&ctx);
+	sha512_Update(&ctx, sigs[N - 1], 32);
+	sha512_Update(&ctx, pks[N - 1], 32);
+	sha512_Update(&ctx, msgs[N - 1], mlen[N - 1]);
+	sha512_Final(&ctx, hash);
+	expand256_modm(h, hash, 64);
+	mul256_modm(h, h, a);
+	add256_modm(h, h, r);
+	contract256_modm(sigs[N - 1] + 32, h);
+
+	ck_assert_int_ne(ed25519_sign_open(m[N - 1], mlen[N - 1], pk[N - 1], RS[N - 1]), 0);
+	for (int j = 0; j < 32; j++) {
+		ck_assert_int_ne(ed25519_sign_open_batch(m, mlen, pk, RS, N, valid), 0);
+		for (size_t i = 0; i < N; i++) {
+			ck_assert_int_eq(valid[i], i != N - 1);
+		}
+	}
+}
+END_TEST
+
 START_TEST(test_ed25519_cosi) {
 	const int MAXN = 10;
 	ed25519_secret_key keys[MAXN];
@@ -4801,6 +5895,198 @@ START_TEST(test_rc4_rfc6229)
 }
 END_TEST
 
+START_TEST(test_chacha20_keystream)
+{
+	static const size_t offsets[] = {
+		0x0, 0xf0, 0x1f0, 0x2f0, 0x3f0, 0x5f0, 0x7f0, 0xbf0, 0xfe0,
+	};
+	static const char *vectors[] = {
+		"f798a189f195e66982105ffb640bb7757f579da31602fc93ec01ac56f85ac3c1",
+		"8746d4524d38407a6deb3ab78fab78c94213668bbbd394c5de93b853178addd6",
+		"1c3cdf058c50963168b496043716c7307cd9e0cdd137fccb0f05b47cdbb95c5f",
+		"e7e82bcab358cb3971e61405b2ff17980d6e7e67e861e28201c1ee30b441040f",
+		"4bf9970298e6b5aad33ea2155d105d4e637d1e87c40a8e5f4e8c5a16a4b8f3dc",
+		"636a4876a9d6c7c9203c4198d194961470e2f2ffd9db95b519e85de17620812b",
+		"af4a8be7620fca76c65ff3e6477d177f145c0295389e5e6c004da0621a375539",
+		"df38efa47a9fa94fc374223c5bebf24a164e2d58e853c9582602d0d2c2306c83",
+		"4b12b63fdcf9eccd996dc7662c65280d8bb49b849843cf83d0b239ab0467e6b0",
+	};
+	// the 64-bit block counter carries from the first word into the second
+	static const size_t wrap_offsets[] = {
+		0x0, 0xc0, 0x100, 0x3e0,
+	};
+	static const char *wrap_vectors[] = {
+		"4a579772c390d0c082c7199a8bb9b228d353603ae949e3c63f853a298d227d16",
+		"df5218637e8bfb92ce21771bdb30600d717288249d4cfda5eb0d7126a19c8894",
+		"d0590a4c0e532f1d3614b09a2882c0f83c4c633a94b766df2fc2b7a6a466a198",
+		"6802277d97ec3dcb3fe64be9871def0e11ac0a3540aeb64e37c67e91163c1404",
+	};
+	static const u32 chunks[] = { 1, 63, 64, 65, 200, 256, 511, 512, 700 };
+
+	uint8_t key[32], stream[0x1000], chunked[0x1000];
+	ECRYPT_ctx ctx;
+	size_t i, done;
+
+	for (i = 0; i < sizeof(key); i++) {
+		key[i] = i;
+	}
+
+	ECRYPT_keysetup(&ctx, key, 256, 64);
+	ECRYPT_ivsetup(&ctx, fromhex("0001020304050607"));
+	ECRYPT_keystream_bytes(&ctx, stream, sizeof(stream));
+	for (i = 0; i < sizeof(offsets) / sizeof(*offsets); i++) {
+		ck_assert_mem_eq(stream + offsets[i], fromhex(vectors[i]), 32);
+	}
+
+	// the same stream in pieces that end in the middle of blocks and vector batches
+	ECRYPT_ivsetup(&ctx, fromhex("0001020304050607"));
+	for (done = 0, i = 0; done < sizeof(chunked); i++) {
+		u32 n = chunks[i % (sizeof(chunks) / sizeof(*chunks))];
+		if (n % 64 != 0) {
+			// a partial block ends the stream of a context, start the next piece from its block
+			n = n - n % 64 + 64;
+		}
+		if (n > sizeof(chunked) - done) {
+			n = sizeof(chunked) - done;
+		}
+		ECRYPT_keystream_bytes(&ctx, chunked + done, n);
+		done += n;
+	}
+	ck_assert_mem_eq(chunked, stream, sizeof(stream));
+
+	// encryption of data in place and out of place
+	memset(chunked, 0x5a, sizeof(chunked));
+	ECRYPT_ivsetup(&ctx, fromhex("0001020304050607"));
+	ECRYPT_encrypt_bytes(&ctx, chunked, chunked, sizeof(chunked) - 3);
+	for (i = 0; i < sizeof(chunked) - 3; i++) {
+		ck_assert_int_eq(chunked[i], stream[i] ^ 0x5a);
+	}
+
+	ECRYPT_ivsetup(&ctx, fromhex("0001020304050607"));
+	ctx.input[12] = 0xfffffffd;
+	ctx.input[13] = 5;
+	ECRYPT_keystream_bytes(&ctx, stream, 0x400);
+	for (i = 0; i < sizeof(wrap_offsets) / sizeof(*wrap_offsets); i++) {
+		ck_assert_mem_eq(stream + wrap_offsets[i], fromhex(wrap_vectors[i]), 32);
+	}
+	ck_assert_int_eq(ctx.input[12], 0xd);
+	ck_assert_int_eq(ctx.input[13], 6);
+}
+END_TEST
+
+// test vectors from https://tools.ietf.org/html/rfc7539#section-2.8.2
+START_TEST(test_rfc7539)
+{
+	static const char plaintext[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+	uint8_t key[32], nonce[12], aad[12], in[777], out[777], tag[16];
+	chacha20poly1305_ctx ctx;
+	size_t i;
+
+	memcpy(key, fromhex("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"), 32);
+	memcpy(nonce, fromhex("070000004041424344454647"), 12);
+	memcpy(aad, fromhex("50515253c0c1c2c3c4c5c6c7"), 12);
+	memcpy(in, plaintext, sizeof(plaintext) - 1);
+
+	rfc7539_init(&ctx, key, nonce);
+	rfc7539_auth(&ctx, aad, sizeof(aad));
+	chacha20poly1305_encrypt(&ctx, in, out, sizeof(plaintext) - 1);
+	rfc7539_finish(&ctx, sizeof(aad), sizeof(plaintext) - 1, tag);
+	ck_assert_mem_eq(out, fromhex("d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec64b6116"), sizeof(plaintext) - 1);
+	ck_assert_mem_eq(tag, fromhex("1ae10b594f09e26a7e902ecbd0600691"), 16);
+
+	rfc7539_init(&ctx, key, nonce);
+	rfc7539_auth(&ctx, aad, sizeof(aad));
+	chacha20poly1305_decrypt(&ctx, out, in, sizeof(plaintext) - 1);
+	rfc7539_finish(&ctx, sizeof(aad), sizeof(plaintext) - 1, tag);
+	ck_assert_mem_eq(in, plaintext, sizeof(plaintext) - 1);
+	ck_assert_mem_eq(tag, fromhex("1ae10b594f09e26a7e902ecbd0600691"), 16);
+
+	// a message long enough for several vector batches
+	for (i = 0; i < sizeof(key); i++) {
+		key[i] = i;
+	}
+	for (i = 0; i < sizeof(in); i++) {
+		in[i] = i * 31 + 7;
+	}
+	memcpy(nonce, fromhex("000000090000004a00000000"), 12);
+	rfc7539_init(&ctx, key, nonce);
+	rfc7539_auth(&ctx, aad, sizeof(aad));
+	chacha20poly1305_encrypt(&ctx, in, out, sizeof(in));
+	rfc7539_finish(&ctx, sizeof(aad), sizeof(in), tag);
+	ck_assert_mem_eq(out, fromhex("17d7a280529998f5af11e043d8bac81c30c7c1934052d9d3eb2c87d6a85ec586"), 32);
+	ck_assert_mem_eq(out + sizeof(out) - 32, fromhex("099e66c333b547fd33d25715e149c9837378e9b8504ec8d9408230ab5c285fec"), 32);
+	ck_assert_mem_eq(tag, fromhex("84f5a2540a39c9960315c86574c34e48"), 16);
+
+	// in place and over several chunks of encryption and MAC
+	static uint8_t buf[3000];
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = i * 31 + 7;
+	}
+	rfc7539_init(&ctx, key, nonce);
+	rfc7539_auth(&ctx, aad, sizeof(aad));
+	chacha20poly1305_encrypt(&ctx, buf, buf, sizeof(buf));
+	rfc7539_finish(&ctx, sizeof(aad), sizeof(buf), tag);
+	ck_assert_mem_eq(buf + 1024, fromhex("7bc64f7f5c432be0ea66714dd7b8cd7ff01ac56a2deef78b4f683813f18d9494"), 32);
+	ck_assert_mem_eq(buf + sizeof(buf) - 32, fromhex("941ace2384d920ccdfb18736ce46609d2c2214b908363c01cac147fd71d054d9"), 32);
+	ck_assert_mem_eq(tag, fromhex("ae35a8865dadbe9e04a1c32aaaffb680"), 16);
+
+	rfc7539_init(&ctx, key, nonce);
+	rfc7539_auth(&ctx, aad, sizeof(aad));
+	chacha20poly1305_decrypt(&ctx, buf, buf, sizeof(buf));
+	rfc7539_finish(&ctx, sizeof(aad), sizeof(buf), tag);
+	for (i = 0; i < sizeof(buf); i++) {
+		ck_assert_int_eq(buf[i], (uint8_t)(i * 31 + 7));
+	}
+	ck_assert_mem_eq(tag, fromhex("ae35a8865dadbe9e04a1c32aaaffb680"), 16);
+}
+END_TEST
+
+START_TEST(test_poly1305)
+{
+	static const size_t lengths[] = {0, 64, 255, 256, 1000, 4096};
+	static const char *macs[] = {
+		"737a81888f969da4abb2b9c0c7ced5dc",
+		"510ab0a25ee7e5518391d5d85af706ab",
+		"dbfd61301edb3a55f924192e544c308d",
+		"008209fdb8dc675111a4cb59e9486484",
+		"1dd15d0d9871b9725dabb7beebccc270",
+		"c9e044a5625c7422746ff81f3c0db4c2",
+	};
+	static uint8_t msg[4096];
+	uint8_t key[32], mac[16];
+	poly1305_context ctx;
+	size_t i, j;
+
+	ck_assert_int_eq(poly1305_power_on_self_test(), 1);
+
+	for (i = 0; i < sizeof(key); i++) {
+		key[i] = i * 7 + 3;
+	}
+	for (i = 0; i < sizeof(msg); i++) {
+		msg[i] = i * 13 + 1;
+	}
+	for (i = 0; i < sizeof(lengths) / sizeof(*lengths); i++) {
+		// in one piece, long inputs take the vector path
+		poly1305_auth(mac, msg, lengths[i], key);
+		ck_assert_mem_eq(mac, fromhex(macs[i]), 16);
+
+		// in pieces too short for it
+		poly1305_init(&ctx, key);
+		for (j = 0; j < lengths[i]; j += 37) {
+			poly1305_update(&ctx, msg + j, lengths[i] - j < 37 ? lengths[i] - j : 37);
+		}
+		poly1305_finish(&ctx, mac);
+		ck_assert_mem_eq(mac, fromhex(macs[i]), 16);
+	}
+
+	// largest limbs everywhere
+	memset(key, 0xff, sizeof(key));
+	memset(msg, 0xff, sizeof(msg));
+	poly1305_auth(mac, msg, sizeof(msg), key);
+	ck_assert_mem_eq(mac, fromhex("2827279b4c1d3e6b93286238199e131a"), 16);
+}
+END_TEST
+
 #include "test_check_segwit.h"
 #include "test_check_cashaddr.h"
 
@@ -4838,6 +6124,8 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_bignum_digitcount);
 	tcase_add_test(tc, test_bignum_is_less);
 	tcase_add_test(tc, test_bignum_format);
+	tcase_add_test(tc, test_bignum_multiply_secp256k1);
+	tcase_add_test(tc, test_bignum_multiply_nist256p1);
 	tcase_add_test(tc, test_bignum_format_uint64);
 	suite_add_tcase(s, tc);
 
@@ -4847,6 +6135,8 @@ Suite *test_suite(void)
 
 	tc = tcase_create("base58");
 	tcase_add_test(tc, test_base58);
+	tcase_add_test(tc, test_base58_raw);
+	tcase_add_test(tc, test_base58_batch);
 	suite_add_tcase(s, tc);
 
 #if USE_GRAPHENE
@@ -4865,8 +6155,14 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_bip32_vector_3);
 	tcase_add_test(tc, test_bip32_compare);
 	tcase_add_test(tc, test_bip32_optimized);
+	tcase_add_test(tc, test_bip32_batch);
+	tcase_add_test(tc, test_bip32_range);
 	tcase_add_test(tc, test_bip32_cache_1);
 	tcase_add_test(tc, test_bip32_cache_2);
+	tcase_add_test(tc, test_bip32_cache_ctx);
+#if USE_REENTRANT
+	tcase_add_test(tc, test_bip32_cache_threads);
+#endif
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("bip32-nist");
@@ -4895,8 +6191,16 @@ Suite *test_suite(void)
 
 	tc = tcase_create("ecdsa");
 	tcase_add_test(tc, test_ecdsa_signature);
+	tcase_add_test(tc, test_ecdsa_verify_batch_secp256k1);
+	tcase_add_test(tc, test_ecdsa_verify_batch_nist256p1);
 	suite_add_tcase(s, tc);
 
+#if USE_REENTRANT
+	tc = tcase_create("reentrant");
+	tcase_add_test(tc, test_reentrant);
+	suite_add_tcase(s, tc);
+#endif
+
 	tc = tcase_create("rfc6979");
 	tcase_add_test(tc, test_rfc6979);
 	suite_add_tcase(s, tc);
@@ -4927,11 +6231,14 @@ Suite *test_suite(void)
 
 	tc = tcase_create("aes");
 	tcase_add_test(tc, test_aes);
+	tcase_add_test(tc, test_aes_multi_block);
+	tcase_add_test(tc, test_aes_gcm);
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("sha2");
 	tcase_add_test(tc, test_sha1);
 	tcase_add_test(tc, test_sha256);
+	tcase_add_test(tc, test_sha256_multi);
 	tcase_add_test(tc, test_sha512);
 	suite_add_tcase(s, tc);
 
@@ -4939,6 +6246,7 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_sha3_256);
 	tcase_add_test(tc, test_sha3_512);
 	tcase_add_test(tc, test_keccak_256);
+	tcase_add_test(tc, test_keccak_256_x4);
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("blake");
@@ -4950,15 +6258,25 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_blake2s);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("hasher");
+	tcase_add_test(tc, test_hasher);
+	suite_add_tcase(s, tc);
+
 	tc = tcase_create("pbkdf2");
 	tcase_add_test(tc, test_pbkdf2_hmac_sha256);
 	tcase_add_test(tc, test_pbkdf2_hmac_sha512);
+	tcase_add_test(tc, test_pbkdf2_hmac_sha512_batch);
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("bip39");
 	tcase_add_test(tc, test_mnemonic);
 	tcase_add_test(tc, test_mnemonic_check);
 	tcase_add_test(tc, test_mnemonic_to_entropy);
+	tcase_add_test(tc, test_mnemonic_find_word);
+	tcase_add_test(tc, test_mnemonic_seed_cache);
+#if USE_REENTRANT
+	tcase_add_test(tc, test_mnemonic_seed_cache_threads);
+#endif
 	suite_add_tcase(s, tc);
 
 	tc = tcase_create("pubkey_validity");
@@ -5002,6 +6320,12 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_ed25519_keccak);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("ed25519_batch");
+	tcase_add_test(tc, test_ed25519_batch);
+	tcase_add_test(tc, test_ed25519_batch_torsion);
+	tcase_add_test(tc, test_ed25519_batch_mixed_torsion);
+	suite_add_tcase(s, tc);
+
 	tc = tcase_create("ed25519_cosi");
 	tcase_add_test(tc, test_ed25519_cosi);
 	suite_add_tcase(s, tc);
@@ -5052,6 +6376,12 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_rc4_rfc6229);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("chacha20poly1305");
+	tcase_add_test(tc, test_chacha20_keystream);
+	tcase_add_test(tc, test_rfc7539);
+	tcase_add_test(tc, test_poly1305);
+	suite_add_tcase(s, tc);
+
 	tc = tcase_create("segwit");
 	tcase_add_test(tc, test_segwit);
 	suite_add_tcase(s, tc);
@@ -5112,8 +6442,11 @@ Suite *test_suite(void)
 	tcase_add_test(tc, test_xmr_add_keys3);
 	tcase_add_test(tc, test_xmr_get_subaddress_secret_key);
 	tcase_add_test(tc, test_xmr_gen_c);
+	tcase_add_test(tc, test_xmr_h_niels);
 	tcase_add_test(tc, test_xmr_varint);
 	tcase_add_test(tc, test_xmr_gen_range_sig);
+	tcase_add_test(tc, test_xmr_gen_range_sig_batch);
+	tcase_add_test(tc, test_xmr_scan_outputs);
 	suite_add_tcase(s, tc);
 #endif
 	return s;
@@ -1110,6 +1110,54 @@ START_TEST(test_xmr_gen_c)
 END_TEST
 
 
+START_TEST(test_xmr_h_niels)
+{
+	static const char *scalars[] = {
+		"0000000000000000000000000000000000000000000000000000000000000000",
+		"0100000000000000000000000000000000000000000000000000000000000000",
+		"ecd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010",
+		"e3e6558c291bbb98aa691d068b67d59dc520afb23fdd51bf65283626fc2ad903",
+		"ffffffffffffffff000000000000000000000000000000000000000000000000",
+	};
+
+	bignum256modm a, b;
+	ge25519 H, res, res_exp;
+	unsigned char packed[32];
+
+	// the first entry is H itself
+	ge25519_set_xmr_h(&H);
+	set256_modm(a, 1);
+	ge25519_scalarmult_h_niels(&res, a);
+	ck_assert_int_eq(ge25519_eq(&res, &H), 1);
+
+	for (size_t i = 0; i < (sizeof(scalars) / sizeof(*scalars)); i++) {
+		expand256_modm(b, fromhex(scalars[i]), 32);
+		ge25519_scalarmult(&res_exp, &H, b);
+		ge25519_scalarmult_h_niels(&res, b);
+		ck_assert_int_eq(ge25519_eq(&res, &res_exp), 1);
+
+		for (size_t j = 0; j < (sizeof(scalars) / sizeof(*scalars)); j++) {
+			expand256_modm(a, fromhex(scalars[j]), 32);
+			xmr_add_keys2(&res_exp, a, b, &H);
+			xmr_add_keys2_h(&res, a, b);
+			ck_assert_int_eq(ge25519_eq(&res, &res_exp), 1);
+		}
+	}
+
+	for (int i = 0; i < 16; i++) {
+		xmr_random_scalar(a);
+		xmr_random_scalar(b);
+		xmr_add_keys2(&res_exp, a, b, &H);
+		xmr_add_keys2_h(&res, a, b);
+		ge25519_pack(packed, &res);
+		ck_assert_int_eq(ge25519_eq(&res, &res_exp), 1);
+		ck_assert_int_eq(ge25519_unpack_vartime(&res, packed), 1);
+		ck_assert_int_eq(ge25519_check(&res), 1);
+	}
+}
+END_TEST
+
+
 START_TEST(test_xmr_varint)
 {
 	static const struct {
@@ -1222,4 +1270,234 @@ START_TEST(test_xmr_gen_range_sig)
 	}
 }
 END_TEST
+
+#if USE_REENTRANT
+typedef struct {
+	void (*job)(void *, size_t);
+	void *arg;
+	size_t i;
+} test_xmr_parallel_job;
+
+static void *test_xmr_parallel_run(void *arg)
+{
+	test_xmr_parallel_job *j = arg;
+	j->job(j->arg, j->i);
+	return NULL;
+}
+
+// one thread per job
+static void test_xmr_parallel_for_thread(void (*job)(void *, size_t), void *arg, size_t count, void *pool)
+{
+	pthread_t threads[XMR_ATOMS];
+	test_xmr_parallel_job jobs[XMR_ATOMS];
+	(void)pool;
+	ck_assert(count <= XMR_ATOMS);
+	for (size_t i = 0; i < count; i++) {
+		jobs[i].job = job;
+		jobs[i].arg = arg;
+		jobs[i].i = i;
+		ck_assert_int_eq(pthread_create(&threads[i], NULL, test_xmr_parallel_run, &jobs[i]), 0);
+	}
+	for (size_t i = 0; i < count; i++) {
+		ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+	}
+}
+#endif
+
+START_TEST(test_xmr_gen_range_sig_batch)
+{
+	uint64_t tests[] = {
+			0, 1, 65535, 65537, 0xffffffffffffffffULL, 0xdeadc0deULL,
+	};
+
+	unsigned char C_ex[32], C_batch[32];
+	xmr_range_sig_t sig_ex, sig_batch;
+	ge25519 C;
+	bignum256modm mask_ex, mask_batch, last_mask;
+	bignum256modm ai[64], alpha[64];
+	xmr_parallel_for_t parallel_for[] = {
+			NULL,
+#if USE_REENTRANT
+			test_xmr_parallel_for_thread,
+#endif
+	};
+
+	// seeds the platform generator once, so that srand below sticks
+	random32();
+	xmr_random_scalar(last_mask);
+
+	for (size_t i = 0; i < (sizeof(tests) / sizeof(*tests)); i++) {
+		for (size_t p = 0; p < (sizeof(parallel_for) / sizeof(*parallel_for)); p++) {
+			for (int last = 0; last < 2; last++) {
+				srand(i + 1);
+				xmr_gen_range_sig_ex(&sig_ex, &C, mask_ex, tests[i], last ? &last_mask : NULL, ai, alpha);
+				ge25519_pack(C_ex, &C);
+
+				srand(i + 1);
+				xmr_gen_range_sig_batch(&sig_batch, &C, mask_batch, tests[i], last ? &last_mask : NULL, ai, alpha, parallel_for[p], NULL);
+				ge25519_pack(C_batch, &C);
+
+				ck_assert_mem_eq(&sig_ex, &sig_batch, sizeof(sig_ex));
+				ck_assert_mem_eq(C_ex, C_batch, 32);
+				ck_assert_int_eq(eq256_modm(mask_ex, mask_batch), 1);
+				if (last) {
+					ck_assert_int_eq(eq256_modm(mask_batch, last_mask), 1);
+				}
+			}
+		}
+	}
+}
+END_TEST
+
+START_TEST(test_xmr_scan_outputs)
+{
+	enum { TXS = 24, OUTS = 4 };
+	xmr_subaddr_entry_t entries[48];
+	xmr_subaddr_table_t table;
+	xmr_key_t tx_pubs[TXS], additional[TXS][OUTS], outputs[TXS][OUTS], invalid;
+	xmr_scan_tx_t txs[TXS];
+	xmr_scan_match_t expected[TXS * OUTS * 2], matches[TXS * OUTS * 2];
+	size_t expected_count = 0, count;
+	bignum256modm a, b, r, m;
+	ge25519 B, R, D, P, deriv;
+	const xmr_subaddr_entry_t *e;
+
+	xmr_random_scalar(a);
+	xmr_random_scalar(b);
+	ge25519_scalarmult_base_wrapper(&B, b);
+
+	xmr_subaddr_table_init(&table, entries, sizeof(entries) / sizeof(*entries));
+	ck_assert_int_eq(xmr_subaddr_table_add(&table, &B, a, 0, 0, 20), 20);
+	ck_assert_int_eq(xmr_subaddr_table_add(&table, &B, a, 1, 0, 20), 20);
+	ck_assert_int_eq(xmr_subaddr_table_add(&table, &B, a, 2, 5, 100), 8);
+	ck_assert_int_eq(table.count, 48);
+
+	// the main address is B itself, subaddresses B + H_s("SubAddr" || a || major || minor) G
+	for (uint32_t major = 0; major < 3; major++) {
+		for (uint32_t minor = 0; minor < 20; minor++) {
+			unsigned char buff[32];
+			if (major == 0 && minor == 0) {
+				ge25519_copy(&D, &B);
+			} else {
+				xmr_get_subaddress_secret_key(m, major, minor, a);
+				ge25519_scalarmult_base_wrapper(&P, m);
+				ge25519_add(&D, &B, &P, 0);
+			}
+			ge25519_pack(buff, &D);
+			e = xmr_subaddr_table_find(&table, buff);
+			if (major == 2 && (minor < 5 || minor >= 13)) {
+				ck_assert(e == NULL);
+				continue;
+			}
+			ck_assert(e != NULL);
+			ck_assert_int_eq(e->major, major);
+			ck_assert_int_eq(e->minor, minor);
+		}
+	}
+
+	// a y coordinate that is not on the curve
+	memset(invalid, 0, sizeof(invalid));
+	while (ge25519_unpack_vartime(&P, invalid)) {
+		invalid[0]++;
+	}
+
+	for (uint32_t t = 0; t < TXS; t++) {
+		// outputs found with the transaction key come first
+		xmr_scan_match_t found[2][OUTS];
+		size_t found_count[2] = {0, 0};
+
+		txs[t].tx_pub = tx_pubs[t];
+		txs[t].additional_pubs = (t % 5 == 3) ? (const xmr_key_t *)additional[t] : NULL;
+		txs[t].outputs = (const xmr_key_t *)outputs[t];
+		txs[t].output_count = t % 7 == 6 ? 0 : 1 + t % OUTS;
+
+		xmr_random_scalar(r);
+		ge25519_scalarmult_base_wrapper(&R, r);
+		ge25519_pack(tx_pubs[t], &R);
+		xmr_generate_key_derivation(&deriv, &R, a);
+
+		for (uint32_t i = 0; i < txs[t].output_count; i++) {
+			const uint32_t major = (t + i) % 3, minor = major == 2 ? 5 + (t * 7 + i) % 8 : (t * 7 + i) % 20;
+			const int additional_key = txs[t].additional_pubs != NULL && i % 2 == 1;
+			ge25519 deriv_out;
+
+			if (txs[t].additional_pubs != NULL) {
+				xmr_random_scalar(r);
+				ge25519_scalarmult_base_wrapper(&R, r);
+				ge25519_pack(additional[t][i], &R);
+				xmr_generate_key_derivation(&deriv_out, &R, a);
+			}
+			if (!additional_key) {
+				ge25519_copy(&deriv_out, &deriv);
+			}
+
+			if ((t + i) % 4 == 1) {
+				// not ours
+				xmr_random_scalar(r);
+				ge25519_scalarmult_base_wrapper(&P, r);
+				ge25519_pack(outputs[t][i], &P);
+				continue;
+			}
+			if (major == 0 && minor == 0) {
+				ge25519_copy(&D, &B);
+			} else {
+				xmr_get_subaddress_secret_key(m, major, minor, a);
+				ge25519_scalarmult_base_wrapper(&P, m);
+				ge25519_add(&D, &B, &P, 0);
+			}
+			xmr_derive_public_key(&P, &deriv_out, i, &D);
+			ge25519_pack(outputs[t][i], &P);
+
+			found[additional_key][found_count[additional_key]].tx = t;
+			found[additional_key][found_count[additional_key]].output = i;
+			found[additional_key][found_count[additional_key]].major = major;
+			found[additional_key][found_count[additional_key]].minor = minor;
+			ge25519_pack(found[additional_key][found_count[additional_key]].derivation, &deriv_out);
+			found_count[additional_key]++;
+		}
+		for (int k = 0; k < 2; k++) {
+			memcpy(&expected[expected_count], found[k], found_count[k] * sizeof(xmr_scan_match_t));
+			expected_count += found_count[k];
+		}
+	}
+
+	count = xmr_scan_outputs(&table, a, txs, TXS, matches, sizeof(matches) / sizeof(*matches));
+	ck_assert_int_eq(count, expected_count);
+	for (size_t j = 0; j < count; j++) {
+		ck_assert_int_eq(matches[j].tx, expected[j].tx);
+		ck_assert_int_eq(matches[j].output, expected[j].output);
+		ck_assert_int_eq(matches[j].major, expected[j].major);
+		ck_assert_int_eq(matches[j].minor, expected[j].minor);
+		ck_assert_mem_eq(matches[j].derivation, expected[j].derivation, 32);
+	}
+
+	// truncated
+	count = xmr_scan_outputs(&table, a, txs, TXS, matches, 3);
+	ck_assert_int_eq(count, 3);
+	ck_assert_int_eq(matches[2].tx, expected[2].tx);
+	ck_assert_int_eq(matches[2].output, expected[2].output);
+
+	// keys and outputs that are not points are skipped
+	memcpy(tx_pubs[0], invalid, 32);
+	memcpy(outputs[2][0], invalid, 32);
+	count = 0;
+	for (size_t j = 0; j < expected_count; j++) {
+		if (expected[j].tx != 0 && !(expected[j].tx == 2 && expected[j].output == 0)) {
+			memcpy(&expected[count++], &expected[j], sizeof(xmr_scan_match_t));
+		}
+	}
+	ck_assert(count < expected_count);
+	expected_count = count;
+	count = xmr_scan_outputs(&table, a, txs, TXS, matches, sizeof(matches) / sizeof(*matches));
+	ck_assert_int_eq(count, expected_count);
+	for (size_t j = 0; j < count; j++) {
+		ck_assert_int_eq(matches[j].tx, expected[j].tx);
+		ck_assert_int_eq(matches[j].output, expected[j].output);
+	}
+
+	// another view key finds nothing
+	xmr_random_scalar(b);
+	ck_assert_int_eq(xmr_scan_outputs(&table, b, txs, TXS, matches, sizeof(matches) / sizeof(*matches)), 0);
+}
+END_TEST
 #endif
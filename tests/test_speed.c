@@ -10,6 +10,16 @@
 #include "nist256p1.h"
 #include "ed25519-donna/ed25519.h"
 #include "hasher.h"
+#include "sha2.h"
+#include "sha3.h"
+#include "base58.h"
+#include "chacha20poly1305/rfc7539.h"
+#include "aes/aes.h"
+#include "aes/aes_gcm.h"
+#if USE_REENTRANT
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 static uint8_t msg[256];
 
@@ -120,6 +130,48 @@ void bench_verify_nist256p1_65(int iterations)
 	}
 }
 
+#define VERIFY_BATCH 64
+
+static uint8_t batch_pubs[VERIFY_BATCH][33], batch_sigs[VERIFY_BATCH][64], batch_digests[VERIFY_BATCH][32];
+static const uint8_t *batch_ppubs[VERIFY_BATCH], *batch_psigs[VERIFY_BATCH], *batch_pdigests[VERIFY_BATCH];
+
+void prepare_verify_batch(void)
+{
+	uint8_t priv[32];
+
+	const ecdsa_curve *curve = &secp256k1;
+
+	memcpy(priv, "\xc5\x5e\xce\x85\x8b\x0d\xdd\x52\x63\xf9\x68\x10\xfe\x14\x43\x7c\xd3\xb5\xe1\xfb\xd7\xc6\xa2\xec\x1e\x03\x1f\x05\xe8\x6d\x8b\xd5", 32);
+	for (int i = 0; i < VERIFY_BATCH; i++) {
+		priv[0] = i;
+		ecdsa_get_public_key33(curve, priv, batch_pubs[i]);
+		hasher_Raw(HASHER_SHA2, priv, sizeof(priv), batch_digests[i]);
+		ecdsa_sign_digest(curve, priv, batch_digests[i], batch_sigs[i], NULL, NULL);
+		batch_ppubs[i] = batch_pubs[i];
+		batch_psigs[i] = batch_sigs[i];
+		batch_pdigests[i] = batch_digests[i];
+	}
+}
+
+void bench_verify_secp256k1_loop(int iterations)
+{
+	const ecdsa_curve *curve = &secp256k1;
+
+	for (int i = 0 ; i < iterations; i++) {
+		ecdsa_verify_digest(curve, batch_pubs[i % VERIFY_BATCH], batch_sigs[i % VERIFY_BATCH], batch_digests[i % VERIFY_BATCH]);
+	}
+}
+
+void bench_verify_secp256k1_batch(int iterations)
+{
+	const ecdsa_curve *curve = &secp256k1;
+
+	for (int i = 0 ; i < iterations; i += VERIFY_BATCH) {
+		int n = iterations - i < VERIFY_BATCH ? iterations - i : VERIFY_BATCH;
+		ecdsa_verify_digest_batch(curve, n, batch_ppubs, batch_psigs, batch_pdigests, NULL);
+	}
+}
+
 void bench_verify_ed25519(int iterations)
 {
 	ed25519_public_key pk;
@@ -135,6 +187,37 @@ void bench_verify_ed25519(int iterations)
 	}
 }
 
+static ed25519_public_key ed25519_batch_pks[ED25519_VERIFY_BATCH_SIZE];
+static ed25519_signature ed25519_batch_sigs[ED25519_VERIFY_BATCH_SIZE];
+static const unsigned char *ed25519_batch_m[ED25519_VERIFY_BATCH_SIZE], *ed25519_batch_ppks[ED25519_VERIFY_BATCH_SIZE], *ed25519_batch_psigs[ED25519_VERIFY_BATCH_SIZE];
+static size_t ed25519_batch_mlen[ED25519_VERIFY_BATCH_SIZE];
+
+void prepare_verify_batch_ed25519(void)
+{
+	ed25519_secret_key sk;
+
+	memcpy(sk, "\xc5\x5e\xce\x85\x8b\x0d\xdd\x52\x63\xf9\x68\x10\xfe\x14\x43\x7c\xd3\xb5\xe1\xfb\xd7\xc6\xa2\xec\x1e\x03\x1f\x05\xe8\x6d\x8b\xd5", 32);
+	for (int i = 0; i < ED25519_VERIFY_BATCH_SIZE; i++) {
+		sk[0] = i;
+		ed25519_publickey(sk, ed25519_batch_pks[i]);
+		ed25519_sign(msg, sizeof(msg), sk, ed25519_batch_pks[i], ed25519_batch_sigs[i]);
+		ed25519_batch_m[i] = msg;
+		ed25519_batch_mlen[i] = sizeof(msg);
+		ed25519_batch_ppks[i] = ed25519_batch_pks[i];
+		ed25519_batch_psigs[i] = ed25519_batch_sigs[i];
+	}
+}
+
+void bench_verify_ed25519_batch(int iterations)
+{
+	int valid[ED25519_VERIFY_BATCH_SIZE];
+
+	for (int i = 0 ; i < iterations; i += ED25519_VERIFY_BATCH_SIZE) {
+		int n = iterations - i < ED25519_VERIFY_BATCH_SIZE ? iterations - i : ED25519_VERIFY_BATCH_SIZE;
+		ed25519_sign_open_batch(ed25519_batch_m, ed25519_batch_mlen, ed25519_batch_ppks, ed25519_batch_psigs, n, valid);
+	}
+}
+
 void bench_multiply_curve25519(int iterations)
 {
 	uint8_t result[32];
@@ -179,6 +262,166 @@ void bench_ckd_optimized(int iterations)
 	}
 }
 
+void bench_ckd_range(int iterations)
+{
+	char addr[MAX_ADDR_SIZE];
+	uint8_t public_key[33];
+	HDNodePublicRange range;
+	hdnode_public_ckd_range_begin(&range, &root, 0, iterations);
+	while (hdnode_public_ckd_range_next(&range, NULL, public_key, NULL)) {
+		ecdsa_get_address(public_key, HASHER_SHA2, HASHER_SHA2D, 0, addr, sizeof(addr));
+	}
+	hdnode_public_ckd_range_end(&range);
+}
+
+void bench_sha256(int iterations)
+{
+	uint8_t digest[SHA256_DIGEST_LENGTH];
+	for (int i = 0; i < iterations; i++) {
+		sha256_Raw(msg + (i & 0x7f), 32, digest);
+	}
+}
+
+void bench_sha256_x4(int iterations)
+{
+	uint8_t digests[4][SHA256_DIGEST_LENGTH];
+	const uint8_t *data[4];
+	for (int i = 0; i < iterations; i += 4) {
+		for (int l = 0; l < 4; l++) {
+			data[l] = msg + ((i + l) & 0x7f);
+		}
+		sha256_Raw_x4(data, 32, digests);
+	}
+}
+
+void bench_sha256_x8(int iterations)
+{
+	uint8_t digests[8][SHA256_DIGEST_LENGTH];
+	const uint8_t *data[8];
+	for (int i = 0; i < iterations; i += 8) {
+		for (int l = 0; l < 8; l++) {
+			data[l] = msg + ((i + l) & 0x7f);
+		}
+		sha256_Raw_x8(data, 32, digests);
+	}
+}
+
+// 64 bytes, an uncompressed public key without prefix as hashed for
+// Ethereum addresses
+void bench_keccak_256(int iterations)
+{
+	uint8_t digest[SHA3_256_DIGEST_LENGTH];
+	for (int i = 0; i < iterations; i++) {
+		keccak_256(msg + (i & 0x7f), 64, digest);
+	}
+}
+
+void bench_keccak_256_x4(int iterations)
+{
+	uint8_t digests[4][SHA3_256_DIGEST_LENGTH];
+	const uint8_t *data[4];
+	for (int i = 0; i < iterations; i += 4) {
+		for (int l = 0; l < 4; l++) {
+			data[l] = msg + ((i + l) & 0x7f);
+		}
+		keccak_256_x4(data, 64, digests);
+	}
+}
+
+// 82 bytes, the size of a serialized extended public key
+void bench_base58_encode(int iterations)
+{
+	char str[120];
+	for (int i = 0; i < iterations; i++) {
+		base58_encode_check(msg + (i & 0x7f), 82, HASHER_SHA2D, str, sizeof(str));
+	}
+}
+
+void bench_base58_encode_batch(int iterations)
+{
+	char str[16][120];
+	for (int i = 0; i < iterations; i += 16) {
+		base58_encode_check_batch(msg + (i & 0x7f), 82, 16, HASHER_SHA2D, str[0], sizeof(str[0]));
+	}
+}
+
+void bench_base58_decode(int iterations)
+{
+	char str[120];
+	uint8_t data[82];
+	base58_encode_check(msg, 82, HASHER_SHA2D, str, sizeof(str));
+	for (int i = 0; i < iterations; i++) {
+		base58_decode_check(str, HASHER_SHA2D, data, sizeof(data));
+	}
+}
+
+// one operation is 4 KiB of data
+void bench_chacha20(int iterations)
+{
+	static uint8_t buf[4096];
+	ECRYPT_ctx ctx;
+	ECRYPT_keysetup(&ctx, msg, 256, 64);
+	ECRYPT_ivsetup(&ctx, msg + 32);
+	for (int i = 0; i < iterations; i++) {
+		ECRYPT_encrypt_bytes(&ctx, buf, buf, sizeof(buf));
+	}
+}
+
+void bench_poly1305(int iterations)
+{
+	static uint8_t buf[4096];
+	uint8_t mac[16];
+	for (int i = 0; i < iterations; i++) {
+		poly1305_auth(mac, buf, sizeof(buf), msg);
+	}
+}
+
+void bench_rfc7539(int iterations)
+{
+	static uint8_t buf[4096];
+	uint8_t tag[16];
+	chacha20poly1305_ctx ctx;
+	for (int i = 0; i < iterations; i++) {
+		rfc7539_init(&ctx, msg, msg + 32);
+		rfc7539_auth(&ctx, msg + 64, 16);
+		chacha20poly1305_encrypt(&ctx, buf, buf, sizeof(buf));
+		rfc7539_finish(&ctx, 16, sizeof(buf), tag);
+	}
+}
+
+void bench_aes_ctr(int iterations)
+{
+	static uint8_t buf[4096];
+	uint8_t cbuf[16] = {0};
+	aes_encrypt_ctx ctx;
+	aes_encrypt_key256(msg, &ctx);
+	for (int i = 0; i < iterations; i++) {
+		aes_ctr_crypt(buf, buf, sizeof(buf), cbuf, aes_ctr_cbuf_inc, &ctx);
+	}
+}
+
+void bench_aes_cbc_decrypt(int iterations)
+{
+	static uint8_t buf[4096];
+	uint8_t iv[16] = {0};
+	aes_decrypt_ctx ctx;
+	aes_decrypt_key256(msg, &ctx);
+	for (int i = 0; i < iterations; i++) {
+		aes_cbc_decrypt(buf, buf, sizeof(buf), iv, &ctx);
+	}
+}
+
+void bench_aes_gcm(int iterations)
+{
+	static uint8_t buf[4096];
+	uint8_t tag[16];
+	aes_gcm_ctx ctx;
+	aes_gcm_init_key(msg, 32, &ctx);
+	for (int i = 0; i < iterations; i++) {
+		aes_gcm_encrypt_message(msg + 32, 12, msg + 64, 16, buf, buf, sizeof(buf), tag, sizeof(tag), &ctx);
+	}
+}
+
 void bench(void (*func)(int), const char *name, int iterations)
 {
 	clock_t t = clock();
@@ -189,6 +432,57 @@ void bench(void (*func)(int), const char *name, int iterations)
 
 #define BENCH(FUNC, ITER) bench(FUNC, #FUNC, ITER)
 
+#if USE_REENTRANT
+
+struct bench_job {
+	void (*func)(int);
+	int iterations;
+};
+
+static void *bench_thread(void *arg)
+{
+	const struct bench_job *job = arg;
+	job->func(job->iterations);
+	return NULL;
+}
+
+static double wallclock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// run func(iterations) in 1, 2, 4, ... threads at once and report the
+// total throughput. clock() would add up the CPU time of all threads,
+// so this measures wall clock time instead.
+void bench_threads(void (*func)(int), const char *name, int iterations)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	struct bench_job job = { func, iterations };
+	pthread_t threads[cpus > 0 ? cpus : 1];
+	double single = 0;
+
+	for (long n = 1; n <= cpus; n = (n * 2 > cpus && n < cpus) ? cpus : n * 2) {
+		double t = wallclock();
+		for (long i = 0; i < n; i++) {
+			pthread_create(&threads[i], NULL, bench_thread, &job);
+		}
+		for (long i = 0; i < n; i++) {
+			pthread_join(threads[i], NULL);
+		}
+		float speed = n * iterations / (wallclock() - t);
+		if (n == 1) {
+			single = speed;
+		}
+		printf("%25s: %8.2f ops/s (%ld threads, %.2fx)\n", name, speed, n, speed / single);
+	}
+}
+
+#define BENCH_THREADS(FUNC, ITER) bench_threads(FUNC, #FUNC, ITER)
+
+#endif
+
 int main(void) {
 
 	prepare_msg();
@@ -197,6 +491,11 @@ int main(void) {
 	BENCH(bench_verify_secp256k1_33, 500);
 	BENCH(bench_verify_secp256k1_65, 500);
 
+	prepare_verify_batch();
+
+	BENCH(bench_verify_secp256k1_loop, 512);
+	BENCH(bench_verify_secp256k1_batch, 512);
+
 	BENCH(bench_sign_nist256p1, 500);
 	BENCH(bench_verify_nist256p1_33, 500);
 	BENCH(bench_verify_nist256p1_65, 500);
@@ -204,12 +503,41 @@ int main(void) {
 	BENCH(bench_sign_ed25519, 4000);
 	BENCH(bench_verify_ed25519, 4000);
 
+	prepare_verify_batch_ed25519();
+
+	BENCH(bench_verify_ed25519_batch, 4096);
+
 	BENCH(bench_multiply_curve25519, 4000);
 
 	prepare_node();
 
 	BENCH(bench_ckd_normal, 1000);
 	BENCH(bench_ckd_optimized, 1000);
+	BENCH(bench_ckd_range, 1000);
+
+	BENCH(bench_sha256, 1000000);
+	BENCH(bench_sha256_x4, 1000000);
+	BENCH(bench_sha256_x8, 1000000);
+
+	BENCH(bench_keccak_256, 1000000);
+	BENCH(bench_keccak_256_x4, 1000000);
+
+	BENCH(bench_chacha20, 20000);
+	BENCH(bench_poly1305, 20000);
+	BENCH(bench_rfc7539, 20000);
+
+	BENCH(bench_aes_ctr, 20000);
+	BENCH(bench_aes_cbc_decrypt, 20000);
+	BENCH(bench_aes_gcm, 20000);
+
+	BENCH(bench_base58_encode, 100000);
+	BENCH(bench_base58_encode_batch, 100000);
+	BENCH(bench_base58_decode, 100000);
+
+#if USE_REENTRANT
+	BENCH_THREADS(bench_sign_secp256k1, 500);
+	BENCH_THREADS(bench_ckd_normal, 1000);
+#endif
 
 	return 0;
 }
@@ -221,6 +221,55 @@ def chacha_poly_decrypt(key, iv, associated_data, ciphertext, tag):
     return plaintext if tag == computed_tag else False
 
 
+def aes_gcm_encrypt(key, iv, associated_data, plaintext, tag_length):
+    context = bytes(context_structure_length)
+    tag = bytes(tag_length)
+    ciphertext = bytes(len(plaintext))
+    if lib.aes_gcm_init_key(key, len(key), context) != 0:
+        return False, False
+    if (
+        lib.aes_gcm_encrypt_message(
+            iv,
+            ctypes.c_size_t(len(iv)),
+            associated_data,
+            ctypes.c_size_t(len(associated_data)),
+            plaintext,
+            ciphertext,
+            ctypes.c_size_t(len(plaintext)),
+            tag,
+            ctypes.c_size_t(tag_length),
+            context,
+        )
+        != 0
+    ):
+        return False, False
+    return ciphertext, tag
+
+
+def aes_gcm_decrypt(key, iv, associated_data, ciphertext, tag):
+    context = bytes(context_structure_length)
+    plaintext = bytes(len(ciphertext))
+    if lib.aes_gcm_init_key(key, len(key), context) != 0:
+        return False
+    if (
+        lib.aes_gcm_decrypt_message(
+            iv,
+            ctypes.c_size_t(len(iv)),
+            associated_data,
+            ctypes.c_size_t(len(associated_data)),
+            ciphertext,
+            plaintext,
+            ctypes.c_size_t(len(ciphertext)),
+            tag,
+            ctypes.c_size_t(len(tag)),
+            context,
+        )
+        != 0
+    ):
+        return False
+    return plaintext
+
+
 def add_pkcs_padding(data):
     padding_length = 16 - len(data) % 16
     return data + bytes([padding_length] * padding_length)
@@ -379,6 +428,61 @@ def generate_chacha_poly(filename):
     return vectors
 
 
+def generate_aes_gcm(filename):
+    vectors = []
+
+    data = load_json_testvectors(filename)
+
+    if not keys_in_dict(data, {"algorithm", "testGroups"}):
+        raise DataError()
+
+    if data["algorithm"] != "AES-GCM":
+        raise DataError()
+
+    for test_group in data["testGroups"]:
+        if not keys_in_dict(test_group, {"tests"}):
+            raise DataError()
+
+        for test in test_group["tests"]:
+            if not keys_in_dict(
+                test, {"key", "iv", "aad", "msg", "ct", "tag", "result"}
+            ):
+                raise DataError()
+            try:
+                key = unhexlify(test["key"])
+                iv = unhexlify(test["iv"])
+                associated_data = unhexlify(test["aad"])
+                plaintext = unhexlify(test["msg"])
+                ciphertext = unhexlify(test["ct"])
+                tag = unhexlify(test["tag"])
+                result = parse_result(test["result"])
+            except:
+                raise DataError()
+
+            if len(key) not in [128 / 8, 192 / 8, 256 / 8]:
+                continue
+
+            # aes_gcm refuses tags shorter than 12 bytes
+            if len(tag) < 12:
+                continue
+
+            if result is None:
+                continue
+
+            vectors.append(
+                (
+                    hexlify(key),
+                    hexlify(iv),
+                    hexlify(associated_data),
+                    hexlify(plaintext),
+                    hexlify(ciphertext),
+                    hexlify(tag),
+                    result,
+                )
+            )
+    return vectors
+
+
 def generate_curve25519_dh(filename):
     vectors = []
 
@@ -617,6 +721,7 @@ ecdh_vectors = (
 )
 chacha_poly_vectors = generate_chacha_poly("chacha20_poly1305_test.json")
 aes_vectors = generate_aes("aes_cbc_pkcs5_test.json")
+aes_gcm_vectors = generate_aes_gcm("aes_gcm_test.json")
 
 
 @pytest.mark.parametrize("public_key, message, signature, result", eddsa_vectors)
@@ -719,3 +824,25 @@ def test_aes(key, iv, plaintext, ciphertext, result):
     computed_plaintext = aes_cbc_decrypt(key, bytes(iv), ciphertext)
     computed_result = plaintext == computed_plaintext
     assert result == computed_result
+
+
+@pytest.mark.parametrize(
+    "key, iv, associated_data, plaintext, ciphertext, tag, result", aes_gcm_vectors
+)
+def test_aes_gcm(key, iv, associated_data, plaintext, ciphertext, tag, result):
+    key = unhexlify(key)
+    iv = unhexlify(iv)
+    associated_data = unhexlify(associated_data)
+    plaintext = unhexlify(plaintext)
+    ciphertext = unhexlify(ciphertext)
+    tag = unhexlify(tag)
+
+    computed_ciphertext, computed_tag = aes_gcm_encrypt(
+        key, iv, associated_data, plaintext, len(tag)
+    )
+    computed_result = ciphertext == computed_ciphertext and tag == computed_tag
+    assert result == computed_result
+
+    computed_plaintext = aes_gcm_decrypt(key, iv, associated_data, ciphertext, tag)
+    computed_result = plaintext == computed_plaintext
+    assert result == computed_result
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <string.h>
+#include "ed25519-donna/ed25519-donna.h"
+#include "monero/xmr.h"
+
+/*
+ * This program prints a table of ed25519 points in packed niels form
+ * {y - x, y + x, 2 * d * x * y}, as used by ge25519_scalarmult_base_niels.
+ * The entry table[8*i+j] contains the point (j+1)*256^i*P, where P is
+ * either the base point G or the Monero commitment generator H. The first
+ * row keeps 2 * x * y, ge25519_scalarmult_base_niels starts from one of
+ * its points and multiplies in d itself.
+ */
+int main(int argc, char **argv) {
+	ge25519 base, pow256i, jp;
+	bignum25519 zi, x, y, t;
+	unsigned char packed[96];
+	int i, j, k;
+
+	if (argc == 2 && strcmp(argv[1], "G") == 0) {
+		ge25519_set_base(&base);
+	} else if (argc == 2 && strcmp(argv[1], "H") == 0) {
+		ge25519_set_xmr_h(&base);
+	} else {
+		printf("Usage: %s G|H\n", argv[0]);
+		return 1;
+	}
+
+	ge25519_copy(&pow256i, &base);
+	for (i = 0; i < 32; i++) {
+		// invariant: pow256i = 256^i * P
+		ge25519_copy(&jp, &pow256i);
+		for (j = 0; j < 8; j++) {
+			// invariant: jp = (j+1) * 256^i * P
+			curve25519_recip(zi, jp.z);
+			curve25519_mul(x, jp.x, zi);
+			curve25519_mul(y, jp.y, zi);
+			curve25519_sub_reduce(t, y, x);
+			curve25519_contract(packed, t);
+			curve25519_add_reduce(t, y, x);
+			curve25519_contract(packed + 32, t);
+			curve25519_mul(t, x, y);
+			if (i == 0) {
+				curve25519_add_reduce(t, t, t);
+			} else {
+				curve25519_mul(t, t, ge25519_ec2d);
+			}
+			curve25519_contract(packed + 64, t);
+
+			printf("\t{");
+			for (k = 0; k < 96; k++) {
+				printf(k < 95 ? "0x%02x," : "0x%02x", packed[k]);
+			}
+			printf(i == 31 && j == 7 ? "}\n" : "},\n");
+
+			ge25519_add(&jp, &jp, &pow256i, 0);
+		}
+		for (k = 0; k < 8; k++) {
+			ge25519_double(&pow256i, &pow256i);
+		}
+	}
+	return 0;
+}
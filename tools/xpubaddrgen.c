@@ -1,7 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include "bip32.h"
 #include "curves.h"
 #include "ecdsa.h"
@@ -9,29 +11,172 @@
 #define VERSION_PUBLIC  0x0488b21e
 #define VERSION_PRIVATE 0x0488ade4
 
+// number of addresses a worker derives at once
+#define BLOCK_SIZE 256
+// "<jobid> <index> <address>\n" is at most 10 + 1 + 10 + 1 + 35 + 1 bytes
+#define LINE_SIZE 64
+
+static int threads = 1;
+
+typedef struct {
+	int64_t block;    // block stored in buf, -1 if the slot is free
+	int ready;        // buf holds the complete output of block
+	size_t len;
+	char buf[BLOCK_SIZE * LINE_SIZE];
+} slot_t;
+
+typedef struct {
+	uint32_t jobid, from, to;
+	HDNode node;
+	int64_t next_block, blocks;
+	slot_t *slots;
+	int nslots;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} job_t;
+
+static size_t format_block(job_t *job, int64_t block, char *buf)
+{
+	uint8_t public_keys[BLOCK_SIZE * 33];
+	char address[36];
+	uint32_t first = job->from + block * BLOCK_SIZE;
+	uint32_t count = job->to - first < BLOCK_SIZE ? job->to - first : BLOCK_SIZE;
+	uint32_t i;
+	size_t len = 0;
+
+	if (!hdnode_public_ckd_batch(&job->node, first, count, public_keys)) {
+		return snprintf(buf, LINE_SIZE, "%d error\n", job->jobid);
+	}
+	for (i = 0; i < count; i++) {
+		ecdsa_get_address(public_keys + 33 * i, 0, HASHER_SHA2, HASHER_SHA2D, address, sizeof(address));
+		len += snprintf(buf + len, LINE_SIZE, "%d %d %s\n", job->jobid, first + i, address);
+	}
+	return len;
+}
+
+// workers take blocks in increasing order and put the result into the
+// slot block % nslots, once the writer has consumed its previous content.
+static void *worker(void *arg)
+{
+	job_t *job = arg;
+
+	for (;;) {
+		pthread_mutex_lock(&job->lock);
+		int64_t block = job->next_block++;
+		if (block >= job->blocks) {
+			pthread_mutex_unlock(&job->lock);
+			return NULL;
+		}
+		slot_t *slot = &job->slots[block % job->nslots];
+		while (slot->block != -1) {
+			pthread_cond_wait(&job->cond, &job->lock);
+		}
+		slot->block = block;
+		slot->ready = 0;
+		pthread_mutex_unlock(&job->lock);
+
+		size_t len = format_block(job, block, slot->buf);
+
+		pthread_mutex_lock(&job->lock);
+		slot->len = len;
+		slot->ready = 1;
+		pthread_cond_broadcast(&job->cond);
+		pthread_mutex_unlock(&job->lock);
+	}
+}
+
 void process_job(uint32_t jobid, const char *xpub, uint32_t change, uint32_t from, uint32_t to)
 {
-	HDNode node, child;
-	if (change > 1 || to <= from || hdnode_deserialize(xpub, VERSION_PUBLIC, VERSION_PRIVATE, SECP256K1_NAME, &node, NULL) != 0) {
+	job_t job;
+	pthread_t *tid;
+	int64_t block;
+	int i, started = 0;
+
+	if (change > 1 || to <= from || to > 0x80000000 || hdnode_deserialize(xpub, VERSION_PUBLIC, VERSION_PRIVATE, SECP256K1_NAME, &job.node, NULL) != 0) {
 		printf("%d error\n", jobid);
 		return;
 	}
-	hdnode_public_ckd(&node, change);
-	uint32_t i;
-	char address[36];
-	for (i = from; i < to; i++) {
-		memcpy(&child, &node, sizeof(HDNode));
-		hdnode_public_ckd(&child, i);
-		ecdsa_get_address(child.public_key, 0, HASHER_SHA2, HASHER_SHA2D, address, sizeof(address));
-		printf("%d %d %s\n", jobid, i, address);
+	hdnode_public_ckd(&job.node, change);
+
+	job.jobid = jobid;
+	job.from = from;
+	job.to = to;
+	job.next_block = 0;
+	job.blocks = ((int64_t)to - from + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	job.nslots = 2 * threads;
+	job.slots = malloc(job.nslots * sizeof(slot_t));
+	tid = malloc(threads * sizeof(pthread_t));
+	if (!job.slots || !tid) {
+		free(job.slots);
+		free(tid);
+		printf("%d error\n", jobid);
+		return;
 	}
+	for (i = 0; i < job.nslots; i++) {
+		job.slots[i].block = -1;
+	}
+	pthread_mutex_init(&job.lock, NULL);
+	pthread_cond_init(&job.cond, NULL);
+
+	// with a single thread the writer derives the addresses itself
+	for (i = 0; i < threads && threads > 1; i++) {
+		if (pthread_create(&tid[i], NULL, worker, &job) != 0) {
+			break;
+		}
+		started++;
+	}
+
+	// write the blocks in order as they become ready
+	for (block = 0; block < job.blocks; block++) {
+		slot_t *slot = &job.slots[block % job.nslots];
+		if (started == 0) {
+			// no worker threads, do the job ourselves
+			slot->len = format_block(&job, block, slot->buf);
+		} else {
+			pthread_mutex_lock(&job.lock);
+			while (slot->block != block || !slot->ready) {
+				pthread_cond_wait(&job.cond, &job.lock);
+			}
+			pthread_mutex_unlock(&job.lock);
+		}
+		fwrite(slot->buf, 1, slot->len, stdout);
+		// hand each block to the reader right away
+		fflush(stdout);
+		pthread_mutex_lock(&job.lock);
+		slot->block = -1;
+		pthread_cond_broadcast(&job.cond);
+		pthread_mutex_unlock(&job.lock);
+	}
+
+	for (i = 0; i < started; i++) {
+		pthread_join(tid[i], NULL);
+	}
+	pthread_cond_destroy(&job.cond);
+	pthread_mutex_destroy(&job.lock);
+	free(job.slots);
+	free(tid);
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
 	char line[1024], xpub[1024];
 	uint32_t jobid, change, from, to;
 	int r;
+
+	if (argc == 3 && strcmp(argv[1], "-t") == 0) {
+		threads = atoi(argv[2]);
+	} else if (argc != 1) {
+		fprintf(stderr, "Usage: %s [-t threads]\n", argv[0]);
+		return 1;
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+
+	// full buffering, stdout is flushed after every block and every job
+	static char outbuf[BLOCK_SIZE * LINE_SIZE];
+	setvbuf(stdout, outbuf, _IOFBF, sizeof(outbuf));
+
 	for (;;) {
 		if (!fgets(line, sizeof(line), stdin)) break;
 		r = sscanf(line, "%u %s %u %u %u\n", &jobid, xpub, &change, &from, &to);
@@ -42,6 +187,7 @@ int main(void)
 		} else {
 			process_job(jobid, xpub, change, from, to);
 		}
+		fflush(stdout);
 	}
 	return 0;
 }